@@ -141,9 +141,11 @@ protected:
     const LandUseHistory* mLandUseHistory;
     
     //! The difference in the sigmoid curve by year offset + 1 - year offset.
-    //! This value get precomputed during initcalc to avoid doing the computationally
-    //! expensive operations during calc.
-    std::vector<double> precalc_sigmoid_diff;
+    //! This is only calculated when the mature age is greater than 1.
+    std::vector<double> mSigmoidKernel;
+
+    //! The fraction of a change in soil carbon occurring by year offset.
+    std::vector<double> mSoilDecayKernel;
     
     //! Flag to ensure historical emissions are only calculated a single time
     //! since they can not be reset.
@@ -166,6 +168,12 @@ private:
                            const int aYear,
                            const int aEndYear,
                            objects::YearVector<double>& aEmissVector);
+
+    static void addKernelResponse( const double aCarbonDiff,
+                                   const std::vector<double>& aKernel,
+                                   const int aYear,
+                                   const int aEndYear,
+                                   objects::YearVector<double>& aEmissVector );
 };
 
 #endif // _ASIMPLE_CARBON_CALC_H_
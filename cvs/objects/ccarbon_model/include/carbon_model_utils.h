@@ -44,6 +44,7 @@
  * \author Jim Naslund and Ming Chang
  */
 
+#include <vector>
 #include "util/base/include/time_vector.h"
 
 class LandUseHistory;
@@ -65,6 +66,10 @@ public:
     static int getStartYear();
     static int getEndYear();
 
+    static void calcSoilDecayKernel( const int aSoilTimeScale, std::vector<double>& aKernel );
+
+    static void calcSigmoidKernel( const int aMatureAge, std::vector<double>& aKernel );
+
     static double interpYearHelper( const objects::PeriodVector<double>& aPeriodVector,
                                     const unsigned int aYear );
 
@@ -55,19 +55,19 @@ using namespace objects;
 extern Scenario* scenario;
 
 ASimpleCarbonCalc::ASimpleCarbonCalc():
+    mStoredEmissionsAbove(0),
+    mStoredEmissionsBelow(0),
     mTotalEmissions(CarbonModelUtils::getStartYear(), CarbonModelUtils::getEndYear()),
     mTotalEmissionsAbove(CarbonModelUtils::getStartYear(), CarbonModelUtils::getEndYear()),
     mTotalEmissionsBelow(CarbonModelUtils::getStartYear(), CarbonModelUtils::getEndYear()),
     mCarbonStock(scenario->getModeltime()->getStartYear(), CarbonModelUtils::getEndYear()),
-    mLandUseHistory( 0 ),
     mSoilTimeScale( CarbonModelUtils::getSoilTimeScale() ),
-    precalc_sigmoid_diff(  /* only allocate space if necessary i.e. mature age > 1 */ ),
-    mStoredEmissionsAbove(0),
-    mStoredEmissionsBelow(0),
+    mLandUseHistory( 0 ),
     mHasCalculatedHistoricEmiss( false )
 {
     int endYear = CarbonModelUtils::getEndYear();
     const Modeltime* modeltime = scenario->getModeltime();
+    CarbonModelUtils::calcSoilDecayKernel( mSoilTimeScale, mSoilDecayKernel );
 
     // Note we are not allocating space for period zero since that is historical
     // and can never be calculated more than once.
@@ -138,13 +138,22 @@ void ASimpleCarbonCalc::calc( const int aPeriod, const int aEndYear ) {
         int year = prevModelYear + 1;
         YearVector<double>& currEmissionsAbove = *mStoredEmissionsAbove[ aPeriod ];
         YearVector<double>& currEmissionsBelow = *mStoredEmissionsBelow[ aPeriod ];
+
+        // The emissions from the first year of the period on are contiguous
+        // in each vector, so they are cleared and totaled as arrays.
+        const int numYears = aEndYear - year + 1;
+        double* currAbove = &currEmissionsAbove[ year ];
+        double* currBelow = &currEmissionsBelow[ year ];
+        double* totalAbove = &mTotalEmissionsAbove[ year ];
+        double* totalBelow = &mTotalEmissionsBelow[ year ];
+        double* total = &mTotalEmissions[ year ];
         
         // clear the previously calculated emissions first
-        for( ; year <= aEndYear; ++year ) {
-            mTotalEmissionsAbove[ year ] -= currEmissionsAbove[ year ];
-            currEmissionsAbove[ year ] = 0.0;
-            mTotalEmissionsBelow[ year ] -= currEmissionsBelow[ year ];
-            currEmissionsBelow[ year ] = 0.0;
+        for( int i = 0; i < numYears; ++i ) {
+            totalAbove[ i ] -= currAbove[ i ];
+            currAbove[ i ] = 0.0;
+            totalBelow[ i ] -= currBelow[ i ];
+            currBelow[ i ] = 0.0;
         }
         
         year = prevModelYear;
@@ -164,10 +173,10 @@ void ASimpleCarbonCalc::calc( const int aPeriod, const int aEndYear ) {
         }
         
         // add current emissions to the total
-        for( year = prevModelYear + 1; year <= aEndYear; ++year ) {
-            mTotalEmissionsAbove[ year ] += currEmissionsAbove[ year ];
-            mTotalEmissionsBelow[ year ] += currEmissionsBelow[ year ];
-            mTotalEmissions[ year ] = mTotalEmissionsAbove[ year ] + mTotalEmissionsBelow[ year ];
+        for( int i = 0; i < numYears; ++i ) {
+            totalAbove[ i ] += currAbove[ i ];
+            totalBelow[ i ] += currBelow[ i ];
+            total[ i ] = totalAbove[ i ] + totalBelow[ i ];
         }
     }
 }
@@ -283,19 +292,8 @@ void ASimpleCarbonCalc::calcBelowGroundCarbonEmission( const double aCarbonDiff,
     // have occured, at twice the half-life 75% would have occurred, etc. 
     // Note also that the aCarbonDiff is passed here as previous carbon minus current carbon
     // so a positive difference means that emissions will occur and a negative means uptake.
-    
-    const double halfLife = mSoilTimeScale / 10.0;
-    const double log2 = log( 2.0 );
-    const double lambda = log2 / halfLife;
-    int yearCounter = 0;
-    double cumStockDiff_t1, cumStockDiff_t2;
-    cumStockDiff_t1 = 0.0;
-    for( int currYear = aYear; currYear <= aEndYear; ++currYear ) {
-        yearCounter += 1;
-        cumStockDiff_t2 = aCarbonDiff * ( 1.0 - exp( -1.0 * lambda * yearCounter ) );
-        aEmissVector[ currYear ] += cumStockDiff_t2 - cumStockDiff_t1;
-        cumStockDiff_t1 = cumStockDiff_t2;
-    }
+    // The annual fractions of the change have been precomputed for the soil time scale.
+    addKernelResponse( aCarbonDiff, mSoilDecayKernel, aYear, aEndYear, aEmissVector );
 }
 
 /*!
@@ -316,11 +314,40 @@ void ASimpleCarbonCalc::calcSigmoidCurve( const double aCarbonDiff,
      *      year.
      */
     assert( getMatureAge() > 1 );
+    assert( !mSigmoidKernel.empty() );
     
-    for( int currYear = aYear; currYear <= aEndYear; ++currYear ){
-        // To avoid expensive calculations the difference in the sigmoid curve
-        // has already been precomputed.
-        aEmissVector[ currYear ] += precalc_sigmoid_diff[ currYear - aYear ] * aCarbonDiff;
+    // To avoid expensive calculations the difference in the sigmoid curve
+    // has already been precomputed.
+    addKernelResponse( aCarbonDiff, mSigmoidKernel, aYear, aEndYear, aEmissVector );
+}
+
+/*!
+ * \brief    Spread a change in carbon over future years using a response kernel.
+ * \details  Adds the change multiplied by element i of the kernel to the
+ *           emissions i years after aYear. The emissions are contiguous in
+ *           memory so this is written as a loop over arrays, which the
+ *           compiler can vectorize, rather than indexing the vector by year.
+ * \param    aCarbonDiff Change in carbon for aYear.
+ * \param    aKernel Fraction of the change occurring by year offset.
+ * \param    aYear Year.
+ * \param    aEndYear The last future year to calculate to.
+ * \param    aEmissVector A vector to accumulate emissions into.
+ */
+void ASimpleCarbonCalc::addKernelResponse( const double aCarbonDiff,
+                                           const vector<double>& aKernel,
+                                           const int aYear,
+                                           const int aEndYear,
+                                           YearVector<double>& aEmissVector )
+{
+    const int numYears = aEndYear - aYear + 1;
+    if( numYears <= 0 ) {
+        return;
+    }
+    assert( numYears <= static_cast<int>( aKernel.size() ) );
+    double* emiss = &aEmissVector[ aYear ];
+    const double* kernel = &aKernel[ 0 ];
+    for( int i = 0; i < numYears; ++i ) {
+        emiss[ i ] += aCarbonDiff * kernel[ i ];
     }
 }
 
@@ -388,6 +415,7 @@ double ASimpleCarbonCalc::getAboveGroundCarbonSubsidyDiscountFactor( ){
 
 void ASimpleCarbonCalc::setSoilTimeScale( const int aTimeScale ) {
     mSoilTimeScale = aTimeScale;
+    CarbonModelUtils::calcSoilDecayKernel( mSoilTimeScale, mSoilDecayKernel );
 }
 
 double ASimpleCarbonCalc::getAboveGroundCarbonStock( const int aYear ) const {
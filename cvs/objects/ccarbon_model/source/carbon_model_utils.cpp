@@ -41,6 +41,7 @@
 #include "util/base/include/definitions.h"
 #include <cassert>
 #include <cfloat>
+#include <cmath>
 
 #include "ccarbon_model/include/carbon_model_utils.h"
 #include "util/base/include/util.h"
@@ -142,6 +143,52 @@ double CarbonModelUtils::getSoilTimeScale(){
     return SOIL_TIME_SCALE;
 }
 
+/*!
+ * \brief Return the response of soil carbon to a unit change in stock.
+ * \details Soil carbon is emitted or taken up exponentially with a half-life
+ *          of the soil time scale divided by ten. Element i of the kernel is
+ *          the fraction of a change in soil carbon in one year which occurs
+ *          i years later, so that emissions from the change are the change
+ *          multiplied by the kernel. The kernel spans every year of the
+ *          carbon calculation. It should be calculated when the time scale is
+ *          set, not during calc.
+ * \param aSoilTimeScale Soil decay function time scale parameter.
+ * \param aKernel Vector in which to return the soil decay kernel.
+ */
+void CarbonModelUtils::calcSoilDecayKernel( const int aSoilTimeScale, vector<double>& aKernel ){
+    const double halfLife = aSoilTimeScale / 10.0;
+    const double lambda = log( 2.0 ) / halfLife;
+    aKernel.resize( getEndYear() - getStartYear() + 1 );
+    double prevCumulative = 0.0;
+    for( unsigned int i = 0; i < aKernel.size(); ++i ){
+        const double currCumulative = 1.0 - exp( -1.0 * lambda * ( i + 1 ) );
+        aKernel[ i ] = currCumulative - prevCumulative;
+        prevCumulative = currCumulative;
+    }
+}
+
+/*!
+ * \brief Return the response of vegetation carbon to a unit change in stock.
+ * \details Vegetation grows along a sigmoid curve until it reaches the mature
+ *          age. Element i of the kernel is the difference in the curve between
+ *          i and i + 1 years after the change. The kernel spans every year of
+ *          the carbon calculation. It should be calculated when the mature age
+ *          is set, not during calc.
+ * \pre The mature age must be greater than one.
+ * \param aMatureAge The mature age of the vegetation.
+ * \param aKernel Vector in which to return the sigmoid kernel.
+ */
+void CarbonModelUtils::calcSigmoidKernel( const int aMatureAge, vector<double>& aKernel ){
+    assert( aMatureAge > 1 );
+    aKernel.resize( getEndYear() - getStartYear() + 1 );
+    double prevSigmoid = pow( 1 - exp( ( -3.0 * 0 ) / aMatureAge ), 2.0 );
+    for( unsigned int i = 0; i < aKernel.size(); ++i ){
+        const double currSigmoid = pow( 1 - exp( ( -3.0 * ( i + 1 ) ) / aMatureAge ), 2.0 );
+        aKernel[ i ] = currSigmoid - prevSigmoid;
+        prevSigmoid = currSigmoid;
+    }
+}
+
 /*!
  * \brief Helper function to interpolate a value for a year from a PeriodVector.
  * \details Calculates a linearly interpolated value for the year. If the year
@@ -180,17 +180,10 @@ void LandCarbonDensities::setMatureAge( const int aMatureAge )
     //assert( mMatureAge > 0 );
     mMatureAge = aMatureAge;
     
-    // Precompute the sigmoid curve differnce to avoid doing it during calc.
-    // Note this is only necessary when the mature age is greater than 1.
+    // Look up the precomputed sigmoid curve difference to avoid computing it
+    // during calc. Note this is only necessary when the mature age is greater than 1.
     if( mMatureAge > 1 ) {
-        precalc_sigmoid_diff.resize( CarbonModelUtils::getEndYear() - CarbonModelUtils::getStartYear() + 1 );
-        double prevSigmoid = pow( 1 - exp( ( -3.0 * 0 ) / mMatureAge ), 2.0 );
-        for ( int i = CarbonModelUtils::getStartYear(); i <= CarbonModelUtils::getEndYear(); ++i ){
-            const int offestYear = i - CarbonModelUtils::getStartYear();
-            double currSigmoid = pow( 1 - exp( ( -3.0 * ( offestYear + 1 ) ) / mMatureAge ), 2.0 );
-            precalc_sigmoid_diff[ offestYear ] = currSigmoid - prevSigmoid;
-            prevSigmoid = currSigmoid;
-        }
+        CarbonModelUtils::calcSigmoidKernel( mMatureAge, mSigmoidKernel );
     }
 }
 
@@ -0,0 +1,125 @@
+#ifndef _MAGICC_input_reader_H_
+#define _MAGICC_input_reader_H_
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*
+ *  MAGICC_input_reader.h
+ *  magicc++
+ *
+ */
+
+/*  MAGICC reads its configuration and history files every time CLIMAT() runs.
+    The magicc_input_reader stands in for the input file stream so that, when
+    it is given a cache, each value read from a file is recorded the first time
+    the file is read and handed back from the recording on later runs without
+    touching or parsing the file. Because the recorded values are exactly the
+    ones the stream produced, the results are identical to reading the file.
+    If a later run reads a file differently, for instance because a parameter
+    override changes a branch, the reader falls back to the file from that
+    point and records the new sequence.
+
+    The reader can also read the gas emissions from a text header followed by
+    values which were passed from GCAM in memory.
+
+    The cache belongs to the MAGICC state of a single climate model, so readers
+    for different models never share anything.
+*/
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+// Kinds of reads which are recorded.
+enum magicc_read_kind { READ_DOUBLE, READ_FLOAT, READ_INT, READ_AND_DISCARD, READ_CSV_VALUE, READ_SKIPLINE };
+
+struct magicc_recorded_read {
+    magicc_read_kind kind;
+    double value;
+};
+
+// The reads recorded from each file, by file name.
+typedef std::map<std::string, std::vector<magicc_recorded_read> > magicc_input_cache;
+
+class magicc_input_reader {
+public:
+    magicc_input_reader( magicc_input_cache* cache = 0 );
+    ~magicc_input_reader();
+
+    void open( const std::string& f, bool echo );
+    void open_data( const std::string& text, const std::vector<float>& values );
+    void close();
+
+    magicc_input_reader& operator>>( double& value );
+    magicc_input_reader& operator>>( float& value );
+    magicc_input_reader& operator>>( int& value );
+    float read_and_discard( bool echo );
+    float read_csv_value( bool echo );
+    void skipline( bool echo );
+    void getline( std::string& line );
+private:
+    typedef std::vector<magicc_recorded_read> recording;
+
+    template<class T> void extract( T& value, magicc_read_kind kind );
+    bool next_replayed( magicc_read_kind kind, double& value );
+    bool next_data_value( float& value );
+    void record( magicc_read_kind kind, double value );
+    void fall_back_to_file();
+
+    // Recorded reads, or null if reads are not cached.
+    magicc_input_cache* cache;
+
+    std::string file_name;
+    std::ifstream file;
+    std::istringstream text;
+    std::istream* stream;
+
+    // Set while recording reads from a file or replaying them.
+    recording* current_recording;
+    bool replaying;
+    unsigned int replay_pos;
+
+    // Values which follow the text when reading in-memory data.
+    std::vector<float> data_values;
+    unsigned int data_pos;
+};
+
+void openfile_read( magicc_input_reader* infile, const std::string& f, bool echo );
+void skipline( magicc_input_reader* infile, bool echo );
+float read_csv_value( magicc_input_reader* infile, bool echo );
+float read_and_discard( magicc_input_reader* infile, bool echo );
+void getline( magicc_input_reader& infile, std::string& line );
+
+#endif // _MAGICC_input_reader_H_
@@ -44,7 +44,9 @@
 // iTp is used extensively in array declarations, so it's special
 #define iTp 740
 
+#include <vector>
 #include "climate/include/MAGICC_array.h"
+#include "climate/include/MAGICC_input_reader.h"
 
 //#define DEBUG_MAGICC++
 #define __func__ __FUNCTION__
@@ -234,9 +236,11 @@ typedef struct {
 
 struct NEWPARAMS_block {
     NEWPARAMS_block (): aNewClimSens(0),aNewBTsoil(0), DT2XUSER(0), aNewBTGPP(0),aNewBTHumus(0),
-                   aNewDUSER(0),aNewFUSER(0), aNewSO2dir1990(0), aNewSO2ind1990(0) {}
+                   aNewDUSER(0),aNewFUSER(0), aNewSO2dir1990(0), aNewSO2ind1990(0), aNewYK(0) {}
     float aNewClimSens, aNewBTsoil, DT2XUSER, aNewBTGPP, aNewBTHumus, 
         aNewDUSER, aNewFUSER, aNewSO2dir1990, aNewSO2ind1990;
+    // Ocean heat diffusivity in cm**2/s, replaces YK from magrun_c.cfg when positive.
+    float aNewYK;
 };
 
 typedef struct {
@@ -329,22 +333,75 @@ typedef struct {
     int KEYDW;
 } VARW_block;
 
+// Local variables which the Fortran routines keep between calls (SAVE)
+struct SAVED_block {
+    SAVED_block (): TCUM(0), TBASE(0), XX(0), GS1990(0), B19901(0), B19902(0), B19903(0), B19904(0),
+                    BZERO1(0), BZERO2(0), BZERO3(0), BZERO4(0), GSPREV1(0), GSPREV2(0), GSPREV3(0), GSPREV4(0),
+                    VZ1(0), VZ2(0), VZ3(0), VZ4(0), T00LO(0), T00MID(0), T00HI(0), T00USER(0), DQOZ(0), QOZ1(0),
+                    TX(0), DELT90(0), DELT00(0), DELC(0) {}
+    // tslcalc
+    float TCUM, TBASE, XX, GS1990, B19901, B19902, B19903, B19904;
+    float BZERO1, BZERO2, BZERO3, BZERO4, GSPREV1, GSPREV2, GSPREV3, GSPREV4, VZ1, VZ2, VZ3, VZ4;
+    // deltaq
+    float T00LO, T00MID, T00HI, T00USER, DQOZ, QOZ1, TX, DELT90, DELT00;
+    // carbon
+    float DELC;
+};
+
+/*  Everything a MAGICC run keeps between calls to CLIMAT() and exposes to the
+    externally called methods. The original code held these blocks in globals,
+    so there could be only one MAGICC per process. Each climate model now owns
+    one of these and passes it to every call, so that separate instances can
+    run at the same time on different threads and a run can be copied.
+*/
+struct magicc_state {
+    magicc_state (): CACHE_INPUTS(false), WRITE_OUTPUT_FILES(true) {}
+    CARB_block CARB;
+    TANDSL_block TANDSL;
+    CONCS_block CONCS;
+    NEWCONCS_block NEWCONCS;
+    STOREDVALS_block STOREDVALS;
+    METH1_block METH1;
+    CAR_block CAR;
+    FORCE_block FORCE;
+    JSTART_block JSTART;
+    QADD_block QADD;
+    HALOF_block HALOF;
+    NEWPARAMS_block NEWPARAMS;
+    BCOC_block BCOC;
+    SAVED_block SAVED;
+
+    // gas.emk header and data set from GCAM, followed by any emissions passed
+    // in memory.
+    std::string GAS_EMK_DATA;
+    std::vector<float> GAS_EMK_VALUES;
+
+    // Whether input files are read through INPUT_CACHE.
+    bool CACHE_INPUTS;
+    magicc_input_cache INPUT_CACHE;
+
+    // Whether CLIMAT() writes its diagnostic files to MAGICC-output-dir.
+    bool WRITE_OUTPUT_FILES;
+};
+
 // Function prototypes
-void CLIMAT();
+void CLIMAT( magicc_state* state );
 void tslcalc( int N, Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, CARB_block* CARB,
              TANDSL_block* TANDSL, VARW_block* VARW, QSPLIT_block* QSPLIT, ICE_block* ICE, 
-             NSIM_block* NSIM, std::ofstream* outfile8 );
+             NSIM_block* NSIM, std::ofstream* outfile8, SAVED_block* SAVED );
 void init( Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, TANDSL_block* TANDSL, FORCE_block* FORCE, 
           Sulph_block* Sulph, VARW_block* VARW, ICE_block* ICE, AREAS_block* AREAS, NSIM_block* NSIM,
           OZ_block* OZ, NEWCONCS_block* NEWCONCS, CARB_block* CARB, CAR_block* CAR, METH1_block* METH1,
           METH2_block* METH2, METH3_block* METH3, METH4_block* METH4, CO2READ_block* CO2READ, JSTART_block* JSTART,
-          CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, TauNitr_block* TauNitr, QADD_block* QADD );
+          CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, TauNitr_block* TauNitr, QADD_block* QADD,
+          SAVED_block* SAVED );
 void interp( int NVAL, int ISTART, int IY[], float X[], magicc_array* Y, int KEND );
 void deltaq( Limits_block* Limits, OZ_block* OZ, CLIM_block* CLIM, CONCS_block* CONCS,
             NEWCONCS_block* NEWCONCS, CARB_block* CARB, TANDSL_block* TANDSL, CAR_block* CAR,
             METH1_block* METH1, FORCE_block* FORCE, METH2_block* METH2, METH3_block* METH3,
             METH4_block* METH4, TauNitr_block* TauNitr, Sulph_block* Sulph, NSIM_block* NSIM, 
-            CO2READ_block* CO2READ, JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS );
+            CO2READ_block* CO2READ, JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS,
+            SAVED_block* SAVED );
 void initcar( const int NN, const float D80, const float F80, COBS_block* COBS, 
              CARB_block* CARB, CAR_block* CAR );
 void halocarb( const int N, float C0, float E, float* C1, float* Q, float TAU00, float TAUCH4 );
@@ -359,7 +416,7 @@ void carbon( const int MM, float TEM, float EFOSS, float ENETDEF, float CPP, flo
             float PL, float HU, float SO, float REGRO, float ETOT,
             float* PL1, float* HU1, float* SO1, float* REGRO1, float* ETOT1,
             float* SUMEM, float* FLUX, float* DELM, float* EGROSSD, float* C1,
-            CAR_block* CAR ); 
+            CAR_block* CAR, SAVED_block* SAVED ); 
 void sulphate( const int JY, float ESO2, float ESO21, float ECO, float* QSO2, 
               float* QDIR, float* QFOC, float* QMN, Sulph_block* Sulph );
 void lamcalc( float Q, float FNHL, float FSHL, float XK, float XKH, float DT2X, 
@@ -369,29 +426,31 @@ void runmod( Limits_block* Limits, CLIM_block* CLIM, CONCS_block* CONCS, CARB_bl
             AREAS_block* AREAS, QADD_block* QADD, BCOC_block* BCOC, FORCE_block* FORCE, NSIM_block* NSIM,
             OZ_block* OZ, NEWCONCS_block* NEWCONCS, CAR_block* CAR, METH1_block* METH1, METH2_block* METH2, 
             METH3_block* METH3, METH4_block* METH4, TauNitr_block* TauNitr,
-            JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, ICE_block* ICE, std::ofstream* outfile8 );
+            JSTART_block* JSTART, CORREN_block* CORREN, HALOF_block* HALOF, COBS_block* COBS, ICE_block* ICE, std::ofstream* outfile8,
+            SAVED_block* SAVED );
 void split( const float QGLOBE, const float A, const float BN, const float BS, float* QNO, float* QNL, 
            float* QSO, float* QSL, AREAS_block* AREAS );
 
-void setGlobals( CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
+void setGlobals( magicc_state* state, CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
                 STOREDVALS_block* STOREDVALS, NEWPARAMS_block* NEWPARAMS, BCOC_block* BCOC, 
                 METH1_block* METH1, CAR_block* CAR, FORCE_block* FORCE, JSTART_block* JSTART,
                 QADD_block* QADD, HALOF_block* HALOF, std::string& GAS_EMK_DATA );
-void setLocals( CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
+void setLocals( magicc_state* state, CARB_block* CARB, TANDSL_block* TANDSL, CONCS_block* CONCS, NEWCONCS_block* NEWCONCS, 
                 STOREDVALS_block* STOREDVALS, NEWPARAMS_block* NEWPARAMS, BCOC_block* BCOC, 
                 METH1_block* METH1, CAR_block* CAR, FORCE_block* FORCE, JSTART_block* JSTART,
                 QADD_block* QADD, HALOF_block* HALOF, std::string& GAS_EMK_DATA );
 
 // Externally called methods
 
-float getSLR( const int inYear );
-float GETFORCING( const int iGasNumber, const int inYear );
-float GETGHGCONC(int, int);
-float GETGMTEMP(int);
-float GETCARBONRESULTS(int, int);
-void SETPARAMETERVALUES(int, float);
+float getSLR( magicc_state* state, const int inYear );
+float GETFORCING( magicc_state* state, const int iGasNumber, const int inYear );
+float GETGHGCONC(magicc_state*, int, int);
+float GETGMTEMP(magicc_state*, int);
+float GETCARBONRESULTS(magicc_state*, int, int);
+void SETPARAMETERVALUES(magicc_state*, int, float);
 void overrideParameters( NEWPARAMS_block* NEWPARAMS, CAR_block* CAR, METH1_block* METH1, BCOC_block* BCOC );
-void SET_GAS_EMK( const std::string& GAS_EMK_DATA );
+void SET_GAS_EMK( magicc_state* state, const std::string& GAS_EMK_DATA );
+void SET_GAS_EMK_VALUES( magicc_state* state, const std::vector<float>& GAS_EMK_VALUES );
 
 // Internal helper methods
 
@@ -0,0 +1,221 @@
+#ifndef _CLIMATE_EMULATOR_H_
+#define _CLIMATE_EMULATOR_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file climate_emulator.h
+* \ingroup Objects
+* \brief The ClimateEmulator class header file.
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+#include "climate/include/iclimate_model.h"
+
+class Modeltime;
+class IVisitor;
+
+/*! 
+* \ingroup Objects
+* \brief A climate model which can stand in for another climate model with a
+*        linear response fitted to the last runs of that model.
+* \details The emulator wraps a full climate model and passes emissions and
+*          all other calls through to it. Each run of the full model is kept
+*          with the emissions it was given. Once two full runs with different
+*          emissions are kept, a run with emulation enabled estimates
+*          temperature, total forcing and the CO2, CH4 and N2O concentrations
+*          by moving the outputs of the last full run along the difference
+*          between the two kept runs, in proportion to how far the new
+*          emissions have moved in the same direction. Emissions are compared
+*          with each gas scaled by its largest emissions in the first full run.
+*
+*          The estimate is only used when most of the change in emissions lies
+*          in the fitted direction, which is the case while a target solver
+*          changes a single tax. Otherwise the full model is run and the fit is
+*          moved forward. Every full run is compared with the estimate the
+*          emulator would have made for it, and the largest differences are
+*          reported as the error of the emulator.
+*
+*          While emulating, the runs of the full model for each period are
+*          skipped, and they are replayed before the next full run. Outputs
+*          which are not emulated are read from the last full run.
+*/
+class ClimateEmulator: public IClimateModel {
+public:
+    ClimateEmulator( IClimateModel* aModel, const Modeltime* aModeltime );
+    ~ClimateEmulator();
+
+    virtual void XMLParse( const xercesc::DOMNode* node );
+    virtual const std::string& getXMLName() const;
+    virtual void toInputXML( std::ostream& out, Tabs* tabs ) const;
+    virtual void toDebugXML( const int period, std::ostream& out, Tabs* tabs ) const;
+    virtual void completeInit( const std::string& aScenarioName );
+
+    virtual bool setEmissions( const std::string& aGasName,
+                               const int aPeriod,
+                               const double aEmission );
+
+    virtual bool setLUCEmissions( const std::string& aGasName,
+                                  const int aYear,
+                                  const double aEmission );
+
+    virtual double getEmissions( const std::string& aGasName,
+                                 const int aYear ) const;
+
+    virtual enum runModelStatus runModel();
+    virtual enum runModelStatus runModel( const int aYear );
+
+    virtual enum runModelStatus runEnsemble( ClimateEnsemble& aEnsemble );
+
+    virtual double getConcentration( const std::string& aGasName,
+                                     const int aYear ) const;
+
+    virtual double getTemperature( const int aYear ) const;
+
+    virtual double getForcing( const std::string& aGasName,
+                               const int aYear ) const;
+
+    virtual double getTotalForcing( const int aYear ) const;
+
+    virtual double getNetTerrestrialUptake( const int aYear ) const;
+
+    virtual double getNetOceanUptake( const int aYear ) const;
+
+    virtual int getCarbonModelStartYear() const;
+
+    virtual void printFileOutput() const;
+    virtual void printDBOutput() const;
+    virtual void accept( IVisitor* aVisitor, const int aPeriod ) const;
+
+    void setEmulationEnabled( const bool aEnabled );
+
+    bool isLastRunEmulated() const;
+
+    enum runModelStatus runFullModel();
+
+    void printStatistics( std::ostream& aOut ) const;
+
+private:
+    //! Outputs which are emulated.
+    enum OutputType {
+        TEMPERATURE,
+        TOTAL_FORCING,
+        CO2_CONCENTRATION,
+        CH4_CONCENTRATION,
+        N2O_CONCENTRATION,
+        NUM_OUTPUT_TYPES
+    };
+
+    //! A run of the full model.
+    struct FullRun {
+        //! The emissions of the run in the order of mEmissions.
+        std::vector<double> mEmissions;
+
+        //! The outputs of the run by output type and year.
+        std::vector<double> mOutputs;
+    };
+
+    std::vector<double> getEmissionsVector() const;
+
+    std::vector<double> getFullModelOutputs() const;
+
+    bool estimate( const std::vector<double>& aEmissions,
+                   std::vector<double>& aOutputs,
+                   double& aResidual ) const;
+
+    double getEmulatedOutput( const OutputType aType, const int aYear ) const;
+
+    static const std::string& getOutputName( const OutputType aType );
+
+    //! The full climate model.
+    std::auto_ptr<IClimateModel> mModel;
+
+    //! A reference to the scenario's modeltime object.
+    const Modeltime* mModeltime;
+
+    //! First year for which outputs are emulated.
+    int mStartYear;
+
+    //! Last year for which outputs are emulated.
+    int mEndYear;
+
+    //! Whether runs may be emulated.
+    bool mEmulationEnabled;
+
+    //! Whether the outputs of the last run were emulated.
+    bool mLastRunEmulated;
+
+    //! Whether the runs of the full model for any period have been skipped
+    //! since the last full run.
+    bool mSkippedPeriodRuns;
+
+    //! Largest fraction of the change in emissions which may lie outside of
+    //! the fitted direction for a run to be emulated.
+    double mMaxResidual;
+
+    //! Current emissions by gas and year.
+    std::map<std::pair<std::string, int>, double> mEmissions;
+
+    //! Scale of the emissions of each gas, set by the first full run.
+    std::map<std::string, double> mGasScales;
+
+    //! The last full run.
+    FullRun mLastRun;
+
+    //! The full run before mLastRun with different emissions.
+    FullRun mPreviousRun;
+
+    //! Outputs of the last run if it was emulated.
+    std::vector<double> mEmulatedOutputs;
+
+    //! Largest difference between the estimate and a full run by output type.
+    std::vector<double> mMaxErrors;
+
+    //! Number of runs which were emulated.
+    unsigned int mNumEmulatedRuns;
+
+    //! Number of runs of the full model.
+    unsigned int mNumFullRuns;
+
+    //! Number of full runs which were compared with an estimate.
+    unsigned int mNumComparedRuns;
+};
+
+#endif // _CLIMATE_EMULATOR_H_
@@ -0,0 +1,115 @@
+#ifndef _CLIMATE_ENSEMBLE_H_
+#define _CLIMATE_ENSEMBLE_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file climate_ensemble.h
+* \ingroup Objects
+* \brief The ClimateEnsemble class header file.
+*/
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+class IClimateModel;
+
+/*! 
+* \ingroup Objects
+* \brief A set of climate parameter draws run over a single emissions pathway.
+* \details The ensemble is read from a CSV file whose first line names the
+*          varied parameters, for instance climate-sensitivity and
+*          ocean-diffusivity, and whose following lines each give the values
+*          for one member. A climate model runs each member with its emissions
+*          already set and stores the results of the member here. The ensemble
+*          then reports percentiles across the members of temperature, total
+*          forcing and CO2 concentration by year.
+*
+*          Members are stored by index and each member's results are written
+*          only by the run of that member, so members may be run at the same
+*          time on different threads.
+*/
+class ClimateEnsemble {
+public:
+    ClimateEnsemble( const int aStartYear, const int aEndYear );
+
+    bool readParameters( const std::string& aFileName );
+
+    unsigned int getNumMembers() const;
+
+    const std::vector<std::string>& getParameterNames() const;
+
+    double getParameter( const unsigned int aMember, const unsigned int aParameter ) const;
+
+    void storeResults( const unsigned int aMember, const IClimateModel& aModel );
+
+    void printPercentiles( std::ostream& aOut ) const;
+
+    static const std::string& getClimateSensitivityName();
+
+    static const std::string& getOceanDiffusivityName();
+
+private:
+    //! Results which are stored for each member.
+    enum ResultType {
+        TEMPERATURE,
+        TOTAL_FORCING,
+        CO2_CONCENTRATION,
+        NUM_RESULT_TYPES
+    };
+
+    static const std::string& getResultName( const ResultType aType );
+
+    //! First year for which results are stored.
+    int mStartYear;
+
+    //! Last year for which results are stored.
+    int mEndYear;
+
+    //! Names of the varied parameters.
+    std::vector<std::string> mParameterNames;
+
+    //! Parameter values by member and parameter.
+    std::vector<std::vector<double> > mParameters;
+
+    //! Results by member, result type and year, empty for members which
+    //! did not run.
+    std::vector<std::vector<std::vector<double> > > mResults;
+};
+
+#endif // _CLIMATE_ENSEMBLE_H_
@@ -0,0 +1,138 @@
+#ifndef _CLIMATE_RESULT_CACHE_H_
+#define _CLIMATE_RESULT_CACHE_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file climate_result_cache.h
+* \ingroup Objects
+* \brief The ClimateResultCache class header file.
+*/
+
+#include <vector>
+#include <cassert>
+
+/*! 
+* \ingroup Objects
+* \brief Yearly climate model results stored by column and year.
+* \details Each result the climate model reports, such as the concentration
+*          or forcing of one gas or the global temperature, is given a column
+*          when the model is set up. The model keeps the column ID in place of
+*          the gas name, so that storing and retrieving a result is an array
+*          index rather than a lookup by name. All columns are stored in a
+*          single array, with the years of a column next to each other so that
+*          a time series of one result can be read in order.
+*
+*          Each value also records whether it is valid for the current run. A
+*          model may leave some columns to be retrieved only when they are
+*          first queried, and mark a year invalid when it runs that year again.
+*/
+class ClimateResultCache {
+public:
+    ClimateResultCache();
+
+    void setYears( const int aStartYear, const int aEndYear );
+
+    int addColumn();
+
+    int getNumColumns() const;
+
+    int getStartYear() const;
+
+    int getEndYear() const;
+
+    void invalidateYear( const int aYear );
+
+    void invalidateAll();
+
+    /*!
+     * \brief Whether a value has been stored for the current run.
+     * \param aColumn The column ID.
+     * \param aYear The year.
+     * \return Whether the value is valid.
+     */
+    bool isValid( const int aColumn, const int aYear ) const {
+        return mIsValid[ getIndex( aColumn, aYear ) ];
+    }
+
+    /*!
+     * \brief Get a stored value.
+     * \param aColumn The column ID.
+     * \param aYear The year.
+     * \return The value, which is zero if none has been stored.
+     */
+    double getValue( const int aColumn, const int aYear ) const {
+        return mValues[ getIndex( aColumn, aYear ) ];
+    }
+
+    /*!
+     * \brief Store a value and mark it valid.
+     * \param aColumn The column ID.
+     * \param aYear The year.
+     * \param aValue The value.
+     */
+    void setValue( const int aColumn, const int aYear, const double aValue ) {
+        const int index = getIndex( aColumn, aYear );
+        mValues[ index ] = aValue;
+        mIsValid[ index ] = true;
+    }
+
+private:
+    //! Index into the value arrays of a column and year.
+    int getIndex( const int aColumn, const int aYear ) const {
+        assert( aColumn >= 0 && aColumn < mNumColumns );
+        assert( aYear >= mStartYear && aYear < mStartYear + mNumYears );
+        return aColumn * mNumYears + aYear - mStartYear;
+    }
+
+    //! First year stored.
+    int mStartYear;
+
+    //! Number of years stored for each column.
+    int mNumYears;
+
+    //! Number of columns.
+    int mNumColumns;
+
+    //! Values by column and then year.
+    std::vector<double> mValues;
+
+    //! Whether each value has been stored for the current run.
+    std::vector<bool> mIsValid;
+};
+
+#endif // _CLIMATE_RESULT_CACHE_H_
@@ -52,6 +52,7 @@
 #include <vector>
 
 #include "climate/include/iclimate_model.h"
+#include "climate/include/climate_result_cache.h"
 #include "climate/source/hector/headers/core/core.hpp"
 #include "climate/source/hector/headers/visitors/csv_outputstream_visitor.hpp"
 
@@ -80,6 +81,14 @@ class IVisitor;
  *          the beginning of each new scenario) or in a stabilization
  *          run (where we might have to run each stabilization period
  *          many times to find the right GHG tax).
+ *
+ *          Climate outputs are kept in a ClimateResultCache, with a
+ *          column for each gas and quantity, so the getters look a gas
+ *          up once and then index by year.  Outputs that Hector keeps
+ *          as a time series, such as halocarbon forcing, are only
+ *          retrieved from the core when they are first queried.  With
+ *          reduced-output set this also applies to the CH4, N2O and O3
+ *          concentrations, which are otherwise stored every year.
  */
 class HectorModel: public IClimateModel {
 public:
@@ -99,6 +108,7 @@ public:
     virtual double getEmissions( const std::string& aGasName, const int aYear ) const;
     virtual runModelStatus runModel();
     virtual runModelStatus runModel( const int aPeriod );
+    virtual runModelStatus runEnsemble( ClimateEnsemble& aEnsemble );
     virtual double getConcentration( const std::string& aGasName, const int aYear ) const;
     virtual double getTemperature( const int aYear ) const;
     virtual double getForcing( const std::string& aGasName, const int aYear ) const;
@@ -120,9 +130,11 @@ private:
     //! Last year to use historical emissions
     int mEmissionsSwitchYear;
 
-    /* TODO: The gas lookup tables in this class have really
-     * proliferated.  We should change them to vectors and include a
-     * single lookup table for looking up the index for a gas.  One
+    //! Whether to retrieve time series outputs only when queried
+    bool mReducedOutput;
+
+    /* TODO: The emissions lookup tables in this class are still keyed
+     * by gas name.  They could use column IDs as the results do.  One
      * obstacle to this is that a couple of the tables include the
      * unimplemented gasses (so that we are ready when they get
      * implemented in Hector). */
@@ -142,29 +154,49 @@ private:
     //! table of emissions passed in from GCAM
     std::map<std::string, std::vector<double> > mEmissionsTable;
 
-    //! table of concentrations retrieved from Hector
-    std::map<std::string, std::vector<double> > mConcTable;
-
     //! Some Hector components store their forcing in a time series.
     //! This is a lookup table for the message strings used to
     //! retrieve them.
     std::map<std::string, std::string> mHectorRFTseriesMsg;
 
-    //! table of forcings retrieved from Hector, by gas (for those
-    //! that don't keep their data in a time series)
-    std::map<std::string, std::vector<double> > mGasRFTable;
+    //! How the output in a result column is retrieved from Hector
+    struct ResultSource {
+        //! Hector message for the output
+        std::string mMessage;
+
+        //! Whether Hector keeps the output as a time series, so that it
+        //! can be retrieved for any year the core has run through.
+        bool mIsTimeSeries;
+
+        //! Whether the output is stored each year as the core runs,
+        //! rather than retrieved when it is first queried.
+        bool mStoreEachYear;
+    };
+
+    //! results retrieved from Hector by column and year.  This is
+    //! mutable so that outputs can be retrieved when first queried.
+    mutable ClimateResultCache mResults;
+
+    //! source of the output in each result column
+    std::vector<ResultSource> mResultSources;
 
-    //! total forcings retrieved from Hector
-    std::vector<double> mTotRFTable;
+    //! result column for the concentration of each gas
+    std::map<std::string, int> mConcColumns;
 
-    //! temperatures retrieved from Hector
-    std::vector<double> mTemperatureTable;
+    //! result column for the forcing of each gas
+    std::map<std::string, int> mRFColumns;
 
-    //! land fluxes retrieved from Hector
-    std::vector<double> mLandFlux;
+    //! result column for total forcing
+    int mTotRFColumn;
 
-    //! ocean fluxes retrieved from Hector
-    std::vector<double> mOceanFlux;
+    //! result column for global temperature
+    int mTemperatureColumn;
+
+    //! result column for land flux
+    int mLandFluxColumn;
+
+    //! result column for ocean flux
+    int mOceanFluxColumn;
 
     //! conversion factors from GCAM's output units to Hector's native
     //! units (multiply GCAM's value by this to get the hector value)
@@ -176,6 +208,11 @@ private:
     //! Hector core object
     std::auto_ptr<Hector::Core> mHcore;
 
+    //! Climate parameters set on the core after the ini file is read,
+    //! by ClimateEnsemble parameter name.  Empty except while running
+    //! an ensemble.
+    std::map<std::string, double> mParameterOverrides;
+
     //! file handle for the outputstream visitor
     std::auto_ptr<std::ofstream> mOfile;
 
@@ -192,17 +229,27 @@ private:
     //! reset the Hector GCAM component and the Hector model for a new run
     void reset( const int aPeriod );
 
+    //! send mParameterOverrides to a core which has not been prepared to run
+    void setParameterOverrides();
+
+    //! run a new core with mParameterOverrides through all stored emissions
+    runModelStatus rerunAllPeriods();
+
     //! worker routine for setting emissions
     bool setEmissionsByYear( const std::string& aGasName, const int aYear, double aEmissions );
 
-    //! subroutines for getting data from Hector and storing it in the tables
-    void storeConc( const int aYear );
-    void storeRF( const int aYear );
-    void storeGlobals( const int aYear );
+    //! get the outputs stored each year from Hector and store them in mResults
+    void storeResults( const int aYear );
+
+    //! set up the result columns used by storeResults
+    void setupResults();
+
+    //! add a result column for a Hector output
+    int addResult( const std::string& aMessage, const bool aIsTimeSeries,
+                   const bool aStoreEachYear );
 
-    //! set up the tables used by the functions in the previous block
-    void setupConcTbl();
-    void setupRFTbl();
+    //! get a result, retrieving it from Hector if it has not been stored
+    double getResult( const int aColumn, const int aYear ) const;
 
     int yearlyDataIndex( const int aYear ) const;
 };
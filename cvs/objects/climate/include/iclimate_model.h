@@ -53,6 +53,7 @@
 
 class Tabs;
 class IVisitor;
+class ClimateEnsemble;
 
 /*! 
 * \ingroup Objects
@@ -182,6 +183,17 @@ public:
      *           necessary reset.
      */
     virtual enum runModelStatus runModel( const int aYear ) { return NOT_IMPLEMENTED; }
+
+    /*! \brief Run the climate model once for each member of a parameter ensemble.
+     *  \details Runs the emissions which have already been set with the
+     *           parameters of each member and stores the results of each run
+     *           in the ensemble. After returning, the model holds the results
+     *           of its own parameters again.
+     *  \note Implementing this method is optional.
+     *  \param aEnsemble The ensemble to run and in which to store results.
+     *  \return Whether the ensemble completed successfully.
+     */
+    virtual enum runModelStatus runEnsemble( ClimateEnsemble& ) { return NOT_IMPLEMENTED; }
     
     /*! \brief Returns the concentrations for a given gas in a given period from
     *          the climate model.
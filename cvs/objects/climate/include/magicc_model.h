@@ -48,10 +48,17 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <memory>
 #include "climate/include/iclimate_model.h"
 
+#if GCAM_PARALLEL_ENABLED
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+#endif
+
 class Modeltime;
 class IVisitor;
+struct magicc_state;
 
 /*! 
 * \ingroup Objects
@@ -70,12 +77,17 @@ class IVisitor;
 *       the economic model. This is done by reading in a scenario container with
 *       only a modeltime object and an empty world object. It will run off the
 *       values in the input_gases.emk file.
+* \note Each MagiccModel owns the state of its MAGICC runs, so several models
+*       can run MAGICC at the same time and a model can be copied along with
+*       the results of its last run.
 * \author Josh Lurz
 */
 
 class MagiccModel: public IClimateModel {
 public:
     MagiccModel( const Modeltime* aModeltime );
+    MagiccModel( const MagiccModel& aOther );
+    ~MagiccModel();
 
     virtual void completeInit( const std::string& aScenarioName );
     
@@ -98,6 +110,8 @@ public:
 
     virtual enum runModelStatus runModel();
 
+    virtual enum runModelStatus runEnsemble( ClimateEnsemble& aEnsemble );
+
     virtual double getConcentration( const std::string& aGasName,
                                      const int aYear ) const;
 
@@ -123,6 +137,8 @@ public:
     static const std::string& getnetDefor80sName();
 
 private:
+    //! Undefined assignment operator, use the copy constructor.
+    MagiccModel& operator=( const MagiccModel& );
 
     bool isValidClimateModelYear( const int aYear ) const;
 
@@ -130,7 +146,11 @@ private:
     static unsigned int getNumInputGases();
     void readFile();
     void overwriteMAGICCParameters( );
-    void writeMAGICCEmissionsFile( );
+    void writeMAGICCEmissionsFile( const bool aInMemory );
+    void callMAGICC( const bool aInMemory );
+    std::vector<double> getComparisonOutputs() const;
+    void runEnsembleMember( ClimateEnsemble& aEnsemble, const unsigned int aMember,
+                            const std::vector<int>& aParameterIndices ) const;
     void writeComma( int gasNumber, int& numberOfDataPoints, std::ostringstream& gasFile );
         
     static int getNumAdditionalGasPoints();
@@ -177,6 +197,9 @@ private:
     //! Climate Sensitivity.
     double mClimateSensitivity;
 
+    //! Ocean heat diffusivity in cm^2/s (MAGICC Parameter YK)
+    double mOceanDiffusivity;
+
     //! Soil Feedback Factor (MAGICC Parameter btSoil)
     double mSoilTempFeedback;
 
@@ -212,6 +235,22 @@ private:
 
     //! Number of historical data points read in.
     int mNumberHistoricalDataPoints;
+
+    //! The MAGICC state for this model, kept between runs.
+    std::auto_ptr<magicc_state> mState;
+
+#if GCAM_PARALLEL_ENABLED
+    //! helper class for tbb parallel_for over ensemble members
+    struct EnsembleHelper {
+        const MagiccModel& mModel;
+        ClimateEnsemble& mEnsemble;
+        const std::vector<int>& mParameterIndices;
+        EnsembleHelper( const MagiccModel& aModel, ClimateEnsemble& aEnsemble,
+                        const std::vector<int>& aParameterIndices )
+            : mModel( aModel ), mEnsemble( aEnsemble ), mParameterIndices( aParameterIndices ) {}
+        void operator()( const tbb::blocked_range<int>& aRange ) const;
+    };
+#endif
 };
 
 #endif // _MAGICC_MODEL_H_
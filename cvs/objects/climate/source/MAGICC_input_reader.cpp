@@ -0,0 +1,268 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*
+ *  MAGICC_input_reader.cpp
+ *  magicc++
+ *
+ */
+
+#include <iostream>
+
+#include "climate/include/MAGICC_input_reader.h"
+#include "climate/include/ObjECTS_MAGICC.h"
+
+using namespace std;
+
+magicc_input_reader::magicc_input_reader( magicc_input_cache* cache ):cache( cache ), stream( 0 ), current_recording( 0 ),
+replaying( false ), replay_pos( 0 ), data_pos( 0 )
+{
+}
+
+magicc_input_reader::~magicc_input_reader()
+{
+    close();
+}
+
+// Open a file, replaying the reads recorded the last time it was read if
+// there is a cache which has a recording.
+void magicc_input_reader::open( const string& f, bool echo )
+{
+    close();
+    file_name = f;
+    if( cache ) {
+        magicc_input_cache::iterator cached = cache->find( f );
+        if( cached != cache->end() ) {
+            current_recording = &cached->second;
+            replaying = true;
+            if ( echo ) cout << "Replaying cached reads of file " << f << "\n";
+            return;
+        }
+        current_recording = &(*cache)[ f ];
+    }
+    openfile_read( &file, f, echo );
+    stream = &file;
+}
+
+// Read from text held in memory, followed by values which are handed back by
+// reads once the text is used up.
+void magicc_input_reader::open_data( const string& data_text, const vector<float>& values )
+{
+    close();
+    text.str( data_text );
+    text.clear();
+    stream = &text;
+    data_values = values;
+}
+
+void magicc_input_reader::close()
+{
+    if( file.is_open() ) {
+        file.close();
+    }
+    file.clear();
+    stream = 0;
+    current_recording = 0;
+    replaying = false;
+    replay_pos = 0;
+    data_values.clear();
+    data_pos = 0;
+}
+
+magicc_input_reader& magicc_input_reader::operator>>( double& value )
+{
+    extract( value, READ_DOUBLE );
+    return *this;
+}
+
+magicc_input_reader& magicc_input_reader::operator>>( float& value )
+{
+    extract( value, READ_FLOAT );
+    return *this;
+}
+
+magicc_input_reader& magicc_input_reader::operator>>( int& value )
+{
+    extract( value, READ_INT );
+    return *this;
+}
+
+template<class T>
+void magicc_input_reader::extract( T& value, magicc_read_kind kind )
+{
+    double replayed;
+    float data_value;
+    if( next_replayed( kind, replayed ) ) {
+        value = static_cast<T>( replayed );
+    }
+    else if( next_data_value( data_value ) ) {
+        value = static_cast<T>( data_value );
+    }
+    else {
+        (*stream) >> value;
+        record( kind, value );
+    }
+}
+
+float magicc_input_reader::read_and_discard( bool echo )
+{
+    double replayed;
+    float f;
+    if( next_replayed( READ_AND_DISCARD, replayed ) ) {
+        f = static_cast<float>( replayed );
+    }
+    else if( !next_data_value( f ) ) {
+        f = ::read_and_discard( stream, echo );
+        record( READ_AND_DISCARD, f );
+    }
+    return f;
+}
+
+float magicc_input_reader::read_csv_value( bool echo )
+{
+    double replayed;
+    float f;
+    if( next_replayed( READ_CSV_VALUE, replayed ) ) {
+        f = static_cast<float>( replayed );
+    }
+    else if( !next_data_value( f ) ) {
+        f = ::read_csv_value( stream, echo );
+        record( READ_CSV_VALUE, f );
+    }
+    return f;
+}
+
+void magicc_input_reader::skipline( bool echo )
+{
+    double replayed;
+    if( !next_replayed( READ_SKIPLINE, replayed ) ) {
+        ::skipline( stream, echo );
+        record( READ_SKIPLINE, 0 );
+    }
+}
+
+// Lines of text are not recorded, so reading one stops replaying.
+void magicc_input_reader::getline( string& line )
+{
+    if( replaying ) {
+        fall_back_to_file();
+    }
+    std::getline( *stream, line );
+    if( current_recording ) {
+        // The recording can not reproduce this read, so it must be redone
+        // from the file each time.
+        cache->erase( file_name );
+        current_recording = 0;
+    }
+}
+
+// Get the next recorded value if it is for the same kind of read, otherwise
+// go back to reading the file.
+bool magicc_input_reader::next_replayed( magicc_read_kind kind, double& value )
+{
+    if( !replaying ) {
+        return false;
+    }
+    if( replay_pos < current_recording->size() && (*current_recording)[ replay_pos ].kind == kind ) {
+        value = (*current_recording)[ replay_pos ].value;
+        ++replay_pos;
+        return true;
+    }
+    fall_back_to_file();
+    return false;
+}
+
+// Get the next in-memory value once the text has been read.
+bool magicc_input_reader::next_data_value( float& value )
+{
+    if( stream != &text || data_pos >= data_values.size() || text.peek() != char_traits<char>::eof() ) {
+        return false;
+    }
+    value = data_values[ data_pos++ ];
+    return true;
+}
+
+void magicc_input_reader::record( magicc_read_kind kind, double value )
+{
+    if( current_recording ) {
+        magicc_recorded_read read = { kind, value };
+        current_recording->push_back( read );
+    }
+}
+
+// Open the file and repeat the reads replayed so far so that reading can
+// continue from the file, recording from this point on.
+void magicc_input_reader::fall_back_to_file()
+{
+    replaying = false;
+    openfile_read( &file, file_name, false );
+    stream = &file;
+    for( unsigned int i = 0; i < replay_pos; ++i ) {
+        switch( (*current_recording)[ i ].kind ) {
+            case READ_DOUBLE: { double d; file >> d; break; }
+            case READ_FLOAT: { float f; file >> f; break; }
+            case READ_INT: { int n; file >> n; break; }
+            case READ_AND_DISCARD: ::read_and_discard( stream, false ); break;
+            case READ_CSV_VALUE: ::read_csv_value( stream, false ); break;
+            case READ_SKIPLINE: ::skipline( stream, false ); break;
+        }
+    }
+    current_recording->resize( replay_pos );
+}
+
+// Overloads of the file helpers so that MAGICC reads through a reader the same
+// way it reads through a stream.
+
+void openfile_read( magicc_input_reader* infile, const string& f, bool echo )
+{
+    infile->open( f, echo );
+}
+
+void skipline( magicc_input_reader* infile, bool echo )
+{
+    infile->skipline( echo );
+}
+
+float read_csv_value( magicc_input_reader* infile, bool echo )
+{
+    return infile->read_csv_value( echo );
+}
+
+float read_and_discard( magicc_input_reader* infile, bool echo )
+{
+    return infile->read_and_discard( echo );
+}
+
+void getline( magicc_input_reader& infile, string& line )
+{
+    infile.getline( line );
+}
@@ -40,6 +40,7 @@
 
 
 #include "climate/include/ObjECTS_MAGICC.h"
+#include "climate/include/MAGICC_input_reader.h"
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/configuration.h"
 
@@ -47,10 +48,22 @@
 
 using namespace std;
 
+/*  Open a diagnostic output file of CLIMAT() unless the state has them turned
+    off. A stream which is not opened discards everything written to it, so
+    the rest of CLIMAT() does not need to check.
+*/
+static void openOutputFile( const magicc_state* state, ofstream* outfile, const string& f )
+{
+    if( state->WRITE_OUTPUT_FILES ) {
+        openfile_write( outfile, f, DEBUG_IO );
+    }
+}
+
 
 // The climat() function is up here so as to encapsulate all these stinking variables;
-// we're not going to allow any globals in the C++ code
-void CLIMAT()
+// we're not going to allow any globals in the C++ code. Anything which must outlive
+// the call is kept in the state of the calling climate model.
+void CLIMAT( magicc_state* state )
 {
     // Get input and output file directories from the configuration.  Opening files
     // will be done relative to these paths.
@@ -58,7 +71,7 @@ void CLIMAT()
     const string BASE_OUTPUT_DIR = conf->getString( "MAGICC-output-dir", "../output" );
     const string BASE_INPUT_DIR = conf->getString( "MAGICC-input-dir", "../input/magicc/inputs" );
     ofstream outfile8; // need to do this here; see line F395 and F658
-    openfile_write( &outfile8, BASE_OUTPUT_DIR + "/mag_c.csv", DEBUG_IO );
+    openOutputFile( state, &outfile8, BASE_OUTPUT_DIR + "/mag_c.csv" );
     
     //F   1 ! MAGTAR.FOR
     //F   2 !
@@ -387,9 +400,11 @@ void CLIMAT()
 
     // Input gas data will be read out of this string rather than through an actual file.
     string GAS_EMK_DATA;
+    // Emissions passed in memory follow the header in GAS_EMK_DATA when this is not empty.
+    const vector<float>& GAS_EMK_VALUES = state->GAS_EMK_VALUES;
 
     // The MAGICC routines need access to these data structures, so set some global references
-    setLocals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+    setLocals( state, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
                 &STOREDVALS, &NEWPARAMS, &BCOC, 
                 &METH1, &CAR, &FORCE, &JSTART,
                 &QADD, &HALOF, GAS_EMK_DATA );
@@ -477,7 +492,7 @@ void CLIMAT()
     //F 254 !
     //F 255       lun = 42   ! spare logical unit no.
     //F 256       open(unit=lun,file='./magicc_files/CO2HIST.IN',status='OLD')
-    ifstream infile;
+    magicc_input_reader infile( state->CACHE_INPUTS ? &state->INPUT_CACHE : 0 );
     openfile_read( &infile, BASE_INPUT_DIR + "/co2hist_c.in", DEBUG_IO );
     //F 257       DO ICO2=0,JSTART
     for( int ICO2=0; ICO2<=JSTART.JSTART; ICO2++ ) {
@@ -1183,7 +1198,7 @@ void CLIMAT()
     // Handled at beginning of climat()
     //F 660       OPEN(UNIT=88,file='./outputs/CCSM.TXT', STATUS='UNKNOWN')
     ofstream outfile88;
-    openfile_write( &outfile88, BASE_OUTPUT_DIR + "/ccsm_c.txt", DEBUG_IO );
+    openOutputFile( state, &outfile88, BASE_OUTPUT_DIR + "/ccsm_c.txt" );
     //F 661 !
     //F 662 !  INTERIM CORRECTION TO AVOID CRASH IF S90IND SET TO ZERO IN
     //F 663 !   MAGUSER.CFG
@@ -1192,6 +1207,7 @@ void CLIMAT()
     if( Sulph.S90IND == 0.0 ) Sulph.S90IND = -0.0001;
     //F 666 !
     //F 667       XK=YK*3155.76
+    if( NEWPARAMS.aNewYK > 0 ) YK = NEWPARAMS.aNewYK;
     CLIM.XK = YK * 3155.76;
     //F 668 !
     //F 669 !  CO2 AND CH4 GAS CYCLE PARAMETERS ARE SELECTED IN DELTAQ.
@@ -1679,7 +1695,8 @@ void CLIMAT()
     //F 968       open(unit=lun,file='GAS.EMK',status='OLD')
     // Input gas data will be read out of a string rather than a gas.emk file to
     // facilitate in memory transfer of data from GCAM.
-    istringstream gasfile( GAS_EMK_DATA );
+    magicc_input_reader gasfile;
+    gasfile.open_data( GAS_EMK_DATA, GAS_EMK_VALUES );
     //F 969 !
     //F 970 !  READ HEADER AND NUMBER OR ROWS OF EMISIONS DATA FROM GAS.EMK
     //F 971 !
@@ -2101,7 +2118,7 @@ void CLIMAT()
     //F1202       CALL INIT
     init( &Limits, &CLIM, &CONCS, &TANDSL, &FORCE, &Sulph, &VARW, &ICE, &AREAS, &NSIM,
          &OZ, &NEWCONCS, &CARB, &CAR, &METH1, &METH2, &METH3, &METH4, &CO2READ, &JSTART,
-         &CORREN, &HALOF, &COBS, &TauNitr, &QADD );
+         &CORREN, &HALOF, &COBS, &TauNitr, &QADD, &state->SAVED );
     //F1203 !
     //F1204 !  LINEARLY EXTRAPOLATE LAST ESO2 VALUES FOR ONE YEAR
     //F1205 !
@@ -2357,7 +2374,7 @@ void CLIMAT()
              &Sulph, &VARW, &ICE, &AREAS, &NSIM,
              &OZ, &NEWCONCS, &CARB, &CAR, &METH1,
              &METH2, &METH3, &METH4, &CO2READ, &JSTART,
-             &CORREN, &HALOF, &COBS, &TauNitr, &QADD );     
+             &CORREN, &HALOF, &COBS, &TauNitr, &QADD, &state->SAVED );     
          //F1372 !
         //F1373       IF(NESO2.EQ.1)THEN
         if( NESO2 == 1 ) {
@@ -2458,7 +2475,7 @@ void CLIMAT()
                &CO2READ, &Sulph, &DSENS, &VARW, &QSPLIT,
                &AREAS, &QADD, &BCOC, &FORCE, &NSIM,
                &OZ, &NEWCONCS, &CAR, &METH1, &METH2, &METH3, &METH4, &TauNitr,
-               &JSTART, &CORREN, &HALOF, &COBS, &ICE, &outfile8 );
+               &JSTART, &CORREN, &HALOF, &COBS, &ICE, &outfile8, &state->SAVED );
         //F1423 !
         //F1424 !  EXTRA CALL TO RUNMOD TO GET FINAL FORCING VALUES FOR K=KEND
         //F1425 !   WHEN DT=1.0
@@ -3827,13 +3844,13 @@ void CLIMAT()
         //F2238 	OPEN (UNIT=9, file='./outputs/MAGOUT.CSV')
 
         // GetForcing now relies on globals, and these need to be set
-        setGlobals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+        setGlobals( state, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
                    &STOREDVALS, &NEWPARAMS, &BCOC, 
                    &METH1, &CAR, &FORCE, &JSTART,
                    &QADD, &HALOF, GAS_EMK_DATA );
 
         ofstream outfile9;
-        openfile_write( &outfile9, BASE_OUTPUT_DIR + "/magout_c.csv", DEBUG_IO ); //FIX filename
+        openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/magout_c.csv" ); //FIX filename
         //F2239 
         //F2240   100 FORMAT(I5,1H,,27(F15.5,1H,))
         //F2241 
@@ -3874,26 +3891,26 @@ void CLIMAT()
 
             // RADIATIVE FORCING
             //F2273 	 MAGICCCResults(13,(K-1990)/IIPRT+1) = GETFORCING( 0, K ) ! Total antro forcing
-            MAGICCCResults[ 4 ][ yrindex ] = GETFORCING( 0, K );
+            MAGICCCResults[ 4 ][ yrindex ] = GETFORCING( state, 0, K );
             //F2282 	 MAGICCCResults(22,(K-1990)/IIPRT+1) = & !Kyoto Forcing
             //F2283 	    GETFORCING( 1, K ) + GETFORCING( 2, K )  + GETFORCING( 3, K ) + & ! CO2, CH4, and N2O
             //F2284 	    GETFORCING( 4, K ) + GETFORCING( 9, K ) + GETFORCING( 10, K ) + &! Long-lived F-gases
             //F2285 	    GETFORCING( 5, K ) + GETFORCING( 6, K ) + GETFORCING( 7, K ) + &
             //F2286 	    GETFORCING( 8, K ) + GETFORCING( 11, K ) + GETFORCING( 12, K ) ! Shorter-lived F-gases
-            MAGICCCResults[ 5 ][ yrindex ] = GETFORCING( 1, K ) + GETFORCING( 2, K ) + GETFORCING( 3, K ) +
-                GETFORCING( 4, K ) + GETFORCING( 9, K ) + GETFORCING( 10, K ) +
-                GETFORCING( 5, K ) + GETFORCING( 6, K ) + GETFORCING( 7, K ) +
-                GETFORCING( 8, K ) + GETFORCING( 11, K ) + GETFORCING( 12, K );
+            MAGICCCResults[ 5 ][ yrindex ] = GETFORCING( state, 1, K ) + GETFORCING( state, 2, K ) + GETFORCING( state, 3, K ) +
+                GETFORCING( state, 4, K ) + GETFORCING( state, 9, K ) + GETFORCING( state, 10, K ) +
+                GETFORCING( state, 5, K ) + GETFORCING( state, 6, K ) + GETFORCING( state, 7, K ) +
+                GETFORCING( state, 8, K ) + GETFORCING( state, 11, K ) + GETFORCING( state, 12, K );
             //F2262 	 MAGICCCResults(5,(K-1990)/IIPRT+1) = GETFORCING( 1, K ) ! CO2
-            MAGICCCResults[ 6 ][ yrindex ] = GETFORCING( 1, K );
+            MAGICCCResults[ 6 ][ yrindex ] = GETFORCING( state, 1, K );
             //F2263 	 MAGICCCResults(6,(K-1990)/IIPRT+1) = GETFORCING( 2, K ) ! CH4 (no indirect components)
-            MAGICCCResults[ 7 ][ yrindex ] = GETFORCING( 2, K );
+            MAGICCCResults[ 7 ][ yrindex ] = GETFORCING( state, 2, K );
             //F2264 	 MAGICCCResults(7,(K-1990)/IIPRT+1) = GETFORCING( 3, K ) ! N2O
-            MAGICCCResults[ 8 ][ yrindex ] = GETFORCING( 3, K );
+            MAGICCCResults[ 8 ][ yrindex ] = GETFORCING( state, 3, K );
             //F2270 	 MAGICCCResults(10,(K-1990)/IIPRT+1) = GETFORCING( 14, K ) ! SO2 direct only
-            MAGICCCResults[ 9 ][ yrindex ] = GETFORCING( 14, K );
+            MAGICCCResults[ 9 ][ yrindex ] = GETFORCING( state, 14, K );
             //F2271 	 MAGICCCResults(11,(K-1990)/IIPRT+1) = GETFORCING( 13, K ) - GETFORCING( 14, K ) ! indirect only
-            MAGICCCResults[ 10 ][ yrindex ] = GETFORCING( 13, K ) - GETFORCING( 14, K );
+            MAGICCCResults[ 10 ][ yrindex ] = GETFORCING( state, 13, K ) - GETFORCING( state, 14, K );
 
             // EMISSIONS
             //F2274 	 MAGICCCResults(14,(K-1990)/IIPRT+1) = EF(IYR)
@@ -3915,17 +3932,17 @@ void CLIMAT()
             //F2258 	 MAGICCCResults(1,(K-1990)/IIPRT+1) = TEMUSER(IYR)+TGAV(226)
             MAGICCCResults[ 18 ][ yrindex ] = STOREDVALS.TEMUSER[ IYR ] + TANDSL.TGAV[ 226 ];
             //F2281 	 MAGICCCResults(21,(K-1990)/IIPRT+1) = getSLR( IYR ) ! getSLR is external fn with acutal year as argument
-            MAGICCCResults[ 19 ][ yrindex ] = getSLR( K );
+            MAGICCCResults[ 19 ][ yrindex ] = getSLR( state, K );
 
             // BC/OC FORCING
             //F2293 	 MAGICCCResults(26,(K-1990)/IIPRT+1) = GETFORCING( 24, K )	! BC forcing 
-         //   MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( 24, K );
+         //   MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( state, 24, K );
             //F2294 	 MAGICCCResults(27,(K-1990)/IIPRT+1) = GETFORCING( 25, K )	! OC forcing 
-         //   MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( 25, K );
+         //   MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( state, 25, K );
             // Fossil BC/OC Forcing
-            MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( 28, K );
+            MAGICCCResults[ 20 ][ yrindex ] = GETFORCING( state, 28, K );
             // Biomass Burning Aerosol Forcing
-            MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( 20, K );
+            MAGICCCResults[ 21 ][ yrindex ] = GETFORCING( state, 20, K );
             
             //F2295 
             //F2296 ! now we can write stuff out
@@ -3956,7 +3973,7 @@ void CLIMAT()
         if( NSIM.ISCENGEN == 9 || NSIM.NSIM == 4 ) {
             //F2314 !
             //F2315       open(unit=9,file='./outputs/concs.dis',status='UNKNOWN')
-            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/concs_c.dis", DEBUG_IO );
+            openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/concs_c.dis" );
             //F2316 !
             //F2317         WRITE (9,211)
             outfile9 << "YEAR CO2USER   CO2LO  CO2MID   CO2HI CH4USER   CH4LO  CH4MID   CH4HI     N2O MIDTAUCH4" << endl;
@@ -4082,7 +4099,7 @@ void CLIMAT()
             //F2394 !  WRITE FORCING CHANGES FROM MID-1990 TO MAG DISPLAY FILE
             //F2395 !
             //F2396       open(unit=9,file='./outputs/forcings.dis',status='UNKNOWN')
-            openfile_write( &outfile9, BASE_OUTPUT_DIR + "/forcings_c.dis", DEBUG_IO );
+            openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/forcings_c.dis" );
             //F2397 !
             //F2398         WRITE (9,57)
             outfile9 << "YEAR,CO2,CH4tot,N2O, HALOtot,TROPOZ,SO4DIR,SO4IND,BIOAER,FOC+FBC,QAERMN,QLAND, TOTAL, YEAR,CH4-O3," << endl;
@@ -4291,22 +4308,22 @@ void CLIMAT()
         //F2524 !
         //F2525         OPEN(UNIT=10,file='./outputs/lodrive.raw' ,STATUS='UNKNOWN')
         ofstream outfile10, outfile11, outfile12, outfile13, outfile14, outfile15, outfile16, outfile17;
-        openfile_write( &outfile10, BASE_OUTPUT_DIR + "/lodrive.raw", DEBUG_IO );
+        openOutputFile( state, &outfile10, BASE_OUTPUT_DIR + "/lodrive.raw" );
         //F2526         OPEN(UNIT=11,file='./outputs/middrive.raw',STATUS='UNKNOWN')
-        openfile_write( &outfile11, BASE_OUTPUT_DIR + "/middrive.raw", DEBUG_IO );
+        openOutputFile( state, &outfile11, BASE_OUTPUT_DIR + "/middrive.raw" );
         //F2527         OPEN(UNIT=12,file='./outputs/hidrive.raw' ,STATUS='UNKNOWN')
-        openfile_write( &outfile12, BASE_OUTPUT_DIR + "/hidrive.raw", DEBUG_IO );
+        openOutputFile( state, &outfile12, BASE_OUTPUT_DIR + "/hidrive.raw" );
         //F2528         OPEN(UNIT=13,file='./outputs/usrdrive.raw',STATUS='UNKNOWN')
-        openfile_write( &outfile13, BASE_OUTPUT_DIR + "/usrdrive.raw", DEBUG_IO );
+        openOutputFile( state, &outfile13, BASE_OUTPUT_DIR + "/usrdrive.raw" );
         //F2529 !
         //F2530         OPEN(UNIT=14,file='./outputs/lodrive.out' ,STATUS='UNKNOWN')
-        openfile_write( &outfile14, BASE_OUTPUT_DIR + "/lodrive.out", DEBUG_IO );
+        openOutputFile( state, &outfile14, BASE_OUTPUT_DIR + "/lodrive.out" );
         //F2531         OPEN(UNIT=15,file='./outputs/middrive.out',STATUS='UNKNOWN')
-        openfile_write( &outfile15, BASE_OUTPUT_DIR + "/middrive.out", DEBUG_IO );
+        openOutputFile( state, &outfile15, BASE_OUTPUT_DIR + "/middrive.out" );
         //F2532         OPEN(UNIT=16,file='./outputs/hidrive.out' ,STATUS='UNKNOWN')
-        openfile_write( &outfile16, BASE_OUTPUT_DIR + "/hidrive.out", DEBUG_IO );
+        openOutputFile( state, &outfile16, BASE_OUTPUT_DIR + "/hidrive.out" );
         //F2533         OPEN(UNIT=17,file='./outputs/usrdrive.out',STATUS='UNKNOWN')
-        openfile_write( &outfile17, BASE_OUTPUT_DIR + "/usrdrive.out", DEBUG_IO );
+        openOutputFile( state, &outfile17, BASE_OUTPUT_DIR + "/usrdrive.out" );
         //F2534 !
         //F2535         DO NCLIM=1,4
         for( NSIM.NCLIM=1; NSIM.NCLIM<=4; NSIM.NCLIM++ ) {
@@ -4522,7 +4539,7 @@ void CLIMAT()
     //F2649 !
     //F2650       open(unit=9,file='./outputs/temps.dis',status='UNKNOWN')
     ofstream outfile9;
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/temps_c.dis", DEBUG_IO );
+    openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/temps_c.dis" );
     //F2651 !
     //F2652         WRITE (9,213)
     outfile9 << "YEAR  TEMUSER    TEMLO   TEMMID    TEMHI TEMNOSO2" << endl;
@@ -4550,7 +4567,7 @@ void CLIMAT()
     //F2668 !  WRITE SEALEVEL CHANGES TO MAG DISPLAY FILE
     //F2669 !
     //F2670       open(unit=9,file='./outputs/sealev.dis',status='UNKNOWN')
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/sealev_c.dis", DEBUG_IO );
+    openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/sealev_c.dis" );
     //F2671 !
     //F2672         WRITE (9,214)
     outfile9 << "YEAR  MSLUSER    MSLLO   MSLMID    MSLHI" << endl;
@@ -4578,7 +4595,7 @@ void CLIMAT()
     //F2688 !  WRITE EMISSIONS TO MAG DISPLAY FILE
     //F2689 !
     //F2690       open(unit=9,file='./outputs/emiss.dis',status='UNKNOWN')
-    openfile_write( &outfile9, BASE_OUTPUT_DIR + "/emiss_c.dis", DEBUG_IO );
+    openOutputFile( state, &outfile9, BASE_OUTPUT_DIR + "/emiss_c.dis" );
     //F2691 !
     //F2692         WRITE (9,212)
     outfile9 << "YEAR  FOSSCO2 NETDEFOR      CH4      N2O SO2-REG1 SO2-REG2 SO2-REG3   SO2-GL" << endl;
@@ -4632,7 +4649,7 @@ void CLIMAT()
     //F2725 !
     //F2726       OPEN(UNIT=888,file='./outputs/FRACLEFT.OUT',STATUS='UNKNOWN')
     ofstream outfile888;
-    openfile_write( &outfile888, BASE_OUTPUT_DIR + "/fracleft_c.out", DEBUG_IO );
+    openOutputFile( state, &outfile888, BASE_OUTPUT_DIR + "/fracleft_c.out" );
     //F2727 !
     //F2728 !  FRACTION OF CO2 REMAINING IN ATMOSPHERE
     //F2729 !
@@ -4998,7 +5015,7 @@ void CLIMAT()
     //F3057         end
     outfile8.close();
 
-    setGlobals( &CARB, &TANDSL, &CONCS, &NEWCONCS, 
+    setGlobals( state, &CARB, &TANDSL, &CONCS, &NEWCONCS, 
               &STOREDVALS, &NEWPARAMS, &BCOC, 
               &METH1, &CAR, &FORCE, &JSTART,
               &QADD, &HALOF, GAS_EMK_DATA );
@@ -0,0 +1,430 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+* \file climate_emulator.cpp
+* \ingroup Objects
+* \brief ClimateEmulator class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "climate/include/climate_emulator.h"
+#include "util/base/include/model_time.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+using namespace xercesc;
+
+/*!
+ * \brief Constructor.
+ * \param aModel The full climate model, which the emulator takes ownership of.
+ * \param aModeltime The scenario's modeltime object.
+ */
+ClimateEmulator::ClimateEmulator( IClimateModel* aModel, const Modeltime* aModeltime ):
+mModel( aModel ),
+mModeltime( aModeltime ),
+mStartYear( aModeltime->getStartYear() ),
+mEndYear( aModeltime->getEndYear() ),
+mEmulationEnabled( false ),
+mLastRunEmulated( false ),
+mSkippedPeriodRuns( false ),
+mMaxResidual( Configuration::getInstance()->getDouble( "climate-emulator-max-residual", 0.1, false ) ),
+mMaxErrors( NUM_OUTPUT_TYPES, 0.0 ),
+mNumEmulatedRuns( 0 ),
+mNumFullRuns( 0 ),
+mNumComparedRuns( 0 )
+{
+    assert( mModel.get() );
+}
+
+//! Destructor.
+ClimateEmulator::~ClimateEmulator(){
+}
+
+void ClimateEmulator::XMLParse( const DOMNode* node ){
+    mModel->XMLParse( node );
+}
+
+const string& ClimateEmulator::getXMLName() const {
+    return mModel->getXMLName();
+}
+
+void ClimateEmulator::toInputXML( ostream& out, Tabs* tabs ) const {
+    mModel->toInputXML( out, tabs );
+}
+
+void ClimateEmulator::toDebugXML( const int period, ostream& out, Tabs* tabs ) const {
+    mModel->toDebugXML( period, out, tabs );
+}
+
+void ClimateEmulator::completeInit( const string& aScenarioName ){
+    mModel->completeInit( aScenarioName );
+}
+
+bool ClimateEmulator::setEmissions( const string& aGasName, const int aPeriod, const double aEmission ){
+    const bool valid = mModel->setEmissions( aGasName, aPeriod, aEmission );
+    if( valid ) {
+        mEmissions[ make_pair( aGasName, mModeltime->getper_to_yr( aPeriod ) ) ] = aEmission;
+    }
+    return valid;
+}
+
+bool ClimateEmulator::setLUCEmissions( const string& aGasName, const int aYear, const double aEmission ){
+    const bool valid = mModel->setLUCEmissions( aGasName, aYear, aEmission );
+    if( valid ) {
+        mEmissions[ make_pair( aGasName, aYear ) ] = aEmission;
+    }
+    return valid;
+}
+
+double ClimateEmulator::getEmissions( const string& aGasName, const int aYear ) const {
+    return mModel->getEmissions( aGasName, aYear );
+}
+
+/*!
+ * \brief Run the climate model, emulating it if possible.
+ * \details The run is emulated if emulation is enabled, two full runs with
+ *          different emissions have been kept and the part of the change in
+ *          emissions outside of the fitted direction is small enough.
+ *          Otherwise the full model is run.
+ * \return Whether the run completed successfully.
+ */
+IClimateModel::runModelStatus ClimateEmulator::runModel(){
+    if( mEmulationEnabled ) {
+        vector<double> outputs;
+        double residual = 0;
+        if( estimate( getEmissionsVector(), outputs, residual ) && residual <= mMaxResidual ) {
+            mEmulatedOutputs.swap( outputs );
+            mLastRunEmulated = true;
+            ++mNumEmulatedRuns;
+
+            ILogger& climatelog = ILogger::getLogger( "climate-log" );
+            climatelog.setLevel( ILogger::DEBUG );
+            climatelog << "Emulated the climate model with a residual of " << residual << "." << endl;
+            return SUCCESS;
+        }
+    }
+    return runFullModel();
+}
+
+/*!
+ * \brief Run the climate model for a single period.
+ * \details While emulating the run is skipped and replayed before the next
+ *          full run.
+ * \param aYear The year to run the model through.
+ * \return Whether the run completed successfully.
+ */
+IClimateModel::runModelStatus ClimateEmulator::runModel( const int aYear ){
+    if( mEmulationEnabled && !mPreviousRun.mEmissions.empty() ) {
+        mSkippedPeriodRuns = true;
+        return SUCCESS;
+    }
+    return mModel->runModel( aYear );
+}
+
+IClimateModel::runModelStatus ClimateEmulator::runEnsemble( ClimateEnsemble& aEnsemble ){
+    return mModel->runEnsemble( aEnsemble );
+}
+
+/*!
+ * \brief Run the full climate model with the current emissions.
+ * \details The outputs are compared with the estimate of the emulator and
+ *          kept to fit later estimates.
+ * \return Whether the run completed successfully.
+ */
+IClimateModel::runModelStatus ClimateEmulator::runFullModel(){
+    // Scale each gas by its emissions in the first run.
+    if( mGasScales.empty() ) {
+        typedef map<pair<string, int>, double>::const_iterator EmissionsIterator;
+        for( EmissionsIterator it = mEmissions.begin(); it != mEmissions.end(); ++it ) {
+            double& scale = mGasScales[ it->first.first ];
+            scale = max( scale, fabs( it->second ) );
+        }
+        for( map<string, double>::iterator it = mGasScales.begin(); it != mGasScales.end(); ++it ) {
+            if( it->second == 0 ) {
+                it->second = 1;
+            }
+        }
+    }
+
+    const vector<double> emissions = getEmissionsVector();
+    vector<double> estimated;
+    double residual = 0;
+    const bool hasEstimate = estimate( emissions, estimated, residual );
+
+    // Catch up the period runs which were skipped while emulating.
+    if( mSkippedPeriodRuns ) {
+        for( int period = 1; period < mModeltime->getmaxper(); ++period ) {
+            mModel->runModel( mModeltime->getper_to_yr( period ) );
+        }
+        mSkippedPeriodRuns = false;
+    }
+
+    const runModelStatus status = mModel->runModel();
+    mLastRunEmulated = false;
+    mEmulatedOutputs.clear();
+    ++mNumFullRuns;
+    if( status != SUCCESS ) {
+        return status;
+    }
+
+    FullRun run;
+    run.mEmissions = emissions;
+    run.mOutputs = getFullModelOutputs();
+
+    if( hasEstimate ) {
+        ++mNumComparedRuns;
+        const unsigned int numYears = mEndYear - mStartYear + 1;
+        vector<double> errors( NUM_OUTPUT_TYPES, 0.0 );
+        for( unsigned int i = 0; i < run.mOutputs.size(); ++i ) {
+            const unsigned int type = i / numYears;
+            errors[ type ] = max( errors[ type ], fabs( estimated[ i ] - run.mOutputs[ i ] ) );
+        }
+        ILogger& climatelog = ILogger::getLogger( "climate-log" );
+        climatelog.setLevel( ILogger::DEBUG );
+        climatelog << "Climate emulator error against a full run with a residual of " << residual << ":";
+        for( unsigned int type = 0; type < NUM_OUTPUT_TYPES; ++type ) {
+            mMaxErrors[ type ] = max( mMaxErrors[ type ], errors[ type ] );
+            climatelog << ' ' << getOutputName( static_cast<OutputType>( type ) ) << ' ' << errors[ type ];
+        }
+        climatelog << endl;
+    }
+
+    // Keep the last run with different emissions so the fit has a direction.
+    if( run.mEmissions != mLastRun.mEmissions ) {
+        mPreviousRun = mLastRun;
+    }
+    mLastRun = run;
+    return status;
+}
+
+//! Set whether runs may be emulated.
+void ClimateEmulator::setEmulationEnabled( const bool aEnabled ){
+    mEmulationEnabled = aEnabled;
+}
+
+//! Get whether the outputs of the last run were emulated.
+bool ClimateEmulator::isLastRunEmulated() const {
+    return mLastRunEmulated;
+}
+
+/*!
+ * \brief Print the number of emulated and full runs and the largest errors.
+ * \param aOut Stream to which to print.
+ */
+void ClimateEmulator::printStatistics( ostream& aOut ) const {
+    aOut << "Climate emulator ran " << mNumEmulatedRuns << " emulated and "
+         << mNumFullRuns << " full climate model runs." << endl;
+    if( mNumComparedRuns > 0 ) {
+        aOut << "Largest emulator errors over " << mNumComparedRuns << " full runs:";
+        for( unsigned int type = 0; type < NUM_OUTPUT_TYPES; ++type ) {
+            aOut << ' ' << getOutputName( static_cast<OutputType>( type ) ) << ' ' << mMaxErrors[ type ];
+        }
+        aOut << endl;
+    }
+}
+
+double ClimateEmulator::getConcentration( const string& aGasName, const int aYear ) const {
+    if( mLastRunEmulated ) {
+        if( aGasName == "CO2" ) {
+            return getEmulatedOutput( CO2_CONCENTRATION, aYear );
+        }
+        if( aGasName == "CH4" ) {
+            return getEmulatedOutput( CH4_CONCENTRATION, aYear );
+        }
+        if( aGasName == "N2O" ) {
+            return getEmulatedOutput( N2O_CONCENTRATION, aYear );
+        }
+    }
+    return mModel->getConcentration( aGasName, aYear );
+}
+
+double ClimateEmulator::getTemperature( const int aYear ) const {
+    return mLastRunEmulated ? getEmulatedOutput( TEMPERATURE, aYear )
+        : mModel->getTemperature( aYear );
+}
+
+double ClimateEmulator::getForcing( const string& aGasName, const int aYear ) const {
+    return mModel->getForcing( aGasName, aYear );
+}
+
+double ClimateEmulator::getTotalForcing( const int aYear ) const {
+    return mLastRunEmulated ? getEmulatedOutput( TOTAL_FORCING, aYear )
+        : mModel->getTotalForcing( aYear );
+}
+
+double ClimateEmulator::getNetTerrestrialUptake( const int aYear ) const {
+    return mModel->getNetTerrestrialUptake( aYear );
+}
+
+double ClimateEmulator::getNetOceanUptake( const int aYear ) const {
+    return mModel->getNetOceanUptake( aYear );
+}
+
+int ClimateEmulator::getCarbonModelStartYear() const {
+    return mModel->getCarbonModelStartYear();
+}
+
+void ClimateEmulator::printFileOutput() const {
+    mModel->printFileOutput();
+}
+
+void ClimateEmulator::printDBOutput() const {
+    mModel->printDBOutput();
+}
+
+void ClimateEmulator::accept( IVisitor* aVisitor, const int aPeriod ) const {
+    mModel->accept( aVisitor, aPeriod );
+}
+
+/*!
+ * \brief Get the current emissions, each gas divided by its scale.
+ * \return The scaled emissions ordered by gas and year.
+ */
+vector<double> ClimateEmulator::getEmissionsVector() const {
+    vector<double> emissions;
+    emissions.reserve( mEmissions.size() );
+    typedef map<pair<string, int>, double>::const_iterator EmissionsIterator;
+    for( EmissionsIterator it = mEmissions.begin(); it != mEmissions.end(); ++it ) {
+        map<string, double>::const_iterator scale = mGasScales.find( it->first.first );
+        emissions.push_back( scale != mGasScales.end() ? it->second / scale->second : it->second );
+    }
+    return emissions;
+}
+
+/*!
+ * \brief Get the emulated outputs from the full model.
+ * \return The outputs by output type and year.
+ */
+vector<double> ClimateEmulator::getFullModelOutputs() const {
+    const int numYears = mEndYear - mStartYear + 1;
+    vector<double> outputs( NUM_OUTPUT_TYPES * numYears );
+    for( int i = 0; i < numYears; ++i ) {
+        const int year = mStartYear + i;
+        outputs[ TEMPERATURE * numYears + i ] = mModel->getTemperature( year );
+        outputs[ TOTAL_FORCING * numYears + i ] = mModel->getTotalForcing( year );
+        outputs[ CO2_CONCENTRATION * numYears + i ] = mModel->getConcentration( "CO2", year );
+        outputs[ CH4_CONCENTRATION * numYears + i ] = mModel->getConcentration( "CH4", year );
+        outputs[ N2O_CONCENTRATION * numYears + i ] = mModel->getConcentration( "N2O", year );
+    }
+    return outputs;
+}
+
+/*!
+ * \brief Estimate the outputs of the full model for a set of emissions.
+ * \details The change in emissions from the last full run is projected onto
+ *          the change between the previous and the last full run, and the
+ *          outputs of the last run are moved by the same multiple of the
+ *          change in outputs between the two runs.
+ * \param aEmissions The scaled emissions.
+ * \param aOutputs The estimated outputs by output type and year.
+ * \param aResidual The fraction of the change in emissions which lies outside
+ *        of the fitted direction.
+ * \return Whether an estimate could be made.
+ */
+bool ClimateEmulator::estimate( const vector<double>& aEmissions,
+                                vector<double>& aOutputs,
+                                double& aResidual ) const
+{
+    if( mPreviousRun.mEmissions.empty() || mPreviousRun.mEmissions.size() != aEmissions.size()
+        || mLastRun.mEmissions.size() != aEmissions.size() )
+    {
+        return false;
+    }
+
+    double directionNorm = 0;
+    double projection = 0;
+    double changeNorm = 0;
+    for( unsigned int i = 0; i < aEmissions.size(); ++i ) {
+        const double direction = mLastRun.mEmissions[ i ] - mPreviousRun.mEmissions[ i ];
+        const double change = aEmissions[ i ] - mLastRun.mEmissions[ i ];
+        directionNorm += direction * direction;
+        projection += direction * change;
+        changeNorm += change * change;
+    }
+    if( directionNorm == 0 ) {
+        return false;
+    }
+
+    const double step = projection / directionNorm;
+    const double outside = max( changeNorm - step * projection, 0.0 );
+    aResidual = changeNorm > 0 ? sqrt( outside / changeNorm ) : 0;
+
+    aOutputs.resize( mLastRun.mOutputs.size() );
+    for( unsigned int i = 0; i < aOutputs.size(); ++i ) {
+        aOutputs[ i ] = mLastRun.mOutputs[ i ]
+            + step * ( mLastRun.mOutputs[ i ] - mPreviousRun.mOutputs[ i ] );
+    }
+    return true;
+}
+
+/*!
+ * \brief Get an output of the last emulated run.
+ * \param aType The output type.
+ * \param aYear The year.
+ * \return The emulated output, or the output of the full model for years which
+ *         are not emulated.
+ */
+double ClimateEmulator::getEmulatedOutput( const OutputType aType, const int aYear ) const {
+    if( aYear < mStartYear || aYear > mEndYear ) {
+        switch( aType ) {
+            case TEMPERATURE:
+                return mModel->getTemperature( aYear );
+            case TOTAL_FORCING:
+                return mModel->getTotalForcing( aYear );
+            case CO2_CONCENTRATION:
+                return mModel->getConcentration( "CO2", aYear );
+            case CH4_CONCENTRATION:
+                return mModel->getConcentration( "CH4", aYear );
+            default:
+                return mModel->getConcentration( "N2O", aYear );
+        }
+    }
+    return mEmulatedOutputs[ aType * ( mEndYear - mStartYear + 1 ) + aYear - mStartYear ];
+}
+
+/*!
+ * \brief Get the name under which an output type is reported.
+ * \param aType The output type.
+ * \return The name of the output type.
+ */
+const string& ClimateEmulator::getOutputName( const OutputType aType ) {
+    const static string NAMES[] = { "temperature", "total-forcing", "CO2-concentration",
+                                    "CH4-concentration", "N2O-concentration" };
+    assert( aType < NUM_OUTPUT_TYPES );
+    return NAMES[ aType ];
+}
@@ -0,0 +1,241 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+* \file climate_ensemble.cpp
+* \ingroup Objects
+* \brief ClimateEnsemble class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cassert>
+
+#include "climate/include/climate_ensemble.h"
+#include "climate/include/iclimate_model.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+
+/*!
+ * \brief Split a line of CSV input into its cells.
+ * \param aLine The line to split.
+ * \return The cells.
+ */
+static vector<string> splitCSVLine( const string& aLine ) {
+    vector<string> cells;
+    istringstream lineStream( aLine );
+    string cell;
+    while( getline( lineStream, cell, ',' ) ) {
+        // Remove a trailing carriage return left by files written on Windows.
+        if( !cell.empty() && cell[ cell.size() - 1 ] == '\r' ) {
+            cell.erase( cell.size() - 1 );
+        }
+        cells.push_back( cell );
+    }
+    return cells;
+}
+
+/*!
+ * \brief Get a percentile of sorted values by linear interpolation.
+ * \param aSortedValues The values, sorted in increasing order.
+ * \param aFraction The percentile as a fraction.
+ * \return The percentile.
+ */
+static double getPercentile( const vector<double>& aSortedValues, const double aFraction ) {
+    const double position = aFraction * ( aSortedValues.size() - 1 );
+    const unsigned int lower = static_cast<unsigned int>( floor( position ) );
+    const unsigned int upper = min( lower + 1, static_cast<unsigned int>( aSortedValues.size() - 1 ) );
+    return aSortedValues[ lower ] + ( position - lower ) * ( aSortedValues[ upper ] - aSortedValues[ lower ] );
+}
+
+/*!
+ * \brief Constructor.
+ * \param aStartYear First year for which to store results.
+ * \param aEndYear Last year for which to store results.
+ */
+ClimateEnsemble::ClimateEnsemble( const int aStartYear, const int aEndYear ):
+mStartYear( aStartYear ),
+mEndYear( aEndYear )
+{
+}
+
+//! Get the name of the equilibrium climate sensitivity parameter.
+const string& ClimateEnsemble::getClimateSensitivityName() {
+    const static string NAME = "climate-sensitivity";
+    return NAME;
+}
+
+//! Get the name of the ocean heat diffusivity parameter.
+const string& ClimateEnsemble::getOceanDiffusivityName() {
+    const static string NAME = "ocean-diffusivity";
+    return NAME;
+}
+
+/*!
+ * \brief Get the name under which a result type is printed.
+ * \param aType The result type.
+ * \return The name of the result type.
+ */
+const string& ClimateEnsemble::getResultName( const ResultType aType ) {
+    const static string NAMES[] = { "temperature", "total-forcing", "CO2-concentration" };
+    assert( aType < NUM_RESULT_TYPES );
+    return NAMES[ aType ];
+}
+
+/*!
+ * \brief Read the parameter values of the members.
+ * \details The first line of the file names the parameters and each
+ *          following non-empty line gives the values for one member. Results
+ *          for all members are allocated here so that members may later be
+ *          stored concurrently.
+ * \param aFileName Name of the CSV file.
+ * \return Whether at least one member was read.
+ */
+bool ClimateEnsemble::readParameters( const string& aFileName ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    ifstream inputFile( aFileName.c_str() );
+    if( !inputFile ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Could not open climate ensemble file " << aFileName << "." << endl;
+        return false;
+    }
+
+    string line;
+    getline( inputFile, line );
+    mParameterNames = splitCSVLine( line );
+    mParameters.clear();
+    while( getline( inputFile, line ) ) {
+        vector<string> cells = splitCSVLine( line );
+        if( cells.empty() || ( cells.size() == 1 && cells[ 0 ].empty() ) ) {
+            continue;
+        }
+        if( cells.size() != mParameterNames.size() ) {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Skipping climate ensemble member with " << cells.size() << " values, expected "
+                    << mParameterNames.size() << "." << endl;
+            continue;
+        }
+        vector<double> values( cells.size() );
+        for( unsigned int i = 0; i < cells.size(); ++i ) {
+            values[ i ] = atof( cells[ i ].c_str() );
+        }
+        mParameters.push_back( values );
+    }
+
+    mResults.assign( mParameters.size(), vector<vector<double> >() );
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Read " << mParameters.size() << " climate ensemble members from " << aFileName << "." << endl;
+    return !mParameters.empty();
+}
+
+//! Get the number of members in the ensemble.
+unsigned int ClimateEnsemble::getNumMembers() const {
+    return static_cast<unsigned int>( mParameters.size() );
+}
+
+//! Get the names of the varied parameters.
+const vector<string>& ClimateEnsemble::getParameterNames() const {
+    return mParameterNames;
+}
+
+/*!
+ * \brief Get the value of a parameter for a member.
+ * \param aMember Index of the member.
+ * \param aParameter Index of the parameter in getParameterNames.
+ * \return The parameter value.
+ */
+double ClimateEnsemble::getParameter( const unsigned int aMember, const unsigned int aParameter ) const {
+    assert( aMember < mParameters.size() );
+    assert( aParameter < mParameterNames.size() );
+    return mParameters[ aMember ][ aParameter ];
+}
+
+/*!
+ * \brief Store the results of a member from a climate model which has run it.
+ * \details Only the results of the given member are written, so different
+ *          members may be stored at the same time.
+ * \param aMember Index of the member.
+ * \param aModel The climate model which ran the member.
+ */
+void ClimateEnsemble::storeResults( const unsigned int aMember, const IClimateModel& aModel ) {
+    assert( aMember < mResults.size() );
+    const int numYears = mEndYear - mStartYear + 1;
+    vector<vector<double> >& results = mResults[ aMember ];
+    results.assign( NUM_RESULT_TYPES, vector<double>( numYears ) );
+    for( int i = 0; i < numYears; ++i ) {
+        const int year = mStartYear + i;
+        results[ TEMPERATURE ][ i ] = aModel.getTemperature( year );
+        results[ TOTAL_FORCING ][ i ] = aModel.getTotalForcing( year );
+        results[ CO2_CONCENTRATION ][ i ] = aModel.getConcentration( "CO2", year );
+    }
+}
+
+/*!
+ * \brief Print percentiles of the results across members.
+ * \details Writes a CSV table with one row per result and year giving the
+ *          5th, 17th, 50th, 83rd and 95th percentiles. Members which did not
+ *          run are left out.
+ * \param aOut Stream to which to print.
+ */
+void ClimateEnsemble::printPercentiles( ostream& aOut ) const {
+    const double fractions[] = { 0.05, 0.17, 0.50, 0.83, 0.95 };
+    const unsigned int numFractions = sizeof( fractions ) / sizeof( fractions[ 0 ] );
+    const int numYears = mEndYear - mStartYear + 1;
+
+    aOut << "variable,year,p05,p17,p50,p83,p95" << endl;
+    for( int type = 0; type < NUM_RESULT_TYPES; ++type ) {
+        for( int i = 0; i < numYears; ++i ) {
+            vector<double> values;
+            values.reserve( mResults.size() );
+            for( unsigned int member = 0; member < mResults.size(); ++member ) {
+                if( !mResults[ member ].empty() ) {
+                    values.push_back( mResults[ member ][ type ][ i ] );
+                }
+            }
+            if( values.empty() ) {
+                continue;
+            }
+            sort( values.begin(), values.end() );
+            aOut << getResultName( static_cast<ResultType>( type ) ) << ',' << mStartYear + i;
+            for( unsigned int j = 0; j < numFractions; ++j ) {
+                aOut << ',' << getPercentile( values, fractions[ j ] );
+            }
+            aOut << endl;
+        }
+    }
+}
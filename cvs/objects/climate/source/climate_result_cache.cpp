@@ -0,0 +1,108 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+* \file climate_result_cache.cpp
+* \ingroup Objects
+* \brief ClimateResultCache class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <algorithm>
+
+#include "climate/include/climate_result_cache.h"
+
+using namespace std;
+
+//! Constructor
+ClimateResultCache::ClimateResultCache():
+mStartYear( 0 ),
+mNumYears( 0 ),
+mNumColumns( 0 )
+{
+}
+
+/*!
+ * \brief Set the years stored for each column.
+ * \details Any values already stored are discarded.
+ * \param aStartYear The first year.
+ * \param aEndYear The last year, inclusive.
+ */
+void ClimateResultCache::setYears( const int aStartYear, const int aEndYear ) {
+    mStartYear = aStartYear;
+    mNumYears = max( aEndYear - aStartYear + 1, 0 );
+    mValues.assign( mNumColumns * mNumYears, 0.0 );
+    mIsValid.assign( mNumColumns * mNumYears, false );
+}
+
+/*!
+ * \brief Add a column for a result.
+ * \return The ID of the new column.
+ */
+int ClimateResultCache::addColumn() {
+    mValues.resize( mValues.size() + mNumYears, 0.0 );
+    mIsValid.resize( mIsValid.size() + mNumYears, false );
+    return mNumColumns++;
+}
+
+int ClimateResultCache::getNumColumns() const {
+    return mNumColumns;
+}
+
+int ClimateResultCache::getStartYear() const {
+    return mStartYear;
+}
+
+int ClimateResultCache::getEndYear() const {
+    return mStartYear + mNumYears - 1;
+}
+
+/*!
+ * \brief Mark the values of every column for a year as invalid.
+ * \details Called when the climate model runs the year again, so that
+ *          results retrieved only when queried are not reused from the
+ *          previous run.
+ * \param aYear The year.
+ */
+void ClimateResultCache::invalidateYear( const int aYear ) {
+    if( aYear < mStartYear || aYear >= mStartYear + mNumYears ) {
+        return;
+    }
+    for( int column = 0; column < mNumColumns; ++column ) {
+        mIsValid[ getIndex( column, aYear ) ] = false;
+    }
+}
+
+//! Mark all values as invalid.
+void ClimateResultCache::invalidateAll() {
+    fill( mIsValid.begin(), mIsValid.end(), false );
+}
@@ -40,11 +40,13 @@
 
 #include <memory>
 #include <limits>
+#include <algorithm>
 #include <fstream>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
 #include "climate/include/hector_model.hpp"
+#include "climate/include/climate_ensemble.h"
 
 #if USE_HECTOR 
 
@@ -97,6 +99,8 @@ HectorModel::HectorModel( const Modeltime* aModeltime ) : mModeltime( aModeltime
     mEmissionsSwitchYear = def_switch_year;
     // Hector config location.  
     mHectorIniFile = def_ini_file; 
+    // Store all outputs each year unless reduced output is requested.
+    mReducedOutput = false;
 }
 
 
@@ -112,6 +116,7 @@ void HectorModel::XMLParse( const DOMNode* node ) {
      * hector-end-year
      * hector-ini-file
      * emissions-switch-year
+     * reduced-output
      *
      */
 
@@ -139,6 +144,9 @@ void HectorModel::XMLParse( const DOMNode* node ) {
         else if( chname == "carbon-model-start-year" ) {
             mCarbonModelStartYear = XMLHelper<int>::getValue( chnode );
         }
+        else if( chname == "reduced-output" ) {
+            mReducedOutput = XMLHelper<bool>::getValue( chnode );
+        }
         else {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
             mainLog.setLevel( ILogger::ERROR );
@@ -156,6 +164,7 @@ void HectorModel::toInputXML( ostream& out, Tabs* tabs) const {
     XMLWriteElementCheckDefault( mHectorIniFile, "hector-ini-file", out, tabs,
                                  string( def_ini_file ) );
     XMLWriteElementCheckDefault( mCarbonModelStartYear, "carbon-model-start-year", out, tabs, 1975 );
+    XMLWriteElementCheckDefault( mReducedOutput, "reduced-output", out, tabs, false );
     XMLWriteClosingTag( getXMLName(), out, tabs );
 }
 
@@ -164,6 +173,7 @@ void HectorModel::toDebugXML( const int period, ostream& out, Tabs* tabs ) const
     XMLWriteElement( mHectorEndYear, "hector-end-year", out, tabs );
     XMLWriteElement( mEmissionsSwitchYear, "emissions-switch-year", out, tabs );
     XMLWriteElement( mHectorIniFile, "hector-ini-file", out, tabs );
+    XMLWriteElement( mReducedOutput, "reduced-output", out, tabs );
     XMLWriteClosingTag( getXMLName(), out, tabs );
 } 
 
@@ -190,6 +200,7 @@ void HectorModel::completeInit( const string& aScenarioName ) {
                << endl << "\thector-end-year = " << mHectorEndYear
                << endl << "\temissions-switch-year = " << mEmissionsSwitchYear
                << endl << "\thector-ini-file = " << mHectorIniFile
+               << endl << "\treduced-output = " << mReducedOutput
                << endl;
 
     try {
@@ -287,10 +298,6 @@ void HectorModel::completeInit( const string& aScenarioName ) {
         mEmissionsTable[ it->first ].resize (mModeltime->getmaxper() );
         mUnitConvFac[ it->first ] = 1.0; // default value; will set exceptions below
         mHectorUnits[ it->first ] = Hector::U_GG; // This is the default; exceptions below
-
-        // per-gas results tables
-        mConcTable[ it->first ].resize( nrslt );
-        mGasRFTable[ it->first ].resize( nrslt ); 
         
         climatelog << "Tracking GCAM gas " << it->first << " as Hector gas "
                    << it->second << endl;
@@ -298,14 +305,8 @@ void HectorModel::completeInit( const string& aScenarioName ) {
     // Land Use CO2 is special; it can be set each year, rather than each period.
     mEmissionsTable["CO2NetLandUse"].resize( nrslt );
 
-    // tables for temperature and total forcing and land and ocean fluxes
-    mTotRFTable.resize( nrslt );
-    mTemperatureTable.resize( nrslt );
-    mLandFlux.resize( nrslt );
-    mOceanFlux.resize( nrslt );
-    // set up the other results tables
-    setupConcTbl();
-    setupRFTbl();
+    // set up the results columns
+    setupResults();
     
     // Set conversion factors for gasses that require them
     mUnitConvFac["SO2tot"] = TG_TO_GG / S_TO_SO2; // GCAM in Tg-SO2; Hector in Tg-S
@@ -374,6 +375,9 @@ void HectorModel::reset( const int aPeriod ) {
     climatelog << "Parsing ini file= " << mHectorIniFile << endl;
     Hector::INIToCoreReader coreParser( mHcore.get() );
     coreParser.parse( mHectorIniFile );
+    // Results retrieved from the old core may not hold for the new one.
+    mResults.invalidateAll();
+    setParameterOverrides();
     mHcore->addVisitor( mHosv.get() ); 
     mHcore->prepareToRun();
 
@@ -420,6 +424,102 @@ void HectorModel::reset( const int aPeriod ) {
     mHcore->run( static_cast<double>( mLastYear ) );
 }
 
+/*!
+ * \brief Send the ensemble parameter overrides to the core
+ * \details Must be called after the ini file is read and before the
+ *          core is prepared to run, since components only read their
+ *          parameters when they are prepared.
+ */
+void HectorModel::setParameterOverrides() {
+    map<string, double>::const_iterator it =
+        mParameterOverrides.find( ClimateEnsemble::getClimateSensitivityName() );
+    if( it != mParameterOverrides.end() ) {
+        mHcore->sendMessage( M_SETDATA, D_ECS,
+                             Hector::message_data( Hector::unitval( it->second, Hector::U_DEGC ) ) );
+    }
+    it = mParameterOverrides.find( ClimateEnsemble::getOceanDiffusivityName() );
+    if( it != mParameterOverrides.end() ) {
+        mHcore->sendMessage( M_SETDATA, D_DIFFUSIVITY,
+                             Hector::message_data( Hector::unitval( it->second, Hector::U_CM2_S ) ) );
+    }
+}
+
+/*!
+ * \brief Run a new core through all of the emissions GCAM has set
+ * \details The core is reset from the ini file, so that
+ *          mParameterOverrides take effect, and every stored period
+ *          and land use emission is sent again before running to the
+ *          end date.
+ * \return Status of the run.
+ */
+IClimateModel::runModelStatus HectorModel::rerunAllPeriods() {
+    reset( 1 );
+
+    map<std::string, std::vector<double> >::const_iterator it;
+    for( it = mEmissionsTable.begin(); it != mEmissionsTable.end(); ++it ) {
+        const string& gas = it->first;
+        const vector<double>& emissions = it->second;
+        if( gas != "CO2NetLandUse" ) {
+            for( int i = 1; i < mModeltime->getmaxper(); ++i ) {
+                if( util::isValidNumber( emissions[ i ] ) ) {
+                    setEmissionsByYear( gas, mModeltime->getper_to_yr( i ), emissions[ i ] );
+                }
+            }
+        }
+        else {
+            // LUC emissions are only stored through the Hector end year.
+            const int lastYear = min( mModeltime->getEndYear(), mHectorEndYear );
+            for( int yr = mModeltime->getper_to_yr( 1 ); yr <= lastYear; ++yr ) {
+                const double emiss = emissions[ yearlyDataIndex( yr ) ];
+                if( util::isValidNumber( emiss ) ) {
+                    setEmissionsByYear( gas, yr, emiss );
+                }
+            }
+        }
+    }
+    return runModel();
+}
+
+/*!
+ * \brief Run the climate model for each member of a climate ensemble
+ * \details The Hector core cannot be copied, so members are run one
+ *          after another, each on a core reset from the ini file with
+ *          the member's parameters.  The model is then run once more
+ *          with its own parameters so that its results are as before.
+ * \param aEnsemble The ensemble to run and in which to store results.
+ * \return Whether the ensemble was run.
+ */
+IClimateModel::runModelStatus HectorModel::runEnsemble( ClimateEnsemble& aEnsemble ) {
+    ILogger& climatelog = ILogger::getLogger( "climate-log" );
+    const vector<string>& names = aEnsemble.getParameterNames();
+    for( unsigned int i = 0; i < names.size(); ++i ) {
+        if( names[ i ] != ClimateEnsemble::getClimateSensitivityName() &&
+            names[ i ] != ClimateEnsemble::getOceanDiffusivityName() )
+        {
+            climatelog.setLevel( ILogger::WARNING );
+            climatelog << "Ignoring unknown climate ensemble parameter " << names[ i ] << endl;
+        }
+    }
+
+    runModelStatus status = SUCCESS;
+    for( unsigned int member = 0; member < aEnsemble.getNumMembers(); ++member ) {
+        mParameterOverrides.clear();
+        for( unsigned int i = 0; i < names.size(); ++i ) {
+            mParameterOverrides[ names[ i ] ] = aEnsemble.getParameter( member, i );
+        }
+        if( rerunAllPeriods() == SUCCESS ) {
+            aEnsemble.storeResults( member, *this );
+        }
+        else {
+            status = FAILURE;
+        }
+    }
+
+    mParameterOverrides.clear();
+    rerunAllPeriods();
+    return status;
+}
+
 /*! \brief Set emissions for hector model 
  *  \details Set emissions for the requested gas, unless the year is
  *           before the historical switch-over year, in which case we
@@ -548,9 +648,7 @@ IClimateModel::runModelStatus HectorModel::runModel( const int aYear ) {
     // yearly results.
     for( int year = mLastYear + 1; year <= aYear; ++year ) {
         mHcore->run( static_cast<double>( year ) );
-        storeConc( year );
-        storeRF( year );
-        storeGlobals( year );
+        storeResults( year );
     }
     mLastYear = aYear;
     return SUCCESS;
@@ -589,13 +687,16 @@ double HectorModel::getConcentration( const string& aGasName, const int aYear) c
     ILogger& climatelog = ILogger::getLogger( "climate-log" );
     climatelog.setLevel( ILogger::DEBUG );
     
-    map<string, vector<double> >::const_iterator it =
-        mConcTable.find( aGasName );
-    if( it != mConcTable.end() ) {
-        int idx = yearlyDataIndex( aYear );
-        double conc = (it->second)[ idx ];
+    map<string, int>::const_iterator it = mConcColumns.find( aGasName );
+    if( it != mConcColumns.end() ) {
+        if( aYear > mHectorEndYear ) {
+            climatelog.setLevel( ILogger::WARNING );
+            climatelog << "getConcentration():  invalid year: " << aYear << endl;
+            return 0.0;
+        }
+        double conc = getResult( it->second, aYear );
         climatelog << "\tgetConcentration:  gas= " << aGasName
-                   << "\tyear= " << aYear << "  index= " << idx
+                   << "\tyear= " << aYear << "  column= " << it->second
                    << "\tconc= " << conc << endl;
         return conc;
     }
@@ -616,10 +717,9 @@ double HectorModel::getTemperature( const int aYear ) const {
         return 0.0;
     }
 
-    int idx = yearlyDataIndex( aYear );
-    double tempval = mTemperatureTable[ idx ];
+    double tempval = getResult( mTemperatureColumn, aYear );
     climatelog.setLevel( ILogger::DEBUG );
-    climatelog << "\tgetTemperature:  year= " << aYear << "  index= " << idx
+    climatelog << "\tgetTemperature:  year= " << aYear
                << "\ttemperature= " << tempval << endl;
     return tempval;
 }
@@ -633,7 +733,7 @@ double HectorModel::getTotalForcing( const int aYear ) const {
         return 0.0;
     }
 
-    double forcingval = mTotRFTable[ yearlyDataIndex( aYear ) ];
+    double forcingval = getResult( mTotRFColumn, aYear );
     climatelog.setLevel( ILogger::DEBUG );
     climatelog << "\tgetTotalForcing:  year= " << aYear
                << "\ttotal forcing= " << forcingval << endl;
@@ -650,32 +750,18 @@ double HectorModel::getForcing( const string& aGas, int aYear ) const {
         return 0.0;
     }
 
-    // In hector, halocarbons store their data in a time series, so we
-    // don't have to make a table for them in the GCAM component.  We
-    // can just ask the hector core for them by name and date. 
-    // TODO: make all hector components work this way.
-
-    map<std::string, std::string>::const_iterator ittseries =
-        mHectorRFTseriesMsg.find( aGas ); 
-    // If the gas is a halocarbon, grab the RF request string and send
-    // it to the Hector core.
-    if( ittseries != mHectorRFTseriesMsg.end() ) {
-        return mHcore->sendMessage( M_GETDATA, ittseries->second, aYear );
-    }
-
-    // For other RF components, 
-    map<std::string, std::vector<double> >::const_iterator it =
-        mGasRFTable.find( aGas );
-
-    if( it == mGasRFTable.end() ) {
+    // Halocarbons keep their forcing in a time series in the Hector
+    // core, so their columns are filled the first time they are
+    // queried rather than every year.
+    map<string, int>::const_iterator it = mRFColumns.find( aGas );
+    if( it == mRFColumns.end() ) {
         climatelog << "getForcing(): invalid gas: " << aGas << endl;
         return 0.0;
     }
 
-    int idx = yearlyDataIndex( aYear );
-    double forcing = (it->second)[ idx ];
+    double forcing = getResult( it->second, aYear );
     climatelog << "\tgetForcing:  gas= " << aGas
-               << "\tyear= " << aYear << "  index= " << idx
+               << "\tyear= " << aYear << "  column= " << it->second
                << "\tforcing= " << forcing << endl;
     return forcing;
 }
@@ -685,136 +771,153 @@ int HectorModel::yearlyDataIndex( const int year ) const {
     return year - mModeltime->getStartYear();
 }
 
-void HectorModel::storeConc( const int aYear ) {
+/*!
+ * \brief Get a result for a year
+ * \details If the result has not been stored for the current run and
+ *          Hector keeps it as a time series, it is retrieved from the
+ *          core and stored so that later queries do not go back to the
+ *          core.  Results for years the core has not run through yet
+ *          are not retrieved.
+ * \param aColumn The result column.
+ * \param aYear The year.
+ * \return The result, or zero if the year is outside of the years
+ *         results are kept for.
+ */
+double HectorModel::getResult( const int aColumn, const int aYear ) const {
+    if( aYear < mResults.getStartYear() || aYear > mResults.getEndYear() ) {
+        return 0.0;
+    }
+    if( !mResults.isValid( aColumn, aYear ) && aYear <= mLastYear ) {
+        const ResultSource& source = mResultSources[ aColumn ];
+        if( source.mIsTimeSeries ) {
+            mResults.setValue( aColumn, aYear,
+                               mHcore->sendMessage( M_GETDATA, source.mMessage,
+                                                    Hector::message_data( aYear ) ) );
+        }
+    }
+    return mResults.getValue( aColumn, aYear );
+}
+
+/*!
+ * \brief Add a result column for a Hector output
+ * \details Outputs which Hector does not keep as a time series are
+ *          only available for the year the core has just run, so they
+ *          must be stored each year.
+ * \param aMessage The Hector message for the output.
+ * \param aIsTimeSeries Whether Hector keeps the output as a time series.
+ * \param aStoreEachYear Whether to store the output each year as the
+ *        core runs rather than when it is first queried.
+ * \return The new column.
+ */
+int HectorModel::addResult( const string& aMessage, const bool aIsTimeSeries,
+                            const bool aStoreEachYear )
+{
+    ResultSource source;
+    source.mMessage = aMessage;
+    source.mIsTimeSeries = aIsTimeSeries;
+    source.mStoreEachYear = aStoreEachYear || !aIsTimeSeries;
+    mResultSources.push_back( source );
+    return mResults.addColumn();
+}
+
+void HectorModel::storeResults( const int aYear ) {
     ILogger& climatelog = ILogger::getLogger( "climate-log" );
 
-    // No need to check the index because we checked it in runModel
-    int i = yearlyDataIndex( aYear );
+    // Values left from a previous run of this year are no longer valid.
+    mResults.invalidateYear( aYear );
 
-    // These are all of the atmospheric concentrations that Hector is
-    // set up to provide.
+    // No need to check the year because we checked it in runModel
     Hector::message_data date( aYear );
-    mConcTable["CH4"][i]   = mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_CH4,date ); 
-    mConcTable["N2O"][i]   = mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_N2O,date );
-    mConcTable["O3"][i]    = mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_O3, date );
-    mConcTable["CO2"][i]   = mHcore->sendMessage( M_GETDATA, D_ATMOSPHERIC_CO2 );
-
-    // Hector doesn't actually compute concentrations for these
-    // gasses. (we use their emissions to compute O3 concentration,
-    // but don't compute the concentrations of the original gasses.) 
-    // mConcTable["CO"][i]    = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_CO);
-    // mConcTable["NOX"][i]   = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_NOX);
-    // mConcTable["NMVOC"][i] = mHcore->sendMessage(M_GETDATA, D_ATMOSPHERIC_NMVOC);
+    for( unsigned int column = 0; column < mResultSources.size(); ++column ) {
+        const ResultSource& source = mResultSources[ column ];
+        if( source.mStoreEachYear ) {
+            double value = source.mIsTimeSeries ?
+                mHcore->sendMessage( M_GETDATA, source.mMessage, date ) :
+                mHcore->sendMessage( M_GETDATA, source.mMessage );
+            mResults.setValue( column, aYear, value );
+        }
+    }
 
-    // Log the concentrations we are seeing here
+    // Log what we saw here in the debugging log
     climatelog.setLevel( ILogger::DEBUG );
-    climatelog << "\tstoreConc: year= " << aYear << "  index= " << i << endl
-               << "\t\tCO2 = " << mConcTable["CO2"][i] << endl
-               << "\t\tCH4 = " << mConcTable["CH4"][i] << endl
-               << "\t\tN2O = " << mConcTable["N2O"][i] << endl
-               << "\t\tO3  = " << mConcTable["O3"][i] << endl;
-    
+    climatelog << "\tstoreResults:  year= " << aYear << endl
+               << "\t\tCO2 conc  = " << mResults.getValue( mConcColumns[ "CO2" ], aYear ) << endl
+               << "\t\ttotal RF  = " << mResults.getValue( mTotRFColumn, aYear ) << endl
+               << "\t\t     CO2  = " << mResults.getValue( mRFColumns[ "CO2" ], aYear ) << endl
+               << "\t\t     CH4  = " << mResults.getValue( mRFColumns[ "CH4" ], aYear ) << endl
+               << "\t\t     N2O  = " << mResults.getValue( mRFColumns[ "N2O" ], aYear ) << endl
+               << "\t\t      BC  = " << mResults.getValue( mRFColumns[ "BC" ], aYear ) << endl
+               << "\t\t      OC  = " << mResults.getValue( mRFColumns[ "OC" ], aYear ) << endl;
 }
 
-void HectorModel::setupConcTbl() {
-    int size = yearlyDataIndex( mHectorEndYear ) + 1;
-
-    mConcTable["CH4"].resize( size );
-    mConcTable["N2O"].resize( size );
-    mConcTable["O3"].resize( size );
-    //mConcTable["CO"].resize( size );
-    //mConcTable["NOX"].resize( size );
-    mConcTable["CO2"].resize( size );
-    //mConcTable["NMVOC"].resize( size ); 
-}    
-
-// Be sure to keep this in sync with setupRFTbl.  If you add a gas
-// here, you need to add it there too!
-void HectorModel::storeRF(const int aYear ) {
-    ILogger& climatelog = ILogger::getLogger( "climate-log" );
-    int i = yearlyDataIndex( aYear );
-    
-    // total
-    mTotRFTable[i]             = mHcore->sendMessage( M_GETDATA, D_RF_TOTAL );
+void HectorModel::setupResults() {
+    mResults = ClimateResultCache();
+    mResultSources.clear();
+    mConcColumns.clear();
+    mRFColumns.clear();
+    mResults.setYears( mModeltime->getStartYear(), mHectorEndYear );
 
-    // misc gases requested by GCAM
-    mGasRFTable["CO2"][i]      = mHcore->sendMessage( M_GETDATA, D_RF_CO2 );
-    mGasRFTable["CH4"][i]      = mHcore->sendMessage( M_GETDATA, D_RF_CH4 );
-    mGasRFTable["N2O"][i]      = mHcore->sendMessage( M_GETDATA, D_RF_N2O );
-    mGasRFTable["BC"][i]       = mHcore->sendMessage( M_GETDATA, D_RF_BC );
-    mGasRFTable["OC"][i]       = mHcore->sendMessage( M_GETDATA, D_RF_OC );
+    // These are all of the atmospheric concentrations that Hector is
+    // set up to provide.  CH4, N2O and O3 are kept as time series,
+    // so with reduced output they are only retrieved when queried.
+    mConcColumns[ "CH4" ] = addResult( D_ATMOSPHERIC_CH4, true, !mReducedOutput );
+    mConcColumns[ "N2O" ] = addResult( D_ATMOSPHERIC_N2O, true, !mReducedOutput );
+    mConcColumns[ "O3" ]  = addResult( D_ATMOSPHERIC_O3, true, !mReducedOutput );
+    mConcColumns[ "CO2" ] = addResult( D_ATMOSPHERIC_CO2, false, true );
+
+    // Hector doesn't actually compute concentrations for these
+    // gasses. (we use their emissions to compute O3 concentration,
+    // but don't compute the concentrations of the original gasses.) 
+    // mConcColumns["CO"]    = addResult( D_ATMOSPHERIC_CO, false, true );
+    // mConcColumns["NOX"]   = addResult( D_ATMOSPHERIC_NOX, false, true );
+    // mConcColumns["NMVOC"] = addResult( D_ATMOSPHERIC_NMVOC, false, true );
+
+    // total and misc gases requested by GCAM
+    mTotRFColumn        = addResult( D_RF_TOTAL, false, true );
+    mRFColumns[ "CO2" ] = addResult( D_RF_CO2, false, true );
+    mRFColumns[ "CH4" ] = addResult( D_RF_CH4, false, true );
+    mRFColumns[ "N2O" ] = addResult( D_RF_N2O, false, true );
+    mRFColumns[ "BC" ]  = addResult( D_RF_BC, false, true );
+    mRFColumns[ "OC" ]  = addResult( D_RF_OC, false, true );
 
 #if 0
     // Forcings that hector can provide, but which are not currently
     // requested by GCAM.  In the interests of keeping memory usage
     // down, we won't actually store these unless someone wants them.
-    // Remember, if you enable them here, then you also have to add
-    // them in setupRFTbl below.
 
     // Water vapor
-    mGasRFTable["H2O"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_H2O );
+    mRFColumns[ "H2O" ]  = addResult( D_RF_H2O, false, true );
     // SO2: direct, indirect, and total
-    mGasRFTable["SO2d"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_SO2d );
-    mGasRFTable["SO2i"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_SO2i );
-    mGasRFTable["SO2"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_SO2 );
+    mRFColumns[ "SO2d" ] = addResult( D_RF_SO2d, false, true );
+    mRFColumns[ "SO2i" ] = addResult( D_RF_SO2i, false, true );
+    mRFColumns[ "SO2" ]  = addResult( D_RF_SO2, false, true );
     // Ozone
-    mGasRFTable["O3"][i]    = mHcore->sendMessage( M_GETDATA, D_RF_O3 );
-
-    // Volcanoes!  <- ?
-    mGasRFTable["HFC125"][i]   = mHcore->sendMessage( M_GETDATA, D_RF_HFC125 );
-    
+    mRFColumns[ "O3" ]   = addResult( D_RF_O3, false, true );
 #endif
 
-    // Log what we saw here in the debugging log
-    climatelog << "\tstoreRF:  year= " << aYear << "\tindex= " << i << endl
-               << "\t\ttotal RF  = " << mTotRFTable[i] << endl
-               << "\t\t     CO2  = " << mGasRFTable["CO2"][i] << endl
-               << "\t\t     CH4  = " << mGasRFTable["CH4"][i] << endl
-               << "\t\t     N2O  = " << mGasRFTable["N2O"][i] << endl
-               << "\t\t      BC  = " << mGasRFTable["BC"][i] << endl
-               << "\t\t      OC  = " << mGasRFTable["OC"][i] << endl;
-}
-
-void HectorModel::setupRFTbl() {
-    int size = yearlyDataIndex( mHectorEndYear ) + 1;
+    // Components (mostly halocarbons) that store their radiative
+    // forcing as a time series.  These are only retrieved from the
+    // core when they are queried.
+    map<string, string>::const_iterator it;
+    for( it = mHectorRFTseriesMsg.begin(); it != mHectorRFTseriesMsg.end(); ++it ) {
+        mRFColumns[ it->first ] = addResult( it->second, true, false );
+    }
 
-    mGasRFTable["CO2"].resize( size );
-    mGasRFTable["CH4"].resize( size );
-    mGasRFTable["N2O"].resize( size );
-    mGasRFTable["BC"].resize( size );
-    mGasRFTable["OC"].resize( size );
+    // global quantities
+    mTemperatureColumn = addResult( D_GLOBAL_TEMP, false, true );
+    mLandFluxColumn    = addResult( D_LAND_CFLUX, false, true );
+    mOceanFluxColumn   = addResult( D_OCEAN_CFLUX, false, true );
 }
-
-//! Store the global quantities retrieved from Hector, except total
-//! forcing, which gets stored in storeRF()
-void HectorModel::storeGlobals( const int aYear ) {
-    int idx = yearlyDataIndex( aYear );
-
-        // // XXX DEBUG
-        // ILogger &climatelog = ILogger::getLogger("climate-log");
-        // climatelog.setLevel(ILogger::DEBUG);
-        // climatelog << "Store globals: " << "  year: " << aYear
-        //            << "  index: " << idx
-        //            << "  table sizes: temp=" << mTemperatureTable.size()
-        //            << "  landflux= " << mLandFlux.size()
-        //            << "  oceanflux= " << mOceanFlux.size()
-        //            << "\n";
-        // // XXX end debug
-    
-    mTemperatureTable[idx] = mHcore->sendMessage( M_GETDATA, D_GLOBAL_TEMP );
-    mLandFlux[idx]         = mHcore->sendMessage( M_GETDATA, D_LAND_CFLUX );
-    mOceanFlux[idx]        = mHcore->sendMessage( M_GETDATA, D_OCEAN_CFLUX );
-} 
     
 
 double HectorModel::getNetTerrestrialUptake( const int aYear ) const {
     // Is this the same as land flux?
-    return mLandFlux[ yearlyDataIndex( aYear ) ];
+    return getResult( mLandFluxColumn, aYear );
 }
 
 double HectorModel::getNetOceanUptake(const int aYear ) const {
     // Is this the same thing as ocean flux?
-    return mOceanFlux[ yearlyDataIndex( aYear ) ];
+    return getResult( mOceanFluxColumn, aYear );
 }
 
 int HectorModel::getCarbonModelStartYear() const {
@@ -826,10 +929,15 @@ void HectorModel::printDBOutput() const {
     void dboutput4(string var1name,string var2name,string var3name,
                    string var4name, string uname,vector<double> dout);
 
+    // The result columns are looked up once and read directly for
+    // each period.
+    const int co2ConcColumn = mConcColumns.find( "CO2" )->second;
+    const int co2RFColumn = mRFColumns.find( "CO2" )->second;
+
     // CO2 concentration
     vector<double> data( mModeltime->getmaxper() );
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getConcentration( "CO2", mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( co2ConcColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "Concentrations", "Period", "PPM", data );
  
@@ -843,31 +951,31 @@ void HectorModel::printDBOutput() const {
 
     // Total Forcing
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getTotalForcing( mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( mTotRFColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "Forcing", "Period","W/m^2", data );
 
     // CO2 forcing.
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getForcing( "CO2", mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( co2RFColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "CO2-Forcing", "Period","W/m^2", data );
 
     // Fill up a vector of Global Mean Temperature.
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getTemperature( mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( mTemperatureColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "Temperature", "Period", "degC", data );
 
     // Net Terrestrial Uptake.
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getNetTerrestrialUptake( mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( mLandFluxColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "NetTerUptake", "Period", "GtC", data );
 
     // Ocean Uptake.
     for( int period = 0; period < mModeltime->getmaxper(); ++period ){
-        data[ period ] = getNetOceanUptake( mModeltime->getper_to_yr( period ) );
+        data[ period ] = getResult( mOceanFluxColumn, mModeltime->getper_to_yr( period ) );
     }
     dboutput4( "global", "General", "OceanUptake", "Period", "GtC", data );
 
@@ -42,10 +42,14 @@
 #include <fstream>
 #include <string>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
 #include "climate/include/magicc_model.h"
+#include "climate/include/climate_ensemble.h"
 #include "containers/include/scenario.h"
 #include "util/base/include/model_time.h"
 #include "util/base/include/configuration.h"
@@ -65,6 +69,44 @@ extern Scenario* scenario;
 // MAGICC 5.3 expects a 2000 year line in gas.emk
 const int MagiccModel::GAS_EMK_CRIT_YEAR = 2000;
 
+namespace {
+    //! Number of decimals for emissions in gas.emk.
+    const int OUT_PRECISION = 4;
+
+    /*! \brief Write the year which starts a line of gas emissions.
+    * \param aYear The year.
+    * \param aGasFileData The gas.emk data, written to if aGasValues is null.
+    * \param aGasValues Values for MAGICC to read in memory, or null.
+    */
+    void writeGasYear( const int aYear, ostringstream& aGasFileData, vector<float>* aGasValues ) {
+        if( aGasValues ) {
+            aGasValues->push_back( static_cast<float>( aYear ) );
+        }
+        else {
+            aGasFileData << setw( 4 ) << aYear << ",";
+        }
+    }
+
+    /*! \brief Write an emission for a gas.
+    * \details Values passed in memory are rounded to the decimals written
+    *          to gas.emk and converted the way MAGICC reads them, so that both
+    *          ways of passing emissions give identical results.
+    * \param aValue The emission.
+    * \param aGasFileData The gas.emk data, written to if aGasValues is null.
+    * \param aGasValues Values for MAGICC to read in memory, or null.
+    */
+    void writeGasValue( const double aValue, ostringstream& aGasFileData, vector<float>* aGasValues ) {
+        if( aGasValues ) {
+            char buffer[ 64 ];
+            snprintf( buffer, sizeof( buffer ), "%.*f", OUT_PRECISION, aValue );
+            aGasValues->push_back( strtof( buffer, 0 ) );
+        }
+        else {
+            aGasFileData << setw( 6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) << aValue;
+        }
+    }
+}
+
 // Setup the gas name vector.
 const string MagiccModel::sInputGasNames[] = { "CO2",
                                                "CO2NetLandUse",
@@ -117,6 +159,7 @@ mGHGInputFileName(""),
 mModeltime( aModeltime ),
 mIsValid( false ),
 mClimateSensitivity( -1 ),
+mOceanDiffusivity( -1 ),
 mSoilTempFeedback( -1 ),
 mHumusTempFeedback( -1 ),
 mGPPTempFeedback( -1 ),
@@ -128,11 +171,50 @@ mBCUnitForcing( 0 ),
 mOCUnitForcing( 0 ), // initialize to zero since -1 is a legit value
 mLastHistoricalYear ( 0 ), // default to zero -- use only model data
 mCarbonModelStartYear( 1975 ), // Need to have first model year here, but should be 1990 for MAGICC. FIX.
-mNumberHistoricalDataPoints( 0 ) // internal counter
+mNumberHistoricalDataPoints( 0 ), // internal counter
+mState( new magicc_state )
 {
 
 }
 
+/*! \brief Copy constructor.
+* \details Copies the emissions, parameters and the MAGICC state, so the copy
+*          reports the results of the last run and runs independently of the
+*          original from then on.
+* \param aOther The model to copy.
+*/
+MagiccModel::MagiccModel( const MagiccModel& aOther ):
+mOutputGasNameMap( aOther.mOutputGasNameMap ),
+mModelEmissionsByGas( aOther.mModelEmissionsByGas ),
+mDefaultEmissionsByGas( aOther.mDefaultEmissionsByGas ),
+mDefaultEmissionsYears( aOther.mDefaultEmissionsYears ),
+mLUCEmissionsByYear( aOther.mLUCEmissionsByYear ),
+mScenarioName( aOther.mScenarioName ),
+mGHGInputFileName( aOther.mGHGInputFileName ),
+mModeltime( aOther.mModeltime ),
+mIsValid( aOther.mIsValid ),
+mClimateSensitivity( aOther.mClimateSensitivity ),
+mOceanDiffusivity( aOther.mOceanDiffusivity ),
+mSoilTempFeedback( aOther.mSoilTempFeedback ),
+mHumusTempFeedback( aOther.mHumusTempFeedback ),
+mGPPTempFeedback( aOther.mGPPTempFeedback ),
+mOceanCarbFlux80s( aOther.mOceanCarbFlux80s ),
+mNetDeforestCarbFlux80s( aOther.mNetDeforestCarbFlux80s ),
+mSO2Dir1990( aOther.mSO2Dir1990 ),
+mSO2Ind1990( aOther.mSO2Ind1990 ),
+mBCUnitForcing( aOther.mBCUnitForcing ),
+mOCUnitForcing( aOther.mOCUnitForcing ),
+mLastHistoricalYear( aOther.mLastHistoricalYear ),
+mCarbonModelStartYear( aOther.mCarbonModelStartYear ),
+mNumberHistoricalDataPoints( aOther.mNumberHistoricalDataPoints ),
+mState( new magicc_state( *aOther.mState ) )
+{
+}
+
+//! Destructor
+MagiccModel::~MagiccModel(){
+}
+
 /*! \brief Complete the initialization of the MagiccModel.
 * \details This function first resizes the internal vectors which store
 *          emissions by gas and period. It then reads in the default set of data
@@ -201,25 +283,27 @@ void MagiccModel::completeInit( const string& aScenarioName ){
 void MagiccModel::overwriteMAGICCParameters( ){
     // Override parameters in MAGICC if necessary
     int varIndex = 1;
-    SETPARAMETERVALUES( varIndex, mClimateSensitivity );
+    SETPARAMETERVALUES( mState.get(), varIndex, mClimateSensitivity );
     varIndex = 2;
-    SETPARAMETERVALUES( varIndex, mSoilTempFeedback );
+    SETPARAMETERVALUES( mState.get(), varIndex, mSoilTempFeedback );
     varIndex = 3;
-    SETPARAMETERVALUES( varIndex, mHumusTempFeedback );
+    SETPARAMETERVALUES( mState.get(), varIndex, mHumusTempFeedback );
     varIndex = 4;
-    SETPARAMETERVALUES( varIndex, mGPPTempFeedback );
+    SETPARAMETERVALUES( mState.get(), varIndex, mGPPTempFeedback );
     varIndex = 5;
-    SETPARAMETERVALUES( varIndex, mNetDeforestCarbFlux80s );
+    SETPARAMETERVALUES( mState.get(), varIndex, mNetDeforestCarbFlux80s );
     varIndex = 6;
-    SETPARAMETERVALUES( varIndex, mOceanCarbFlux80s );
+    SETPARAMETERVALUES( mState.get(), varIndex, mOceanCarbFlux80s );
     varIndex = 7;
-    SETPARAMETERVALUES( varIndex, mSO2Dir1990 );
+    SETPARAMETERVALUES( mState.get(), varIndex, mSO2Dir1990 );
     varIndex = 8;
-    SETPARAMETERVALUES( varIndex, mSO2Ind1990 );
+    SETPARAMETERVALUES( mState.get(), varIndex, mSO2Ind1990 );
     varIndex = 9;
-    SETPARAMETERVALUES( varIndex, mBCUnitForcing );
+    SETPARAMETERVALUES( mState.get(), varIndex, mBCUnitForcing );
     varIndex = 10;
-    SETPARAMETERVALUES( varIndex, mOCUnitForcing );
+    SETPARAMETERVALUES( mState.get(), varIndex, mOCUnitForcing );
+    varIndex = 11;
+    SETPARAMETERVALUES( mState.get(), varIndex, mOceanDiffusivity );
 }
 
 //! parse MAGICC xml object
@@ -250,6 +334,10 @@ void MagiccModel::XMLParse( const DOMNode* node ){
         else if ( nodeName == "climateSensitivity" ){
             mClimateSensitivity = XMLHelper<double>::getValue( curr );
         }
+        // Ocean heat diffusivity.
+        else if ( nodeName == "oceanDiffusivity" ){
+            mOceanDiffusivity = XMLHelper<double>::getValue( curr );
+        }
         // Soil Feedback Factor. 
         else if ( nodeName == "soilTempFeedback" ){
             mSoilTempFeedback = XMLHelper<double>::getValue( curr );
@@ -309,6 +397,9 @@ void MagiccModel::toInputXML( ostream& out, Tabs* tabs ) const {
     // Write out mClimateSensitivity
     XMLWriteElementCheckDefault( mClimateSensitivity, "climateSensitivity", out, tabs, -1.0 );
 
+    // Write out ocean heat diffusivity.
+    XMLWriteElementCheckDefault( mOceanDiffusivity, "oceanDiffusivity", out, tabs, -1.0 );
+
     // Write out Soil Feedback Factor.
     XMLWriteElementCheckDefault( mSoilTempFeedback, "soilTempFeedback", out, tabs, -1.0 );
 
@@ -347,6 +438,9 @@ void MagiccModel::toDebugXML( const int period, ostream& out, Tabs* tabs ) const
     // Write out mClimateSensitivity
     XMLWriteElement( mClimateSensitivity, "climateSensitivity", out, tabs );
 
+    // Write out ocean heat diffusivity.
+    XMLWriteElement( mOceanDiffusivity, "oceanDiffusivity", out, tabs );
+
     // Write out Soil Feedback Factor.
     XMLWriteElement( mSoilTempFeedback, "soilTempFeedback", out, tabs );
 
@@ -544,9 +638,7 @@ double MagiccModel::getEmissions( const string& aGasName,
  *          as specified by the user. 
  *          Emissions are interpolated in-between years without data.
  */
-void MagiccModel::writeMAGICCEmissionsFile(){
-    const int OUT_PRECISION = 4; // Number of decimals
-    
+void MagiccModel::writeMAGICCEmissionsFile( const bool aInMemory ){
     // Open a stringstream until are ready to print to file
     ostringstream gasFileData;
     
@@ -555,6 +647,11 @@ void MagiccModel::writeMAGICCEmissionsFile(){
     gasFileData.setf( ios::fixed, ios::floatfield );
     gasFileData.setf( ios::showpoint );
 
+    // Emissions passed in memory are collected here instead of being written
+    // to the data.
+    vector<float> gasValues;
+    vector<float>* gasValuesPtr = aInMemory ? &gasValues : 0;
+
     int lastHistoricalData = 0; // Last historical data point written out
     int numberOfDataPoints = 0; // Number of data points written to magicc input file
 
@@ -562,11 +659,11 @@ void MagiccModel::writeMAGICCEmissionsFile(){
     for( unsigned int index = 0; index < mNumberHistoricalDataPoints; ++index ){
         int year = static_cast<int>( floor( mDefaultEmissionsByGas[ 0 ][ index ] ) );
         if ( ( year <= mLastHistoricalYear ) ) {
-            gasFileData << setw( 4 ) <<  year << ",";
+            writeGasYear( year, gasFileData, gasValuesPtr );
             lastHistoricalData = index;
             for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
                 // Write out exogenous emissions for each gas.
-                gasFileData << setw( 6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) << mDefaultEmissionsByGas[ gasNumber +1 ][ index ];
+                writeGasValue( mDefaultEmissionsByGas[ gasNumber +1 ][ index ], gasFileData, gasValuesPtr );
                 
                 // Need to deal with 1) interpolation between history and model, 
                 writeComma( gasNumber, numberOfDataPoints, gasFileData );
@@ -598,15 +695,15 @@ void MagiccModel::writeMAGICCEmissionsFile(){
                 // Write out model emissions for all the gases if past historical emissions year.
                 for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
                      if ( gasNumber == 0 ) {
-                        gasFileData << setw( 4 ) << year << ",";
+                        writeGasYear( year, gasFileData, gasValuesPtr );
                     }
                     // We are always passing GCAM LUC carbon emissions to MAGICC annually.
                     // Therefore, LUC Emissions are not interpolated between historical and GCAM values.
                     // Historical LUC emissions vary from year-to year in any event, so some jumps between historical
                     // and model data are acceptable
                     if ( sInputGasNames[ gasNumber ] == "CO2NetLandUse" ) { 
-                        gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                                    << mLUCEmissionsByYear[ year - mModeltime->getStartYear() - 1 ];
+                        writeGasValue( mLUCEmissionsByYear[ year - mModeltime->getStartYear() - 1 ],
+                                       gasFileData, gasValuesPtr );
                     }
                     // For all emissions other than LUC carbon
                     else {
@@ -624,13 +721,12 @@ void MagiccModel::writeMAGICCEmissionsFile(){
                                 previousValue = mDefaultEmissionsByGas[ gasNumber + 1 ] [ lastHistoricalData ];
                             }
                             
-                            gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                             << util::linearInterpolateY( year, prevYear, nextYear, previousValue, nextValue );
+                            writeGasValue( util::linearInterpolateY( year, prevYear, nextYear, previousValue, nextValue ),
+                                           gasFileData, gasValuesPtr );
                         }
                         else {
                             // Write out model emission for this gas.
-                            gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                                        << mModelEmissionsByGas[ gasNumber ][ period ];
+                            writeGasValue( mModelEmissionsByGas[ gasNumber ][ period ], gasFileData, gasValuesPtr );
                         }
                     }
                     writeComma( gasNumber, numberOfDataPoints, gasFileData );
@@ -649,17 +745,15 @@ void MagiccModel::writeMAGICCEmissionsFile(){
         int period = mModeltime->getmaxper();
         for ( unsigned int extra = 0; extra < getNumAdditionalGasPoints(); extra++ ) {
             year = year + 10;
-            gasFileData << setw( 4 ) << year << ",";
+            writeGasYear( year, gasFileData, gasValuesPtr );
             // Write out all the gases.
             for( unsigned int gasNumber = 0; gasNumber < getNumInputGases(); ++gasNumber ){
                 if ( sInputGasNames[ gasNumber ] == "CO2NetLandUse" ) {
                     int index = mModeltime->getEndYear() - mModeltime->getStartYear() + extra - 1;
-                    gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION )
-                    << mLUCEmissionsByYear[ index ];
+                    writeGasValue( mLUCEmissionsByYear[ index ], gasFileData, gasValuesPtr );
                 }
                 else {
-                    gasFileData << setw(  6 + OUT_PRECISION ) << setprecision( OUT_PRECISION ) 
-                                << mModelEmissionsByGas[ gasNumber ][ period ]; //sjsTEMP - this should be +1, but that's strange.
+                    writeGasValue( mModelEmissionsByGas[ gasNumber ][ period ], gasFileData, gasValuesPtr ); //sjsTEMP - this should be +1, but that's strange.
                 }
                 writeComma( gasNumber, numberOfDataPoints, gasFileData );
             }
@@ -690,11 +784,20 @@ void MagiccModel::writeMAGICCEmissionsFile(){
     }
     gasStream << endl;
     
+    // Emissions passed in memory follow the header, and there is no file
+    // to save.
+    if( aInMemory ) {
+        SET_GAS_EMK( mState.get(), gasStream.str() );
+        SET_GAS_EMK_VALUES( mState.get(), gasValues );
+        return;
+    }
+
     // Transfer bulk of data to output stream.
     gasStream << gasFileData.str(); 
     
     // Set the gas data into MAGICC.
-    SET_GAS_EMK( gasStream.str() );
+    SET_GAS_EMK( mState.get(), gasStream.str() );
+    SET_GAS_EMK_VALUES( mState.get(), gasValues );
     
     // Check if the users still wants the gas data saved as a file which may be
     // useful for debugging or to use as input for a stand alone MAGICC run.
@@ -735,7 +838,55 @@ enum MagiccModel::runModelStatus MagiccModel::runModel(){
               mModelEmissionsByGas[ gasNumber ][ finalPeriod ] );
     }
     
-    writeMAGICCEmissionsFile( );
+    const Configuration* conf = Configuration::getInstance();
+    const bool inMemory = conf->getBool( "MAGICC-in-memory", false, false );
+
+    // Optionally run MAGICC once through the files first so the results of
+    // the in memory run can be checked against them.
+    vector<double> fileOutputs;
+    const bool validate = inMemory && conf->getBool( "MAGICC-validate-in-memory", false, false );
+    if( validate ) {
+        callMAGICC( false );
+        fileOutputs = getComparisonOutputs();
+    }
+
+    callMAGICC( inMemory );
+    mIsValid = true;
+
+    if( validate ) {
+        const vector<double> memoryOutputs = getComparisonOutputs();
+        unsigned int numMismatches = 0;
+        double maxDiff = 0;
+        for( unsigned int i = 0; i < memoryOutputs.size(); ++i ) {
+            if( memoryOutputs[ i ] != fileOutputs[ i ] ) {
+                ++numMismatches;
+                maxDiff = max( maxDiff, fabs( memoryOutputs[ i ] - fileOutputs[ i ] ) );
+            }
+        }
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        if( numMismatches == 0 ) {
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "In memory MAGICC results match the file based run for "
+                    << memoryOutputs.size() << " values." << endl;
+        }
+        else {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "In memory MAGICC results differ from the file based run in "
+                    << numMismatches << " of " << memoryOutputs.size()
+                    << " values, maximum difference " << maxDiff << "." << endl;
+        }
+    }
+    return SUCCESS;
+}
+
+/*! \brief Write the emissions and parameters and call MAGICC.
+* \param aInMemory Whether emissions are passed in memory and MAGICC replays
+*        the values it read from its input files on earlier runs instead of
+*        parsing them again.
+*/
+void MagiccModel::callMAGICC( const bool aInMemory ) {
+    mState->CACHE_INPUTS = aInMemory;
+    writeMAGICCEmissionsFile( aInMemory );
     
     // First overwrite parameters
     overwriteMAGICCParameters( );
@@ -744,13 +895,117 @@ enum MagiccModel::runModelStatus MagiccModel::runModel(){
     ILogger& mainLog = ILogger::getLogger( "main_log" );
     mainLog.setLevel( ILogger::NOTICE );
     mainLog << "Calling the climate model..."<< endl;
-    CLIMAT();
+    CLIMAT( mState.get() );
     mainLog.setLevel( ILogger::DEBUG );
     mainLog << "Finished with CLIMAT()" << endl;
-    mIsValid = true;
+}
+
+/*! \brief Run MAGICC for each member of a climate ensemble.
+* \details The emissions of the last run are passed in memory and MAGICC is run
+*          once more with the model's own parameters so that the values it reads
+*          from its input files are cached. Each member then runs on a copy of
+*          the MAGICC state with its parameters replacing climate sensitivity
+*          or ocean diffusivity, so members only share read-only data and are
+*          run in parallel when parallelism is enabled. The diagnostic files
+*          MAGICC writes are shared by all members and hold whichever member
+*          finished last.
+* \param aEnsemble The ensemble to run and in which to store results.
+* \return Whether the ensemble was run.
+*/
+enum MagiccModel::runModelStatus MagiccModel::runEnsemble( ClimateEnsemble& aEnsemble ) {
+    if( !mIsValid ) {
+        return INVALID;
+    }
+
+    // Find which MAGICC parameter each ensemble parameter replaces.
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    const vector<string>& names = aEnsemble.getParameterNames();
+    vector<int> parameterIndices( names.size(), -1 );
+    for( unsigned int i = 0; i < names.size(); ++i ) {
+        if( names[ i ] == ClimateEnsemble::getClimateSensitivityName() ) {
+            parameterIndices[ i ] = 1;
+        }
+        else if( names[ i ] == ClimateEnsemble::getOceanDiffusivityName() ) {
+            parameterIndices[ i ] = 11;
+        }
+        else {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Ignoring unknown climate ensemble parameter " << names[ i ] << "." << endl;
+        }
+    }
+
+    callMAGICC( true );
+
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Running " << aEnsemble.getNumMembers() << " climate ensemble members." << endl;
+#if GCAM_PARALLEL_ENABLED
+    EnsembleHelper helper( *this, aEnsemble, parameterIndices );
+    tbb::parallel_for( tbb::blocked_range<int>( 0, aEnsemble.getNumMembers() ), helper );
+#else
+    for( unsigned int member = 0; member < aEnsemble.getNumMembers(); ++member ) {
+        runEnsembleMember( aEnsemble, member, parameterIndices );
+    }
+#endif
     return SUCCESS;
 }
 
+#if GCAM_PARALLEL_ENABLED
+void MagiccModel::EnsembleHelper::operator()( const tbb::blocked_range<int>& aRange ) const
+{
+    for( int member = aRange.begin(); member != aRange.end(); ++member ) {
+        mModel.runEnsembleMember( mEnsemble, member, mParameterIndices );
+    }
+}
+#endif
+
+/*! \brief Run a single ensemble member on a copy of the MAGICC state.
+* \details Emissions and cached inputs are taken from this model's state, which
+*          is not modified. The member does not write the MAGICC diagnostic
+*          files.
+* \param aEnsemble The ensemble in which to store results.
+* \param aMember Index of the member to run.
+* \param aParameterIndices MAGICC parameter index for each ensemble
+*        parameter, -1 for parameters which are ignored.
+*/
+void MagiccModel::runEnsembleMember( ClimateEnsemble& aEnsemble, const unsigned int aMember,
+                                     const vector<int>& aParameterIndices ) const
+{
+    MagiccModel memberModel( *this );
+    // Members may run at the same time and would all write the same files.
+    memberModel.mState->WRITE_OUTPUT_FILES = false;
+    memberModel.overwriteMAGICCParameters();
+    for( unsigned int i = 0; i < aParameterIndices.size(); ++i ) {
+        if( aParameterIndices[ i ] != -1 ) {
+            SETPARAMETERVALUES( memberModel.mState.get(), aParameterIndices[ i ],
+                                aEnsemble.getParameter( aMember, i ) );
+        }
+    }
+    CLIMAT( memberModel.mState.get() );
+    aEnsemble.storeResults( aMember, memberModel );
+}
+
+/*! \brief Collect the results used to compare two MAGICC runs.
+* \details Includes temperature, forcing by gas and the CO2, CH4 and N2O
+*          concentrations for each year from 1990 through the end of the model.
+* \return The results in a fixed order.
+*/
+vector<double> MagiccModel::getComparisonOutputs() const {
+    vector<double> outputs;
+    const int endYear = mModeltime->getEndYear();
+    for( int year = 1990; year <= endYear; ++year ) {
+        outputs.push_back( GETGMTEMP( mState.get(), year ) );
+        for( map<string, int>::const_iterator gas = mOutputGasNameMap.begin();
+             gas != mOutputGasNameMap.end(); ++gas )
+        {
+            outputs.push_back( GETFORCING( mState.get(), gas->second, year ) );
+        }
+        for( int gasNumber = 1; gasNumber <= 3; ++gasNumber ) {
+            outputs.push_back( GETGHGCONC( mState.get(), gasNumber, year ) );
+        }
+    }
+    return outputs;
+}
+
 /* \brief Get the number of input gases to MAGICC.
 * \return The fixed number of gases.
 */
@@ -774,7 +1029,7 @@ double MagiccModel::getConcentration( const string& aGasName,
     int year = aYear;
     int gasNumber = util::searchForValue( mOutputGasNameMap, aGasName );
     if ( gasNumber != 0 ) {
-        return GETGHGCONC( gasNumber, year );
+        return GETGHGCONC( mState.get(), gasNumber, year );
     }
     return -1;
 }
@@ -787,7 +1042,7 @@ double MagiccModel::getTemperature( const int aYear ) const {
 
     // Need to store the year locally so it can be passed by reference.
     int year = aYear;
-    return GETGMTEMP( year );
+    return GETGMTEMP( mState.get(), year );
 }
 
 double MagiccModel::getForcing( const string& aGasName, const int aYear ) const {
@@ -799,7 +1054,7 @@ double MagiccModel::getForcing( const string& aGasName, const int aYear ) const
     int year = aYear;
     int gasNumber = util::searchForValue( mOutputGasNameMap, aGasName );
     if ( gasNumber != 0 ) {
-        return GETFORCING( gasNumber, year );
+        return GETFORCING( mState.get(), gasNumber, year );
     }
     return -1;
 }
@@ -818,7 +1073,7 @@ double MagiccModel::getNetTerrestrialUptake( const int aYear ) const {
 
     int year = aYear;
     int itemNumber = 10;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mState.get(), itemNumber, year );
 }
 
 double MagiccModel::getNetOceanUptake( const int aYear ) const {
@@ -835,7 +1090,7 @@ double MagiccModel::getNetOceanUptake( const int aYear ) const {
 
     int year = aYear;
     int itemNumber = 4;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mState.get(), itemNumber, year );
 }
 
 double MagiccModel::getNetLandUseChangeEmission( const int aYear ) const {
@@ -852,7 +1107,7 @@ double MagiccModel::getNetLandUseChangeEmission( const int aYear ) const {
 
     int itemNumber = 2;
     int year = aYear;
-    return GETCARBONRESULTS( itemNumber, year );
+    return GETCARBONRESULTS( mState.get(), itemNumber, year );
 }
 
 double MagiccModel::getTotalForcing( const int aYear ) const {
@@ -864,7 +1119,7 @@ double MagiccModel::getTotalForcing( const int aYear ) const {
     // Need to store the year and gas number locally so it can be passed by reference.
     int year = aYear;
     int gasNumber = 0; // global forcing
-    return GETFORCING( gasNumber, year );
+    return GETFORCING( mState.get(), gasNumber, year );
 }
 
 
@@ -46,10 +46,12 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <memory>
 #include <xercesc/dom/DOMNode.hpp>
 #include "containers/include/iscenario_runner.h"
 class Timer;
+class BatchCSVOutputter;
 
 /*! 
  * \ingroup Objects
@@ -76,6 +78,14 @@ class Timer;
  *          "BatchMode". The name of the configuration file is determined by the
  *          file configuration value "BatchFileName".
  *
+ *          If the int configuration value "batch-worker-processes" is greater
+ *          than one, that many scenarios are run at once in forked copies of
+ *          the process. Each copy shares the parsed configuration and batch
+ *          file with the parent and has its own copy of the model globals.
+ *          The base input file and configured scenario components are parsed
+ *          once before forking, so each copy only parses its own file sets.
+ *          Output is written by one copy at a time.
+ *
  *          <b>XML specification for BatchRunner</b>
  *          - XML name: \c BatchRunner
  *          - Contained by: None.
@@ -182,8 +192,12 @@ protected:
 	bool runSingleScenario( IScenarioRunner* aScenarioRunner,
                             const Component& aCurrComponent,
                             const int aSinglePeriod,
+                            BatchCSVOutputter& aCSVOutputter,
                             Timer& aTimer );
 
+    class ScenarioEvaluator;
+    friend class ScenarioEvaluator;
+
     bool XMLParseComponentSet( const xercesc::DOMNode* aNode );
 
     bool XMLParseRunnerSet( const xercesc::DOMNode* aNode );
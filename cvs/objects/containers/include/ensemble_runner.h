@@ -0,0 +1,218 @@
+#ifndef _ENSEMBLE_RUNNER_H_
+#define _ENSEMBLE_RUNNER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file ensemble_runner.h
+ * \ingroup Objects
+ * \brief The EnsembleRunner class header file.
+ */
+
+#include <string>
+#include <list>
+#include <vector>
+#include <map>
+#include <memory>
+#include "containers/include/iscenario_runner.h"
+#include "util/base/include/forked_task_runner.h"
+
+class Timer;
+class SingleScenarioRunner;
+
+/*! 
+ * \ingroup Objects
+ * \brief A scenario runner which runs an ensemble of scenarios with randomly
+ *        perturbed parameters and summarizes the results.
+ * \details The ensemble is read from the file configuration value
+ *          "ensemble-spec-file". For each sample a value is drawn for every
+ *          parameter and the values are added to the base scenario as an
+ *          in-memory add-on document, so no files are written for the
+ *          samples.
+ *
+ *          The base input file and configured scenario components are parsed
+ *          once. Samples are run in forked copies of the process, at most
+ *          "ensemble-worker-processes" at a time, which each take a
+ *          copy-on-write copy of the parsed base. Each sample starts its
+ *          markets from the solved prices of the nearest sample which had
+ *          solved when it was started, with distances measured in units of
+ *          the spread of each parameter. Builds which cannot fork parse the
+ *          base for each sample and run them serially.
+ *
+ *          The batch CSV results of every sample are written to the batch CSV
+ *          output file, and summary statistics of each result over the solved
+ *          samples are written to "ensemble-summary-file".
+ *
+ *          The ensemble runner is turned on using the boolean configuration
+ *          value "ensemble-mode".
+ *
+ *          <b>XML specification for EnsembleRunner</b>
+ *          - XML name: \c ensemble-runner
+ *          - Contained by: None.
+ *          - Parsing inherited from class: None.
+ *          - Elements:
+ *              - \c num-samples The number of samples to run.
+ *              - \c random-seed The seed for drawing samples. Defaults to 1.
+ *              - \c warm-start Whether to start samples from the prices of the
+ *                   nearest solved sample. Defaults to true.
+ *              - \c parameter A parameter to perturb.
+ *                  - Attributes:
+ *                      - \c name Name of the parameter.
+ *                  - Elements:
+ *                      - \c target Path to the value relative to the scenario
+ *                           element, as a list of element names separated by /.
+ *                           Each element may be followed by attribute values
+ *                           in the form [\@name='value'], for example
+ *                           world/region[\@name='USA']/supplysector[\@name='electricity']/relative-cost-logit/logit-exponent[\@year='2020'].
+ *                           Elements along the path must already exist in
+ *                           the scenario, they are not created.
+ *                      - \c distribution One of uniform, normal or lognormal.
+ *                      - \c min The lower bound of a uniform distribution.
+ *                      - \c max The upper bound of a uniform distribution.
+ *                      - \c mean The mean of a normal distribution, or of the
+ *                           log of a lognormal distribution.
+ *                      - \c std-dev The standard deviation of a normal
+ *                           distribution, or of the log of a lognormal
+ *                           distribution.
+ */
+class EnsembleRunner: public IScenarioRunner, public IForkedTask {
+    friend class ScenarioRunnerFactory;
+public:
+    virtual ~EnsembleRunner();
+
+    virtual const std::string& getName() const;
+
+    // IParsable interface
+    virtual bool XMLParse( const xercesc::DOMNode* aRoot );
+
+    virtual bool setupScenarios( Timer& aTimer,
+                                 const std::string aName = "",
+                                 const std::list<std::string> aScenComponents = std::list<std::string>() );
+
+    virtual bool runScenarios( const int aSinglePeriod,
+                               const bool aPrintDebugging,
+                               Timer& aTimer );
+
+    virtual void printOutput( Timer& aTimer, const bool aCloseDB = true ) const;
+
+    virtual void cleanup();
+
+    virtual Scenario* getInternalScenario();
+    virtual const Scenario* getInternalScenario() const;
+
+    // IForkedTask methods
+    virtual bool runInChild( const int aTaskIndex, std::string& aResult );
+    virtual void collectResult( const int aTaskIndex, const std::string& aResult,
+                                const bool aReceived, const bool aSucceeded );
+private:
+    //! A parameter which is perturbed in each sample.
+    struct Parameter {
+        //! The name of the parameter.
+        std::string mName;
+
+        //! The path to the value relative to the scenario element.
+        std::string mTarget;
+
+        //! The name of the distribution to draw values from.
+        std::string mDistribution;
+
+        //! The lower bound of a uniform distribution.
+        double mMin;
+
+        //! The upper bound of a uniform distribution.
+        double mMax;
+
+        //! The mean of a normal distribution.
+        double mMean;
+
+        //! The standard deviation of a normal distribution.
+        double mStdDev;
+    };
+
+    //! The parameters to perturb.
+    std::vector<Parameter> mParameters;
+
+    //! The number of samples to run.
+    int mNumSamples;
+
+    //! The seed for drawing samples.
+    unsigned int mRandomSeed;
+
+    //! Whether to start each sample from the prices of the nearest solved
+    //! sample.
+    bool mWarmStart;
+
+    //! The parameter values of each sample.
+    std::vector<std::vector<double> > mSamples;
+
+    //! The batch CSV output of each sample, empty if the sample did not run.
+    std::vector<std::string> mSampleOutput;
+
+    //! Whether each sample solved.
+    std::vector<bool> mSampleSolved;
+
+    typedef std::map<int, std::vector<std::vector<double> > > SamplePrices;
+
+    //! Solved market prices by period for each solved sample.
+    SamplePrices mSolvedPrices;
+
+    //! The name passed to setupScenarios which is added to the name of every
+    //! sample.
+    std::string mBaseName;
+
+    //! Scenario components passed to setupScenarios which are parsed for
+    //! every sample.
+    std::list<std::string> mBaseComponents;
+
+    //! The last period to run.
+    int mStopPeriod;
+
+    //! The scenario runner which runs each sample.
+    std::auto_ptr<SingleScenarioRunner> mSingleScenario;
+
+    EnsembleRunner();
+    static const std::string& getXMLNameStatic();
+    bool XMLParseParameter( const xercesc::DOMNode* aNode );
+    void drawSamples();
+    const std::string createSampleXML( const int aSample ) const;
+    int findNearestSolvedSample( const int aSample ) const;
+    bool runSample( const int aSample, std::string& aOutput,
+                    std::vector<std::vector<double> >& aPrices );
+    void writeSummary() const;
+};
+
+#endif // _ENSEMBLE_RUNNER_H_
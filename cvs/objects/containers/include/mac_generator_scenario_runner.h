@@ -46,6 +46,7 @@
 */
 
 #include <memory>
+#include <vector>
 #include "containers/include/iscenario_runner.h"
 
 class Timer;
@@ -59,7 +60,9 @@ class SingleScenarioRunner;
 *        period.
 * \details This class runs a scenario multiple times while varying a fixed
 *          carbon price, to determine the MAC curve and total cost for the
-*          scenario.
+*          scenario. A curve is created for each gas listed in the
+*          configuration, and the points for all gases may be run together in
+*          forked worker processes.
 * \author Josh Lurz
 */
 class MACGeneratorScenarioRunner: public IScenarioRunner {
@@ -92,8 +95,9 @@ private:
     //! fixed taxed scenarios after.
     std::auto_ptr<SingleScenarioRunner> mSingleScenario;
 
-    //! The delegate object which calculates total costs.
-    std::auto_ptr<TotalPolicyCostCalculator> mPolicyCostCalculator;
+    //! The delegate objects which calculate total costs, one for each abated
+    //! gas.
+    std::vector<TotalPolicyCostCalculator*> mPolicyCostCalculators;
 
     MACGeneratorScenarioRunner();
     static const std::string& getXMLNameStatic();
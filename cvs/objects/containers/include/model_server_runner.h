@@ -0,0 +1,168 @@
+#ifndef _MODEL_SERVER_RUNNER_H_
+#define _MODEL_SERVER_RUNNER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file model_server_runner.h
+ * \ingroup Objects
+ * \brief The ModelServerRunner class header file.
+ */
+
+#include <string>
+#include <list>
+#include <memory>
+#include "containers/include/iscenario_runner.h"
+#include "util/base/include/forked_task_runner.h"
+
+class Timer;
+class SingleScenarioRunner;
+
+/*! 
+ * \ingroup Objects
+ * \brief A scenario runner which keeps the parsed base scenario resident and
+ *        runs scenarios requested over a local socket.
+ * \details The base input file and configured scenario components are parsed
+ *          once in setupScenarios. runScenarios then listens on the Unix
+ *          domain socket named by the string configuration value
+ *          "server-socket" and serves connections one at a time until a
+ *          shutdown request is received. Each request is run in a forked copy
+ *          of the server which shares the parsed base with the server, parses
+ *          the add-on XML given in the request, completes initialization and
+ *          solves. The base held by the server is never modified, so every
+ *          request starts from the same base scenario.
+ *
+ *          The server is turned on using the boolean configuration value
+ *          "server-mode" and is only available in builds which support
+ *          ForkedTaskRunner.
+ *
+ *          <b>Request protocol</b>
+ *          A request is a series of newline terminated commands:
+ *          - \c component \c path Parse an add-on XML file.
+ *          - \c fragment \c size Parse the add-on XML contained in the next
+ *               size bytes following the newline. A fragment larger than
+ *               256MB is skipped and the request fails. A size which is not
+ *               a number closes the connection since the fragment can not be
+ *               skipped.
+ *          - \c name \c name Add a name on to the configured scenario name.
+ *          - \c stop-period \c period The last period to run. Defaults to the
+ *               configured stop-period.
+ *          - \c run Run the request and send the response.
+ *          - \c shutdown Stop the server.
+ *
+ *          Add-on files are parsed in the order given, followed by the
+ *          fragments in the order given. The
+ *          response is a line containing \c ok, \c unsolved or \c error and
+ *          the size of the body, followed by the body. The body is the batch
+ *          CSV output for the scenario, or an error message. A connection may
+ *          send any number of requests.
+ *
+ * \note The response is always the single row of results written by
+ *       BatchCSVOutputter. The protocol has no way to select other results,
+ *       so a client needing more must change the batch CSV output.
+ */
+class ModelServerRunner: public IScenarioRunner, public IForkedTask {
+    friend class ScenarioRunnerFactory;
+public:
+    virtual ~ModelServerRunner();
+
+    virtual const std::string& getName() const;
+
+    // IParsable interface
+    virtual bool XMLParse( const xercesc::DOMNode* aRoot );
+
+    virtual bool setupScenarios( Timer& aTimer,
+                                 const std::string aName = "",
+                                 const std::list<std::string> aScenComponents = std::list<std::string>() );
+
+    virtual bool runScenarios( const int aSinglePeriod,
+                               const bool aPrintDebugging,
+                               Timer& aTimer );
+
+    virtual void printOutput( Timer& aTimer, const bool aCloseDB = true ) const;
+
+    virtual void cleanup();
+
+    virtual Scenario* getInternalScenario();
+    virtual const Scenario* getInternalScenario() const;
+
+    // IForkedTask methods
+    virtual bool runInChild( const int aTaskIndex, std::string& aResult );
+    virtual void collectResult( const int aTaskIndex, const std::string& aResult,
+                                const bool aReceived, const bool aSucceeded );
+private:
+    //! A single request to run a scenario.
+    struct Request {
+        //! Paths of add-on XML files to parse in order.
+        std::list<std::string> mComponents;
+
+        //! Add-on XML fragments to parse in order after the files.
+        std::list<std::string> mFragments;
+
+        //! The name to add on to the configured scenario name.
+        std::string mName;
+
+        //! The last period to run.
+        int mStopPeriod;
+    };
+
+    //! The scenario runner which runs each request in a forked child.
+    std::auto_ptr<SingleScenarioRunner> mSingleScenario;
+
+    //! Scenario components passed to setupScenarios which are parsed before
+    //! the add-ons of every request.
+    std::list<std::string> mBaseComponents;
+
+    //! The name passed to setupScenarios which is added to the name of every
+    //! request.
+    std::string mBaseName;
+
+    //! The request currently being run.
+    Request mCurrentRequest;
+
+    //! The status line and body of the response to the current request.
+    std::string mResponse;
+
+    //! The number of requests which did not solve.
+    int mNumUnsolved;
+
+    ModelServerRunner();
+    static const std::string& getXMLNameStatic();
+    bool serveConnection( const int aConnection, const int aDefaultStopPeriod, bool& aShutdown );
+};
+
+#endif // _MODEL_SERVER_RUNNER_H_
@@ -46,6 +46,7 @@
 
 #include <memory>
 #include <list>
+#include <string>
 #include "containers/include/iscenario_runner.h"
 
 class Timer;
@@ -67,6 +68,8 @@ class XMLDBOutputter;
  *             file.
  *          -# Scenario components passed into the function, in the order they
  *             are passed in.
+ *          -# XML documents given to setInMemoryComponents, in the order they
+ *             were given.
  *
  *          setupScenarios must be called before runScenarios. runScenarios may
  *          be called multiple times, as in the case when total policy costs are
@@ -81,6 +84,26 @@ class XMLDBOutputter;
  *          The getInternalScenarios functions only return a valid scenario
  *          after setupScenarios is called.
  *
+ *          When many scenarios with the same base input file and configured
+ *          scenario components are run in forked processes, the base may be
+ *          parsed once with parseSharedBaseScenario before forking. The next
+ *          setupScenarios call in each process then takes over its
+ *          copy-on-write copy of the base and only parses the components
+ *          passed in. Parsed data which is never modified stays shared
+ *          between the processes. This is an optimisation of forked runs
+ *          which relies on fork for the copy, the model itself can not be
+ *          cloned.
+ * \note The shared base has the following limits:
+ *       - Only runs which fork a process per scenario benefit. The shared
+ *         base is taken over by a single setupScenarios call and there is no
+ *         way to copy a Scenario, so serial batch runs still parse the base
+ *         for every scenario.
+ *       - Only parsing is shared. completeInit runs after the scenario's own
+ *         components are parsed, so every scenario still runs it.
+ *       - A scenario which is run in the parent process, for instance after a
+ *         worker process failed, takes over the parent's shared base. Any
+ *         later scenario in the parent parses the base again.
+ *
  * \todo What should be documented here vs. the IScenarioRunner interface.
  *
  * \author Josh Lurz
@@ -112,12 +135,28 @@ public:
 
     XMLDBOutputter* getXMLDBOutputter() const;
 
+    void setInMemoryComponents( const std::list<std::string>& aXMLDocuments );
+
+    static bool parseSharedBaseScenario();
+
+    static void clearSharedBaseScenario();
+
 protected:    
     SingleScenarioRunner();
     static const std::string& getXMLNameStatic();
+    static bool parseBaseInputs( Scenario* aScenario );
+
+    //! A scenario with the base inputs parsed which will be used by the next
+    //! call to setupScenarios instead of parsing them again.
+    static std::auto_ptr<Scenario> sSharedBaseScenario;
+
     //! The scenario which will be run.
     std::auto_ptr<Scenario> mScenario;
 
+    //! XML documents which are parsed after the scenario components by each
+    //! call to setupScenarios.
+    std::list<std::string> mInMemoryComponents;
+
     //! The XML database output is a special case in that we must keep
     //! it around in case we want to do additional processing once GCAM
     //! is done running.
@@ -46,8 +46,11 @@
 */
 
 #include <map>
+#include <iosfwd>
 #include <memory>
 #include <vector>
+#include <string>
+#include "util/base/include/forked_task_runner.h"
 
 class SingleScenarioRunner;
 class Curve;
@@ -61,12 +64,29 @@ class Curve;
 *          scenario.
 * \author Josh Lurz
 */
-class TotalPolicyCostCalculator {
+class TotalPolicyCostCalculator: public IForkedTask {
 public:
     explicit TotalPolicyCostCalculator( SingleScenarioRunner* aSingleScenario );
+    TotalPolicyCostCalculator( SingleScenarioRunner* aSingleScenario, const std::string& aGHGName );
     ~TotalPolicyCostCalculator();
+    void addSensitivityDirections();
     bool calculateAbatementCostCurve();
+    bool startAbatementCostCurve();
+    bool runTrials();
+    void finishAbatementCostCurve();
+    unsigned int getNumPoints() const;
+    double getPointRunTime() const;
     void printOutput() const;
+    void printOutput( std::ostream& aCostCurvesOut ) const;
+
+    static std::vector<std::string> getAbatedGasNames();
+    static bool runTrialsInWorkers( const std::vector<TotalPolicyCostCalculator*>& aCalculators,
+                                    const int aNumWorkers );
+
+    // IForkedTask methods
+    virtual bool runInChild( const int aTaskIndex, std::string& aResult );
+    virtual void collectResult( const int aTaskIndex, const std::string& aResult,
+                                const bool aReceived, const bool aSucceeded );
 private:
     //! The total global cost of the policy.
     double mGlobalCost;
@@ -77,12 +97,37 @@ private:
     //! Whether costs have been successfully run.
     bool mRanCosts;
 
+    //! Whether all points run in worker processes solved.
+    bool mWorkersSucceeded;
+
     //! The number of points to use to calculate the marginal abatement curve.
     unsigned int mNumPoints;
 
     //! The name of the GHG for which to calculate the marginal abatement curve.
     std::string mGHGName;
 
+    //! Whether to start each point from the solved prices of the nearest
+    //! point which has already been run.
+    bool mWarmStart;
+
+    //! Whether to start points next to the base scenario from prices
+    //! predicted by the sensitivity of the base solution to the tax.
+    bool mUsePredictor;
+
+    //! One region in each policy market for the gas, for which the
+    //! sensitivity of the base solution is calculated.
+    std::vector<std::string> mSensitivityRegions;
+
+    //! The total time in seconds spent running points, including points run
+    //! in worker processes.
+    double mPointRunTime;
+
+    typedef std::map<int, std::vector<std::vector<double> > > PointPrices;
+
+    //! Solved market prices by period for each point which has been run in
+    //! this process, including the base scenario as point mNumPoints.
+    PointPrices mPointPrices;
+
     //! The scenario runner which controls running the initial scenario, and all
     //! fixed taxed scenarios after. This is a weak reference.
     SingleScenarioRunner* mSingleScenario;
@@ -107,7 +152,14 @@ private:
     VectorRegionCurves mPeriodCostCurves;
     RegionCurves mRegionalCostCurves;
 
-    bool runTrials();
+    void init( SingleScenarioRunner* aSingleScenario );
+    bool runTrial( const int aPoint );
+    void setPointTaxes( const int aPoint );
+    void storePointPrices( const int aPoint );
+    void seedPointPrices( const int aPoint );
+    void seedPredictedPrices( const int aPoint );
+    const std::string writeTrialCurves( const int aPoint ) const;
+    bool readTrialCurves( const int aPoint, const std::string& aData );
     void createCostCurvesByPeriod();
     void createRegionalCostCurves();
     const std::string createXMLOutputString() const;
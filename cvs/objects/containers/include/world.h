@@ -46,6 +46,7 @@
 */
 
 #include <map>
+#include <set>
 #include <vector>
 #include <list>
 #include <memory>
@@ -59,6 +60,7 @@ class ILogger;
 class Curve;
 class CalcCounter;
 class IClimateModel;
+class ClimateEmulator;
 class GHGPolicy;
 class GlobalTechnologyDatabase;
 class IActivity;
@@ -86,12 +88,13 @@ class World: public IVisitable, public IRoundTrippable
 public:
     World();
     ~World();
-    void XMLParse( const xercesc::DOMNode* node );
+    bool XMLParse( const xercesc::DOMNode* node );
     void completeInit();
     void toInputXML( std::ostream& out, Tabs* tabs ) const;
     void toDebugXML( const int period, std::ostream& out, Tabs* tabs ) const;
 	static const std::string& getXMLNameStatic();
     const std::string& getName() const;
+    bool hasRegionSubsetError() const;
     void initCalc( const int period );
     void postCalc( const int aPeriod );
 
@@ -101,12 +104,14 @@ public:
     void setEmissions( int period );
     void runClimateModel();
     void runClimateModel( int period );
+    void runClimateEnsemble();
     void csvOutputFile() const; 
     void dbOutput( const std::list<std::string>& aPrimaryFuelList ) const; 
     const std::map<std::string,int> getOutputRegionMap() const;
     bool isAllCalibrated( const int period, double calAccuracy, const bool printWarnings ) const;
     void setTax( const GHGPolicy* aTax );
     const IClimateModel* getClimateModel() const;
+    ClimateEmulator* useClimateEmulator();
     std::map<std::string, const Curve*> getEmissionsQuantityCurves( const std::string& ghgName ) const;
     std::map<std::string, const Curve*> getEmissionsPriceCurves( const std::string& ghgName ) const;
     CalcCounter* getCalcCounter() const;
@@ -143,6 +148,10 @@ private:
     std::vector<Region*> regions; //!< array of pointers to Region objects
     std::auto_ptr<IClimateModel> mClimateModel; //!< The climate model.
 
+    //! The climate model as an emulator if useClimateEmulator has wrapped
+    //! it in one, otherwise null.  Owned by mClimateModel.
+    ClimateEmulator* mClimateEmulator;
+
     //! An object which maintains a count of the number of times
     //! calc() has been called.
     std::auto_ptr<CalcCounter> mCalcCounter;
@@ -153,8 +162,32 @@ private:
     //! The global technology database.
     std::auto_ptr<GlobalTechnologyDatabase> mGlobalTechDB;
 
+    //! The names of the regions to parse if only a subset of the regions
+    //! should be run, including any regions pulled in by market dependencies.
+    //! If empty all regions are parsed.
+    std::set<std::string> mRegionSubset;
+
+    //! Regions which have been skipped while parsing due to the region subset.
+    std::set<std::string> mSkippedRegions;
+
+    //! Names of markets which every region refers to. These global markets
+    //! do not pull their host region into the region subset.
+    std::set<std::string> mGlobalMarkets;
+
+    //! Whether the region subset has been closed over the configured input files.
+    bool mIsRegionSubsetClosed;
+
+    //! Whether a region needed by the region subset was skipped.
+    bool mHasRegionSubsetError;
+
     void clear();
 
+    bool shouldParseRegion( const xercesc::DOMNode* aNode );
+
+    bool closeRegionSubset();
+
+    bool expandRegionSubset( const std::map<std::string, std::set<std::string> >& aRegionMarkets );
+
     void csvGlobalDataFile() const;
  public:
     //! Number of activities in the global activity list
@@ -43,16 +43,20 @@
 
 #include "util/base/include/definitions.h"
 #include <string>
+#include <sstream>
+#include <vector>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "containers/include/batch_runner.h"
 #include "containers/include/scenario_runner_factory.h"
+#include "containers/include/single_scenario_runner.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/xml_helper.h"
 #include "util/base/include/configuration.h"
 #include "util/logger/include/ilogger.h"
 #include "containers/include/scenario.h"
 #include "reporting/include/batch_csv_outputter.h"
+#include "util/base/include/forked_task_runner.h"
 
 using namespace std;
 using namespace xercesc;
@@ -61,6 +65,131 @@ extern Scenario* scenario;
 
 typedef list<IScenarioRunner*>::iterator RunnerIterator;
 
+/*!
+ * \brief Runs the scenarios of a batch in forked copies of the process.
+ * \details Each task is a single scenario run with a single scenario runner.
+ *          The child writes back whether the scenario solved followed by its
+ *          batch CSV results. Scenarios which could not be run in a child are
+ *          run in the current process instead.
+ */
+class BatchRunner::ScenarioEvaluator: public IForkedTask {
+public:
+    ScenarioEvaluator( BatchRunner* aBatchRunner,
+                       const vector<Component>& aScenarios,
+                       const int aSinglePeriod,
+                       BatchCSVOutputter& aCSVOutputter,
+                       Timer& aTimer );
+
+    // IForkedTask methods
+    virtual bool runInChild( const int aTaskIndex, string& aResult );
+    virtual void collectResult( const int aTaskIndex, const string& aResult,
+                                const bool aReceived, const bool aSucceeded );
+
+    int getNumTasks() const;
+
+    bool getSuccess() const;
+private:
+    //! The batch runner which owns the scenario runners.
+    BatchRunner* mBatchRunner;
+
+    //! The scenarios to run.
+    const vector<Component>& mScenarios;
+
+    //! The scenario runners to run each scenario with.
+    vector<IScenarioRunner*> mRunners;
+
+    //! The model period to run.
+    const int mSinglePeriod;
+
+    //! The outputter to write the batch CSV results of each scenario to.
+    BatchCSVOutputter& mCSVOutputter;
+
+    //! The timer passed to the scenario runs.
+    Timer& mTimer;
+
+    //! Whether all scenarios collected so far solved.
+    bool mSuccess;
+};
+
+/*!
+ * \brief Constructor.
+ * \param aBatchRunner The batch runner which owns the scenario runners.
+ * \param aScenarios The scenarios to run.
+ * \param aSinglePeriod The model period to run.
+ * \param aCSVOutputter The outputter to write the batch CSV results to.
+ * \param aTimer The timer passed to the scenario runs.
+ */
+BatchRunner::ScenarioEvaluator::ScenarioEvaluator( BatchRunner* aBatchRunner,
+                                                   const vector<Component>& aScenarios,
+                                                   const int aSinglePeriod,
+                                                   BatchCSVOutputter& aCSVOutputter,
+                                                   Timer& aTimer ):
+mBatchRunner( aBatchRunner ),
+mScenarios( aScenarios ),
+mRunners( aBatchRunner->mScenarioRunners.begin(), aBatchRunner->mScenarioRunners.end() ),
+mSinglePeriod( aSinglePeriod ),
+mCSVOutputter( aCSVOutputter ),
+mTimer( aTimer ),
+mSuccess( true )
+{
+}
+
+bool BatchRunner::ScenarioEvaluator::runInChild( const int aTaskIndex, string& aResult ) {
+    // Tasks are ordered by scenario and then by runner, the same as a serial
+    // batch run.
+    ostringstream csvResults;
+    BatchCSVOutputter csvOutputter( csvResults );
+    const bool success = mBatchRunner->runSingleScenario( mRunners[ aTaskIndex % mRunners.size() ],
+                                                          mScenarios[ aTaskIndex / mRunners.size() ],
+                                                          mSinglePeriod, csvOutputter, mTimer );
+    aResult = ( success ? "1" : "0" ) + csvResults.str();
+    return success;
+}
+
+void BatchRunner::ScenarioEvaluator::collectResult( const int aTaskIndex, const string& aResult,
+                                                    const bool aReceived, const bool )
+{
+    const Component& scenario = mScenarios[ aTaskIndex / mRunners.size() ];
+    if( !aReceived || aResult.empty() ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Scenario " << scenario.mName
+                << " could not be run in a separate process, running it serially." << endl;
+        mSuccess &= mBatchRunner->runSingleScenario( mRunners[ aTaskIndex % mRunners.size() ],
+                                                     scenario, mSinglePeriod, mCSVOutputter,
+                                                     mTimer );
+        return;
+    }
+
+    // The list of unsolved scenarios was updated in the child so it must be
+    // updated again here.  This includes scenarios which failed to set up, for
+    // which there are no CSV results.
+    const bool scenarioSuccess = aResult[ 0 ] == '1';
+    if( !scenarioSuccess ) {
+        mBatchRunner->mUnsolvedNames.push_back( scenario.mName );
+    }
+    mSuccess &= scenarioSuccess;
+    if( aResult.size() > 1 ) {
+        mCSVOutputter.writeScenarioOutput( aResult.substr( 1 ) );
+    }
+}
+
+/*!
+ * \brief Get the number of tasks, which is one for each scenario and runner.
+ * \return The number of tasks.
+ */
+int BatchRunner::ScenarioEvaluator::getNumTasks() const {
+    return static_cast<int>( mScenarios.size() * mRunners.size() );
+}
+
+/*!
+ * \brief Get whether all of the scenarios solved.
+ * \return Whether all of the scenarios solved.
+ */
+bool BatchRunner::ScenarioEvaluator::getSuccess() const {
+    return mSuccess;
+}
+
 /*!
  * \brief Constructor
  */
@@ -76,7 +205,7 @@ const string& BatchRunner::getName() const {
     return getXMLNameStatic();
 }
 
-bool BatchRunner::setupScenarios( Timer& aTimer, const string aName, const list<string> aScenComponents ){
+bool BatchRunner::setupScenarios( Timer&, const string, const list<string> ){
     // Get the name of the batch file from the Configuration.
     const string batchFileName = Configuration::getInstance()->getFile( "BatchFileName" );
 
@@ -100,7 +229,7 @@ bool BatchRunner::setupScenarios( Timer& aTimer, const string aName, const list<
 }
 
 bool BatchRunner::runScenarios( const int aSinglePeriod,
-                                const bool aPrintDebugging,
+                                const bool,
                                 Timer& aTimer )
 {
     // Quick error checking for empty readin.
@@ -135,8 +264,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
     // All generated scenarios are run with each scenario runner in the order in
     // which the scenario runners were read.
     bool shouldExit = false;
-    bool success = true;
-    BatchCSVOutputter csvOutputter;
+    vector<Component> scenarios;
     while( !shouldExit ){
         // The data structure containing the current run.
         Component fileSetsToRun;
@@ -146,17 +274,7 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             fileSetsToRun.mFileSets.push_back( *( currSet->mFileSetIterator ) );
             fileSetsToRun.mName += currSet->mFileSetIterator->mName;
         }
-
-        // Run it using each possible type of IScenarioRunner.
-        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
-            bool scenarioSuccess = runSingleScenario( *runner, fileSetsToRun, aSinglePeriod, aTimer );
-            success &= scenarioSuccess;
-            (*runner)->getInternalScenario()->accept( &csvOutputter, -1 );
-            csvOutputter.writeDidScenarioSolve( scenarioSuccess );
-            // Clean up the current scenario runner before we move on to the next
-            // so that we do not accumulate a large amount of idle memory.
-            (*runner)->cleanup();
-        }
+        scenarios.push_back( fileSetsToRun );
 
         // Loop forward to find a position to increment.
         for( ComponentSet::iterator outPos = mComponentSet.begin(); outPos != mComponentSet.end(); ++outPos ){
@@ -175,10 +293,35 @@ bool BatchRunner::runScenarios( const int aSinglePeriod,
             }
         }
     }
+
+    BatchCSVOutputter csvOutputter;
+    const int numWorkers = Configuration::getInstance()->getInt( "batch-worker-processes", 1 );
+    if( numWorkers > 1 && ForkedTaskRunner::isSupported() ) {
+        // Parse the inputs common to all scenarios once so that each worker
+        // starts from a copy-on-write copy of them made by fork and only
+        // parses its own file sets.
+        SingleScenarioRunner::parseSharedBaseScenario();
+        ScenarioEvaluator evaluator( this, scenarios, aSinglePeriod, csvOutputter, aTimer );
+        ForkedTaskRunner::run( evaluator, evaluator.getNumTasks(), numWorkers );
+        SingleScenarioRunner::clearSharedBaseScenario();
+        return evaluator.getSuccess();
+    }
+    else if( numWorkers > 1 ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Batch worker processes are not supported in this build, running scenarios serially." << endl;
+    }
+
+    bool success = true;
+    for( vector<Component>::const_iterator currScenario = scenarios.begin(); currScenario != scenarios.end(); ++currScenario ){
+        // Run it using each possible type of IScenarioRunner.
+        for( RunnerIterator runner = mScenarioRunners.begin(); runner != mScenarioRunners.end(); ++runner ){
+            success &= runSingleScenario( *runner, *currScenario, aSinglePeriod, csvOutputter, aTimer );
+        }
+    }
     return success;
 }
 
-void BatchRunner::printOutput( Timer& aTimer, const bool aCloseDB ) const {
+void BatchRunner::printOutput( Timer&, const bool ) const {
     // Print out any scenarios that did not solve.
     ILogger& mainLog = ILogger::getLogger( "main_log" );
     mainLog.setLevel( ILogger::NOTICE );
@@ -210,7 +353,10 @@ void BatchRunner::cleanup() {
  * \param aScenarioRunner The scenario runner to use for the scenario.
  * \param aComponent A named list of FileSets which is expanded to create the
  *        list of scenario files to read in.
+ *          Finally the batch CSV results are written and the scenario runner
+ *          is cleaned up so that idle memory does not accumulate between runs.
  * \param aSinglePeriod The model period to run.
+ * \param aCSVOutputter The outputter to write the batch CSV results to.
  * \param aTimer The timer used to print out the amount of time spent performing
  *        operations.
  * \return Whether the model run solved successfully.
@@ -218,6 +364,7 @@ void BatchRunner::cleanup() {
 bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
                                      const Component& aComponent,
                                      const int aSinglePeriod,
+                                     BatchCSVOutputter& aCSVOutputter,
                                      Timer& aTimer )
 {
     // Set the current scenario runner.
@@ -244,20 +391,30 @@ bool BatchRunner::runSingleScenario( IScenarioRunner* aScenarioRunner,
     const string runName = aComponent.mName;
     bool success = mInternalRunner->setupScenarios( aTimer, runName, components );
     // Check if setting up the scenario, which often includes parsing,
-    // succeeded.
+    // succeeded.  The scenario is listed as unsolved, the same as when it is
+    // run in a worker process, but there are no results to write.
     if( !success ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
         mainLog.setLevel( ILogger::WARNING );
         mainLog << "Scenario setup failed. Skipping run." << endl;
+        mUnsolvedNames.push_back( aComponent.mName );
+        mInternalRunner->cleanup();
         return false;
     }
 
     // Run the scenario.
     success = mInternalRunner->runScenarios( aSinglePeriod, false, aTimer );
-    
+
+    // Scenarios run at the same time in other processes write to the same
+    // files and databases, so only one may write its output at a time.
+    ForkedTaskRunner::beginSerialSection();
     // Print the output.
     mInternalRunner->printOutput( aTimer );
-    
+    mInternalRunner->getInternalScenario()->accept( &aCSVOutputter, -1 );
+    aCSVOutputter.writeDidScenarioSolve( success );
+    mInternalRunner->cleanup();
+    ForkedTaskRunner::endSerialSection();
+
     // If the run failed, add to the list of failed runs. CHECK ME!
     if( !success ){
         mUnsolvedNames.push_back( aComponent.mName );
@@ -0,0 +1,746 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file ensemble_runner.cpp
+ * \ingroup Objects
+ * \brief EnsembleRunner class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+#include "containers/include/ensemble_runner.h"
+#include "containers/include/scenario_runner_factory.h"
+#include "containers/include/single_scenario_runner.h"
+#include "containers/include/scenario.h"
+#include "marketplace/include/marketplace.h"
+#include "reporting/include/batch_csv_outputter.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/model_time.h"
+#include "util/base/include/xml_helper.h"
+#include "util/base/include/auto_file.h"
+#include "util/base/include/timer.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+using namespace xercesc;
+
+/*!
+ * \brief Escape the characters which may not appear in an XML attribute value.
+ * \param aValue The value to escape.
+ * \return The escaped value.
+ */
+static string escapeAttribute( const string& aValue ) {
+    string escaped;
+    for( string::const_iterator iter = aValue.begin(); iter != aValue.end(); ++iter ) {
+        switch( *iter ) {
+        case '&':
+            escaped += "&amp;";
+            break;
+        case '<':
+            escaped += "&lt;";
+            break;
+        case '>':
+            escaped += "&gt;";
+            break;
+        case '"':
+            escaped += "&quot;";
+            break;
+        default:
+            escaped += *iter;
+        }
+    }
+    return escaped;
+}
+
+/*!
+ * \brief Write the nested elements for a parameter target containing a value.
+ * \details The target is a list of element names separated by /, each of
+ *          which may be followed by attribute values such as
+ *          [\@name='USA']. Every element containing another element is
+ *          marked nocreate so that a misspelled target is not added to the
+ *          scenario as a new, empty object.
+ * \param aTarget The target path.
+ * \param aValue The value to write in the innermost element.
+ * \param aOut The stream to write to.
+ * \return Whether the target was valid.
+ */
+static bool writeTargetXML( const string& aTarget, const double aValue, ostream& aOut ) {
+    vector<string> elements;
+    string::size_type pos = 0;
+    while( true ) {
+        string::size_type end = aTarget.find_first_of( "[/", pos );
+        const string name = aTarget.substr( pos, end == string::npos ? string::npos : end - pos );
+        if( name.empty() ) {
+            return false;
+        }
+        aOut << '<' << name;
+        bool hasNoCreate = false;
+        while( end != string::npos && aTarget[ end ] == '[' ) {
+            const string::size_type close = aTarget.find( ']', end );
+            if( close == string::npos ) {
+                return false;
+            }
+            const string predicate = aTarget.substr( end + 1, close - end - 1 );
+            const string::size_type equals = predicate.find( '=' );
+            if( predicate.empty() || predicate[ 0 ] != '@' || equals == string::npos ) {
+                return false;
+            }
+            string value = predicate.substr( equals + 1 );
+            if( value.size() >= 2 && ( value[ 0 ] == '\'' || value[ 0 ] == '"' )
+                && value[ value.size() - 1 ] == value[ 0 ] )
+            {
+                value = value.substr( 1, value.size() - 2 );
+            }
+            const string attribute = predicate.substr( 1, equals - 1 );
+            hasNoCreate = hasNoCreate || attribute == "nocreate";
+            aOut << ' ' << attribute << "=\"" << escapeAttribute( value ) << '"';
+            end = close + 1 < aTarget.size() ? close + 1 : string::npos;
+        }
+        if( end != string::npos && !hasNoCreate ) {
+            aOut << " nocreate=\"1\"";
+        }
+        aOut << '>';
+        elements.push_back( name );
+        if( end == string::npos ) {
+            break;
+        }
+        if( aTarget[ end ] != '/' ) {
+            return false;
+        }
+        pos = end + 1;
+    }
+
+    aOut << setprecision( numeric_limits<double>::digits10 + 2 ) << aValue;
+    for( vector<string>::const_reverse_iterator iter = elements.rbegin(); iter != elements.rend(); ++iter ) {
+        aOut << "</" << *iter << '>';
+    }
+    return true;
+}
+
+/*!
+ * \brief Draw a value for a parameter.
+ * \param aDistribution The name of the distribution.
+ * \param aMin The lower bound of a uniform distribution.
+ * \param aMax The upper bound of a uniform distribution.
+ * \param aMean The mean of a normal distribution.
+ * \param aStdDev The standard deviation of a normal distribution.
+ * \param aGenerator The random number generator.
+ * \return The value drawn.
+ */
+static double drawValue( const string& aDistribution, const double aMin, const double aMax,
+                         const double aMean, const double aStdDev, boost::mt19937& aGenerator )
+{
+    if( aDistribution == "normal" || aDistribution == "lognormal" ) {
+        boost::variate_generator<boost::mt19937&, boost::normal_distribution<> >
+            normal( aGenerator, boost::normal_distribution<>( aMean, aStdDev ) );
+        const double value = normal();
+        return aDistribution == "lognormal" ? exp( value ) : value;
+    }
+    boost::variate_generator<boost::mt19937&, boost::uniform_real<> >
+        uniform( aGenerator, boost::uniform_real<>( aMin, aMax ) );
+    return uniform();
+}
+
+/*!
+ * \brief Split a line of CSV output into its cells.
+ * \param aLine The line to split.
+ * \return The cells.
+ */
+static vector<string> splitCSVLine( const string& aLine ) {
+    vector<string> cells;
+    istringstream lineStream( aLine );
+    string cell;
+    while( getline( lineStream, cell, ',' ) ) {
+        cells.push_back( cell );
+    }
+    return cells;
+}
+
+/*!
+ * \brief Get a percentile of sorted values by linear interpolation.
+ * \param aSortedValues The values, sorted in increasing order.
+ * \param aFraction The percentile as a fraction.
+ * \return The percentile.
+ */
+static double getPercentile( const vector<double>& aSortedValues, const double aFraction ) {
+    const double position = aFraction * ( aSortedValues.size() - 1 );
+    const unsigned int lower = static_cast<unsigned int>( floor( position ) );
+    const unsigned int upper = min( lower + 1, static_cast<unsigned int>( aSortedValues.size() - 1 ) );
+    return aSortedValues[ lower ] + ( position - lower ) * ( aSortedValues[ upper ] - aSortedValues[ lower ] );
+}
+
+//! Constructor.
+EnsembleRunner::EnsembleRunner():
+mNumSamples( 0 ),
+mRandomSeed( 1 ),
+mWarmStart( true ),
+mStopPeriod( Scenario::RUN_ALL_PERIODS ),
+mSingleScenario( ScenarioRunnerFactory::createSingleScenarioRunner() )
+{
+}
+
+//! Destructor.
+EnsembleRunner::~EnsembleRunner(){
+}
+
+const string& EnsembleRunner::getName() const {
+    return getXMLNameStatic();
+}
+
+bool EnsembleRunner::XMLParse( const DOMNode* aRoot ){
+    // assume we were passed a valid node.
+    assert( aRoot );
+
+    // get the children of the node.
+    DOMNodeList* nodeList = aRoot->getChildNodes();
+
+    // loop through the children
+    bool success = true;
+    for ( unsigned int i = 0; i < nodeList->getLength(); i++ ){
+        DOMNode* curr = nodeList->item( i );
+        string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+
+        if( nodeName == XMLHelper<void>::text() ) {
+            continue;
+        }
+        else if( nodeName == "num-samples" ) {
+            mNumSamples = XMLHelper<int>::getValue( curr );
+        }
+        else if( nodeName == "random-seed" ) {
+            mRandomSeed = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "warm-start" ) {
+            mWarmStart = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "parameter" ) {
+            success &= XMLParseParameter( curr );
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing " << getXMLNameStatic() << "." << endl;
+            success = false;
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Parse a single parameter to perturb.
+ * \param aNode The parameter node.
+ * \return Whether the parameter was valid.
+ */
+bool EnsembleRunner::XMLParseParameter( const DOMNode* aNode ){
+    Parameter parameter;
+    parameter.mName = XMLHelper<string>::getAttr( aNode, "name" );
+    parameter.mDistribution = "uniform";
+    parameter.mMin = 0;
+    parameter.mMax = 1;
+    parameter.mMean = 0;
+    parameter.mStdDev = 1;
+
+    DOMNodeList* nodeList = aNode->getChildNodes();
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    for ( unsigned int i = 0; i < nodeList->getLength(); i++ ){
+        DOMNode* curr = nodeList->item( i );
+        string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+
+        if( nodeName == XMLHelper<void>::text() ) {
+            continue;
+        }
+        else if( nodeName == "target" ) {
+            parameter.mTarget = XMLHelper<string>::getValue( curr );
+        }
+        else if( nodeName == "distribution" ) {
+            parameter.mDistribution = XMLHelper<string>::getValue( curr );
+        }
+        else if( nodeName == "min" ) {
+            parameter.mMin = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "max" ) {
+            parameter.mMax = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "mean" ) {
+            parameter.mMean = XMLHelper<double>::getValue( curr );
+        }
+        else if( nodeName == "std-dev" ) {
+            parameter.mStdDev = XMLHelper<double>::getValue( curr );
+        }
+        else {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing parameter "
+                    << parameter.mName << "." << endl;
+            return false;
+        }
+    }
+
+    ostringstream testXML;
+    if( !writeTargetXML( parameter.mTarget, 0, testXML ) ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Invalid target " << parameter.mTarget << " for parameter " << parameter.mName << "." << endl;
+        return false;
+    }
+    if( parameter.mDistribution != "uniform" && parameter.mDistribution != "normal"
+        && parameter.mDistribution != "lognormal" )
+    {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Unknown distribution " << parameter.mDistribution << " for parameter "
+                << parameter.mName << "." << endl;
+        return false;
+    }
+    mParameters.push_back( parameter );
+    return true;
+}
+
+/*!
+ * \brief Read the ensemble specification, draw the samples and parse the base
+ *        scenario.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \param aName A name to add on to the name of every sample.
+ * \param aScenComponents Scenario components to parse for every sample.
+ * \return Whether the specification and base scenario were read.
+ */
+bool EnsembleRunner::setupScenarios( Timer&, const string aName,
+                                     const list<string> aScenComponents )
+{
+    mBaseName = aName;
+    mBaseComponents = aScenComponents;
+
+    const string specFile = Configuration::getInstance()->getFile( "ensemble-spec-file", "ensemble.xml" );
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Parsing ensemble specification " << specFile << "." << endl;
+    if( !XMLHelper<void>::parseXML( specFile, this ) ) {
+        return false;
+    }
+    if( mNumSamples <= 0 || mParameters.empty() ) {
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "The ensemble specification must give a positive number of samples and at least one parameter." << endl;
+        return false;
+    }
+    drawSamples();
+
+    // The base is only shared with forked copies, otherwise each sample
+    // parses its own.
+    if( ForkedTaskRunner::isSupported() ) {
+        return SingleScenarioRunner::parseSharedBaseScenario();
+    }
+    return true;
+}
+
+//! Draw the value of every parameter for every sample.
+void EnsembleRunner::drawSamples() {
+    boost::mt19937 generator( mRandomSeed );
+    mSamples.assign( mNumSamples, vector<double>( mParameters.size() ) );
+    for( int sample = 0; sample < mNumSamples; ++sample ) {
+        for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+            const Parameter& parameter = mParameters[ param ];
+            mSamples[ sample ][ param ] = drawValue( parameter.mDistribution, parameter.mMin, parameter.mMax,
+                                                     parameter.mMean, parameter.mStdDev, generator );
+        }
+    }
+}
+
+/*!
+ * \brief Create the add-on document which sets the parameter values of a
+ *        sample.
+ * \param aSample The sample.
+ * \return The XML document.
+ */
+const string EnsembleRunner::createSampleXML( const int aSample ) const {
+    ostringstream xml;
+    xml << "<scenario>";
+    for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+        writeTargetXML( mParameters[ param ].mTarget, mSamples[ aSample ][ param ], xml );
+    }
+    xml << "</scenario>";
+    return xml.str();
+}
+
+/*!
+ * \brief Run all of the samples.
+ * \param aSinglePeriod The last period to run for each sample.
+ * \param aPrintDebugging This parameter is ignored, samples do not print
+ *        debugging information.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether all samples solved.
+ */
+bool EnsembleRunner::runScenarios( const int aSinglePeriod,
+                                   const bool,
+                                   Timer& aTimer )
+{
+    mStopPeriod = aSinglePeriod;
+    mSampleOutput.assign( mNumSamples, string() );
+    mSampleSolved.assign( mNumSamples, false );
+    mSolvedPrices.clear();
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    if( ForkedTaskRunner::isSupported() ) {
+        const int numWorkers = max( Configuration::getInstance()->getInt( "ensemble-worker-processes", 1, false ), 1 );
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Running " << mNumSamples << " ensemble samples in up to " << numWorkers
+                << " worker processes." << endl;
+        ForkedTaskRunner::run( *this, mNumSamples, numWorkers );
+    }
+    else {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Running " << mNumSamples << " ensemble samples serially." << endl;
+        for( int sample = 0; sample < mNumSamples; ++sample ) {
+            vector<vector<double> > prices;
+            mSampleSolved[ sample ] = runSample( sample, mSampleOutput[ sample ], prices );
+            if( mSampleSolved[ sample ] ) {
+                mSolvedPrices[ sample ] = prices;
+            }
+            mSingleScenario->cleanup();
+        }
+    }
+
+    const int numSolved = static_cast<int>( count( mSampleSolved.begin(), mSampleSolved.end(), true ) );
+    mainLog.setLevel( ILogger::WARNING );
+    mainLog << numSolved << " of " << mNumSamples << " ensemble samples solved." << endl;
+
+    mainLog.setLevel( ILogger::DEBUG );
+    aTimer.print( mainLog, "Ensemble run time:" );
+    return numSolved == mNumSamples;
+}
+
+/*!
+ * \brief Find the solved sample with parameter values nearest to a sample.
+ * \details The distance in each parameter is scaled by the range of values
+ *          drawn for that parameter so that parameters with large values do
+ *          not dominate.
+ * \param aSample The sample for which to find a neighbor.
+ * \return The nearest solved sample, or -1 if no sample has solved.
+ */
+int EnsembleRunner::findNearestSolvedSample( const int aSample ) const {
+    vector<double> ranges( mParameters.size() );
+    for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+        double minValue = mSamples[ 0 ][ param ];
+        double maxValue = minValue;
+        for( int sample = 1; sample < mNumSamples; ++sample ) {
+            minValue = min( minValue, mSamples[ sample ][ param ] );
+            maxValue = max( maxValue, mSamples[ sample ][ param ] );
+        }
+        ranges[ param ] = maxValue > minValue ? maxValue - minValue : 1;
+    }
+
+    int nearest = -1;
+    double nearestDistance = 0;
+    for( SamplePrices::const_iterator iter = mSolvedPrices.begin(); iter != mSolvedPrices.end(); ++iter ) {
+        double distance = 0;
+        for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+            const double difference = ( mSamples[ aSample ][ param ] - mSamples[ iter->first ][ param ] )
+                                      / ranges[ param ];
+            distance += difference * difference;
+        }
+        if( nearest == -1 || distance < nearestDistance ) {
+            nearest = iter->first;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+/*!
+ * \brief Set up and run a single sample.
+ * \param aSample The sample to run.
+ * \param aOutput The batch CSV output for the sample.
+ * \param aPrices The solved market prices by period if the sample solved.
+ * \return Whether the sample solved.
+ */
+bool EnsembleRunner::runSample( const int aSample, string& aOutput,
+                                vector<vector<double> >& aPrices )
+{
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Running ensemble sample " << aSample << "." << endl;
+
+    mSingleScenario->setInMemoryComponents( list<string>( 1, createSampleXML( aSample ) ) );
+    Timer timer;
+    if( !mSingleScenario->setupScenarios( timer, mBaseName + "-sample-" + util::toString( aSample ),
+                                          mBaseComponents ) )
+    {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Setup failed for ensemble sample " << aSample << "." << endl;
+        return false;
+    }
+
+    Scenario* sampleScenario = mSingleScenario->getInternalScenario();
+    const int nearest = mWarmStart ? findNearestSolvedSample( aSample ) : -1;
+    if( nearest != -1 ) {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Starting ensemble sample " << aSample << " from the prices of sample "
+                << nearest << "." << endl;
+        const vector<vector<double> >& prices = mSolvedPrices.find( nearest )->second;
+        for( unsigned int per = 0; per < prices.size(); ++per ) {
+            sampleScenario->getMarketplace()->setPriceGuesses( per, prices[ per ] );
+        }
+    }
+
+    const bool success = mSingleScenario->runScenarios( mStopPeriod, false, timer );
+    sampleScenario->getMarketplace()->clearPriceGuesses();
+
+    ostringstream csvOut;
+    BatchCSVOutputter csvOutputter( csvOut );
+    sampleScenario->accept( &csvOutputter, -1 );
+    csvOutputter.writeDidScenarioSolve( success );
+    aOutput = csvOut.str();
+
+    if( success ) {
+        const int maxPeriod = sampleScenario->getModeltime()->getmaxper();
+        aPrices.resize( maxPeriod );
+        for( int per = 0; per < maxPeriod; ++per ) {
+            aPrices[ per ] = sampleScenario->getMarketplace()->getPrices( per );
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Write a binary value to a stream.
+ * \param aOut The stream to write to.
+ * \param aValue The value to write.
+ */
+template<class T>
+static void writeBinary( ostream& aOut, const T& aValue ) {
+    aOut.write( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+}
+
+/*!
+ * \brief Read a binary value from a stream.
+ * \param aIn The stream to read from.
+ * \param aValue The value to read into.
+ * \return Whether the value was read.
+ */
+template<class T>
+static bool readBinary( istream& aIn, T& aValue ) {
+    return aIn.read( reinterpret_cast<char*>( &aValue ), sizeof( T ) ).good();
+}
+
+/*!
+ * \brief Run a sample in a forked copy of the process.
+ * \param aTaskIndex The sample to run.
+ * \param aResult The batch CSV output of the sample followed by its solved
+ *        prices.
+ * \return Whether the sample solved.
+ */
+bool EnsembleRunner::runInChild( const int aTaskIndex, string& aResult ) {
+    string output;
+    vector<vector<double> > prices;
+    const bool success = runSample( aTaskIndex, output, prices );
+
+    ostringstream result( ios_base::out | ios_base::binary );
+    writeBinary( result, static_cast<unsigned int>( output.size() ) );
+    result.write( output.data(), output.size() );
+    writeBinary( result, static_cast<unsigned int>( prices.size() ) );
+    for( unsigned int per = 0; per < prices.size(); ++per ) {
+        writeBinary( result, static_cast<unsigned int>( prices[ per ].size() ) );
+        for( unsigned int i = 0; i < prices[ per ].size(); ++i ) {
+            writeBinary( result, prices[ per ][ i ] );
+        }
+    }
+    aResult = result.str();
+    return success;
+}
+
+/*!
+ * \brief Store the output and prices of a sample run in a forked copy.
+ * \details Solved prices are stored so that samples started later may start
+ *          from them.
+ * \param aTaskIndex The sample.
+ * \param aResult The batch CSV output of the sample followed by its solved
+ *        prices.
+ * \param aReceived Whether the copy returned a result.
+ * \param aSucceeded Whether the sample solved.
+ */
+void EnsembleRunner::collectResult( const int aTaskIndex, const string& aResult,
+                                    const bool aReceived, const bool aSucceeded )
+{
+    istringstream in( aResult, ios_base::in | ios_base::binary );
+    unsigned int outputSize = 0;
+    string output;
+    vector<vector<double> > prices;
+    bool valid = aReceived && readBinary( in, outputSize );
+    if( valid ) {
+        output.resize( outputSize );
+        valid = outputSize == 0 || in.read( &output[ 0 ], outputSize ).good();
+    }
+    unsigned int numPeriods = 0;
+    valid = valid && readBinary( in, numPeriods );
+    prices.resize( valid ? numPeriods : 0 );
+    for( unsigned int per = 0; per < prices.size() && valid; ++per ) {
+        unsigned int numPrices = 0;
+        valid = readBinary( in, numPrices );
+        prices[ per ].resize( valid ? numPrices : 0 );
+        for( unsigned int i = 0; i < prices[ per ].size() && valid; ++i ) {
+            valid = readBinary( in, prices[ per ][ i ] );
+        }
+    }
+
+    if( !valid ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Worker process for ensemble sample " << aTaskIndex << " failed to return results." << endl;
+        return;
+    }
+    mSampleOutput[ aTaskIndex ] = output;
+    mSampleSolved[ aTaskIndex ] = aSucceeded;
+    if( aSucceeded ) {
+        mSolvedPrices[ aTaskIndex ] = prices;
+    }
+}
+
+/*!
+ * \brief Write the output of every sample to the batch CSV file and the
+ *        summary statistics to the ensemble summary file.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \param aCloseDB This parameter is ignored.
+ */
+void EnsembleRunner::printOutput( Timer&, const bool ) const {
+    BatchCSVOutputter csvOutputter;
+    for( unsigned int sample = 0; sample < mSampleOutput.size(); ++sample ) {
+        if( !mSampleOutput[ sample ].empty() ) {
+            csvOutputter.writeScenarioOutput( mSampleOutput[ sample ] );
+        }
+    }
+    writeSummary();
+}
+
+/*!
+ * \brief Write summary statistics of each batch CSV result over the solved
+ *        samples, followed by the parameter values of every sample.
+ */
+void EnsembleRunner::writeSummary() const {
+    // Collect the values of each result column from the solved samples. The
+    // first column is the scenario name.
+    vector<string> header;
+    vector<vector<double> > columnValues;
+    for( unsigned int sample = 0; sample < mSampleOutput.size(); ++sample ) {
+        if( !mSampleSolved[ sample ] ) {
+            continue;
+        }
+        istringstream output( mSampleOutput[ sample ] );
+        string headerLine;
+        string valueLine;
+        getline( output, headerLine );
+        getline( output, valueLine );
+        if( header.empty() ) {
+            header = splitCSVLine( headerLine );
+            columnValues.resize( header.size() );
+        }
+        const vector<string> cells = splitCSVLine( valueLine );
+        for( unsigned int col = 1; col < cells.size() && col < header.size(); ++col ) {
+            istringstream cellStream( cells[ col ] );
+            double value;
+            if( cellStream >> value ) {
+                columnValues[ col ].push_back( value );
+            }
+        }
+    }
+
+    AutoOutputFile summary( "ensemble-summary-file", "ensemble-summary.csv" );
+    *summary << "Result,Samples,Mean,Std Dev,Min,5th Percentile,Median,95th Percentile,Max" << endl;
+    for( unsigned int col = 1; col < header.size(); ++col ) {
+        vector<double>& values = columnValues[ col ];
+        if( values.empty() ) {
+            continue;
+        }
+        sort( values.begin(), values.end() );
+        double mean = 0;
+        for( unsigned int i = 0; i < values.size(); ++i ) {
+            mean += values[ i ];
+        }
+        mean /= values.size();
+        double variance = 0;
+        for( unsigned int i = 0; i < values.size(); ++i ) {
+            variance += ( values[ i ] - mean ) * ( values[ i ] - mean );
+        }
+        variance = values.size() > 1 ? variance / ( values.size() - 1 ) : 0;
+        *summary << header[ col ] << ',' << values.size() << ',' << mean << ',' << sqrt( variance ) << ','
+                 << values.front() << ',' << getPercentile( values, 0.05 ) << ','
+                 << getPercentile( values, 0.5 ) << ',' << getPercentile( values, 0.95 ) << ','
+                 << values.back() << endl;
+    }
+
+    // Write the parameter values of every sample.
+    *summary << endl << "Sample,Solved";
+    for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+        *summary << ',' << mParameters[ param ].mName;
+    }
+    *summary << endl;
+    for( unsigned int sample = 0; sample < mSamples.size(); ++sample ) {
+        *summary << sample << ',' << ( sample < mSampleSolved.size() && mSampleSolved[ sample ] );
+        for( unsigned int param = 0; param < mParameters.size(); ++param ) {
+            *summary << ',' << mSamples[ sample ][ param ];
+        }
+        *summary << endl;
+    }
+}
+
+void EnsembleRunner::cleanup() {
+    mSingleScenario->cleanup();
+    SingleScenarioRunner::clearSharedBaseScenario();
+}
+
+Scenario* EnsembleRunner::getInternalScenario(){
+    return mSingleScenario->getInternalScenario();
+}
+
+const Scenario* EnsembleRunner::getInternalScenario() const {
+    return mSingleScenario->getInternalScenario();
+}
+
+/*!
+ * \brief Get the XML name of the class.
+ * \return The XML name of the class.
+ */
+const string& EnsembleRunner::getXMLNameStatic(){
+    static const string XML_NAME = "ensemble-runner";
+    return XML_NAME;
+}
@@ -50,6 +50,8 @@
 #include "containers/include/scenario.h"
 #include "util/base/include/auto_file.h"
 #include "marketplace/include/marketplace.h"
+#include "util/base/include/forked_task_runner.h"
+#include "util/base/include/xml_helper.h"
 
 using namespace std;
 using namespace xercesc;
@@ -71,13 +73,20 @@ MACGeneratorScenarioRunner::MACGeneratorScenarioRunner(){
         mainLog << "Calibration is incompatible with the generation of marginal abatement curves." << endl;
     }
     else {
-        // Create the policy cost calculator.
-        mPolicyCostCalculator.reset( new TotalPolicyCostCalculator( mSingleScenario.get() ) );
+        // Create a policy cost calculator for each gas.
+        const vector<string> gasNames = TotalPolicyCostCalculator::getAbatedGasNames();
+        for( unsigned int i = 0; i < gasNames.size(); ++i ) {
+            mPolicyCostCalculators.push_back( new TotalPolicyCostCalculator( mSingleScenario.get(),
+                                                                             gasNames[ i ] ) );
+        }
     }
 }
 
 //! Destructor
 MACGeneratorScenarioRunner::~MACGeneratorScenarioRunner(){
+    for( unsigned int i = 0; i < mPolicyCostCalculators.size(); ++i ) {
+        delete mPolicyCostCalculators[ i ];
+    }
 }
 
 const string& MACGeneratorScenarioRunner::getName() const {
@@ -126,6 +135,12 @@ bool MACGeneratorScenarioRunner::runScenarios( const int aSinglePeriod,
     if( usingRestartPeriod ) {
         mSingleScenario->getInternalScenario()->getMarketplace()->store_prices_for_cost_calculation();
     }
+    // The sensitivities used to predict point prices are calculated while the
+    // base scenario solves.
+    for( unsigned int i = 0; i < mPolicyCostCalculators.size(); ++i ) {
+        mPolicyCostCalculators[ i ]->addSensitivityDirections();
+    }
+
     // Run the base scenario. Print debugging for the base scenario run.
     bool success = mSingleScenario->runScenarios( Scenario::RUN_ALL_PERIODS,
                                                   aPrintDebugging, aTimer );
@@ -133,9 +148,29 @@ bool MACGeneratorScenarioRunner::runScenarios( const int aSinglePeriod,
     // Print the output now before it is overwritten.
     mSingleScenario->printOutput( aTimer, false );
 
-    // Now calculate the abatement curves.
-    if( mPolicyCostCalculator.get() ){
-        success &= mPolicyCostCalculator->calculateAbatementCostCurve();
+    // Now calculate the abatement curves. Every calculator must store the
+    // solved policy run before any points are run.
+    vector<TotalPolicyCostCalculator*> startedCalculators;
+    for( unsigned int i = 0; i < mPolicyCostCalculators.size(); ++i ) {
+        if( mPolicyCostCalculators[ i ]->startAbatementCostCurve() ) {
+            startedCalculators.push_back( mPolicyCostCalculators[ i ] );
+        }
+    }
+
+    // When there are several gases run all of their points as one set of
+    // worker processes so that the workers are kept busy across gases.
+    const int numWorkers = Configuration::getInstance()->getInt( "cost-curve-worker-processes", 1, false );
+    if( startedCalculators.size() > 1 && numWorkers > 1 && ForkedTaskRunner::isSupported() ) {
+        success &= TotalPolicyCostCalculator::runTrialsInWorkers( startedCalculators, numWorkers );
+    }
+    else {
+        for( unsigned int i = 0; i < startedCalculators.size(); ++i ) {
+            success &= startedCalculators[ i ]->runTrials();
+        }
+    }
+
+    for( unsigned int i = 0; i < startedCalculators.size(); ++i ) {
+        startedCalculators[ i ]->finishAbatementCostCurve();
     }
 
     // Return whether the initial run and all datapoint calculations completed
@@ -145,8 +180,19 @@ bool MACGeneratorScenarioRunner::runScenarios( const int aSinglePeriod,
 
 //! Print the output.
 void MACGeneratorScenarioRunner::printOutput( Timer& timer, const bool aCloseDB ) const {
-    if( mPolicyCostCalculator.get() ){
-        mPolicyCostCalculator->printOutput();
+    if( mPolicyCostCalculators.size() == 1 ){
+        mPolicyCostCalculators.front()->printOutput();
+    }
+    else if( !mPolicyCostCalculators.empty() ){
+        // Write the curves for all gases into the same cost curves file.
+        AutoOutputFile ccOut( "costCurvesOutputFileName",
+                              "cost_curves.xml" );
+        Tabs tabs;
+        XMLWriteOpeningTag( "CostCurvesInfoByGas", *ccOut, &tabs );
+        for( unsigned int i = 0; i < mPolicyCostCalculators.size(); ++i ) {
+            mPolicyCostCalculators[ i ]->printOutput( *ccOut );
+        }
+        XMLWriteClosingTag( "CostCurvesInfoByGas", *ccOut, &tabs );
     }
     
     static const bool printDB = Configuration::getInstance()->shouldWriteFile( "dbFileName" );
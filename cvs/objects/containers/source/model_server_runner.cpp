@@ -0,0 +1,496 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file model_server_runner.cpp
+ * \ingroup Objects
+ * \brief ModelServerRunner class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include "containers/include/model_server_runner.h"
+#include "containers/include/scenario_runner_factory.h"
+#include "containers/include/single_scenario_runner.h"
+#include "containers/include/scenario.h"
+#include "reporting/include/batch_csv_outputter.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/timer.h"
+#include "util/base/include/util.h"
+#include "util/logger/include/ilogger.h"
+
+#if !defined( WIN32 )
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+using namespace std;
+using namespace xercesc;
+
+#if !defined( WIN32 )
+namespace {
+    /*!
+     * \brief Reads lines and fixed size blocks from a socket.
+     */
+    class ConnectionReader {
+    public:
+        explicit ConnectionReader( const int aFD ):mFD( aFD ) {}
+
+        /*!
+         * \brief Read a line without the trailing newline.
+         * \param aLine The line read.
+         * \return Whether a line was read before the connection was closed.
+         */
+        bool readLine( string& aLine ) {
+            string::size_type end;
+            while( ( end = mBuffer.find( '\n' ) ) == string::npos ) {
+                if( !fill() ) {
+                    return false;
+                }
+            }
+            aLine = mBuffer.substr( 0, end );
+            mBuffer.erase( 0, end + 1 );
+            if( !aLine.empty() && aLine[ aLine.size() - 1 ] == '\r' ) {
+                aLine.erase( aLine.size() - 1 );
+            }
+            return true;
+        }
+
+        /*!
+         * \brief Read a block of a given size.
+         * \param aSize The number of bytes to read.
+         * \param aData The data read.
+         * \return Whether the whole block was read before the connection was
+         *         closed.
+         */
+        bool readBytes( const size_t aSize, string& aData ) {
+            while( mBuffer.size() < aSize ) {
+                if( !fill() ) {
+                    return false;
+                }
+            }
+            aData = mBuffer.substr( 0, aSize );
+            mBuffer.erase( 0, aSize );
+            return true;
+        }
+
+        /*!
+         * \brief Read and discard a block of a given size without keeping it
+         *        in memory.
+         * \param aSize The number of bytes to discard.
+         * \return Whether the whole block was read before the connection was
+         *         closed.
+         */
+        bool skipBytes( size_t aSize ) {
+            while( mBuffer.size() < aSize ) {
+                aSize -= mBuffer.size();
+                mBuffer.clear();
+                if( !fill() ) {
+                    return false;
+                }
+            }
+            mBuffer.erase( 0, aSize );
+            return true;
+        }
+    private:
+        //! The socket to read from.
+        const int mFD;
+
+        //! Data read from the socket which has not been returned yet.
+        string mBuffer;
+
+        //! Read more data into the buffer.
+        bool fill() {
+            char buffer[ 4096 ];
+            while( true ) {
+                const ssize_t numRead = read( mFD, buffer, sizeof( buffer ) );
+                if( numRead > 0 ) {
+                    mBuffer.append( buffer, numRead );
+                    return true;
+                }
+                if( numRead == 0 || errno != EINTR ) {
+                    return false;
+                }
+            }
+        }
+    };
+
+    /*!
+     * \brief Write an entire buffer to a socket.
+     * \param aFD The socket to write to.
+     * \param aData The data to write.
+     * \return Whether all of the data was written.
+     */
+    bool writeAll( const int aFD, const string& aData ) {
+        size_t written = 0;
+        while( written < aData.size() ) {
+            const ssize_t numWritten = write( aFD, aData.data() + written, aData.size() - written );
+            if( numWritten < 0 ) {
+                if( errno == EINTR ) {
+                    continue;
+                }
+                return false;
+            }
+            written += numWritten;
+        }
+        return true;
+    }
+}
+#endif
+
+/*!
+ * \brief Create the status line and body of a response.
+ * \param aStatus The status of the request.
+ * \param aBody The body of the response.
+ * \return The response.
+ */
+static string createResponse( const string& aStatus, const string& aBody ) {
+    ostringstream response;
+    response << aStatus << ' ' << aBody.size() << '\n' << aBody;
+    return response.str();
+}
+
+//! The largest fragment in bytes which a request may contain.
+static const size_t MAX_FRAGMENT_SIZE = 256 * 1024 * 1024;
+
+//! Constructor.
+ModelServerRunner::ModelServerRunner():
+mSingleScenario( ScenarioRunnerFactory::createSingleScenarioRunner() ),
+mNumUnsolved( 0 )
+{
+}
+
+//! Destructor.
+ModelServerRunner::~ModelServerRunner(){
+}
+
+const string& ModelServerRunner::getName() const {
+    return getXMLNameStatic();
+}
+
+bool ModelServerRunner::XMLParse( const DOMNode* ){
+    // No data to parse.
+    return true;
+}
+
+/*!
+ * \brief Parse the base scenario which is kept for the life of the server.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \param aName A name to add on to the name of every requested scenario.
+ * \param aScenComponents Scenario components to parse before the add-ons of
+ *        every request.
+ * \return Whether the base scenario was parsed.
+ */
+bool ModelServerRunner::setupScenarios( Timer& aTimer, const string aName,
+                                        const list<string> aScenComponents )
+{
+    mBaseName = aName;
+    mBaseComponents = aScenComponents;
+    const bool success = SingleScenarioRunner::parseSharedBaseScenario();
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::DEBUG );
+    aTimer.print( mainLog, "XML Readin Time:" );
+    return success;
+}
+
+/*!
+ * \brief Serve requests until a shutdown request is received.
+ * \param aSinglePeriod The default last period to run for each request.
+ * \param aPrintDebugging This parameter is ignored, requests do not print
+ *        debugging information.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether the server shut down cleanly and all requests solved.
+ */
+bool ModelServerRunner::runScenarios( const int aSinglePeriod,
+                                      const bool,
+                                      Timer& )
+{
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+#if !defined( WIN32 )
+    if( !ForkedTaskRunner::isSupported() ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Server mode is not supported in this build." << endl;
+        return false;
+    }
+
+    const string socketName = Configuration::getInstance()->getString( "server-socket", "gcam.sock" );
+    sockaddr_un address;
+    memset( &address, 0, sizeof( address ) );
+    if( socketName.size() >= sizeof( address.sun_path ) ) {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Server socket name " << socketName << " is too long." << endl;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    strncpy( address.sun_path, socketName.c_str(), sizeof( address.sun_path ) - 1 );
+
+    const int listenFD = socket( AF_UNIX, SOCK_STREAM, 0 );
+    // Remove a socket left behind by a previous server.
+    unlink( socketName.c_str() );
+    if( listenFD < 0 || bind( listenFD, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) != 0
+        || listen( listenFD, 5 ) != 0 )
+    {
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Could not listen on server socket " << socketName << ": " << strerror( errno ) << endl;
+        if( listenFD >= 0 ) {
+            close( listenFD );
+        }
+        return false;
+    }
+
+    // A client which disconnects before reading its response must not stop
+    // the server.
+    signal( SIGPIPE, SIG_IGN );
+
+    mainLog.setLevel( ILogger::WARNING );
+    mainLog << "Listening for requests on server socket " << socketName << "." << endl;
+
+    bool shutdown = false;
+    while( !shutdown ) {
+        const int connection = accept( listenFD, 0, 0 );
+        if( connection < 0 ) {
+            if( errno == EINTR ) {
+                continue;
+            }
+            mainLog.setLevel( ILogger::SEVERE );
+            mainLog << "Could not accept a connection: " << strerror( errno ) << endl;
+            break;
+        }
+        if( !serveConnection( connection, aSinglePeriod, shutdown ) ) {
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "A client disconnected before reading its response." << endl;
+        }
+        close( connection );
+    }
+    close( listenFD );
+    unlink( socketName.c_str() );
+
+    mainLog.setLevel( ILogger::WARNING );
+    mainLog << "Server shutting down, " << mNumUnsolved << " requests did not solve." << endl;
+    return shutdown && mNumUnsolved == 0;
+#else
+    mainLog.setLevel( ILogger::SEVERE );
+    mainLog << "Server mode is not supported on this platform." << endl;
+    return false;
+#endif
+}
+
+/*!
+ * \brief Read and run requests from a connection until it is closed.
+ * \param aConnection The connected socket.
+ * \param aDefaultStopPeriod The last period to run if a request does not
+ *        give one.
+ * \param aShutdown Set to true if a shutdown request was received.
+ * \return Whether all responses were sent.
+ */
+bool ModelServerRunner::serveConnection( const int aConnection, const int aDefaultStopPeriod,
+                                         bool& aShutdown )
+{
+#if !defined( WIN32 )
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    ConnectionReader reader( aConnection );
+    while( true ) {
+        Request request;
+        request.mStopPeriod = aDefaultStopPeriod;
+        bool run = false;
+        string error;
+        while( !run ) {
+            string line;
+            if( !reader.readLine( line ) ) {
+                return true;
+            }
+            istringstream commandStream( line );
+            string command;
+            commandStream >> command;
+            string argument;
+            getline( commandStream >> ws, argument );
+            if( command.empty() ) {
+                continue;
+            }
+            else if( command == "component" ) {
+                request.mComponents.push_back( argument );
+            }
+            else if( command == "fragment" ) {
+                // Only digits are accepted since a negative size would be
+                // converted to a very large unsigned value.
+                istringstream sizeStream( argument );
+                size_t size = 0;
+                if( argument.empty() || argument.find_first_not_of( "0123456789" ) != string::npos
+                    || !( sizeStream >> size ) )
+                {
+                    // The length of the payload is unknown so it can not be
+                    // skipped and the rest of the connection can not be read.
+                    writeAll( aConnection, createResponse( "error", "Invalid fragment size " + argument
+                                                           + ", closing the connection." ) );
+                    return true;
+                }
+                if( size > MAX_FRAGMENT_SIZE ) {
+                    error = "Fragment size " + argument + " is larger than the maximum of "
+                            + util::toString( MAX_FRAGMENT_SIZE ) + ".";
+                    if( !reader.skipBytes( size ) ) {
+                        return true;
+                    }
+                    continue;
+                }
+                string fragment;
+                if( !reader.readBytes( size, fragment ) ) {
+                    return true;
+                }
+                request.mFragments.push_back( fragment );
+            }
+            else if( command == "name" ) {
+                request.mName = argument;
+            }
+            else if( command == "stop-period" ) {
+                istringstream periodStream( argument );
+                if( !( periodStream >> request.mStopPeriod ) ) {
+                    error = "Invalid stop period " + argument + ".";
+                }
+            }
+            else if( command == "run" ) {
+                run = true;
+            }
+            else if( command == "shutdown" ) {
+                aShutdown = true;
+                return true;
+            }
+            else {
+                error = "Unknown command " + command + ".";
+            }
+        }
+
+        if( !error.empty() ) {
+            mResponse = createResponse( "error", error );
+        }
+        else {
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "Running a request with " << request.mComponents.size() << " add-on files and "
+                    << request.mFragments.size() << " fragments." << endl;
+            mCurrentRequest = request;
+            mResponse.clear();
+            ForkedTaskRunner::run( *this, 1, 1 );
+        }
+        if( !writeAll( aConnection, mResponse ) ) {
+            return false;
+        }
+    }
+#else
+    return false;
+#endif
+}
+
+/*!
+ * \brief Run the current request in a forked copy of the server.
+ * \details The forked copy takes the shared base scenario, parses the add-ons
+ *          and runs the scenario.
+ * \param aTaskIndex The index of the task, which is always zero.
+ * \param aResult The response to send to the client.
+ * \return Whether the scenario solved.
+ */
+bool ModelServerRunner::runInChild( const int, string& aResult ) {
+    list<string> components = mBaseComponents;
+    components.insert( components.end(), mCurrentRequest.mComponents.begin(),
+                       mCurrentRequest.mComponents.end() );
+    mSingleScenario->setInMemoryComponents( mCurrentRequest.mFragments );
+
+    Timer timer;
+    const bool setupSuccess = mSingleScenario->setupScenarios( timer, mBaseName + mCurrentRequest.mName,
+                                                               components );
+    if( !setupSuccess ) {
+        aResult = createResponse( "error", "Scenario setup failed." );
+        return false;
+    }
+
+    const bool success = mSingleScenario->runScenarios( mCurrentRequest.mStopPeriod, false, timer );
+    ostringstream csvOut;
+    BatchCSVOutputter csvOutputter( csvOut );
+    mSingleScenario->getInternalScenario()->accept( &csvOutputter, -1 );
+    csvOutputter.writeDidScenarioSolve( success );
+    aResult = createResponse( success ? "ok" : "unsolved", csvOut.str() );
+    return success;
+}
+
+/*!
+ * \brief Store the response to the current request.
+ * \param aTaskIndex The index of the task.
+ * \param aResult The response written by the child.
+ * \param aReceived Whether the child returned a response.
+ * \param aSucceeded Whether the scenario solved.
+ */
+void ModelServerRunner::collectResult( const int, const string& aResult,
+                                       const bool aReceived, const bool aSucceeded )
+{
+    if( !aReceived ) {
+        mResponse = createResponse( "error", "The model process failed before returning results." );
+    }
+    else {
+        mResponse = aResult;
+    }
+    if( !aSucceeded ) {
+        ++mNumUnsolved;
+    }
+}
+
+//! Nothing is printed since the results of each request are sent to the client.
+void ModelServerRunner::printOutput( Timer&, const bool ) const {
+}
+
+void ModelServerRunner::cleanup() {
+    SingleScenarioRunner::clearSharedBaseScenario();
+}
+
+Scenario* ModelServerRunner::getInternalScenario(){
+    return mSingleScenario->getInternalScenario();
+}
+
+const Scenario* ModelServerRunner::getInternalScenario() const {
+    return mSingleScenario->getInternalScenario();
+}
+
+/*!
+ * \brief Get the XML name of the class.
+ * \return The XML name of the class.
+ */
+const string& ModelServerRunner::getXMLNameStatic(){
+    static const string XML_NAME = "model-server-runner";
+    return XML_NAME;
+}
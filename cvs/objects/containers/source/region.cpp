@@ -347,12 +347,16 @@ void Region::accept( IVisitor* aVisitor, const int aPeriod ) const {
 
     // loop for supply sectors
     for( CSectorIterator currSec = supplySector.begin(); currSec != supplySector.end(); ++currSec ){
-        (*currSec)->accept( aVisitor, aPeriod );
+        if( aVisitor->shouldVisitSector( (*currSec)->getName() ) ) {
+            (*currSec)->accept( aVisitor, aPeriod );
+        }
     }
     
     // loop for resources.
     for( CResourceIterator currResource = mResources.begin(); currResource != mResources.end(); ++currResource ){
-        (*currResource)->accept( aVisitor, aPeriod );
+        if( aVisitor->shouldVisitSector( (*currResource)->getName() ) ) {
+            (*currResource)->accept( aVisitor, aPeriod );
+        }
     }
 
     aVisitor->endVisitRegion( this, aPeriod );
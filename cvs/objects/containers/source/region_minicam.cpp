@@ -926,7 +926,9 @@ void RegionMiniCAM::accept( IVisitor* aVisitor, const int aPeriod ) const {
 
     // loop for final demand sectors.
     for( CFinalDemandIterator currDem = mFinalDemands.begin(); currDem != mFinalDemands.end(); ++currDem ){
-        (*currDem)->accept( aVisitor, aPeriod );
+        if( aVisitor->shouldVisitSector( (*currDem)->getName() ) ) {
+            (*currDem)->accept( aVisitor, aPeriod );
+        }
     }
 
     // Visit Consumers
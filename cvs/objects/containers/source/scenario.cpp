@@ -64,6 +64,7 @@
 #include "solution/solvers/include/solver_factory.h"
 #include "solution/solvers/include/bisection_nr_solver.h"
 #include "solution/util/include/solution_info_param_parser.h" 
+#include "solution/util/include/solution_sensitivity.h"
 
 #if GCAM_PARALLEL_ENABLED && PARALLEL_DEBUG
 #include <stdlib.h>
@@ -157,6 +158,11 @@ bool Scenario::XMLParse( const DOMNode* node ){
         }
         else if ( nodeName == World::getXMLNameStatic() ){
             parseSingleNode( curr, world, new World );
+            // Stop if the world could not find all regions needed by the
+            // region subset.
+            if( world.get() && world->hasRegionSubsetError() ) {
+                return false;
+            }
         }
         else if( nodeName == OutputMetaData::getXMLNameStatic() ) {
             parseSingleNode( curr, mOutputMetaData, new OutputMetaData );
@@ -253,6 +259,9 @@ void Scenario::completeInit() {
     // Set the valid period vector to false.
     mIsValidPeriod.clear();
     mIsValidPeriod.resize( modeltime->getmaxper(), false );
+
+    // Sensitivities from a previous scenario do not apply to this one.
+    SolutionSensitivity::getInstance().clear();
 }
 
 //! Write object to xml output stream.
@@ -323,6 +332,7 @@ bool Scenario::run( const int aSinglePeriod,
     // time steps and operate model.
     if( aSinglePeriod == RUN_ALL_PERIODS ){
         for( int per = 0; per < modeltime->getmaxper(); per++ ){
+            invalidatePeriod( per );
             success &= calculatePeriod( per, *XMLDebugFile, *SGMDebugFile, &tabs, aPrintDebugging );
         }
     }
@@ -343,7 +353,7 @@ bool Scenario::run( const int aSinglePeriod,
         
         // Invalidate the period about to be run and all periods past it.
         for( int per = aSinglePeriod; per < modeltime->getmaxper(); ++per ){
-            mIsValidPeriod[ per ] = false;
+            invalidatePeriod( per );
         }
 
         // Now run the requested period. Results past this period will no longer
@@ -655,6 +665,13 @@ const IClimateModel* Scenario::getClimateModel() const {
     return world->getClimateModel();
 }
 
+/*! \brief Run the climate parameter ensemble over the final emissions.
+* \pre The scenario has been run.
+*/
+void Scenario::runClimateEnsemble() {
+    world->runClimateEnsemble();
+}
+
 /*! \brief A function to generate a series of ghg emissions quantity curves
 *          based on an already performed model run.
 * \details This function used the information stored in it to create a series of
@@ -845,9 +862,11 @@ const vector<int>& Scenario::getUnsolvedPeriods() const {
 /*!
  * \brief Reset the flag which indicates if a model period should be
  *        recalculated to force it to do so the next time run is called.
+ * \details Any solution sensitivities kept for the period are dropped.
  * \param aPeriod The model period to invalidate.
  */
 void Scenario::invalidatePeriod( const int aPeriod ) {
     mIsValidPeriod[ aPeriod ] = false;
+    SolutionSensitivity::getInstance().invalidatePeriod( aPeriod );
 }
 
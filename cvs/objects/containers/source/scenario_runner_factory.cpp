@@ -49,7 +49,9 @@
 #include "containers/include/merge_runner.h"
 #include "containers/include/single_scenario_runner.h"
 #include "containers/include/batch_runner.h"
+#include "containers/include/ensemble_runner.h"
 #include "containers/include/mac_generator_scenario_runner.h"
+#include "containers/include/model_server_runner.h"
 #include "target_finder/include/policy_target_runner.h"
 #include "target_finder/include/simple_policy_target_runner.h"
 
@@ -67,6 +69,8 @@ bool ScenarioRunnerFactory::isOfType( const string& aType ) {
         || ( aType == SingleScenarioRunner::getXMLNameStatic() )
         || ( aType == MACGeneratorScenarioRunner::getXMLNameStatic() )
         || ( aType == BatchRunner::getXMLNameStatic() )
+        || ( aType == ModelServerRunner::getXMLNameStatic() )
+        || ( aType == EnsembleRunner::getXMLNameStatic() )
         || ( aType == PolicyTargetRunner::getXMLNameStatic() )
         || ( aType == SimplePolicyTargetRunner::getXMLNameStatic() ) );
 }
@@ -91,6 +95,12 @@ auto_ptr<IScenarioRunner> ScenarioRunnerFactory::create( const string& aType ) {
     if( aType == BatchRunner::getXMLNameStatic() ){
         return auto_ptr<IScenarioRunner>( new BatchRunner );
     }
+    if( aType == ModelServerRunner::getXMLNameStatic() ){
+        return auto_ptr<IScenarioRunner>( new ModelServerRunner );
+    }
+    if( aType == EnsembleRunner::getXMLNameStatic() ){
+        return auto_ptr<IScenarioRunner>( new EnsembleRunner );
+    }
     if( aType == PolicyTargetRunner::getXMLNameStatic() ){
         return auto_ptr<IScenarioRunner>( new PolicyTargetRunner );
     }
@@ -135,6 +145,16 @@ auto_ptr<IScenarioRunner> ScenarioRunnerFactory::createDefault( const list<strin
     {
         defaultRunner.reset( new BatchRunner );
     }
+    else if( conf->getBool( "server-mode", false, false )
+        && !isExcluded( aExcludedTypes, ModelServerRunner::getXMLNameStatic() ) )
+    {
+        defaultRunner.reset( new ModelServerRunner );
+    }
+    else if( conf->getBool( "ensemble-mode", false, false )
+        && !isExcluded( aExcludedTypes, EnsembleRunner::getXMLNameStatic() ) )
+    {
+        defaultRunner.reset( new EnsembleRunner );
+    }
     else if( conf->getBool( "find-path", false, false )
         && !isExcluded( aExcludedTypes, PolicyTargetRunner::getXMLNameStatic() ) )
     {
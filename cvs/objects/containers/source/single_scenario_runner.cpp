@@ -44,6 +44,7 @@
 #include "containers/include/single_scenario_runner.h"
 #include "containers/include/scenario.h"
 #include "util/base/include/xml_helper.h"
+#include "util/base/include/xml_parse_cache.h"
 #include "util/base/include/configuration.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/configuration.h"
@@ -51,6 +52,7 @@
 #include "util/logger/include/ilogger.h"
 #include "util/logger/include/logger_factory.h"
 #include "reporting/include/xml_db_outputter.h"
+#include "reporting/include/async_output_writer.h"
 
 using namespace std;
 using namespace xercesc;
@@ -64,6 +66,8 @@ extern void closeDB();
 extern void openDB();
 extern void createDBout();
 
+auto_ptr<Scenario> SingleScenarioRunner::sSharedBaseScenario;
+
 /*! \brief Constructor */
 SingleScenarioRunner::SingleScenarioRunner(){
     mXMLDBOutputter = 0;
@@ -91,49 +95,54 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
                                            const string aName,
                                            const list<string> aScenComponents )
 {
-    // Ensure that a new scenario is created for each run.
-    mScenario.reset( new Scenario );
+    // Ensure that a new scenario is created for each run, starting from the
+    // shared base if one was parsed.
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    const bool useSharedBase = sSharedBaseScenario.get() != 0;
+    if( useSharedBase ) {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Using the previously parsed base scenario." << endl;
+        mScenario = sSharedBaseScenario;
+    }
+    else {
+        mScenario.reset( new Scenario );
+    }
 
     // Set the global scenario pointer.
     // TODO: Remove global scenario pointer.
     scenario = mScenario.get();
 
-    // Parse the input file.
+    // Parse the input file and configured scenario components.
     const Configuration* conf = Configuration::getInstance();
-    bool success =
-        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
-                                   mScenario.get() );
-    
-    // Check if parsing succeeded.
-    if( !success ){
+    if( !useSharedBase && !parseBaseInputs( mScenario.get() ) ){
         return false;
     }
 
-    // Fetch the listing of Scenario Components.
-    list<string> scenComponents = conf->getScenarioComponents();
-
-    // Add on any scenario components that were passed in.
-    for( list<string>::const_iterator curr = aScenComponents.begin();
-		curr != aScenComponents.end(); ++curr )
-	{
-        scenComponents.push_back( *curr );
-    }
-    
-    // Iterate over the vector.
+    // Parse any scenario components that were passed in.
     typedef list<string>::const_iterator ScenCompIter;
-    ILogger& mainLog = ILogger::getLogger( "main_log" );
-    for( ScenCompIter currComp = scenComponents.begin();
-		 currComp != scenComponents.end(); ++currComp )
+    for( ScenCompIter currComp = aScenComponents.begin();
+		 currComp != aScenComponents.end(); ++currComp )
 	{
         mainLog.setLevel( ILogger::NOTICE );
         mainLog << "Parsing " << *currComp << " scenario component." << endl;
-        success = XMLHelper<void>::parseXML( *currComp, mScenario.get() );
+        const bool success = XMLHelper<void>::parseXML( *currComp, mScenario.get() );
         
         // Check if parsing succeeded.
         if( !success ){
             return false;
         }
     }
+
+    // Parse any scenario components which were given as XML documents.
+    for( ScenCompIter currComp = mInMemoryComponents.begin();
+         currComp != mInMemoryComponents.end(); ++currComp )
+    {
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing in-memory scenario component." << endl;
+        if( !XMLHelper<void>::parseXMLString( *currComp, mScenario.get() ) ){
+            return false;
+        }
+    }
     
     // Override scenario name from data file with that from configuration file
     const string overrideName = conf->getString( "scenarioName" ) + aName;
@@ -143,6 +152,9 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
 
     mainLog.setLevel( ILogger::NOTICE );
     mainLog << "XML parsing complete." << endl;
+    if( XMLParseCache::getInstance().isEnabled() ) {
+        XMLParseCache::getInstance().printStatistics( mainLog );
+    }
 
     // Add to all loggers that a new scenario is starting so that users may more
     // easily parse which scenario the messages pertain to.
@@ -159,6 +171,82 @@ bool SingleScenarioRunner::setupScenarios( Timer& timer,
     return true;
 }
 
+/*!
+ * \brief Parse the base input file and the scenario components listed in the
+ *        configuration into a scenario.
+ * \param aScenario The scenario to parse into.
+ * \return Whether parsing succeeded.
+ */
+bool SingleScenarioRunner::parseBaseInputs( Scenario* aScenario ) {
+    // Parse the input file.
+    const Configuration* conf = Configuration::getInstance();
+    bool success =
+        XMLHelper<void>::parseXML( conf->getFile( "xmlInputFileName" ),
+                                   aScenario );
+    
+    // Check if parsing succeeded.
+    if( !success ){
+        return false;
+    }
+
+    // Fetch the listing of Scenario Components.
+    const list<string> scenComponents = conf->getScenarioComponents();
+
+    // Iterate over the vector.
+    typedef list<string>::const_iterator ScenCompIter;
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    for( ScenCompIter currComp = scenComponents.begin();
+		 currComp != scenComponents.end(); ++currComp )
+	{
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Parsing " << *currComp << " scenario component." << endl;
+        success = XMLHelper<void>::parseXML( *currComp, aScenario );
+        
+        // Check if parsing succeeded.
+        if( !success ){
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Parse the base input file and configured scenario components once
+ *        for use by the next setupScenarios call.
+ * \details This is only useful before forking processes which each set up a
+ *          scenario, since setupScenarios takes ownership of the base. Each
+ *          forked process gets its own copy of the base which shares memory
+ *          with the parent until it is modified.
+ * \return Whether parsing succeeded. If it did not no base is kept.
+ */
+bool SingleScenarioRunner::parseSharedBaseScenario() {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Parsing the shared base scenario." << endl;
+
+    // Parsing may use the global scenario pointer, so point it at the base
+    // while it is parsed.
+    Scenario* previousScenario = scenario;
+    sSharedBaseScenario.reset( new Scenario );
+    scenario = sSharedBaseScenario.get();
+    const bool success = parseBaseInputs( sSharedBaseScenario.get() );
+    scenario = previousScenario;
+    if( !success ) {
+        sSharedBaseScenario.reset( 0 );
+    }
+    return success;
+}
+
+/*!
+ * \brief Free the shared base scenario if it was not used.
+ */
+void SingleScenarioRunner::clearSharedBaseScenario() {
+    Scenario* previousScenario = scenario;
+    scenario = sSharedBaseScenario.get();
+    sSharedBaseScenario.reset( 0 );
+    scenario = previousScenario;
+}
+
 bool SingleScenarioRunner::runScenarios( const int aSinglePeriod,
                                         const bool aPrintDebugging,
                                         Timer& aTimer )
@@ -205,13 +293,29 @@ void SingleScenarioRunner::printOutput( Timer& aTimer, const bool aCloseDB ) con
     writeTimer.start();
     
     // Print output xml file.
-    AutoOutputFile xmlOut( "xmlOutputFileName", "output.xml" );
+    AsyncOutputWriter& outputWriter = AsyncOutputWriter::getInstance();
     Tabs tabs;
-    mScenario->toInputXML( *xmlOut, &tabs );
+    if( outputWriter.isEnabled() ) {
+        // Generate the XML in memory so that the file can be written in the
+        // background.
+        auto_ptr<FileOutputBlock> xmlOut( new FileOutputBlock( "xmlOutputFileName", "output.xml" ) );
+        if( xmlOut->shouldWrite() ) {
+            mScenario->toInputXML( **xmlOut, &tabs );
+            outputWriter.submit( xmlOut.release() );
+        }
+    }
+    else {
+        AutoOutputFile xmlOut( "xmlOutputFileName", "output.xml" );
+        mScenario->toInputXML( *xmlOut, &tabs );
+    }
 
     // Write csv file output
     mScenario->writeOutputFiles();
 
+    // The climate ensemble is run once over the final emissions rather than
+    // every time the climate model runs.
+    mScenario->runClimateEnsemble();
+
     static const bool printDB = Configuration::getInstance()->shouldWriteFile( "dbFileName" );
     if( printDB ){
         // Perform the database output. 
@@ -282,6 +386,18 @@ const Scenario* SingleScenarioRunner::getInternalScenario() const {
 	return mScenario.get();
 }
 
+/*!
+ * \brief Set scenario components given as XML documents which are parsed by
+ *        setupScenarios after all scenario components read from files.
+ * \details This allows values generated for a single run to be added to the
+ *          scenario without writing them to files.
+ * \param aXMLDocuments The XML documents to parse, replacing any previously
+ *        set.
+ */
+void SingleScenarioRunner::setInMemoryComponents( const list<string>& aXMLDocuments ) {
+    mInMemoryComponents = aXMLDocuments;
+}
+
 /*!
  * \brief Get the refernce to the XMLDBOutputter.
  * \return The XMLDBOutputter.
@@ -41,7 +41,12 @@
 #include "util/base/include/definitions.h"
 #include <cassert>
 #include <vector>
+#include <set>
 #include <string>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
 #include "containers/include/scenario.h"
 #include "containers/include/world.h"
 #include "util/base/include/util.h"
@@ -60,24 +65,97 @@
 #include "containers/include/single_scenario_runner.h"
 #include "policy/include/policy_ghg.h"
 #include "reporting/include/xml_db_outputter.h"
+#include "util/base/include/forked_task_runner.h"
+#include "util/base/include/timer.h"
+#include "solution/util/include/solution_sensitivity.h"
 
 using namespace std;
 using namespace xercesc;
 
 /*! \brief Constructor.
+* \details Calculates the curve for the first gas listed in the configuration.
 * \param aSingleScenario The single scenario runner.
 */
 TotalPolicyCostCalculator::TotalPolicyCostCalculator( SingleScenarioRunner* aSingleScenario ){
+    mGHGName = getAbatedGasNames().front();
+    init( aSingleScenario );
+}
+
+/*! \brief Constructor.
+* \param aSingleScenario The single scenario runner.
+* \param aGHGName The name of the gas for which to calculate the curve.
+*/
+TotalPolicyCostCalculator::TotalPolicyCostCalculator( SingleScenarioRunner* aSingleScenario,
+                                                      const string& aGHGName )
+{
+    mGHGName = aGHGName;
+    init( aSingleScenario );
+}
+
+/*! \brief Initialize the members shared by the constructors.
+* \param aSingleScenario The single scenario runner.
+*/
+void TotalPolicyCostCalculator::init( SingleScenarioRunner* aSingleScenario ) {
     assert( aSingleScenario );
     mSingleScenario = aSingleScenario;
     mGlobalCost = 0;
     mGlobalDiscountedCost = 0;
     mRanCosts = false;
+    mWorkersSucceeded = true;
+    mPointRunTime = 0;
 
     // Get the variables from the configuration.
     const Configuration* conf = Configuration::getInstance();
-    mGHGName = conf->getString( "AbatedGasForCostCurves", "CO2" );
     mNumPoints = conf->getInt( "numPointsForCO2CostCurve", 5 );
+    mWarmStart = conf->getBool( "cost-curve-warm-start", false, false );
+    mUsePredictor = mWarmStart && conf->getBool( "cost-curve-predictor", false, false );
+    mSensitivityRegions.clear();
+}
+
+/*! \brief Register the policy markets for the gas as directions of the
+*          solution sensitivity.
+* \details The sensitivities must be calculated while the base scenario solves,
+*          so this must be called after the scenario is set up and before the
+*          base scenario is run. One region is registered for each distinct
+*          market for the gas. Does nothing unless the predictor is enabled.
+*/
+void TotalPolicyCostCalculator::addSensitivityDirections() {
+    if( !mUsePredictor ) {
+        return;
+    }
+    const Marketplace* marketplace = mSingleScenario->getInternalScenario()->getMarketplace();
+    const map<string, int> regionMap = mSingleScenario->getInternalScenario()->getWorld()->getOutputRegionMap();
+    set<const IInfo*> policyMarkets;
+    for( map<string, int>::const_iterator iter = regionMap.begin(); iter != regionMap.end(); ++iter ) {
+        // Regions which share a market share its information object.
+        const IInfo* marketInfo = marketplace->getMarketInfo( mGHGName, iter->first, 1, false );
+        if( marketInfo && policyMarkets.insert( marketInfo ).second ) {
+            mSensitivityRegions.push_back( iter->first );
+            SolutionSensitivity::getInstance().addDirection( iter->first, mGHGName );
+        }
+    }
+}
+
+/*! \brief Get the names of the gases for which to calculate cost curves.
+* \details The names are read from the AbatedGasForCostCurves configuration
+*          value and may be separated by commas or white space.
+* \return The gas names, which will contain at least one gas.
+*/
+vector<string> TotalPolicyCostCalculator::getAbatedGasNames() {
+    string gasList = Configuration::getInstance()->getString( "AbatedGasForCostCurves", "CO2" );
+    replace( gasList.begin(), gasList.end(), ',', ' ' );
+    istringstream gasStream( gasList );
+    vector<string> gasNames;
+    string gasName;
+    while( gasStream >> gasName ) {
+        if( find( gasNames.begin(), gasNames.end(), gasName ) == gasNames.end() ) {
+            gasNames.push_back( gasName );
+        }
+    }
+    if( gasNames.empty() ) {
+        gasNames.push_back( "CO2" );
+    }
+    return gasNames;
 }
 
 //! Destructor. Deallocated memory for all the curves created. 
@@ -117,11 +195,37 @@ TotalPolicyCostCalculator::~TotalPolicyCostCalculator(){
 bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
     // If there is no policy market, the model will not create cost curves and 
     // will leave mRanCosts as false. This will prevent the cost curves from printing.
+    if( !startAbatementCostCurve() ){
+        return true;
+    }
+
+    // Run the trials and store the cost curves.
+    bool success = runTrials();
+    
+    finishAbatementCostCurve();
+
+    // Return whether all trials completed successfully.
+    return success;
+}
+
+/*! \brief Store the curves and prices of the solved policy scenario.
+* \details This must be called while the internal scenario still contains the
+*          solved policy run, before any points are run for this or any other
+*          gas.
+* \return Whether there is a policy market for the gas, and so a cost curve to
+*         calculate.
+*/
+bool TotalPolicyCostCalculator::startAbatementCostCurve() {
+    // The base scenario has solved, the points do not need sensitivities.
+    for( unsigned int i = 0; i < mSensitivityRegions.size(); ++i ) {
+        SolutionSensitivity::getInstance().removeDirection( mSensitivityRegions[ i ], mGHGName );
+    }
+
     if( mSingleScenario->getInternalScenario()->getMarketplace()->getPrice( mGHGName, "USA", 1 ) == Marketplace::NO_MARKET_PRICE ){
         ILogger& mainLog = ILogger::getLogger( "main_log" );
         mainLog.setLevel( ILogger::NOTICE );
-        mainLog << "Skipping cost curve calculations for non-policy model run." << endl;
-        return true;
+        mainLog << "Skipping " << mGHGName << " cost curve calculations for non-policy model run." << endl;
+        return false;
     }
 
     // Set the size of the emissions curve vectors to the number of trials plus 1 for the base.
@@ -131,19 +235,42 @@ bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
     // Get prices and emissions for the primary scenario run.
     mEmissionsQCurves[ mNumPoints ] = mSingleScenario->getInternalScenario()->getEmissionsQuantityCurves( mGHGName );
     mEmissionsTCurves[ mNumPoints ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
-    
-    // Run the trials and store the cost curves.
-    bool success = runTrials();
-    
+
+    mPointPrices.clear();
+    if( mWarmStart ) {
+        storePointPrices( mNumPoints );
+    }
+    mWorkersSucceeded = true;
+    return true;
+}
+
+/*! \brief Create the cost curves and total costs once all points have been
+*          run.
+*/
+void TotalPolicyCostCalculator::finishAbatementCostCurve() {
     // Create a cost curve for each period and region.
     createCostCurvesByPeriod();
 
     // Create a cost curve for each region and find regional and global costs.
     createRegionalCostCurves();
 
-    // Return whether all trials completed successfully.
     mRanCosts = true;
-    return success;
+}
+
+/*! \brief Get the number of points run to calculate the curve.
+* \return The number of points, not including the base scenario.
+*/
+unsigned int TotalPolicyCostCalculator::getNumPoints() const {
+    return mNumPoints;
+}
+
+/*! \brief Get the total time spent running points.
+* \details Points run in worker processes are included, so this is an
+*          estimate of the time running all points serially would take.
+* \return The time in seconds.
+*/
+double TotalPolicyCostCalculator::getPointRunTime() const {
+    return mPointRunTime;
 }
 
 /*! \brief Run a trial for each point and store the abatement curves.
@@ -151,14 +278,21 @@ bool TotalPolicyCostCalculator::calculateAbatementCostCurve() {
 * on the trial number and the total number of points, so that the data points are equally
 * distributed from 0 to the full carbon tax for each period. It then calculates and 
 * sets the fixed tax for each year. The scenario is then run, and the emissions and 
-* tax curves are stored for each region.
+* tax curves are stored for each region. If more than one cost curve worker process
+* is configured the trials are run in forked worker processes instead.
 * \return Whether all model runs completed successfully.
 * \author Josh Lurz
 */
 bool TotalPolicyCostCalculator::runTrials(){
-    // Get the number of max periods.
-    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
-    const int maxPeriod = modeltime->getmaxper();
+    const int numWorkers = Configuration::getInstance()->getInt( "cost-curve-worker-processes", 1, false );
+    if( numWorkers > 1 ) {
+        if( ForkedTaskRunner::isSupported() ) {
+            return runTrialsInWorkers( vector<TotalPolicyCostCalculator*>( 1, this ), numWorkers );
+        }
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Cost curve worker processes are not supported in this build, running points serially." << endl;
+    }
 
     bool success = true;
     const static bool usingRestartPeriod = Configuration::getInstance()->getInt(
@@ -169,50 +303,446 @@ bool TotalPolicyCostCalculator::runTrials(){
     }
     // Loop through for each point.
     for( int currPoint = mNumPoints - 1; currPoint >= 0; currPoint-- ){
-        // Determine the fraction of the full tax this tax will be.
-        const double fraction = static_cast<double>( currPoint ) / static_cast<double>( mNumPoints );
-        // Iterate through the regions to set different taxes for each if necessary.
-        // Currently this will set the same for all of them.
-        for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
-            // Vector which will contain taxes for this trial.
-            vector<double> currTaxes( maxPeriod );
-
-            // Set the tax for each year. 
-            for( int per = 0; per < maxPeriod; per++ ){
-                const int year = modeltime->getper_to_yr( per );
-                double origTax = rIter->second->getY( year );
-                currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
-                    origTax * fraction;
+        success &= runTrial( currPoint );
+
+        // Restore original solved market prices after each cost iteration to ensure same
+        // starting prices for each iteration.  This is necessary due to changing initial prices.
+        if( !usingRestartPeriod || ( currPoint - 1 ) == 0 ) {
+            mSingleScenario->getInternalScenario()->getMarketplace()->restore_prices_for_cost_calculation();
+        }
+    }
+
+    // Leave the full taxes in place so that curves for other gases are run
+    // against the full policy.
+    setPointTaxes( mNumPoints );
+    return success;
+}
+
+/*! \brief Run the scenario for a single point and store the abatement curves.
+* \details Sets the fixed tax for each region to the fraction of the full tax
+*          for the point, runs the scenario, and stores the emissions and tax
+*          curves for the point. If warm starts are enabled the markets start
+*          from the solved prices of the nearest point already run.
+* \param aPoint The point number to run.
+* \return Whether the model run completed successfully.
+*/
+bool TotalPolicyCostCalculator::runTrial( const int aPoint ) {
+    setPointTaxes( aPoint );
+
+    // Create an ending for the output files using the run number.
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Starting " << mGHGName << " cost curve point run number " << aPoint << "." << endl;
+
+    Marketplace* marketplace = mSingleScenario->getInternalScenario()->getMarketplace();
+    if( mWarmStart ) {
+        seedPointPrices( aPoint );
+    }
+
+    // Run the scenario with the add-on extension to the output file names
+    // as the point number. This allows the output file to be named debug +
+    // point number.
+    Timer pointTimer;
+    pointTimer.start();
+    const bool success = mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, true,
+                                                                      util::toString( aPoint ) );
+    pointTimer.stop();
+    mPointRunTime += pointTimer.getTimeDifference();
+
+    if( mWarmStart ) {
+        marketplace->clearPriceGuesses();
+        if( success ) {
+            storePointPrices( aPoint );
+        }
+    }
+
+    // Save information.
+    mEmissionsQCurves[ aPoint ] = mSingleScenario->getInternalScenario()->getEmissionsQuantityCurves( mGHGName );
+    mEmissionsTCurves[ aPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+    return success;
+}
+
+/*! \brief Set the fixed taxes for a point.
+* \details Sets the tax for each region to the fraction of the full tax for
+*          the point. Setting the taxes for point mNumPoints restores the full
+*          policy.
+* \param aPoint The point for which to set taxes.
+*/
+void TotalPolicyCostCalculator::setPointTaxes( const int aPoint ) {
+    // Get the number of max periods.
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    const int maxPeriod = modeltime->getmaxper();
+
+    // Determine the fraction of the full tax this tax will be.
+    const double fraction = static_cast<double>( aPoint ) / static_cast<double>( mNumPoints );
+    // Iterate through the regions to set different taxes for each if necessary.
+    // Currently this will set the same for all of them.
+    for( CRegionCurvesIterator rIter = mEmissionsTCurves[ mNumPoints ].begin(); rIter != mEmissionsTCurves[ mNumPoints ].end(); ++rIter ){
+        // Vector which will contain taxes for this trial.
+        vector<double> currTaxes( maxPeriod );
+
+        // Set the tax for each year. 
+        for( int per = 0; per < maxPeriod; per++ ){
+            const int year = modeltime->getper_to_yr( per );
+            double origTax = rIter->second->getY( year );
+            currTaxes[ per ] = origTax == Marketplace::NO_MARKET_PRICE ? Marketplace::NO_MARKET_PRICE :
+                origTax * fraction;
+        }
+        // Set the fixed taxes into the world.
+        GHGPolicy tax( mGHGName, rIter->first, currTaxes );
+        mSingleScenario->getInternalScenario()->setTax( &tax );
+    }
+}
+
+/*! \brief Store the solved market prices of a point.
+* \param aPoint The point which was just run.
+*/
+void TotalPolicyCostCalculator::storePointPrices( const int aPoint ) {
+    const Scenario* scenario = mSingleScenario->getInternalScenario();
+    const int maxPeriod = scenario->getModeltime()->getmaxper();
+    vector<vector<double> >& prices = mPointPrices[ aPoint ];
+    prices.resize( maxPeriod );
+    for( int per = 0; per < maxPeriod; ++per ) {
+        prices[ per ] = scenario->getMarketplace()->getPrices( per );
+    }
+}
+
+/*! \brief Start the markets for a point from the prices of the nearest point
+*          which has been solved.
+* \details Neighbouring points differ only by a fraction of the tax, so their
+*          solved prices are a much closer starting point than the prices of
+*          the last point run.
+* \param aPoint The point about to be run.
+*/
+void TotalPolicyCostCalculator::seedPointPrices( const int aPoint ) {
+    PointPrices::const_iterator nearest = mPointPrices.end();
+    for( PointPrices::const_iterator iter = mPointPrices.begin(); iter != mPointPrices.end(); ++iter ) {
+        if( nearest == mPointPrices.end() ||
+            abs( iter->first - aPoint ) < abs( nearest->first - aPoint ) )
+        {
+            nearest = iter;
+        }
+    }
+    if( nearest == mPointPrices.end() ) {
+        return;
+    }
+    Marketplace* marketplace = mSingleScenario->getInternalScenario()->getMarketplace();
+    if( mUsePredictor && nearest->first == static_cast<int>( mNumPoints ) ) {
+        seedPredictedPrices( aPoint );
+        return;
+    }
+    for( unsigned int per = 0; per < nearest->second.size(); ++per ) {
+        marketplace->setPriceGuesses( per, nearest->second[ per ] );
+    }
+}
+
+/*! \brief Start the markets for a point from the prices predicted by the
+*          sensitivity of the base solution to the tax.
+* \details The predicted changes for each policy market of the gas are added
+*          together. Periods for which no sensitivity was calculated, such as
+*          those without a tax, start from the base prices.
+* \param aPoint The point about to be run.
+*/
+void TotalPolicyCostCalculator::seedPredictedPrices( const int aPoint ) {
+    const Modeltime* modeltime = mSingleScenario->getInternalScenario()->getModeltime();
+    Marketplace* marketplace = mSingleScenario->getInternalScenario()->getMarketplace();
+    const vector<vector<double> >& basePrices = mPointPrices[ mNumPoints ];
+    const RegionCurves& taxCurves = mEmissionsTCurves[ mNumPoints ];
+    const double fraction = static_cast<double>( aPoint ) / static_cast<double>( mNumPoints );
+    const SolutionSensitivity& sensitivity = SolutionSensitivity::getInstance();
+
+    unsigned int numPredicted = 0;
+    vector<double> prices;
+    for( unsigned int per = 0; per < basePrices.size(); ++per ) {
+        vector<double> seedPrices = basePrices[ per ];
+        bool predicted = false;
+        for( unsigned int i = 0; i < mSensitivityRegions.size(); ++i ) {
+            const CRegionCurvesIterator taxCurve = taxCurves.find( mSensitivityRegions[ i ] );
+            const double tax = taxCurve == taxCurves.end() ?
+                Marketplace::NO_MARKET_PRICE : taxCurve->second->getY( modeltime->getper_to_yr( per ) );
+            if( tax != Marketplace::NO_MARKET_PRICE &&
+                sensitivity.predictPrices( per, mSensitivityRegions[ i ], mGHGName, tax * fraction, prices ) &&
+                prices.size() == seedPrices.size() )
+            {
+                for( unsigned int j = 0; j < seedPrices.size(); ++j ) {
+                    seedPrices[ j ] += prices[ j ] - basePrices[ per ][ j ];
+                }
+                predicted = true;
             }
-            // Set the fixed taxes into the world.
-            GHGPolicy tax( mGHGName, rIter->first, currTaxes );
-            mSingleScenario->getInternalScenario()->setTax( &tax );
         }
+        marketplace->setPriceGuesses( per, seedPrices );
+        if( predicted ) {
+            ++numPredicted;
+        }
+    }
 
-        // Create an ending for the output files using the run number.
-        ILogger& mainLog = ILogger::getLogger( "main_log" );
-        mainLog.setLevel( ILogger::NOTICE );
-        mainLog << "Starting cost curve point run number " << currPoint << "." << endl;
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::DEBUG );
+    mainLog << "Predicted starting prices for " << numPredicted << " periods of " << mGHGName
+            << " cost curve point " << aPoint << "." << endl;
+}
 
-        // Run the scenario with the add-on extension to the output file names
-        // as the point number. This allows the output file to be named debug +
-        // point number.
-        success &= mSingleScenario->getInternalScenario()->run( Scenario::RUN_ALL_PERIODS, true,
-                                                                util::toString( currPoint ) );
+namespace {
+    /*!
+     * \brief Runs the points of several cost curve calculators as one set of
+     *        forked tasks.
+     * \details Tasks are numbered by calculator and then by point, and each
+     *          task is passed on to the calculator which owns it.
+     */
+    class CostCurvePointTasks: public IForkedTask {
+    public:
+        explicit CostCurvePointTasks( const vector<TotalPolicyCostCalculator*>& aCalculators )
+            :mCalculators( aCalculators ),
+            mNumPoints( aCalculators.front()->getNumPoints() ) {}
+
+        int getNumTasks() const {
+            return static_cast<int>( mCalculators.size() * mNumPoints );
+        }
 
-        // Save information.
-        mEmissionsQCurves[ currPoint ] = mSingleScenario->getInternalScenario()->getEmissionsQuantityCurves( mGHGName );
-        mEmissionsTCurves[ currPoint ] = mSingleScenario->getInternalScenario()->getEmissionsPriceCurves( mGHGName );
+        virtual bool runInChild( const int aTaskIndex, string& aResult ) {
+            return mCalculators[ aTaskIndex / mNumPoints ]->runInChild( aTaskIndex % mNumPoints, aResult );
+        }
 
-        // Restore original solved market prices after each cost iteration to ensure same
-        // starting prices for each iteration.  This is necessary due to changing initial prices.
-        if( !usingRestartPeriod || ( currPoint - 1 ) == 0 ) {
-            mSingleScenario->getInternalScenario()->getMarketplace()->restore_prices_for_cost_calculation();
+        virtual void collectResult( const int aTaskIndex, const string& aResult,
+                                    const bool aReceived, const bool aSucceeded )
+        {
+            mCalculators[ aTaskIndex / mNumPoints ]->collectResult( aTaskIndex % mNumPoints, aResult,
+                                                                    aReceived, aSucceeded );
         }
+    private:
+        //! The calculators for which to run points, which are weak references.
+        const vector<TotalPolicyCostCalculator*>& mCalculators;
+
+        //! The number of points for each calculator.
+        const int mNumPoints;
+    };
+}
+
+/*! \brief Run the trials of one or more calculators in parallel in forked
+*          worker processes.
+* \details Each worker is forked from the solved base scenario so that it
+*          shares the model state with the parent copy-on-write and starts
+*          from the solved prices. The worker runs a single point of a single
+*          gas and sends the emissions and tax curves back to the parent.
+*          Points which could not be run in a worker are run serially instead.
+*          The calculators must all have been started and must use the same
+*          number of points.
+* \param aCalculators The calculators for which to run all points.
+* \param aNumWorkers The maximum number of worker processes to run at once.
+* \return Whether all model runs completed successfully.
+*/
+bool TotalPolicyCostCalculator::runTrialsInWorkers( const vector<TotalPolicyCostCalculator*>& aCalculators,
+                                                    const int aNumWorkers )
+{
+    if( aCalculators.empty() ) {
+        return true;
+    }
+    CostCurvePointTasks tasks( aCalculators );
+
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Running " << tasks.getNumTasks() << " cost curve points for " << aCalculators.size()
+            << " gases in up to " << aNumWorkers << " worker processes." << endl;
+
+    // Store the solved prices so that points which fail in a worker can be
+    // rerun in this process from the same starting point.
+    aCalculators.front()->mSingleScenario->getInternalScenario()->getMarketplace()->store_prices_for_cost_calculation();
+
+    double serialTime = 0;
+    for( unsigned int i = 0; i < aCalculators.size(); ++i ) {
+        aCalculators[ i ]->mWorkersSucceeded = true;
+        serialTime -= aCalculators[ i ]->mPointRunTime;
     }
+
+    Timer workerTimer;
+    workerTimer.start();
+    ForkedTaskRunner::run( tasks, tasks.getNumTasks(), aNumWorkers );
+    workerTimer.stop();
+
+    bool success = true;
+    for( unsigned int i = 0; i < aCalculators.size(); ++i ) {
+        success &= aCalculators[ i ]->mWorkersSucceeded;
+        serialTime += aCalculators[ i ]->mPointRunTime;
+    }
+
+    // Report the speedup over running the same points serially, estimated
+    // from the time each point took to run.
+    const double workerTime = workerTimer.getTimeDifference();
+    mainLog.setLevel( ILogger::NOTICE );
+    mainLog << "Cost curve points took " << workerTime << " seconds in worker processes compared to "
+            << serialTime << " seconds of point run time";
+    if( workerTime > 0 ) {
+        mainLog << ", a speedup of " << serialTime / workerTime;
+    }
+    mainLog << "." << endl;
     return success;
 }
 
+/*! \brief Run a cost curve point in a worker process.
+* \param aTaskIndex The index of the task, points are run from the full tax
+*        down.
+* \param aResult The time taken to run the point followed by the serialized
+*        emissions and tax curves for the point.
+* \return Whether the model run completed successfully.
+*/
+bool TotalPolicyCostCalculator::runInChild( const int aTaskIndex, string& aResult ) {
+    const int point = mNumPoints - 1 - aTaskIndex;
+    const double startRunTime = mPointRunTime;
+    const bool success = runTrial( point );
+    const double runTime = mPointRunTime - startRunTime;
+    aResult.assign( reinterpret_cast<const char*>( &runTime ), sizeof( runTime ) );
+    aResult += writeTrialCurves( point );
+    return success;
+}
+
+/*! \brief Store the curves for a cost curve point run in a worker process.
+* \details If the worker did not return its curves the point is run serially.
+* \param aTaskIndex The index of the task.
+* \param aResult The time taken to run the point followed by the serialized
+*        emissions and tax curves for the point.
+* \param aReceived Whether the worker returned its curves.
+* \param aSucceeded Whether the model run in the worker solved.
+*/
+void TotalPolicyCostCalculator::collectResult( const int aTaskIndex, const string& aResult,
+                                               const bool aReceived, const bool aSucceeded )
+{
+    const int point = mNumPoints - 1 - aTaskIndex;
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    double runTime = 0;
+    if( !aReceived || aResult.size() < sizeof( runTime ) ||
+        !readTrialCurves( point, aResult.substr( sizeof( runTime ) ) ) )
+    {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << "Worker process for " << mGHGName << " cost curve point " << point
+                << " failed to return results, running it serially." << endl;
+        mWorkersSucceeded &= runTrial( point );
+        mSingleScenario->getInternalScenario()->getMarketplace()->restore_prices_for_cost_calculation();
+        setPointTaxes( mNumPoints );
+        return;
+    }
+
+    memcpy( &runTime, aResult.data(), sizeof( runTime ) );
+    mPointRunTime += runTime;
+    if( !aSucceeded ) {
+        mainLog.setLevel( ILogger::WARNING );
+        mainLog << mGHGName << " cost curve point run number " << point << " did not solve." << endl;
+        mWorkersSucceeded = false;
+    }
+}
+
+/*! \brief Write a binary value to a stream.
+* \param aOut The stream to write to.
+* \param aValue The value to write.
+*/
+template<class T>
+static void writeBinary( ostream& aOut, const T& aValue ) {
+    aOut.write( reinterpret_cast<const char*>( &aValue ), sizeof( T ) );
+}
+
+/*! \brief Read a binary value from a stream.
+* \param aIn The stream to read from.
+* \param aValue The value to read into.
+* \return Whether the value was read.
+*/
+template<class T>
+static bool readBinary( istream& aIn, T& aValue ) {
+    return aIn.read( reinterpret_cast<char*>( &aValue ), sizeof( T ) ).good();
+}
+
+//! Write a string with a length prefix to a stream.
+static void writeBinaryString( ostream& aOut, const string& aValue ) {
+    writeBinary( aOut, static_cast<unsigned int>( aValue.size() ) );
+    aOut.write( aValue.data(), aValue.size() );
+}
+
+//! Read a length prefixed string from a stream.
+static bool readBinaryString( istream& aIn, string& aValue ) {
+    unsigned int size;
+    if( !readBinary( aIn, size ) ) {
+        return false;
+    }
+    aValue.resize( size );
+    return size == 0 || aIn.read( &aValue[ 0 ], size ).good();
+}
+
+/*! \brief Serialize the emissions and tax curves for a point.
+* \details For each curve the region, title, axis labels and data points are
+*          written in binary form.
+* \param aPoint The point to serialize.
+* \return The serialized curves.
+*/
+const string TotalPolicyCostCalculator::writeTrialCurves( const int aPoint ) const {
+    ostringstream out( ios_base::out | ios_base::binary );
+    const RegionCurves* curveSets[] = { &mEmissionsQCurves[ aPoint ], &mEmissionsTCurves[ aPoint ] };
+    for( unsigned int set = 0; set < 2; ++set ) {
+        writeBinary( out, static_cast<unsigned int>( curveSets[ set ]->size() ) );
+        for( CRegionCurvesIterator rIter = curveSets[ set ]->begin(); rIter != curveSets[ set ]->end(); ++rIter ) {
+            writeBinaryString( out, rIter->first );
+            writeBinaryString( out, rIter->second->getTitle() );
+            writeBinaryString( out, rIter->second->getXAxisLabel() );
+            writeBinaryString( out, rIter->second->getYAxisLabel() );
+            const Curve::SortedPairVector pairs = rIter->second->getSortedPairs();
+            writeBinary( out, static_cast<unsigned int>( pairs.size() ) );
+            for( Curve::SortedPairVector::const_iterator pIter = pairs.begin(); pIter != pairs.end(); ++pIter ) {
+                writeBinary( out, pIter->first );
+                writeBinary( out, pIter->second );
+            }
+        }
+    }
+    return out.str();
+}
+
+/*! \brief Read the emissions and tax curves for a point written by a worker.
+* \param aPoint The point the curves are for.
+* \param aData The serialized curves.
+* \return Whether the curves were read successfully.
+*/
+bool TotalPolicyCostCalculator::readTrialCurves( const int aPoint, const string& aData ) {
+    istringstream in( aData, ios_base::in | ios_base::binary );
+    // Read into temporary curve sets so that nothing is stored unless all of
+    // the curves could be read.
+    RegionCurves curveSets[ 2 ];
+    bool success = true;
+    for( unsigned int set = 0; set < 2 && success; ++set ) {
+        unsigned int numCurves = 0;
+        success = readBinary( in, numCurves );
+        for( unsigned int curveNum = 0; curveNum < numCurves && success; ++curveNum ) {
+            string region, title, xLabel, yLabel;
+            unsigned int numPoints = 0;
+            success = readBinaryString( in, region ) && readBinaryString( in, title )
+                && readBinaryString( in, xLabel ) && readBinaryString( in, yLabel )
+                && readBinary( in, numPoints );
+            auto_ptr<ExplicitPointSet> points( new ExplicitPointSet() );
+            for( unsigned int i = 0; i < numPoints && success; ++i ) {
+                double x, y;
+                success = readBinary( in, x ) && readBinary( in, y );
+                if( success ) {
+                    points->addPoint( new XYDataPoint( x, y ) );
+                }
+            }
+            if( success ) {
+                Curve* curve = new PointSetCurve( points.release() );
+                curve->setTitle( title );
+                curve->setXAxisLabel( xLabel );
+                curve->setYAxisLabel( yLabel );
+                curveSets[ set ][ region ] = curve;
+            }
+        }
+    }
+
+    if( !success ) {
+        for( unsigned int set = 0; set < 2; ++set ) {
+            for( RegionCurvesIterator rIter = curveSets[ set ].begin(); rIter != curveSets[ set ].end(); ++rIter ) {
+                delete rIter->second;
+            }
+        }
+        return false;
+    }
+    mEmissionsQCurves[ aPoint ] = curveSets[ 0 ];
+    mEmissionsTCurves[ aPoint ] = curveSets[ 1 ];
+    return true;
+}
+
 /*! \brief Create a cost curve for each period and region.
 * \details Using the cost curves generated by the trials, generate and stored a set of cost
 * curves by period and region.
@@ -322,16 +852,27 @@ void TotalPolicyCostCalculator::printOutput() const {
     if( !mRanCosts ){
         return;
     }
+
+    // Open the XML output file and write to it.
+    AutoOutputFile ccOut( "costCurvesOutputFileName",
+                          "cost_curves.xml" );
+    printOutput( *ccOut );
+}
+
+/*! \brief Print the output, writing the XML to an already open stream.
+* \details This allows the curves for several gases to be written to the same
+*          cost curves file.
+* \param aCostCurvesOut The stream to which to write the XML output.
+*/
+void TotalPolicyCostCalculator::printOutput( ostream& aCostCurvesOut ) const {
+    // Don't try to print output if the scenarios weren't run.
+    if( !mRanCosts ){
+        return;
+    }
     
     // Create a string with the XML output.
     const string xmlString = createXMLOutputString();
-    
-    {
-        // Open the XML output file and write to it.
-        AutoOutputFile ccOut( "costCurvesOutputFileName",
-                              "cost_curves.xml" );
-        ccOut << xmlString;
-    }
+    aCostCurvesOut << xmlString;
     
     // Location to insert the information into the container.
     const string UPDATE_LOCATION = "/scenario/world/region[last()]";
@@ -436,7 +977,7 @@ const string TotalPolicyCostCalculator::createXMLOutputString() const {
     Tabs tabs;
 
     // Create a root tag.
-    XMLWriteOpeningTag( "CostCurvesInfo", buffer, &tabs ); 
+    XMLWriteOpeningTag( "CostCurvesInfo", buffer, &tabs, mGHGName ); 
 
     XMLWriteOpeningTag( "PeriodCostCurves", buffer, &tabs );
 
@@ -44,12 +44,16 @@
 #include <string>
 #include <cassert>
 #include <vector>
+#include <list>
 #include <map>
+#include <set>
+#include <sstream>
 #include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 
 #include "util/base/include/xml_helper.h"
+#include "util/base/include/iparsable.h"
 #include "containers/include/world.h"
 #include "containers/include/region_minicam.h"
 #include "containers/include/region_cge.h"
@@ -58,6 +62,7 @@
 #include "marketplace/include/marketplace.h"
 #include "util/base/include/configuration.h"
 #include "util/base/include/util.h"
+#include "util/base/include/auto_file.h"
 #include "util/base/include/summary.h"
 #include "util/curves/include/curve.h"
 #include "util/curves/include/point_set_curve.h"
@@ -68,6 +73,8 @@
 #include "util/logger/include/ilogger.h"
 #include "util/base/include/ivisitor.h"
 #include "climate/include/iclimate_model.h"
+#include "climate/include/climate_ensemble.h"
+#include "climate/include/climate_emulator.h"
 // Could hide with a factory method.
 #include "climate/include/magicc_model.h"
 #include "climate/include/hector_model.hpp"
@@ -95,11 +102,86 @@ using namespace xercesc;
 
 extern Scenario* scenario;
 
+namespace {
+    typedef map<string, set<string> > RegionMarketMap;
+
+    /*!
+     * \brief Recursively find the names of all markets referenced below a node.
+     * \param aNode The node to search.
+     * \param aMarketRegions The set to which market names are added.
+     */
+    void findMarketRegions( const DOMNode* aNode, set<string>& aMarketRegions ) {
+        DOMNodeList* nodeList = aNode->getChildNodes();
+        for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+            const DOMNode* curr = nodeList->item( i );
+            if( curr->getNodeType() != DOMNode::ELEMENT_NODE ) {
+                continue;
+            }
+            const string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+            if( nodeName == "market-name" || nodeName == "market" ) {
+                aMarketRegions.insert( XMLHelper<string>::getValue( curr ) );
+            }
+            else {
+                findMarketRegions( curr, aMarketRegions );
+            }
+        }
+    }
+
+    /*!
+     * \brief Collects the markets each region refers to from scenario
+     *        documents without creating any model objects.
+     */
+    class RegionMarketScanner : public IParsable {
+    public:
+        explicit RegionMarketScanner( RegionMarketMap& aRegionMarkets ):
+        mRegionMarkets( aRegionMarkets )
+        {
+        }
+
+        virtual bool XMLParse( const DOMNode* aNode ) {
+            DOMNodeList* nodeList = aNode->getChildNodes();
+            for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+                const DOMNode* curr = nodeList->item( i );
+                if( XMLHelper<string>::safeTranscode( curr->getNodeName() ) == World::getXMLNameStatic() ) {
+                    scanWorld( curr );
+                }
+            }
+            return true;
+        }
+
+        void scanWorld( const DOMNode* aNode ) {
+            DOMNodeList* nodeList = aNode->getChildNodes();
+            for( unsigned int i = 0; i < nodeList->getLength(); ++i ) {
+                const DOMNode* curr = nodeList->item( i );
+                const string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+                if( nodeName == RegionMiniCAM::getXMLNameStatic() || nodeName == RegionCGE::getXMLNameStatic() ) {
+                    findMarketRegions( curr, mRegionMarkets[ XMLHelper<string>::getAttr( curr, "name" ) ] );
+                }
+            }
+        }
+    private:
+        //! Market names referenced by each region.
+        RegionMarketMap& mRegionMarkets;
+    };
+}
+
 //! Default constructor.
 World::World():
+mClimateEmulator( 0 ),
 mCalcCounter( new CalcCounter() ),
-mGlobalTechDB( new GlobalTechnologyDatabase() )
+mGlobalTechDB( new GlobalTechnologyDatabase() ),
+mIsRegionSubsetClosed( false ),
+mHasRegionSubsetError( false )
 {
+    // Read the optional list of regions to run. Region names may be separated
+    // by commas or white space.
+    string regionSubset = Configuration::getInstance()->getString( "region-subset", "", false );
+    replace( regionSubset.begin(), regionSubset.end(), ',', ' ' );
+    istringstream regionStream( regionSubset );
+    string regionName;
+    while( regionStream >> regionName ) {
+        mRegionSubset.insert( regionName );
+    }
 }
 
 //! World destructor. 
@@ -114,11 +196,35 @@ void World::clear(){
     }
 }
 
-//! parses World xml object
-void World::XMLParse( const DOMNode* node ){
+/*!
+ * \brief Parses the World XML object.
+ * \param node The world node.
+ * \return Whether the node was parsed successfully. This fails if the region
+ *         subset needs a region which was skipped while parsing an earlier
+ *         file.
+ */
+bool World::XMLParse( const DOMNode* node ){
     // assume we are passed a valid node.
     assert( node );
 
+    // Add any regions the region subset depends on through markets before
+    // deciding which regions to skip. The dependencies in all of the
+    // configured input files are found when the first world node is parsed,
+    // components added later can only add dependencies from their own file.
+    if( !mRegionSubset.empty() ) {
+        if( !mIsRegionSubsetClosed && !closeRegionSubset() ) {
+            mHasRegionSubsetError = true;
+            return false;
+        }
+
+        RegionMarketMap regionMarkets;
+        RegionMarketScanner( regionMarkets ).scanWorld( node );
+        if( !expandRegionSubset( regionMarkets ) ) {
+            mHasRegionSubsetError = true;
+            return false;
+        }
+    }
+
     // get all the children.
     DOMNodeList* nodeList = node->getChildNodes();
 
@@ -134,7 +240,9 @@ void World::XMLParse( const DOMNode* node ){
         }
         // MiniCAM regions
         else if( nodeName == RegionMiniCAM::getXMLNameStatic() ){
-            parseContainerNode( curr, regions, regionNamesToNumbers, new RegionMiniCAM() );
+            if( shouldParseRegion( curr ) ) {
+                parseContainerNode( curr, regions, regionNamesToNumbers, new RegionMiniCAM() );
+            }
         }
 		// Read in parameters for climate model
         else if( nodeName == MagiccModel::getXMLNameStatic() ){
@@ -148,7 +256,9 @@ void World::XMLParse( const DOMNode* node ){
 #endif
 		// SGM regions
         else if( nodeName == RegionCGE::getXMLNameStatic() ){
-            parseContainerNode( curr, regions, regionNamesToNumbers, new RegionCGE() );
+            if( shouldParseRegion( curr ) ) {
+                parseContainerNode( curr, regions, regionNamesToNumbers, new RegionCGE() );
+            }
         }
         else {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -156,6 +266,142 @@ void World::XMLParse( const DOMNode* node ){
             mainLog << "Unrecognized text string: " << nodeName << " found while parsing World." << endl;
         }
     }
+    return true;
+}
+
+/*!
+ * \brief Get whether parsing failed because the region subset needed a
+ *        region which had already been skipped.
+ * \details Scenario checks this after parsing the world as the result of
+ *          XMLParse is not returned when parsing a single node.
+ * \return Whether the region subset could not be satisfied.
+ */
+bool World::hasRegionSubsetError() const {
+    return mHasRegionSubsetError;
+}
+
+/*!
+ * \brief Determine if a region node should be parsed given the configured
+ *        region subset.
+ * \details Regions outside of the subset are never created which keeps both
+ *          parsing and solving restricted to the regions of interest.
+ * \param aNode The region node.
+ * \return Whether the region should be parsed.
+ */
+bool World::shouldParseRegion( const DOMNode* aNode ) {
+    if( mRegionSubset.empty() ) {
+        return true;
+    }
+
+    const string regionName = XMLHelper<string>::getAttr( aNode, "name" );
+    if( mRegionSubset.find( regionName ) != mRegionSubset.end() ) {
+        return true;
+    }
+
+    if( mSkippedRegions.insert( regionName ).second ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Skipping region " << regionName << " as it is not in the region-subset." << endl;
+    }
+    return false;
+}
+
+/*!
+ * \brief Close the region subset over the market dependencies in all of the
+ *        configured input files.
+ * \details The base input file and every scenario component are scanned for
+ *          the markets each region refers to before any region is parsed so
+ *          that a region needed by a later file is not skipped in an earlier
+ *          one. Markets which every region refers to are global markets which
+ *          only happen to be keyed to a host region. These do not pull their
+ *          host region into the subset.
+ * \return Whether all of the files could be scanned and the subset closed.
+ */
+bool World::closeRegionSubset() {
+    mIsRegionSubsetClosed = true;
+
+    const Configuration* conf = Configuration::getInstance();
+    list<string> files = conf->getScenarioComponents();
+    files.push_front( conf->getFile( "xmlInputFileName" ) );
+
+    RegionMarketMap regionMarkets;
+    RegionMarketScanner scanner( regionMarkets );
+    for( list<string>::const_iterator it = files.begin(); it != files.end(); ++it ) {
+        if( !XMLHelper<void>::parseXML( *it, &scanner ) ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::ERROR );
+            mainLog << "Could not read " << *it << " to find the regions needed by the region-subset." << endl;
+            return false;
+        }
+    }
+
+    // Find the markets which every region refers to.
+    map<string, unsigned int> numReferences;
+    for( RegionMarketMap::const_iterator regionIt = regionMarkets.begin(); regionIt != regionMarkets.end(); ++regionIt ) {
+        for( set<string>::const_iterator it = regionIt->second.begin(); it != regionIt->second.end(); ++it ) {
+            ++numReferences[ *it ];
+        }
+    }
+    for( map<string, unsigned int>::const_iterator it = numReferences.begin(); it != numReferences.end(); ++it ) {
+        if( regionMarkets.size() > 1 && it->second == regionMarkets.size() ) {
+            mGlobalMarkets.insert( it->first );
+        }
+    }
+
+    return expandRegionSubset( regionMarkets );
+}
+
+/*!
+ * \brief Expand the region subset to include regions which regions in the
+ *        subset depend on through markets.
+ * \details Any market-name or market element within a region in the subset
+ *          which refers to another known region causes that region to be
+ *          added to the subset. This is repeated until no new regions are
+ *          found so that traded markets keep their upstream regions. Markets
+ *          which do not refer to a region and global markets do not pull in
+ *          additional regions. They are solved with the regions in the subset
+ *          only. It is an error for a region to be needed after it was skipped
+ *          while parsing an earlier file.
+ * \param aRegionMarkets The market names referenced by each region.
+ * \return Whether no region which was already skipped is needed.
+ */
+bool World::expandRegionSubset( const RegionMarketMap& aRegionMarkets ) {
+    ILogger& mainLog = ILogger::getLogger( "main_log" );
+    vector<string> toSearch( mRegionSubset.begin(), mRegionSubset.end() );
+    while( !toSearch.empty() ) {
+        const string regionName = toSearch.back();
+        toSearch.pop_back();
+
+        RegionMarketMap::const_iterator regionIt = aRegionMarkets.find( regionName );
+        if( regionIt == aRegionMarkets.end() ) {
+            continue;
+        }
+
+        const set<string>& marketRegions = regionIt->second;
+        for( set<string>::const_iterator it = marketRegions.begin(); it != marketRegions.end(); ++it ) {
+            if( aRegionMarkets.find( *it ) == aRegionMarkets.end()
+                || mGlobalMarkets.find( *it ) != mGlobalMarkets.end()
+                || !mRegionSubset.insert( *it ).second )
+            {
+                continue;
+            }
+
+            // Data for this region in files which were already read has been
+            // lost so the region would be incomplete.
+            if( mSkippedRegions.find( *it ) != mSkippedRegions.end() ) {
+                mainLog.setLevel( ILogger::ERROR );
+                mainLog << "Region " << *it << " was skipped in a previous file but is needed by "
+                        << regionName << ". Add it to the region-subset explicitly." << endl;
+                return false;
+            }
+
+            mainLog.setLevel( ILogger::NOTICE );
+            mainLog << "Adding region " << *it << " to the region-subset as " << regionName
+                    << " depends on its markets." << endl;
+            toSearch.push_back( *it );
+        }
+    }
+    return true;
 }
 
 /*! \brief Complete the initialization
@@ -288,6 +534,15 @@ void World::initCalc( const int period ) {
     }
     
     Configuration* conf = Configuration::getInstance();
+
+    // When running a region subset optionally hold markets outside of the
+    // subset, such as global markets, at their initial prices.
+    if( !mRegionSubset.empty() && conf->getBool( "region-subset-fixed-boundary", false, false ) ) {
+        const int numFixed = scenario->getMarketplace()->fixMarketsOutsideRegions( mRegionSubset, period );
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::NOTICE );
+        mainLog << "Holding " << numFixed << " boundary markets at fixed prices in period " << period << "." << endl;
+    }
     if( conf->getBool( "CalibrationActive" ) ){
         // print an I/O table for debuging before we do any calibration
         ILogger& calLog = ILogger::getLogger( "calibration_log" );
@@ -684,6 +939,33 @@ void World::runClimateModel() {
     mClimateModel->runModel();
 }
 
+/*! \brief Run the climate parameter ensemble over the emissions of the last
+*          climate model run.
+* \details Does nothing unless the climate-ensemble-file is set. The emissions
+*          are not set again, so this must be called after runClimateModel
+*          for the final solution, and only once per scenario as the ensemble
+*          is expensive to run.
+*/
+void World::runClimateEnsemble() {
+    const string ensembleFile = Configuration::getInstance()->getFile( "climate-ensemble-file", "", false );
+    if( ensembleFile.empty() ) {
+        return;
+    }
+    const Modeltime* modeltime = scenario->getModeltime();
+    ClimateEnsemble ensemble( modeltime->getStartYear(), modeltime->getEndYear() );
+    if( ensemble.readParameters( ensembleFile ) ) {
+        if( mClimateModel->runEnsemble( ensemble ) != IClimateModel::NOT_IMPLEMENTED ) {
+            AutoOutputFile ensembleOut( "climate-ensemble-output", "climate-ensemble.csv" );
+            ensemble.printPercentiles( *ensembleOut );
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "The climate model does not support climate ensembles." << endl;
+        }
+    }
+}
+
 void World::runClimateModel( int aPeriod ) {
     if( aPeriod > 0 ) {
         setEmissions( aPeriod );
@@ -812,6 +1094,20 @@ const IClimateModel* World::getClimateModel() const {
     return mClimateModel.get();
 }
 
+/*! \brief Get the climate model as an emulator which can stand in for it.
+* \details Wraps the climate model in a ClimateEmulator the first time this is
+*          called. Objects which already hold the climate model keep using
+*          the full model, so this should be called before they are created.
+* \return The climate emulator.
+*/
+ClimateEmulator* World::useClimateEmulator() {
+    if( !mClimateEmulator ) {
+        mClimateEmulator = new ClimateEmulator( mClimateModel.release(), scenario->getModeltime() );
+        mClimateModel.reset( mClimateEmulator );
+    }
+    return mClimateEmulator;
+}
+
 /*! \brief A function to generate a series of ghg emissions quantity curves based on an already performed model run.
 * \details This function used the information stored in it to create a series of curves, one for each region,
 * with each datapoint containing a time period and an amount of gas emissions.
@@ -910,7 +1206,9 @@ void World::accept( IVisitor* aVisitor, const int aPeriod ) const {
 
     // loop for regions
     for( CRegionIterator currRegion = regions.begin(); currRegion != regions.end(); ++currRegion ){
-        (*currRegion)->accept( aVisitor, aPeriod );
+        if( aVisitor->shouldVisitRegion( (*currRegion)->getName() ) ) {
+            (*currRegion)->accept( aVisitor, aPeriod );
+        }
     }
 
     aVisitor->endVisitWorld( this, aPeriod );
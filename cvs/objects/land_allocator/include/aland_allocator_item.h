@@ -109,6 +109,7 @@ class ALandAllocatorItem : public TreeItem<ALandAllocatorItem>,
                            private boost::noncopyable
 {
     friend class XMLDBOutputter;
+    friend class FlatLandAllocator;
 public:
     typedef TreeItem<ALandAllocatorItem> ParentTreeType;
 
@@ -0,0 +1,135 @@
+#ifndef _FLAT_LAND_ALLOCATOR_H_
+#define _FLAT_LAND_ALLOCATOR_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+ * \file flat_land_allocator.h
+ * \ingroup Objects
+ * \brief The FlatLandAllocator class header file.
+ */
+
+#include <vector>
+#include <string>
+
+class ALandAllocatorItem;
+class LandNode;
+
+/*! 
+ * \brief A level ordered copy of a land allocation tree used to calculate
+ *        shares and allocations.
+ * \details The land allocation tree calculates shares by recursing through its
+ *          items with a virtual call for each, and each node allocates a
+ *          vector of unnormalized shares on every call. This class is built
+ *          from the tree once it is complete and stores the items in level
+ *          order, so that the children of each node are next to each other and
+ *          every item comes after its parent. Shares are then calculated a
+ *          level at a time from the bottom up, and allocations from the top
+ *          down, in loops over arrays which are allocated once.
+ *
+ *          The values each calculation depends on, such as profit rates, profit
+ *          scalers and logit exponents, are read from the tree at the start of
+ *          the calculation and the results are written back to it, so the tree
+ *          remains the model state used for calibration and reporting. The
+ *          calculation is the same as LandNode::calcLandShares and
+ *          LandLeaf::calcLandShares.
+ */
+class FlatLandAllocator {
+public:
+    FlatLandAllocator();
+
+    void build( LandNode* aRoot );
+
+    void calcLandShares( const int aPeriod );
+
+    void calcLandAllocation( const std::string& aRegionName,
+                             const double aRootLandAllocation,
+                             const int aPeriod );
+
+private:
+    void calcUnnormalizedShares( const int aBegin, const int aEnd );
+
+    void calcNodeShares( const int aNode, const int aPeriod );
+
+    //! Items in level order, starting with the root.
+    std::vector<ALandAllocatorItem*> mItems;
+
+    //! Node of each item, or null if the item is a leaf.
+    std::vector<LandNode*> mNodes;
+
+    //! Index of the parent of each item, -1 for the root.
+    std::vector<int> mParent;
+
+    //! Index of the first child of each item.
+    std::vector<int> mFirstChild;
+
+    //! Number of children of each item.
+    std::vector<int> mNumChildren;
+
+    //! Index of the first item in each level, followed by the number of items.
+    std::vector<int> mLevelStart;
+
+    //! Logit exponent of each node, zero for leaves.
+    std::vector<double> mLogitExponent;
+
+    //! Logit exponent of the parent of each item.
+    std::vector<double> mLogitExponentAbove;
+
+    //! Profit scaler of each item.
+    std::vector<double> mProfitScaler;
+
+    //! Adjustment of the profit of each item for new technologies.
+    std::vector<double> mNewTechAdjustment;
+
+    //! Total profit rate of each item, including the profit scaler and the
+    //! adjustment for new technologies.
+    std::vector<double> mTotalProfitRate;
+
+    //! Profit rate of each item.
+    std::vector<double> mProfitRate;
+
+    //! Unnormalized share of each item within its parent.
+    std::vector<double> mUnnormalizedShare;
+
+    //! Share of each item within its parent.
+    std::vector<double> mShare;
+
+    //! Land allocated to each item.
+    std::vector<double> mAllocation;
+};
+
+#endif // _FLAT_LAND_ALLOCATOR_H_
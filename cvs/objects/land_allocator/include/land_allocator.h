@@ -46,6 +46,7 @@
  */
 #include "land_allocator/include/iland_allocator.h"
 #include "land_allocator/include/land_node.h"
+#include "land_allocator/include/flat_land_allocator.h"
 #include "util/base/include/ivisitable.h"
 
 class IInfo;
@@ -59,6 +60,9 @@ class IInfo;
  *          Many methods on this interface are implemented by directly calling
  *          the LandAllocatorNode functions.
  *
+ *          Once the tree is complete it is copied into a FlatLandAllocator,
+ *          which calculates land shares and allocations in its place.
+ *
  *          <b>XML specification for LandAllocator</b>
  *          - XML name: \c LandAllocatorRoot
  *          - Contained by: Region
@@ -149,6 +153,16 @@ private:
     //! Integer storing the soil time scale for a region
     int mSoilTimeScale;                              
 
+    //! Level ordered copy of the tree used to calculate shares and allocations
+    FlatLandAllocator mFlatAllocator;
+
+    //! Whether to calculate land-use change emissions during solution only if
+    //! they are added to a market
+    bool mLazyLUCEmissions;
+
+    //! Number of land-use change emissions calculations skipped in the current period
+    unsigned int mNumSkippedLUCCalcs;
+
     void calibrateLandAllocator( const std::string& aRegionName, const int aPeriod );
 
     void calculateProfitScalers( const std::string& aRegionName, 
@@ -158,6 +172,8 @@ private:
                                 const int aPeriod );
 
     void checkLandArea( const std::string& aRegionName, const int aPeriod );
+
+    bool hasLUCEmissionsMarket( const std::string& aRegionName, const int aPeriod ) const;
 };
 
 #endif // _LAND_ALLOCATOR_H_
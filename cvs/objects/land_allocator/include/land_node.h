@@ -75,6 +75,7 @@ class NodeCarbonCalc;
  *              - \c node-carbon-calc LandNode::mCarbonCalc
  */
 class LandNode : public ALandAllocatorItem {
+    friend class FlatLandAllocator;
 public:
     explicit LandNode( const ALandAllocatorItem* aParent );
 
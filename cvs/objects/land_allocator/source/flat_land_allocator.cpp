@@ -0,0 +1,261 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+/*! 
+ * \file flat_land_allocator.cpp
+ * \ingroup Objects
+ * \brief FlatLandAllocator class source file.
+ */
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+
+#include "land_allocator/include/flat_land_allocator.h"
+#include "land_allocator/include/land_node.h"
+
+using namespace std;
+
+//! Constructor
+FlatLandAllocator::FlatLandAllocator() {
+}
+
+/*!
+ * \brief Build the level ordered arrays from a land allocation tree.
+ * \details Must be called once the tree is complete and before shares are
+ *          calculated. Any previously built tree is replaced.
+ * \param aRoot The root of the tree.
+ */
+void FlatLandAllocator::build( LandNode* aRoot ) {
+    mItems.clear();
+    mNodes.clear();
+    mParent.clear();
+    mFirstChild.clear();
+    mNumChildren.clear();
+    mLevelStart.clear();
+
+    // Breadth first traversal, which places the children of each node next to
+    // each other and each level after the one above it.
+    mItems.push_back( aRoot );
+    mParent.push_back( -1 );
+    mLevelStart.push_back( 0 );
+    int levelEnd = 1;
+    for( int i = 0; i < static_cast<int>( mItems.size() ); ++i ) {
+        if( i == levelEnd ) {
+            mLevelStart.push_back( i );
+            levelEnd = static_cast<int>( mItems.size() );
+        }
+        ALandAllocatorItem* item = mItems[ i ];
+        mFirstChild.push_back( static_cast<int>( mItems.size() ) );
+        mNumChildren.push_back( static_cast<int>( item->getNumChildren() ) );
+        mNodes.push_back( item->getType() == eNode ? static_cast<LandNode*>( item ) : 0 );
+        for( size_t child = 0; child < item->getNumChildren(); ++child ) {
+            mItems.push_back( item->getChildAt( child ) );
+            mParent.push_back( i );
+        }
+    }
+    mLevelStart.push_back( static_cast<int>( mItems.size() ) );
+
+    const size_t numItems = mItems.size();
+    mLogitExponent.assign( numItems, 0.0 );
+    mLogitExponentAbove.assign( numItems, 0.0 );
+    mProfitScaler.assign( numItems, 0.0 );
+    mNewTechAdjustment.assign( numItems, 0.0 );
+    mTotalProfitRate.assign( numItems, 0.0 );
+    mProfitRate.assign( numItems, 0.0 );
+    mUnnormalizedShare.assign( numItems, 0.0 );
+    mShare.assign( numItems, 0.0 );
+    mAllocation.assign( numItems, 0.0 );
+}
+
+/*!
+ * \brief Calculate the share of each item within its parent and the profit
+ *        rate of each node.
+ * \details Unmanaged land profit rates must already have been set. The root's
+ *          own share is not set.
+ * \param aPeriod Model period.
+ */
+void FlatLandAllocator::calcLandShares( const int aPeriod ) {
+    const int numItems = static_cast<int>( mItems.size() );
+    if( numItems == 0 ) {
+        return;
+    }
+
+    // Read the current state of the tree.
+    for( int i = 0; i < numItems; ++i ) {
+        const ALandAllocatorItem* item = mItems[ i ];
+        mProfitScaler[ i ] = item->mProfitScaler[ aPeriod ];
+        mNewTechAdjustment[ i ] = item->mAdjustForNewTech[ aPeriod ];
+        mProfitRate[ i ] = item->mProfitRate[ aPeriod ];
+        mShare[ i ] = item->mShare[ aPeriod ];
+        mLogitExponent[ i ] = mNodes[ i ] ? mNodes[ i ]->mLogitExponent[ aPeriod ] : 0.0;
+    }
+    mLogitExponentAbove[ 0 ] = 0.0; // No logit exponent above the root.
+    for( int i = 1; i < numItems; ++i ) {
+        mLogitExponentAbove[ i ] = mLogitExponent[ mParent[ i ] ];
+    }
+
+    // Work up from the bottom level. The unnormalized shares of the level
+    // below have been calculated by the time the nodes of a level need them.
+    for( int level = static_cast<int>( mLevelStart.size() ) - 2; level >= 0; --level ) {
+        const int begin = mLevelStart[ level ];
+        const int end = mLevelStart[ level + 1 ];
+        for( int i = begin; i < end; ++i ) {
+            if( mNodes[ i ] ) {
+                calcNodeShares( i, aPeriod );
+            }
+        }
+        calcUnnormalizedShares( begin, end );
+    }
+
+    // Write the results back to the tree.
+    for( int i = 1; i < numItems; ++i ) {
+        assert( mShare[ i ] == -1 || ( mShare[ i ] >= 0 && mShare[ i ] <= 1 ) );
+        mItems[ i ]->mShare[ aPeriod ] = mShare[ i ];
+    }
+    for( int i = 0; i < numItems; ++i ) {
+        if( mNodes[ i ] ) {
+            mNodes[ i ]->mProfitRate[ aPeriod ] = mProfitRate[ i ];
+        }
+    }
+}
+
+/*!
+ * \brief Calculate the unnormalized share of a range of items within their
+ *        parents.
+ * \details The profit rates of any nodes in the range must already be
+ *          calculated.
+ * \param aBegin The first item.
+ * \param aEnd One past the last item.
+ */
+void FlatLandAllocator::calcUnnormalizedShares( const int aBegin, const int aEnd ) {
+    for( int i = aBegin; i < aEnd; ++i ) {
+        mTotalProfitRate[ i ] = mProfitScaler[ i ] * mProfitRate[ i ] * mNewTechAdjustment[ i ];
+    }
+    for( int i = aBegin; i < aEnd; ++i ) {
+        const double logitExpAbove = mLogitExponentAbove[ i ];
+        if( !mNodes[ i ] ) {
+            // Total profit rate including the carbon subsidy should not be negative.
+            mUnnormalizedShare[ i ] = mTotalProfitRate[ i ] < 0.0 || mProfitScaler[ i ] == 0.0 ?
+                0.0 : pow( mTotalProfitRate[ i ], logitExpAbove );
+        }
+        else {
+            // Unnormalized share will be ignored if logit exponent is zero.
+            mUnnormalizedShare[ i ] = logitExpAbove > 0 ?
+                pow( mTotalProfitRate[ i ], logitExpAbove ) : 0.0;
+        }
+    }
+}
+
+/*!
+ * \brief Calculate the shares of the children of a node and its profit rate.
+ * \details See LandNode::calcLandShares for the steps of the calculation.
+ * \param aNode The node.
+ * \param aPeriod Model period.
+ */
+void FlatLandAllocator::calcNodeShares( const int aNode, const int aPeriod ) {
+    const int begin = mFirstChild[ aNode ];
+    const int end = begin + mNumChildren[ aNode ];
+    const double logitExponent = mLogitExponent[ aNode ];
+
+    double unnormalizedSum = 0.0;
+    for( int i = begin; i < end; ++i ) {
+        unnormalizedSum += mUnnormalizedShare[ i ];
+    }
+
+    if( logitExponent == 0 && aPeriod > 0 ) {
+        // Fixed share node: copy forward the previous period share unless it
+        // was set by calibration.
+        for( int i = begin; i < end; ++i ) {
+            if( mShare[ i ] == -1 ) {
+                mShare[ i ] = mItems[ i ]->mShare[ aPeriod - 1 ];
+            }
+        }
+    }
+    else if( unnormalizedSum == 0.0 ) {
+        // All children have zero share.
+        mProfitRate[ aNode ] = 0;
+    }
+    else {
+        const double inverseSum = 1.0 / unnormalizedSum;
+        for( int i = begin; i < end; ++i ) {
+            mShare[ i ] = mUnnormalizedShare[ i ] * inverseSum;
+        }
+    }
+
+    if( logitExponent > 0 && unnormalizedSum > 0 ) {
+        mProfitRate[ aNode ] = pow( unnormalizedSum, 1.0 / logitExponent );
+    }
+    else if( logitExponent == 0 ) {
+        mProfitRate[ aNode ] = mNodes[ aNode ]->mUnManagedLandValue;
+    }
+    else if( unnormalizedSum == 0 ) {
+        mProfitRate[ aNode ] = 0.0;
+    }
+}
+
+/*!
+ * \brief Calculate the land allocated to each item.
+ * \details Shares must already have been calculated. Each leaf is passed the
+ *          land allocated to its parent so that it can update its carbon
+ *          calculation and land expansion demands.
+ * \param aRegionName Region name.
+ * \param aRootLandAllocation Land allocated to the root.
+ * \param aPeriod Model period.
+ */
+void FlatLandAllocator::calcLandAllocation( const string& aRegionName,
+                                            const double aRootLandAllocation,
+                                            const int aPeriod )
+{
+    const int numItems = static_cast<int>( mItems.size() );
+    if( numItems == 0 ) {
+        return;
+    }
+
+    for( int i = 1; i < numItems; ++i ) {
+        mShare[ i ] = mItems[ i ]->mShare[ aPeriod ];
+    }
+
+    // Parents come before their children, so one pass sets every allocation.
+    mAllocation[ 0 ] = aRootLandAllocation;
+    for( int i = 1; i < numItems; ++i ) {
+        const double allocationAbove = mAllocation[ mParent[ i ] ];
+        mAllocation[ i ] = allocationAbove > 0.0 && mShare[ i ] > 0.0 ?
+            allocationAbove * mShare[ i ] : 0.0;
+    }
+
+    for( int i = 1; i < numItems; ++i ) {
+        if( !mNodes[ i ] ) {
+            mItems[ i ]->calcLandAllocation( aRegionName, mAllocation[ mParent[ i ] ], aPeriod );
+        }
+    }
+}
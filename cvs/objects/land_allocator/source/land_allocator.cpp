@@ -47,6 +47,8 @@
 #include "util/base/include/model_time.h"
 #include "ccarbon_model/include/carbon_model_utils.h"
 #include "util/base/include/configuration.h"
+#include "marketplace/include/marketplace.h"
+#include "util/logger/include/ilogger.h"
 
 using namespace std;
 using namespace xercesc;
@@ -60,7 +62,9 @@ extern Scenario* scenario;
 LandAllocator::LandAllocator()
 : LandNode( 0 ),
   mCarbonPriceIncreaseRate( 0.0 ),
-  mSoilTimeScale( CarbonModelUtils::getSoilTimeScale() )
+  mSoilTimeScale( CarbonModelUtils::getSoilTimeScale() ),
+  mLazyLUCEmissions( true ),
+  mNumSkippedLUCCalcs( 0 )
 {
 }
 
@@ -172,6 +176,11 @@ void LandAllocator::completeInit( const string& aRegionName,
 
     // Set the soil time scale
     setSoilTimeScale( mSoilTimeScale );
+
+    // The tree is now complete, so build the arrays used to calculate shares.
+    mFlatAllocator.build( this );
+
+    mLazyLUCEmissions = Configuration::getInstance()->getBool( "lazy-luc-emissions", true );
 }
 
 
@@ -353,7 +362,9 @@ double LandAllocator::calcLandShares( const string& aRegionName,
     // First set value of unmanaged land leaves
     setUnmanagedLandProfitRate( aRegionName, mUnManagedLandValue, aPeriod );
 
-    LandNode::calcLandShares( aRegionName, aLogitExpAbove, aPeriod );
+    // Calculate shares for the whole tree.  This is equivalent to
+    // LandNode::calcLandShares on the root.
+    mFlatAllocator.calcLandShares( aPeriod );
  
     // This is the root node so its share is 100%.
     mShare[ aPeriod ] = 1;
@@ -363,9 +374,7 @@ double LandAllocator::calcLandShares( const string& aRegionName,
 void LandAllocator::calcLandAllocation( const string& aRegionName,
                                             const double aLandAllocationAbove,
                                             const int aPeriod ){
-    for ( unsigned int i = 0; i < mChildren.size(); ++i ){
-        mChildren[ i ]->calcLandAllocation( aRegionName, mLandAllocation[ aPeriod ], aPeriod );
-    }
+    mFlatAllocator.calcLandAllocation( aRegionName, mLandAllocation[ aPeriod ], aPeriod );
 }
 
 void LandAllocator::calcLUCEmissions( const string& aRegionName, const int aPeriod,
@@ -397,16 +406,46 @@ void LandAllocator::calcFinalLandAllocation( const string& aRegionName,
                         0, // No land allocation above the root.
                         aPeriod );
 
-    // Calculate land-use change emissions but only to the end of this model
-    // period for performance reasons.
-    calcLUCEmissions( aRegionName,
-                      aPeriod,
-                      scenario->getModeltime()->getper_to_yr( aPeriod ) );
+    // Land-use change emissions only affect the solution if they are added
+    // to a CO2_LUC market.  Otherwise they can wait until postCalc, which
+    // calculates them for the entire model time horizon anyway.
+    if( !mLazyLUCEmissions || hasLUCEmissionsMarket( aRegionName, aPeriod ) ) {
+        // Calculate land-use change emissions but only to the end of this model
+        // period for performance reasons.
+        calcLUCEmissions( aRegionName,
+                          aPeriod,
+                          scenario->getModeltime()->getper_to_yr( aPeriod ) );
+    }
+    else {
+        ++mNumSkippedLUCCalcs;
+    }
 }
 
 void LandAllocator::postCalc( const string& aRegionName, const int aPeriod ) {
     // Calculate land-use change emissions for the entire model time horizon.
     calcLUCEmissions( aRegionName, aPeriod, CarbonModelUtils::getEndYear() );
+
+    if( mNumSkippedLUCCalcs > 0 ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::DEBUG );
+        mainLog << "Skipped " << mNumSkippedLUCCalcs
+                << " land-use change emissions calculations while solving period "
+                << aPeriod << " in region " << aRegionName << endl;
+        mNumSkippedLUCCalcs = 0;
+    }
+}
+
+/*!
+ * \brief Whether land-use change emissions are added to a market.
+ * \details Leaves add their land-use change emissions to the CO2_LUC market
+ *          while the period is solved, if one exists in the region.
+ * \param aRegionName Region name.
+ * \param aPeriod model period.
+ * \return Whether a CO2_LUC market exists.
+ */
+bool LandAllocator::hasLUCEmissionsMarket( const string& aRegionName, const int aPeriod ) const {
+    return scenario->getMarketplace()->getPrice( "CO2_LUC", aRegionName, aPeriod, false )
+        != Marketplace::NO_MARKET_PRICE;
 }
 
 ALandAllocatorItem* LandAllocator::findProductLeaf( const string& aProductName ) {
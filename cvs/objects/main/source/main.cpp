@@ -75,6 +75,7 @@
 #include "util/logger/include/logger_factory.h"
 #include "util/base/include/timer.h"
 #include "util/base/include/version.h"
+#include "reporting/include/async_output_writer.h"
 
 using namespace std;
 using namespace xercesc;
@@ -194,6 +195,8 @@ int main( int argc, char *argv[] ) {
     mainLog.setLevel( ILogger::WARNING ); // Increase level so that user will know that model is done
     mainLog << "Model exiting successfully." << endl;
     runner->cleanup();
+    // Wait for any output which is still being written in the background.
+    AsyncOutputWriter::getInstance().waitForCompletion();
     // Cleanup Xerces. This should be encapsulated with an initializer object to ensure against leakage.
     XMLHelper<void>::cleanupParser();
     
@@ -45,6 +45,7 @@
 */
 
 #include <vector>
+#include <set>
 #include <iosfwd>
 #include <string>
 #include <memory>
@@ -164,6 +165,9 @@ public:
     double getStoredDemand( const std::string& goodName, const std::string& regionName,
         const int period ) const;
     void init_to_last( const int period );
+    std::vector<double> getPrices( const int aPeriod ) const;
+    void setPriceGuesses( const int aPeriod, const std::vector<double>& aPrices );
+    void clearPriceGuesses();
     void dbOutput() const; 
     void csvOutputFile( std::string marketsToPrint = "" ) const; 
     int resetToPriceMarket( const int aMarketNumber );
@@ -171,6 +175,7 @@ public:
         const int period );
     void unsetMarketToSolve( const std::string& goodName, const std::string& regionName,
         const int period );
+    int fixMarketsOutsideRegions( const std::set<std::string>& aRegions, const int aPeriod );
     void storeinfo( const int period );
     void restoreinfo( const int period );
 
@@ -213,6 +218,10 @@ private:
     //! Flag indicating whether the next call to world->calc() will be part of a partial derivative calculation 
     bool mIsDerivativeCalc;
 
+    //! Starting prices for solved markets by period which override the
+    //! forecast prices in init_to_last, empty if there are none.
+    std::vector<std::vector<double> > mPriceGuesses;
+
 #if GCAM_PARALLEL_ENABLED
     //! helper class for tbb parallel_for over null supplies and demands
     struct NullSDHelper {
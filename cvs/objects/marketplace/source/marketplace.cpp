@@ -54,6 +54,7 @@
 #include "marketplace/include/price_market.h"
 #include "marketplace/include/linked_market.h"
 #include "marketplace/include/market_locator.h"
+#include "util/base/include/atom.h"
 #include "util/base/include/ivisitor.h"
 #include "containers/include/iinfo.h"
 #include "marketplace/include/cached_market.h"
@@ -407,6 +408,35 @@ void Marketplace::unsetMarketToSolve ( const string& goodName, const string& reg
     }
 }
 
+/*! \brief Stop solving all markets which do not contain any of the given
+*          regions.
+* \details This is used when only a subset of the regions is being run to treat
+*          markets of the regions which are not run as boundary conditions. The
+*          prices of these markets are left at their initial values, which may
+*          be read in from a reference solution, and supplies and demands are
+*          still accumulated for reporting.  Global and multi-region markets,
+*          such as a global carbon constraint, which contain any region in the
+*          subset are still solved.
+* \param aRegions The names of the regions being run.
+* \param aPeriod The period for which to fix the markets.
+* \return The number of markets which were fixed.
+*/
+int Marketplace::fixMarketsOutsideRegions( const set<string>& aRegions, const int aPeriod ) {
+    int numFixed = 0;
+    for( unsigned int i = 0; i < markets.size(); ++i ) {
+        const vector<const objects::Atom*>& containedRegions = markets[ i ][ aPeriod ]->getContainedRegions();
+        bool containsSubsetRegion = false;
+        for( unsigned int j = 0; j < containedRegions.size() && !containsSubsetRegion; ++j ) {
+            containsSubsetRegion = aRegions.find( containedRegions[ j ]->getID() ) != aRegions.end();
+        }
+        if( !containsSubsetRegion ) {
+            markets[ i ][ aPeriod ]->setSolveMarket( false );
+            ++numFixed;
+        }
+    }
+    return numFixed;
+}
+
 #if GCAM_PARALLEL_ENABLED
 void Marketplace::NullSDHelper::operator()( const tbb::blocked_range<int>& aRange) const
 {
@@ -777,6 +807,59 @@ void Marketplace::init_to_last( const int period ) {
             forecastDemand( markets[ i ], period );
         }
     }
+
+    // Start solved markets from any price guesses which were given for the
+    // period. Guesses are ignored if the markets have changed since they were
+    // taken.
+    if( period < static_cast<int>( mPriceGuesses.size() ) &&
+        mPriceGuesses[ period ].size() == markets.size() )
+    {
+        for( unsigned int i = 0; i < markets.size(); ++i ) {
+            if( markets[ i ][ period ]->isSolvable() && mPriceGuesses[ period ][ i ] > 0 ) {
+                markets[ i ][ period ]->setRawPrice( mPriceGuesses[ period ][ i ] );
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Get the prices of all markets in a period.
+ * \details The prices are ordered by market number so that they may be given
+ *          back to setPriceGuesses for a later run of the same scenario.
+ * \param aPeriod The period for which to get prices.
+ * \return The raw price of each market in the period.
+ */
+vector<double> Marketplace::getPrices( const int aPeriod ) const {
+    vector<double> prices( markets.size() );
+    for( unsigned int i = 0; i < markets.size(); ++i ) {
+        prices[ i ] = markets[ i ][ aPeriod ]->getRawPrice();
+    }
+    return prices;
+}
+
+/*!
+ * \brief Set the prices from which solved markets will start in a period.
+ * \details The guesses replace the forecast prices the next time init_to_last
+ *          is called for the period. Only markets which are solved and have a
+ *          positive guess are changed, so fixed prices such as policy taxes
+ *          are left alone.
+ * \param aPeriod The period for which to set the guesses.
+ * \param aPrices The price of each market ordered by market number, as
+ *        returned by getPrices.
+ */
+void Marketplace::setPriceGuesses( const int aPeriod, const vector<double>& aPrices ) {
+    if( static_cast<int>( mPriceGuesses.size() ) <= aPeriod ) {
+        mPriceGuesses.resize( aPeriod + 1 );
+    }
+    mPriceGuesses[ aPeriod ] = aPrices;
+}
+
+/*!
+ * \brief Remove all price guesses so that markets start from their forecast
+ *        prices.
+ */
+void Marketplace::clearPriceGuesses() {
+    mPriceGuesses.clear();
 }
 
 /*! \brief Store the demand, supply and price for each market. 
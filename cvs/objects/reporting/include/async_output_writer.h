@@ -0,0 +1,181 @@
+#ifndef _ASYNC_OUTPUT_WRITER_H_
+#define _ASYNC_OUTPUT_WRITER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file async_output_writer.h
+* \ingroup Objects
+* \brief Header file for the IOutputBlock interface, the FileOutputBlock and
+*        the AsyncOutputWriter classes.
+*/
+
+#include <string>
+#include <sstream>
+#include <memory>
+#include <boost/noncopyable.hpp>
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/tbb_thread.h>
+#include <tbb/concurrent_queue.h>
+#include <tbb/atomic.h>
+#endif
+
+/*!
+ * \ingroup Objects
+ * \brief A finished piece of model output which is ready to be written.
+ * \details Blocks are created on the main thread from a consistent model state
+ *          and must not refer back to the model since they may be written on
+ *          the output writer thread while the model is being changed, solved or
+ *          deleted.
+ */
+class IOutputBlock {
+public:
+    virtual ~IOutputBlock() {}
+
+    /*!
+     * \brief Get the approximate amount of memory held by this block.
+     * \return The size of the block in bytes.
+     */
+    virtual std::size_t getSize() const = 0;
+
+    /*!
+     * \brief Write the block to its final destination.
+     * \note This may be called from the output writer thread.
+     */
+    virtual void write() = 0;
+};
+
+/*!
+ * \ingroup Objects
+ * \brief An output block which buffers text in memory and writes it to a file.
+ * \details The file name is resolved the same way as the AutoOutputFile
+ *          resolves it, and at construction time so that the current scenario
+ *          name is used if it should be appended.
+ */
+class FileOutputBlock : public IOutputBlock {
+public:
+    FileOutputBlock( const std::string& aConfVariableName,
+                     const std::string& aDefaultName );
+
+    /*!
+     * \brief Get the flag if this file should be written.
+     * \return True if this file is being written and false if the output is being ignored.
+     */
+    bool shouldWrite() const {
+        return mShouldWrite;
+    }
+
+    /*! \brief Dereference operator which returns the internal buffer.
+     * \return The internal buffer.
+     */
+    std::ostream& operator*() {
+        return mBuffer;
+    }
+
+    // IOutputBlock methods
+    virtual std::size_t getSize() const;
+
+    virtual void write();
+private:
+    //! The name of the file to write.
+    std::string mFileName;
+
+    //! The flag if this file should be written.
+    const bool mShouldWrite;
+
+    //! The buffered contents of the file.
+    mutable std::stringstream mBuffer;
+};
+
+/*!
+ * \ingroup Objects
+ * \brief Writes output blocks on a dedicated thread so that output I/O does
+ *        not hold up the model.
+ * \details Output blocks are handed to the writer in the order they should be
+ *          written and are written strictly in that order by a single thread.
+ *          The total size of the blocks waiting to be written is limited by
+ *          the async-output-buffer-size configuration value (in MB); if adding
+ *          a block would exceed it the caller waits for the writer to catch up.
+ *          The writer is only active in parallel builds and when the
+ *          async-output configuration flag is set, otherwise blocks are
+ *          written immediately by the calling thread.
+ * \note Currently only the output XML file and the data sent to the XML
+ *       database are written through this class.  The files written by
+ *       writeOutputFiles, the CSV outputs, the batch CSV output and the per
+ *       period outputs are still written synchronously by the model thread.
+ * \warning Users must call waitForCompletion before reading any output which
+ *          may still be queued.
+ */
+class AsyncOutputWriter : private boost::noncopyable {
+public:
+    static AsyncOutputWriter& getInstance();
+
+    ~AsyncOutputWriter();
+
+    bool isEnabled() const;
+
+    void submit( IOutputBlock* aBlock );
+
+    void waitForCompletion();
+private:
+    AsyncOutputWriter();
+
+    //! Whether blocks are written in the background.
+    bool mIsEnabled;
+
+#if GCAM_PARALLEL_ENABLED
+    static void runWriterThread( AsyncOutputWriter* aWriter );
+
+    //! The maximum number of bytes that may be waiting to be written.
+    std::size_t mMaxBufferedBytes;
+
+    //! The number of bytes currently waiting to be written.
+    tbb::atomic<std::size_t> mBufferedBytes;
+
+    //! The number of blocks which have been submitted but not yet written.
+    tbb::atomic<int> mPendingBlocks;
+
+    //! Blocks waiting to be written, a null block signals the writer to stop.
+    tbb::concurrent_bounded_queue<IOutputBlock*> mQueue;
+
+    //! The writer thread, only created if enabled.
+    std::auto_ptr<tbb::tbb_thread> mWriterThread;
+#endif
+};
+
+#endif // _ASYNC_OUTPUT_WRITER_H_
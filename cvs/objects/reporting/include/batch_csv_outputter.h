@@ -44,6 +44,8 @@
 * \author Pralit Patel
 */
 
+#include <iosfwd>
+#include <string>
 #include "util/base/include/default_visitor.h"
 #include "util/base/include/auto_file.h"
 
@@ -59,10 +61,14 @@ class BatchCSVOutputter : public DefaultVisitor {
 public:
     BatchCSVOutputter();
 
+    explicit BatchCSVOutputter( std::ostream& aOut );
+
     ~BatchCSVOutputter();
 
     void writeDidScenarioSolve( bool aDidSolve );
 
+    void writeScenarioOutput( const std::string& aOutput );
+
     //! IVisitor methods
     void startVisitScenario( const Scenario* aScenario, const int aPeriod );
 
@@ -75,6 +81,10 @@ private:
     //! The file to write results to
     AutoOutputFile mFile;
 
+    //! The stream results are written to, which is either the file or a
+    //! stream given to the constructor.
+    std::ostream& mOut;
+
     //! If this is the first scenario to be written
     bool mIsFirstScenario;
 };
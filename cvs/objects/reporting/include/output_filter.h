@@ -0,0 +1,134 @@
+#ifndef _OUTPUT_FILTER_H_
+#define _OUTPUT_FILTER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file output_filter.h
+* \ingroup Objects
+* \brief The OutputFilter class header file.
+*/
+
+#include <string>
+#include <set>
+#include <xercesc/dom/DOMNode.hpp>
+#include "util/base/include/iparsable.h"
+
+/*! 
+* \ingroup Objects
+* \brief A declarative specification of which results a reporting visitor
+*        should write.
+* \details The filter is read from the file named by the Configuration file
+*          variable output-filter.  It contains include and exclude rules for
+*          region, sector and variable names and the level of detail at which
+*          sectors should be reported.  A name passes a rule set if it is not
+*          excluded and either there are no include rules or it is included.
+*          Sector rules apply to supply sectors, resources and final demands.
+*          Variable rules apply to the XML names of the reporting elements,
+*          such as input, output, GHG, LandLeaf, market and climate-model.
+*
+*          <b>XML specification for OutputFilter</b>
+*          - XML name: \c output-filter
+*          - Contained by: None, this is the root of its own file.
+*          - Parsing inherited from class: None.
+*          - Elements:
+*              - \c region OutputFilter::mRegionRules
+*                  - Attributes: \c type Whether to \c include or \c exclude
+*                                the region.
+*              - \c sector OutputFilter::mSectorRules
+*                  - Attributes: \c type As for region.
+*              - \c variable OutputFilter::mVariableRules
+*                  - Attributes: \c type As for region.
+*              - \c aggregation-level OutputFilter::mAggregationLevel
+*                  One of \c sector, \c subsector or \c technology.  Above
+*                  the technology level the outputs, input demands and
+*                  emissions of all technologies are summed into a single
+*                  technology of the sector or subsector. Values which are
+*                  not additive, such as costs and coefficients, are left out.
+*/
+class OutputFilter: public IParsable {
+public:
+    //! The finest level of detail at which sectors are reported.
+    enum AggregationLevel {
+        SECTOR,
+        SUBSECTOR,
+        TECHNOLOGY
+    };
+
+    OutputFilter();
+
+    static const std::string& getXMLNameStatic();
+
+    // IParsable methods
+    virtual bool XMLParse( const xercesc::DOMNode* aNode );
+
+    bool isRegionIncluded( const std::string& aRegionName ) const;
+
+    bool isSectorIncluded( const std::string& aSectorName ) const;
+
+    bool isVariableIncluded( const std::string& aVariableName ) const;
+
+    AggregationLevel getAggregationLevel() const;
+private:
+    /*!
+     * \brief The include and exclude rules for one kind of name.
+     */
+    struct NameRules {
+        //! Names which are included, if empty all names are included.
+        std::set<std::string> mIncluded;
+
+        //! Names which are excluded.
+        std::set<std::string> mExcluded;
+
+        bool isIncluded( const std::string& aName ) const;
+        bool parseRule( const xercesc::DOMNode* aNode );
+    };
+
+    //! Rules for region names.
+    NameRules mRegionRules;
+
+    //! Rules for sector, resource and final demand names.
+    NameRules mSectorRules;
+
+    //! Rules for the XML names of reporting elements.
+    NameRules mVariableRules;
+
+    //! The finest level of detail at which sectors are reported.
+    AggregationLevel mAggregationLevel;
+};
+
+#endif // _OUTPUT_FILTER_H_
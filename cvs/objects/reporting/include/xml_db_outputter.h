@@ -45,17 +45,21 @@
 */
 
 #include <stack>
+#include <map>
 #include <memory>
 #include <iosfwd>
 #include <boost/iostreams/filtering_stream.hpp>
 #include "util/base/include/default_visitor.h"
+#include "reporting/include/async_output_writer.h"
 
 #if( __HAVE_JAVA__ )
 #include <jni.h>
 #include <boost/iostreams/concepts.hpp>
+#include <boost/shared_ptr.hpp>
 #endif
 
 class IndirectEmissionsCalculator;
+class OutputFilter;
 
 /*! 
 * \ingroup Objects
@@ -222,6 +226,9 @@ public:
     virtual void startVisitBuildingServiceInput( const BuildingServiceInput* aBuildingServiceInput, const int aPeriod );
     virtual void endVisitBuildingServiceInput( const BuildingServiceInput* aBuildingServiceInput, const int aPeriod );
 
+    virtual bool shouldVisitRegion( const std::string& aRegionName ) const;
+    virtual bool shouldVisitSector( const std::string& aSectorName ) const;
+
     bool appendData( const std::string& aData, const std::string& aLocation );
 private:
     //! A boost iostream which will send output to the DB as it is printed.
@@ -265,6 +272,33 @@ private:
     //! Indirect emissions calculator for the current region.
     std::auto_ptr<IndirectEmissionsCalculator> mIndirectEmissCalc;
 
+    //! The filter which determines which results are written.
+    std::auto_ptr<OutputFilter> mOutputFilter;
+
+    //! The number of visits which have been started but not ended within an
+    //! element excluded by the output filter.  Nothing is written while this
+    //! is greater than zero.
+    unsigned int mExcludedDepth;
+
+    //! An element within a technology which contains values, identified by its
+    //! XML name, name and type.  The XML name is empty for values of the
+    //! technology itself.
+    typedef std::pair<std::string, std::pair<std::string, std::string> > AggregateElement;
+
+    //! A value within an element, identified by its XML name and attributes.
+    typedef std::pair<std::string, std::map<std::string, std::string> > AggregateItem;
+
+    //! Additive technology values summed over the technologies of the current
+    //! sector or subsector when technologies are not reported.
+    std::map<AggregateElement, std::map<AggregateItem, double> > mAggregateValues;
+
+    //! The element of the current technology which is being visited.
+    AggregateElement mCurrentAggregateElement;
+
+    //! Whether values of the current technology are being summed instead of
+    //! written.
+    bool mIsAggregatingTechnology;
+
 #if( __HAVE_JAVA__ )
     /*!
      * \brief Contains all objects necessary to interact with Java.
@@ -286,13 +320,32 @@ private:
         //! A "global" reference to the actual instance of the mWriteDBClass.
         jobject mWriteDBInstance;
 
+        //! An error flag which may be set if there is an error writing the data
+        //! on the Java side.  It is set by the output writer thread and may be
+        //! read by the main thread.
+#if GCAM_PARALLEL_ENABLED
+        tbb::atomic<bool> mErrorFlag;
+#else
+        bool mErrorFlag;
+#endif
+
+        //! The receiveDataFromGCAM method, looked up when data is first sent.
+        jmethodID mReceiveDataMID;
+
+        //! A "global" reference to the byte array used to send data to Java,
+        //! allocated when data is first sent.
+        jbyteArray mJNIBuffer;
+
         JNIContainer();
         ~JNIContainer();
+
+        JNIEnv* getThreadEnv() const;
     };
 
-    //! An auto pointer to all the JNI data that needs to be maintained through out
-    //! the like of the XMLDBOutputter.
-    const std::auto_ptr<JNIContainer> mJNIContainer;
+    //! A shared pointer to all the JNI data that needs to be maintained through out
+    //! the life of the XMLDBOutputter.  It is shared with any output blocks that
+    //! are waiting to be sent to Java so that they may outlive the XMLDBOutputter.
+    const boost::shared_ptr<JNIContainer> mJNIContainer;
 
     static std::auto_ptr<JNIContainer> createContainer();
 #endif
@@ -305,6 +358,16 @@ private:
         const int aPeriod,
         const std::string& aUnit );
 
+    void writeItemToBuffer( const double aValue,
+        const std::string& aName,
+        std::ostream& out,
+        const Tabs* tabs,
+        const std::map<std::string, std::string>& aAttrs );
+
+    void writeAggregateTechnology( const std::string& aName );
+
+    static bool isAdditiveItem( const std::string& aName );
+
     void writeItem( const std::string& aName,
         const std::string& aUnit,
         const double aValue,
@@ -316,6 +379,10 @@ private:
         const int aYear );
 
     bool isTechnologyOperating( const int aPeriod );
+
+    bool skipStartVisit( const std::string& aVariableName, const bool aIsIncluded = true );
+
+    bool skipEndVisit();
     
     std::iostream* popBufferStack();
 
@@ -329,33 +396,61 @@ private:
      *          of memory to keep the XML document in memory at any point.  Using
      *          the boost::iostreams interface to accomplish this is much easier
      *          and less error prone than trying to do it in the std::iostream.
-     * \note If an error is raised while trying to write the data to the DB the
-     *       error flag in this class will be set.  Since there is no way to stop
-     *       visiting once it has starting the best we can do is ignore all data
-     *       once the error flag is set.
+     *          The data is sent through the AsyncOutputWriter so that, when enabled,
+     *          Java can store it to the database while the model continues.
      */
     class SendToJavaIOSink : public boost::iostreams::sink {
     public:
-        SendToJavaIOSink( const JNIContainer* aJNIContainer );
+        SendToJavaIOSink( const boost::shared_ptr<JNIContainer>& aJNIContainer );
         virtual ~SendToJavaIOSink();
         
         // boost::iostreams::sink methods
         virtual std::streamsize write( const char* aData, std::streamsize aLength );
+
+        //! The same buffer size as the one used in Java, if we try to tune this we should
+        //! adjust it both here and in Java.
+        static const std::streamsize BUFFER_SIZE = 1024 * 1024;
     private:
-        //! A weak pointer to the JNIContainer to communicate with Java
-        const JNIContainer* mJNIContainer;
+        //! The JNIContainer to communicate with Java
+        boost::shared_ptr<JNIContainer> mJNIContainer;
+    };
 
-        //! A JNI method ID to the Java method that will receive the data.
-        jmethodID mReceiveDataMID;
+    /*!
+     * \brief An output block which makes a single call into the Java XMLDBDriver.
+     * \details All calls which send data to or complete the database are made
+     *          through this class so that they are made in order and on the
+     *          thread writing output.
+     * \note If an error is raised while trying to write the data to the DB the
+     *       error flag in the JNIContainer will be set.  Since there is no way to stop
+     *       visiting once it has starting the best we can do is ignore all data
+     *       once the error flag is set.
+     */
+    class JavaOutputBlock : public IOutputBlock {
+    public:
+        //! The Java method to call.
+        enum JavaMethod {
+            RECEIVE_DATA,
+            FINISH,
+            FINALIZE_AND_CLOSE
+        };
 
-        const std::streamsize BUFFER_SIZE;
+        JavaOutputBlock( const boost::shared_ptr<JNIContainer>& aJNIContainer,
+                         const JavaMethod aMethod,
+                         const std::string& aData = std::string() );
 
-        //! A JNI buffer that can be data can be put in to send to Java.
-        jbyteArray mJNIBuffer;
+        // IOutputBlock methods
+        virtual std::size_t getSize() const;
 
-        //! An error flag which may be set if there is an error writing the data
-        //! on the Java side.
-        bool mErrorFlag;
+        virtual void write();
+    private:
+        //! The JNIContainer to communicate with Java
+        boost::shared_ptr<JNIContainer> mJNIContainer;
+
+        //! The Java method to call.
+        const JavaMethod mMethod;
+
+        //! Data to send to Java, only used for RECEIVE_DATA.
+        const std::string mData;
     };
 #endif
 
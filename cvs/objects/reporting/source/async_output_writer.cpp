@@ -0,0 +1,198 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file async_output_writer.cpp
+* \ingroup Objects
+* \brief FileOutputBlock and AsyncOutputWriter class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <fstream>
+#include "reporting/include/async_output_writer.h"
+#include "util/base/include/configuration.h"
+#include "util/base/include/util.h"
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/tick_count.h>
+#endif
+
+using namespace std;
+
+/*!
+ * \brief Create a file output block with a name found from the Configuration.
+ * \details Checks the Configuration for a variable with the given name. If
+ *          it is not found, the given default name is used.
+ * \param aConfVariableName Name of the configuration variable that stores
+ *        the file name.
+ * \param aDefaultName Filename to use if the variable is not found.
+ */
+FileOutputBlock::FileOutputBlock( const string& aConfVariableName,
+                                  const string& aDefaultName )
+:mShouldWrite( Configuration::getInstance()->shouldWriteFile( aConfVariableName ) )
+{
+    const Configuration* conf = Configuration::getInstance();
+    if( mShouldWrite ) {
+        mFileName = conf->getFile( aConfVariableName, aDefaultName );
+        if( conf->shouldAppendScnToFile( aConfVariableName ) ) {
+            mFileName = util::appendScenarioToFileName( mFileName );
+        }
+    }
+}
+
+size_t FileOutputBlock::getSize() const {
+    // Note that this is an estimate which ignores the stream's own overhead.
+    return static_cast<size_t>( mBuffer.tellp() );
+}
+
+void FileOutputBlock::write() {
+    if( !mShouldWrite ) {
+        return;
+    }
+    ofstream file( mFileName.c_str(), ios::out );
+    util::checkIsOpen( file, mFileName );
+    file << mBuffer.rdbuf();
+}
+
+/*!
+ * \brief Get the single instance of the output writer.
+ * \details The writer is created the first time this is called and therefore
+ *          this must not be called until the Configuration has been parsed.
+ * \return The output writer.
+ */
+AsyncOutputWriter& AsyncOutputWriter::getInstance() {
+    static AsyncOutputWriter sInstance;
+    return sInstance;
+}
+
+//! Constructor which will start the writer thread if it is enabled.
+AsyncOutputWriter::AsyncOutputWriter()
+{
+#if GCAM_PARALLEL_ENABLED
+    const Configuration* conf = Configuration::getInstance();
+    mIsEnabled = conf->getBool( "async-output", false, false );
+    mMaxBufferedBytes = static_cast<size_t>( conf->getInt( "async-output-buffer-size", 512, false ) ) * 1024 * 1024;
+    mBufferedBytes = 0;
+    mPendingBlocks = 0;
+    if( mIsEnabled ) {
+        mWriterThread.reset( new tbb::tbb_thread( &AsyncOutputWriter::runWriterThread, this ) );
+    }
+#else
+    mIsEnabled = false;
+#endif
+}
+
+/*!
+ * \brief Destructor which will write any remaining blocks and stop the writer
+ *        thread.
+ */
+AsyncOutputWriter::~AsyncOutputWriter() {
+#if GCAM_PARALLEL_ENABLED
+    if( mWriterThread.get() ) {
+        mQueue.push( 0 );
+        mWriterThread->join();
+    }
+#endif
+}
+
+/*!
+ * \brief Whether blocks are being written in the background.
+ * \details Callers may use this to avoid buffering output in memory when it
+ *          would just be written immediately anyway.
+ * \return True if blocks are written by the writer thread.
+ */
+bool AsyncOutputWriter::isEnabled() const {
+    return mIsEnabled;
+}
+
+/*!
+ * \brief Submit a block to be written.
+ * \details Blocks are written in the order they were submitted.  If the writer
+ *          is not enabled the block is written before this method returns.
+ *          Otherwise this will only wait if the buffer is full.  A single
+ *          block which is larger than the entire buffer is allowed through
+ *          once the writer has caught up.
+ * \param aBlock The block to write, ownership is transferred to the writer.
+ */
+void AsyncOutputWriter::submit( IOutputBlock* aBlock ) {
+    auto_ptr<IOutputBlock> block( aBlock );
+#if GCAM_PARALLEL_ENABLED
+    if( mIsEnabled ) {
+        const size_t blockSize = block->getSize();
+        const tbb::tick_count::interval_t waitInterval( 0.001 );
+        while( mPendingBlocks > 0 && mBufferedBytes + blockSize > mMaxBufferedBytes ) {
+            tbb::this_tbb_thread::sleep( waitInterval );
+        }
+        mBufferedBytes += blockSize;
+        ++mPendingBlocks;
+        mQueue.push( block.release() );
+        return;
+    }
+#endif
+    block->write();
+}
+
+/*!
+ * \brief Wait until all blocks which have been submitted have been written.
+ */
+void AsyncOutputWriter::waitForCompletion() {
+#if GCAM_PARALLEL_ENABLED
+    const tbb::tick_count::interval_t waitInterval( 0.001 );
+    while( mPendingBlocks > 0 ) {
+        tbb::this_tbb_thread::sleep( waitInterval );
+    }
+#endif
+}
+
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief The body of the writer thread.
+ * \details Writes blocks in the order they were queued until a null block
+ *          is received.
+ * \param aWriter The output writer to process.
+ */
+void AsyncOutputWriter::runWriterThread( AsyncOutputWriter* aWriter ) {
+    IOutputBlock* currBlock = 0;
+    while( true ) {
+        aWriter->mQueue.pop( currBlock );
+        if( !currBlock ) {
+            break;
+        }
+        const size_t blockSize = currBlock->getSize();
+        currBlock->write();
+        delete currBlock;
+        aWriter->mBufferedBytes -= blockSize;
+        --aWriter->mPendingBlocks;
+    }
+}
+#endif
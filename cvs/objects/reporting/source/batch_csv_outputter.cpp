@@ -38,7 +38,6 @@
 * \details This source file contains the definition for the startVisit and endVisit methods
 *          for each class that the visitor visits.  Values will be written directly to the
 *          file specified by the configuration paramater batchCSVOutputFile.
-* \todo Figure out why I need a string to output doubles/chars to an AutoOutputFile.
 * \author Pralit Patel
 */
 
@@ -64,6 +63,20 @@ using namespace std;
 */
 BatchCSVOutputter::BatchCSVOutputter():
 mFile( "batchCSVOutputFile", "batch-csv-out.csv" ),
+mOut( *mFile ),
+mIsFirstScenario(true)
+{
+}
+
+/*! \brief Constructor which writes results to the given stream instead of the
+*          configured file.
+* \details This is used to write the results of a scenario run in another
+*          process so that they can be passed back to writeScenarioOutput.
+* \param aOut The stream to write results to.
+*/
+BatchCSVOutputter::BatchCSVOutputter( ostream& aOut ):
+mFile( "batchCSVOutputFile", "batch-csv-out.csv", false ),
+mOut( aOut ),
 mIsFirstScenario(true)
 {
 }
@@ -81,18 +94,18 @@ void BatchCSVOutputter::startVisitScenario( const Scenario* aScenario, const int
     // we can not put this in the constructor because we will not have a model time
     // a that point
     if( mIsFirstScenario ) {
-        mFile << "Scenario" << ',';
+        mOut << "Scenario" << ',';
         const Modeltime* modeltime = aScenario->getModeltime();
 
         for( int period = 0; period < modeltime->getmaxper(); ++period ) {
             // TODO: hard coding CO2
             const int year = modeltime->getper_to_yr( period );
-            mFile << year << ' '<< "CO2 Price" << ',';
+            mOut << year << ' '<< "CO2 Price" << ',';
         }
         for( int period = 0; period < modeltime->getmaxper(); ++period ) {
             // TODO: hard coding CO2
             const int year = modeltime->getper_to_yr( period );
-            mFile << year << ' '<< "CO2 Emissions" << ',';
+            mOut << year << ' '<< "CO2 Emissions" << ',';
         }
 
         int outputInterval = Configuration::getInstance()->getInt( "climateOutputInterval",
@@ -105,25 +118,25 @@ void BatchCSVOutputter::startVisitScenario( const Scenario* aScenario, const int
              year <= endingYear; year += outputInterval )
         {
             // TODO: hard coding CO2
-            mFile << year << ' '<< "CO2 Concentration" << ',';
+            mOut << year << ' '<< "CO2 Concentration" << ',';
         }
         for( int year = scenario->getModeltime()->getStartYear();
              year <= endingYear; year += outputInterval )
         {
             // TODO: hard coding CO2
-            mFile << year << ' '<< "CO2 Radiative Forcing" << ',';
+            mOut << year << ' '<< "CO2 Radiative Forcing" << ',';
         }
         for( int year = scenario->getModeltime()->getStartYear();
              year <= endingYear; year += outputInterval )
         {
             // TODO: hard coding CO2
-            mFile << year << ' '<< "CO2 Temperature Change" << ',';
+            mOut << year << ' '<< "CO2 Temperature Change" << ',';
         }
-        mFile << "Solved" << endl;
+        mOut << "Solved" << endl;
     }
     mIsFirstScenario = false;
 
-    mFile << aScenario->getName() << ',';
+    mOut << aScenario->getName() << ',';
     // TODO: perhaps write some date/time or something
 }
 
@@ -132,10 +145,10 @@ void BatchCSVOutputter::startVisitMarket( const Market* aMarket, const int aPeri
         /*!
          * \warninng This is assuming the periods will be visited in appropriate order.
          */
-        mFile << "" << aMarket->getPrice() << ',';
+        mOut << aMarket->getPrice() << ',';
         
         // would this be wrong if it didn't solve?
-        //mFile << "" << aMarket->getDemand() << ',';
+        //mOut << aMarket->getDemand() << ',';
     }
 }
 
@@ -143,7 +156,7 @@ void BatchCSVOutputter::startVisitClimateModel( const IClimateModel* aClimateMod
     const Modeltime* modeltime = scenario->getModeltime();
     for( int period = 0; period < modeltime->getmaxper(); ++period ) {
         const int year = modeltime->getper_to_yr( period );
-        mFile << "" << aClimateModel->getEmissions( "CO2", year ) << ',';
+        mOut << aClimateModel->getEmissions( "CO2", year ) << ',';
     }
     
     int outputInterval
@@ -157,17 +170,17 @@ void BatchCSVOutputter::startVisitClimateModel( const IClimateModel* aClimateMod
     for( int year = modeltime->getStartYear();
          year <= endingYear; year += outputInterval )
     {
-        mFile << "" << aClimateModel->getConcentration( "CO2", year ) << ',';
+        mOut << aClimateModel->getConcentration( "CO2", year ) << ',';
     }
     for( int year = modeltime->getStartYear();
          year <= endingYear; year += outputInterval )
     {
-        mFile << "" << aClimateModel->getForcing( "CO2", year) << ',';
+        mOut << aClimateModel->getForcing( "CO2", year) << ',';
     }
     for( int year = modeltime->getStartYear();
          year <= endingYear; year += outputInterval )
     {
-        mFile << "" << aClimateModel->getTemperature( year ) << ',';
+        mOut << aClimateModel->getTemperature( year ) << ',';
     }
 }
 
@@ -176,5 +189,26 @@ void BatchCSVOutputter::startVisitClimateModel( const IClimateModel* aClimateMod
  * \param aDidSolve Whether the current scenario solved.
  */
 void BatchCSVOutputter::writeDidScenarioSolve( bool aDidSolve ) {
-    mFile << aDidSolve << endl;
+    mOut << aDidSolve << endl;
+}
+
+/*!
+ * \brief Write the results of a scenario which were written to a stream by
+ *        another BatchCSVOutputter.
+ * \details The results of a new outputter begin with the header, which is
+ *          only kept if no scenario has been written yet.
+ * \param aOutput The results of a single scenario.
+ */
+void BatchCSVOutputter::writeScenarioOutput( const string& aOutput ) {
+    if( mIsFirstScenario ) {
+        mOut << aOutput;
+        mIsFirstScenario = false;
+    }
+    else {
+        const string::size_type headerEnd = aOutput.find( '\n' );
+        if( headerEnd != string::npos ) {
+            mOut << aOutput.substr( headerEnd + 1 );
+        }
+    }
+    mOut.flush();
 }
@@ -0,0 +1,192 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*! 
+* \file output_filter.cpp
+* \ingroup Objects
+* \brief OutputFilter class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <xercesc/dom/DOMNode.hpp>
+#include <xercesc/dom/DOMNodeList.hpp>
+#include "reporting/include/output_filter.h"
+#include "util/base/include/xml_helper.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+using namespace xercesc;
+
+//! Default constructor which will allow all output at full detail.
+OutputFilter::OutputFilter():
+mAggregationLevel( TECHNOLOGY )
+{
+}
+
+/*!
+ * \brief Get the XML node name in static form for comparison when parsing XML.
+ * \return The constant XML_NAME as a static.
+ */
+const string& OutputFilter::getXMLNameStatic() {
+    const static string XML_NAME = "output-filter";
+    return XML_NAME;
+}
+
+bool OutputFilter::XMLParse( const DOMNode* aNode ) {
+    /*! \pre make sure we were passed a valid node. */
+    assert( aNode );
+
+    bool success = true;
+
+    // get all child nodes.
+    const DOMNodeList* nodeList = aNode->getChildNodes();
+
+    // loop through the child nodes.
+    for( unsigned int i = 0; i < nodeList->getLength(); i++ ){
+        const DOMNode* curr = nodeList->item( i );
+        if( curr->getNodeType() != DOMNode::ELEMENT_NODE ){
+            continue;
+        }
+        const string nodeName = XMLHelper<string>::safeTranscode( curr->getNodeName() );
+        if( nodeName == "region" ){
+            success &= mRegionRules.parseRule( curr );
+        }
+        else if( nodeName == "sector" ){
+            success &= mSectorRules.parseRule( curr );
+        }
+        else if( nodeName == "variable" ){
+            success &= mVariableRules.parseRule( curr );
+        }
+        else if( nodeName == "aggregation-level" ){
+            const string level = XMLHelper<string>::getValue( curr );
+            if( level == "sector" ){
+                mAggregationLevel = SECTOR;
+            }
+            else if( level == "subsector" ){
+                mAggregationLevel = SUBSECTOR;
+            }
+            else if( level == "technology" ){
+                mAggregationLevel = TECHNOLOGY;
+            }
+            else {
+                ILogger& mainLog = ILogger::getLogger( "main_log" );
+                mainLog.setLevel( ILogger::ERROR );
+                mainLog << "Invalid aggregation-level " << level << " found while parsing "
+                        << getXMLNameStatic() << "." << endl;
+                success = false;
+            }
+        }
+        else {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Unrecognized text string: " << nodeName << " found while parsing "
+                    << getXMLNameStatic() << "." << endl;
+        }
+    }
+    return success;
+}
+
+/*!
+ * \brief Whether results for the given region should be written.
+ * \param aRegionName The name of the region.
+ * \return Whether the region passes the region rules.
+ */
+bool OutputFilter::isRegionIncluded( const string& aRegionName ) const {
+    return mRegionRules.isIncluded( aRegionName );
+}
+
+/*!
+ * \brief Whether results for the given sector should be written.
+ * \param aSectorName The name of the supply sector, resource, or final demand.
+ * \return Whether the sector passes the sector rules.
+ */
+bool OutputFilter::isSectorIncluded( const string& aSectorName ) const {
+    return mSectorRules.isIncluded( aSectorName );
+}
+
+/*!
+ * \brief Whether a reporting element and its children should be written.
+ * \param aVariableName The XML name of the reporting element.
+ * \return Whether the element passes the variable rules.
+ */
+bool OutputFilter::isVariableIncluded( const string& aVariableName ) const {
+    return mVariableRules.isIncluded( aVariableName );
+}
+
+/*!
+ * \brief Get the finest level of detail at which sectors should be reported.
+ * \return The aggregation level.
+ */
+OutputFilter::AggregationLevel OutputFilter::getAggregationLevel() const {
+    return mAggregationLevel;
+}
+
+/*!
+ * \brief Whether the name passes the rules.
+ * \param aName The name to check.
+ * \return True if the name is not excluded and either there are no include
+ *         rules or it is included.
+ */
+bool OutputFilter::NameRules::isIncluded( const string& aName ) const {
+    if( mExcluded.find( aName ) != mExcluded.end() ){
+        return false;
+    }
+    return mIncluded.empty() || mIncluded.find( aName ) != mIncluded.end();
+}
+
+/*!
+ * \brief Parse a single include or exclude rule.
+ * \param aNode The rule node, the type attribute gives the kind of rule and
+ *        the value gives the name.
+ * \return Whether the rule was valid.
+ */
+bool OutputFilter::NameRules::parseRule( const DOMNode* aNode ) {
+    const string type = XMLHelper<string>::getAttr( aNode, "type" );
+    const string name = XMLHelper<string>::getValue( aNode );
+    if( type == "include" ){
+        mIncluded.insert( name );
+    }
+    else if( type == "exclude" ){
+        mExcluded.insert( name );
+    }
+    else {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::ERROR );
+        mainLog << "Invalid rule type " << type << " for " << name << " found while parsing "
+                << getXMLNameStatic() << "." << endl;
+        return false;
+    }
+    return true;
+}
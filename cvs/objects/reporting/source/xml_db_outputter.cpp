@@ -95,6 +95,7 @@
 #include "sectors/include/more_sector_info.h"
 #include "util/base/include/util.h"
 #include "reporting/include/indirect_emissions_calculator.h"
+#include "reporting/include/output_filter.h"
 #include "technologies/include/default_technology.h"
 #include "technologies/include/iproduction_state.h"
 #include "util/base/include/auto_file.h"
@@ -110,6 +111,7 @@
 #include "functions/include/building_node_input.h"
 #include "functions/include/building_service_input.h"
 #include "functions/include/satiation_demand_function.h"
+#include "util/base/include/forked_task_runner.h"
 #include <typeinfo>
 
 // Whether to write a text file with the contents that are to be inserted
@@ -147,22 +149,36 @@ using namespace boost::iostreams;
 // Static initialize the JavaVM to be null
 JavaVM* XMLDBOutputter::JNIContainer::mJavaVM = 0;
 
+// Define the buffer size constant, the value is given in the declaration.
+const streamsize XMLDBOutputter::SendToJavaIOSink::BUFFER_SIZE;
+
 /*!
  * \brief Constructor for the JNI container.
  * \see createContainer()
  */
 XMLDBOutputter::JNIContainer::JNIContainer():
-mJavaEnv( 0 )
+mJavaEnv( 0 ),
+mWriteDBClass( 0 ),
+mWriteDBInstance( 0 ),
+mReceiveDataMID( 0 ),
+mJNIBuffer( 0 )
 {
+    mErrorFlag = false;
 }
 
 /*!
  * \brief Destructor for the JNI container.
+ * \note The container may be destroyed by the output writer thread if it was
+ *       the last to use it.
  */
 XMLDBOutputter::JNIContainer::~JNIContainer() {
     if( mJavaEnv ) {
-        mJavaEnv->DeleteGlobalRef( mWriteDBClass );
-        mJavaEnv->DeleteGlobalRef( mWriteDBInstance );
+        JNIEnv* currEnv = getThreadEnv();
+        currEnv->DeleteGlobalRef( mWriteDBClass );
+        currEnv->DeleteGlobalRef( mWriteDBInstance );
+        if( mJNIBuffer ) {
+            currEnv->DeleteGlobalRef( mJNIBuffer );
+        }
     }
 
     // Apparently this is a bug since the beginning of time for Java, the DestroyJavaVM
@@ -173,17 +189,43 @@ XMLDBOutputter::JNIContainer::~JNIContainer() {
         mJavaVM->DestroyJavaVM();
     }*/
 }
+
+/*!
+ * \brief Get the Java environment for the calling thread.
+ * \details A JNIEnv is only valid on the thread it was created for so any thread
+ *          other than the one which created the container must attach itself to
+ *          the Java VM.  Threads are left attached since the Java VM is never
+ *          shut down.
+ * \return The Java environment for the current thread.
+ */
+JNIEnv* XMLDBOutputter::JNIContainer::getThreadEnv() const {
+    JNIEnv* currEnv = 0;
+    if( mJavaVM->GetEnv( (void**)&currEnv, JNI_VERSION_1_6 ) == JNI_EDETACHED ) {
+        mJavaVM->AttachCurrentThread( (void**)&currEnv, 0 );
+    }
+    return currEnv;
+}
 #endif
 
 /*! \brief Constructor
 */
 XMLDBOutputter::XMLDBOutputter():
 mTabs( new Tabs ),
-mGDP( 0 )
+mGDP( 0 ),
+mOutputFilter( new OutputFilter ),
+mExcludedDepth( 0 ),
+mIsAggregatingTechnology( false )
 #if( __HAVE_JAVA__ )
 ,mJNIContainer( createContainer() )
 #endif
 {
+    // Read the output filter if one was configured, otherwise everything is
+    // written.
+    const string& filterFileName = Configuration::getInstance()->getFile( "output-filter", "", false );
+    if( !filterFileName.empty() ) {
+        XMLHelper<void>::parseXML( filterFileName, mOutputFilter.get() );
+    }
+
 #if( DEBUG_XML_DB )
     // Have data written to mBuffer go to the debug_db file as well.
     file_sink debugDBSink( "debug_db.xml" );
@@ -193,9 +235,10 @@ mGDP( 0 )
 #endif
 
 #if( __HAVE_JAVA__ )
-    // Set Java as the sink of data for mBuffer.
-    SendToJavaIOSink sendToJavaSink( mJNIContainer.get() );
-    mBuffer.push( sendToJavaSink );
+    // Set Java as the sink of data for mBuffer.  Buffer as much data as Java will
+    // receive at a time so that each piece sent is as large as possible.
+    SendToJavaIOSink sendToJavaSink( mJNIContainer );
+    mBuffer.push( sendToJavaSink, SendToJavaIOSink::BUFFER_SIZE );
 #else
     mBuffer.push( null_sink() );
 #endif
@@ -213,7 +256,9 @@ XMLDBOutputter::~XMLDBOutputter(){
  * \brief Write the output to the database.
  * \details In order to keep the memory usage down data has been writing to the
  *          database as XML was being generated.  We will signal that no more data
- *          will be generated and wait for it to finish here.
+ *          will be generated here.  If the AsyncOutputWriter is enabled this will
+ *          return immediately and the output writer will wait for the database
+ *          to finish, otherwise we wait for it here.
  */
 void XMLDBOutputter::finish() const {
     // Close mBuffer so that no more data can be written.
@@ -225,19 +270,7 @@ void XMLDBOutputter::finish() const {
         // have already been given.
         return;
     }
-    // First we need to look up the appropriate "finish" Java method with no
-    // arguments and void return: "()V" then call it.
-    jmethodID finishMID = mJNIContainer->mJavaEnv->GetMethodID( mJNIContainer->mWriteDBClass, "finish", "()V" );
-    if( !finishMID ) {
-        ILogger& mainLog = ILogger::getLogger( "main_log" );
-        mainLog.setLevel( ILogger::SEVERE );
-        mainLog << "Failed to find JNI method: finish" << endl;
-        return;
-    }
-
-    // The java method will wait until the database is done processing all data
-    // before returning.
-    mJNIContainer->mJavaEnv->CallVoidMethod( mJNIContainer->mWriteDBInstance, finishMID );
+    AsyncOutputWriter::getInstance().submit( new JavaOutputBlock( mJNIContainer, JavaOutputBlock::FINISH ) );
 #endif
 }
 
@@ -245,26 +278,14 @@ void XMLDBOutputter::finish() const {
  * \brief A method to inform us that no more data will be appended to the open database so we can
  *        now run any addtional processing necessary and close the database.
  * \details We will simply call the finalizeAndClose method on the XMLDBDriver to do the work.
- *          It may potentially run queries if configured then close the database.
+ *          It may potentially run queries if configured then close the database.  This is done
+ *          through the AsyncOutputWriter so it will not happen until all data has been sent.
  */
 void XMLDBOutputter::finalizeAndClose() {
 #if( __HAVE_JAVA__ )
     // Call finalizeAndClose on the XMLDBDriver if it was successfully opened in the first place.
     if( mJNIContainer.get() ) {
-        // First we need to look up the appropriate "finalizeAndClose" Java method with no
-        // arguments and void return: "()V" then call it.
-        jmethodID finalizeMID = mJNIContainer->mJavaEnv->GetMethodID( mJNIContainer->mWriteDBClass,
-                "finalizeAndClose", "()V" );
-        if( !finalizeMID ) {
-            ILogger& mainLog = ILogger::getLogger( "main_log" );
-            mainLog.setLevel( ILogger::SEVERE );
-            mainLog << "Failed to find JNI method: finalizeAndClose" << endl;
-            return;
-        }
-
-        // The java method will (potentially) run queries then close the database
-        // before returning.
-        mJNIContainer->mJavaEnv->CallVoidMethod( mJNIContainer->mWriteDBInstance, finalizeMID );
+        AsyncOutputWriter::getInstance().submit( new JavaOutputBlock( mJNIContainer, JavaOutputBlock::FINALIZE_AND_CLOSE ) );
     }
 #endif
 }
@@ -277,6 +298,10 @@ void XMLDBOutputter::finalizeAndClose() {
  *         a null container will be returned.
  */
 auto_ptr<XMLDBOutputter::JNIContainer> XMLDBOutputter::createContainer() {
+    // A previous scenario may still be storing its results, wait for it to be
+    // finished and the database closed before opening it again.
+    AsyncOutputWriter::getInstance().waitForCompletion();
+
     // Create a Java instance.
     auto_ptr<JNIContainer> jniContainer( new JNIContainer );
 
@@ -304,6 +329,8 @@ auto_ptr<XMLDBOutputter::JNIContainer> XMLDBOutputter::createContainer() {
     vmArgs.ignoreUnrecognized = false;
     if( !jniContainer->mJavaVM ) {
         JNI_CreateJavaVM( &jniContainer->mJavaVM, (void**)&jniContainer->mJavaEnv, &vmArgs );
+        // The threads of the Java VM would not exist in a forked child.
+        ForkedTaskRunner::disableForking();
     }
     else {
         jniContainer->mJavaVM->AttachCurrentThread( (void**)&jniContainer->mJavaEnv, &vmArgs );
@@ -418,6 +445,9 @@ bool XMLDBOutputter::appendData( const string& aData, const string& aLocation )
         return false;
     }
 
+    // The document must be completely stored before we can append to it.
+    AsyncOutputWriter::getInstance().waitForCompletion();
+
     // Find the appendData method for the class which takes two string arguments:
     // "(Ljava/lang/String;Ljava/lang/String;)Z".  The arguments are the data, and
     // an XPath which gives the location after which to insert the data.  It will
@@ -666,14 +696,31 @@ void XMLDBOutputter::startVisitSector( const Sector* aSector, const int aPeriod
         }
     }
 
+    // Write the total output along with the technology totals when the
+    // subsectors are not reported.
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SECTOR ) {
+        for( int i = 0; i < modeltime->getmaxper(); ++i ){
+            writeItem( "output", mCurrentOutputUnit, aSector->getOutput( i ), i );
+        }
+    }
+
     // We want to write the keywords last due to limitations in
     // XPath we could be searching for them using following-sibling
-    if( !aSector->mKeywordMap.empty() ) {
+    // When aggregating at the sector level the technology totals are still to
+    // be written so the keywords are written by endVisitSector.
+    if( !aSector->mKeywordMap.empty() && mOutputFilter->getAggregationLevel() != OutputFilter::SECTOR ) {
         XMLWriteElementWithAttributes( "", "keyword", mBuffer, mTabs.get(), aSector->mKeywordMap );
     }
 }
 
 void XMLDBOutputter::endVisitSector( const Sector* aSector, const int aPeriod ){
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SECTOR ) {
+        writeAggregateTechnology( aSector->getName() );
+        if( !aSector->mKeywordMap.empty() ) {
+            XMLWriteElementWithAttributes( "", "keyword", mBuffer, mTabs.get(), aSector->mKeywordMap );
+        }
+    }
+
     // Write the closing sector tag.
     XMLWriteClosingTag( aSector->getXMLName(), mBuffer, mTabs.get() );
 
@@ -687,6 +734,12 @@ void XMLDBOutputter::endVisitSector( const Sector* aSector, const int aPeriod ){
 void XMLDBOutputter::startVisitSubsector( const Subsector* aSubsector,
                                           const int aPeriod )
 {
+    // Subsectors are not reported when aggregating at the sector level, their
+    // technologies are summed into the sector instead.
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SECTOR ) {
+        return;
+    }
+
     // Write the opening subsector tag and the type of the base class.
     XMLWriteOpeningTag( aSubsector->getXMLName(), mBuffer, mTabs.get(),
         aSubsector->getName(), 0, Subsector::getXMLNameStatic() );
@@ -704,16 +757,33 @@ void XMLDBOutputter::startVisitSubsector( const Subsector* aSubsector,
             writeItem( "cost", mCurrentPriceUnit, currValue, i );
         }
     }
+    // Write the total output along with the technology totals when the
+    // technologies are not reported.
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SUBSECTOR ) {
+        for( int i = 0; i < modeltime->getmaxper(); ++i ){
+            writeItem( "output", mCurrentOutputUnit, aSubsector->getOutput( i ), i );
+        }
+    }
 }
 
 void XMLDBOutputter::endVisitSubsector( const Subsector* aSubsector,
                                         const int aPeriod )
 {
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SECTOR ) {
+        return;
+    }
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SUBSECTOR ) {
+        writeAggregateTechnology( aSubsector->getName() );
+    }
+
     // Write the closing subsector tag.
     XMLWriteClosingTag( aSubsector->getXMLName(), mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitTranSubsector( const TranSubsector* aTranSubsector, const int aPeriod ) {
+    if( mOutputFilter->getAggregationLevel() == OutputFilter::SECTOR ) {
+        return;
+    }
     const Modeltime* modeltime = scenario->getModeltime();
     for( int i = 0; i < modeltime->getmaxper(); ++i ){
         double currValue = aTranSubsector->speed[ i ];
@@ -777,6 +847,11 @@ void XMLDBOutputter::startVisitTechnology( const Technology* aTechnology, const
     // information on current technology.
     mCurrentTechnology = aTechnology;
 
+    // When technologies are not reported their values are summed by
+    // writeItemToBuffer and written with the subsector or sector.
+    mIsAggregatingTechnology = mOutputFilter->getAggregationLevel() != OutputFilter::TECHNOLOGY;
+    mCurrentAggregateElement = AggregateElement();
+
     // write the technology tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank technologies
     stringstream* parentBuffer = new stringstream();
@@ -794,7 +869,8 @@ void XMLDBOutputter::startVisitTechnology( const Technology* aTechnology, const
     mBufferStack.push( childBuffer );
 
     if( !objects::isEqual<double>( aTechnology->getShareWeight(), 0.0 ) ) {
-        XMLWriteElement( aTechnology->getShareWeight(), "share-weight", *childBuffer, mTabs.get() );
+        writeItemToBuffer( aTechnology->getShareWeight(), "share-weight", *childBuffer, mTabs.get(),
+                           map<string, string>() );
     }
 
     // children of technology go in the child buffer
@@ -824,7 +900,12 @@ void XMLDBOutputter::endVisitTechnology( const Technology* aTechnology,
     // if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
     iostream* parentBuffer = popBufferStack();
-    if( /*!childBuffer->str().empty()*/ childBuffer->rdbuf()->in_avail() ){
+    if( mIsAggregatingTechnology ) {
+        // The values have been summed, only the tag is discarded.
+        mIsAggregatingTechnology = false;
+        mTabs->decreaseIndent();
+    }
+    else if( /*!childBuffer->str().empty()*/ childBuffer->rdbuf()->in_avail() ){
         mBuffer << parentBuffer->rdbuf() << childBuffer->rdbuf();
         // We want to write the keywords last due to limitations in 
         // XPath we could be searching for them using following-sibling
@@ -863,6 +944,9 @@ void XMLDBOutputter::startVisitMiniCAMInput( const MiniCAMInput* aInput, const i
     // we use startVisitInput to write out the generic input information, however
     // startVisitInput will never be called by an accept so we do it here
     startVisitInput( aInput, aPeriod );
+    if( mExcludedDepth > 0 ) {
+        return;
+    }
         
     // We want to write the keywords last due to limitations in 
     // XPath we could be searching for them using following-sibling
@@ -878,6 +962,10 @@ void XMLDBOutputter::endVisitMiniCAMInput( const MiniCAMInput* aInput, const int
 }
 
 void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod ) {
+    if( skipStartVisit( "input" ) ) {
+        return;
+    }
+
     // write the input tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank inputs
     stringstream* parentBuffer = new stringstream();
@@ -885,6 +973,8 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
 
     // the opening tag gets written in the parent buffer
     XMLWriteOpeningTag( aInput->getXMLReportingName(), *parentBuffer, mTabs.get(), aInput->getName(), 0, "input" );
+    mCurrentAggregateElement = AggregateElement( aInput->getXMLReportingName(),
+                                                 make_pair( aInput->getName(), string( "input" ) ) );
     
     // put the buffers on a stack so that we have the correct ordering
     mBufferStack.push( parentBuffer );
@@ -912,7 +1002,7 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
             currValue = aInput->getPricePaid( mCurrentRegion, i );
             if( !objects::isEqual<double>( currValue, 0.0 ) ) {
                 attrs[ "unit" ] = mCurrentPriceUnit;
-                XMLWriteElementWithAttributes( currValue, "price-paid", *childBuffer,
+                writeItemToBuffer( currValue, "price-paid", *childBuffer,
                     mTabs.get(), attrs );
             }
         }
@@ -933,7 +1023,7 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
             if ( attrs[ "unit" ] == "" ) {
                attrs[ "unit" ] = mCurrentInputUnit;
             }
-            XMLWriteElementWithAttributes( currValue, "demand-physical", *childBuffer,
+            writeItemToBuffer( currValue, "demand-physical", *childBuffer,
                 mTabs.get(), attrs );
         }
 
@@ -941,7 +1031,7 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
         currValue = aInput->getCurrencyDemand( i );
         if( !objects::isEqual<double>( currValue, 0.0 ) ) {
             attrs[ "unit" ] = mCurrentPriceUnit;
-            XMLWriteElementWithAttributes( currValue, "demand-currency", *childBuffer,
+            writeItemToBuffer( currValue, "demand-currency", *childBuffer,
                 mTabs.get(), attrs );
         }
 
@@ -952,7 +1042,7 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
             !objects::isEqual<double>( aInput->getPhysicalDemand( i ), 0.0 ) )
         {
             attrs[ "unit" ] = "unitless";
-            XMLWriteElementWithAttributes( currValue, "IO-coefficient", *childBuffer,
+            writeItemToBuffer( currValue, "IO-coefficient", *childBuffer,
                 mTabs.get(), attrs );
         }
 
@@ -960,13 +1050,19 @@ void XMLDBOutputter::startVisitInput( const IInput* aInput, const int aPeriod )
         currValue = aInput->getCarbonContent( i );
         if( !objects::isEqual<double>( currValue, 0.0 ) ) {
             attrs[ "unit" ] = "MTC";
-            XMLWriteElementWithAttributes( currValue, "carbon-content", *childBuffer,
+            writeItemToBuffer( currValue, "carbon-content", *childBuffer,
                 mTabs.get(), attrs );
         }
     }
 }
 
 void XMLDBOutputter::endVisitInput( const IInput* aInput, const int aPeriod ) {
+    if( skipEndVisit() ) {
+        return;
+    }
+
+    mCurrentAggregateElement = AggregateElement();
+
     // Write the input (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -988,6 +1084,10 @@ void XMLDBOutputter::endVisitInput( const IInput* aInput, const int aPeriod ) {
 }
 
 void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod ) {
+    if( skipStartVisit( "output" ) ) {
+        return;
+    }
+
     // write the output tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank outputs
     stringstream* parentBuffer = new stringstream();
@@ -995,6 +1095,8 @@ void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod
 
     // the opening tag gets written in the parent buffer
     XMLWriteOpeningTag( aOutput->getXMLReportingName(), *parentBuffer, mTabs.get(), aOutput->getName(), 0, "output" );
+    mCurrentAggregateElement = AggregateElement( aOutput->getXMLReportingName(),
+                                                 make_pair( aOutput->getName(), string( "output" ) ) );
 
     // put the buffers on a stack so that we have the correct ordering
     mBufferStack.push( parentBuffer );
@@ -1023,7 +1125,7 @@ void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod
         // Write physical output for each output.
         double currValue = aOutput->getPhysicalOutput( curr );
         if( !objects::isEqual<double>( currValue, 0.0 ) ) {
-            XMLWriteElementWithAttributes( currValue, "physical-output", *childBuffer,
+            writeItemToBuffer( currValue, "physical-output", *childBuffer,
                 mTabs.get(), attrs );
         }
         // Write currency output for each output. Note that it may be possible to convert
@@ -1031,13 +1133,19 @@ void XMLDBOutputter::startVisitOutput( const IOutput* aOutput, const int aPeriod
         // don't write both?
         currValue = aOutput->getCurrencyOutput( curr );
         if( !objects::isEqual<double>( currValue, 0.0 ) ) {
-            XMLWriteElementWithAttributes( currValue, "currency-output", *childBuffer,
+            writeItemToBuffer( currValue, "currency-output", *childBuffer,
                 mTabs.get(), attrs );
         }
     }
 }
 
 void XMLDBOutputter::endVisitOutput( const IOutput* aOutput, const int aPeriod ) {
+    if( skipEndVisit() ) {
+        return;
+    }
+
+    mCurrentAggregateElement = AggregateElement();
+
     // Write the output (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1078,6 +1186,10 @@ void XMLDBOutputter::endVisitAgProductionTechnology( const AgProductionTechnolog
 }
 
 void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
+    if( skipStartVisit( "GHG" ) ) {
+        return;
+    }
+
     // write the ghg tag and it's children in temp buffers so that we can
     // check if anything was really written out and avoid writing blank ghgs
     stringstream* parentBuffer = new stringstream();
@@ -1086,6 +1198,8 @@ void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
     // the opening tag gets written in the parent buffer
     XMLWriteOpeningTag( aGHG->getXMLName(), *parentBuffer, mTabs.get(), aGHG->getName(),
                 0, "GHG" );
+    mCurrentAggregateElement = AggregateElement( aGHG->getXMLName(),
+                                                 make_pair( aGHG->getName(), string( "GHG" ) ) );
 
     // put the buffers on a stack so that we have the correct ordering
     mBufferStack.push( parentBuffer );
@@ -1113,14 +1227,14 @@ void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
         // Avoid writing zeros to save space.
         // Write GHG emissions.
         if( !objects::isEqual<double>( currEmission, 0.0 ) ) {
-            XMLWriteElementWithAttributes( currEmission, "emissions",
+            writeItemToBuffer( currEmission, "emissions",
                 *childBuffer, mTabs.get(), attrs );
         }
 
         // Write sequestered amount of GHG emissions .
         currEmission = aGHG->getEmissionsSequestered( i );
         if( !objects::isEqual<double>( currEmission, 0.0 ) ) {
-            XMLWriteElementWithAttributes( currEmission, "emissions-sequestered",
+            writeItemToBuffer( currEmission, "emissions-sequestered",
                 *childBuffer, mTabs.get(), attrs );
         }
 
@@ -1133,6 +1247,12 @@ void XMLDBOutputter::startVisitGHG( const AGHG* aGHG, const int aPeriod ){
 }
 
 void XMLDBOutputter::endVisitGHG( const AGHG* aGHG, const int aPeriod ){
+    if( skipEndVisit() ) {
+        return;
+    }
+
+    mCurrentAggregateElement = AggregateElement();
+
     // Write the ghg (open tag, children, and closing tag) to the buffer at
     // the top of the stack only if the child buffer is not empty
     iostream* childBuffer = popBufferStack();
@@ -1174,6 +1294,11 @@ void XMLDBOutputter::endVisitMarketplace( const Marketplace* aMarketplace,
 void XMLDBOutputter::startVisitMarket( const Market* aMarket,
                                        const int aPeriod )
 {
+    // Markets are also excluded if their region is excluded.
+    if( skipStartVisit( Market::getXMLNameStatic(), mOutputFilter->isRegionIncluded( aMarket->region ) ) ) {
+        return;
+    }
+
     // TODO: What should happen if period != -1 or the period of the market?
     // Write the opening market tag.
     const int year = scenario->getModeltime()->getper_to_yr( aMarket->period );
@@ -1212,6 +1337,10 @@ void XMLDBOutputter::startVisitMarket( const Market* aMarket,
 }
 
 void XMLDBOutputter::endVisitMarket( const Market* aMarket, const int aPeriod ){
+    if( skipEndVisit() ) {
+        return;
+    }
+
     // Write the closing market tag.
     XMLWriteClosingTag( Market::getXMLNameStatic(), mBuffer, mTabs.get() );
 }
@@ -1226,6 +1355,10 @@ void XMLDBOutputter::startVisitClimateModel( const IClimateModel* aClimateModel,
 {
     /*! \pre The function should always be called with the all period output. */
     assert( aPeriod == -1 );
+    if( skipStartVisit( "climate-model" ) ) {
+        return;
+    }
+
     // Write the opening tag.
     XMLWriteOpeningTag( "climate-model", mBuffer, mTabs.get() );
     int outputInterval
@@ -1416,6 +1549,10 @@ void XMLDBOutputter::startVisitClimateModel( const IClimateModel* aClimateModel,
 void XMLDBOutputter::endVisitClimateModel( const IClimateModel* aClimateModel,
                                            const int aPeriod )
 {
+    if( skipEndVisit() ) {
+        return;
+    }
+
     // Write the closing tag.
     XMLWriteClosingTag( "climate-model", mBuffer, mTabs.get() );
 }
@@ -1539,6 +1676,10 @@ void XMLDBOutputter::endVisitLandNode( const LandNode* aLandNode,
 void XMLDBOutputter::startVisitLandLeaf( const LandLeaf* aLandLeaf,
                                          const int aPeriod )
 {
+    if( skipStartVisit( "LandLeaf" ) ) {
+        return;
+    }
+
     // Write the opening gdp tag.
     XMLWriteOpeningTag( "LandLeaf", mBuffer, mTabs.get(), aLandLeaf->getName() );
 
@@ -1564,10 +1705,18 @@ void XMLDBOutputter::startVisitLandLeaf( const LandLeaf* aLandLeaf,
 }
 
 void XMLDBOutputter::endVisitLandLeaf( const LandLeaf* aLandLeaf, const int aPeriod ){
+    if( skipEndVisit() ) {
+        return;
+    }
+
     XMLWriteClosingTag( "LandLeaf", mBuffer, mTabs.get() );
 }
 
 void XMLDBOutputter::startVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const int aPeriod ){
+    if( skipStartVisit( LandCarbonDensities::getXMLNameStatic() ) ) {
+        return;
+    }
+
     XMLWriteOpeningTag( LandCarbonDensities::getXMLNameStatic(), mBuffer, mTabs.get() );
 
     // Loop over the periods to output Carbon information.
@@ -1601,6 +1750,10 @@ void XMLDBOutputter::startVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const
 }
 
 void XMLDBOutputter::endVisitCarbonCalc( const ICarbonCalc* aCarbonCalc, const int aPeriod ){
+    if( skipEndVisit() ) {
+        return;
+    }
+
     XMLWriteClosingTag( LandCarbonDensities::getXMLNameStatic(), mBuffer, mTabs.get() );
 } 
 
@@ -1941,6 +2094,9 @@ void XMLDBOutputter::endVisitBuildingNodeInput( const BuildingNodeInput* aBuildi
 
 void XMLDBOutputter::startVisitBuildingServiceInput( const BuildingServiceInput* aBuildingServiceInput, const int aPeriod ) {
     startVisitInput( aBuildingServiceInput, aPeriod );
+    if( mExcludedDepth > 0 ) {
+        return;
+    }
 
     writeItemToBuffer( aBuildingServiceInput->getSatiationDemandFunction()->mSatiationImpedance,
                        "satiation-impedance", *mBufferStack.top(), mTabs.get(), 1, "unitless" );
@@ -1987,8 +2143,85 @@ void XMLDBOutputter::writeItemToBuffer( const double aValue,
         attributeMap[ "year" ] = util::toString( year );
     }
 
-    XMLWriteElementWithAttributes( aValue, aName, out, tabs,
-                                   attributeMap );
+    writeItemToBuffer( aValue, aName, out, tabs, attributeMap );
+}
+
+/*!
+ * \brief Write a single item with the given attributes to a buffer.
+ * \details While technologies are being aggregated an additive value is
+ *          instead added to the total for the same item in the current element
+ *          of the technology, to be written by writeAggregateTechnology. Other
+ *          values are not written at all.
+ * \param aValue Value to write.
+ * \param aName Element name.
+ * \param out Buffer to write to.
+ * \param tabs Tabs object.
+ * \param aAttrs Attributes of the element.
+ */
+void XMLDBOutputter::writeItemToBuffer( const double aValue,
+                                        const string& aName,
+                                        ostream& out,
+                                        const Tabs* tabs,
+                                        const map<string, string>& aAttrs )
+{
+    if( mIsAggregatingTechnology ) {
+        if( isAdditiveItem( aName ) ) {
+            mAggregateValues[ mCurrentAggregateElement ][ AggregateItem( aName, aAttrs ) ] += aValue;
+        }
+        return;
+    }
+    XMLWriteElementWithAttributes( aValue, aName, out, tabs, aAttrs );
+}
+
+/*!
+ * \brief Write the technology values summed since the last call.
+ * \details The totals are written as a single technology, named after the
+ *          sector or subsector which contains them, with the same inputs,
+ *          outputs and GHGs as the technologies they were summed from. Only
+ *          the additive quantities are included, see isAdditiveItem.
+ * \param aName The name to give the technology.
+ */
+void XMLDBOutputter::writeAggregateTechnology( const string& aName ) {
+    if( mAggregateValues.empty() ) {
+        return;
+    }
+
+    const string& techName = DefaultTechnology::getXMLNameStatic();
+    XMLWriteOpeningTag( techName, mBuffer, mTabs.get(), aName, 0, techName );
+    typedef map<AggregateElement, map<AggregateItem, double> >::const_iterator ElementIterator;
+    typedef map<AggregateItem, double>::const_iterator ItemIterator;
+    for( ElementIterator element = mAggregateValues.begin(); element != mAggregateValues.end(); ++element ) {
+        // An empty element name is used for values of the technology itself.
+        const bool isChildElement = !element->first.first.empty();
+        if( isChildElement ) {
+            XMLWriteOpeningTag( element->first.first, mBuffer, mTabs.get(),
+                                element->first.second.first, 0, element->first.second.second );
+        }
+        for( ItemIterator item = element->second.begin(); item != element->second.end(); ++item ) {
+            XMLWriteElementWithAttributes( item->second, item->first.first, mBuffer, mTabs.get(),
+                                           item->first.second );
+        }
+        if( isChildElement ) {
+            XMLWriteClosingTag( element->first.first, mBuffer, mTabs.get() );
+        }
+    }
+    XMLWriteClosingTag( techName, mBuffer, mTabs.get() );
+    mAggregateValues.clear();
+}
+
+/*!
+ * \brief Whether a technology value can be summed across technologies.
+ * \details Outputs, input demands and emissions are additive. Intensive values
+ *          such as costs, prices, share weights, coefficients and load
+ *          factors are not, and are left out of aggregated technologies since
+ *          their sum has no meaning.
+ * \param aName Element name of the value.
+ * \return Whether the value is summed when technologies are aggregated.
+ */
+bool XMLDBOutputter::isAdditiveItem( const string& aName ) {
+    return aName == "physical-output" || aName == "currency-output" || aName == "service-output"
+        || aName == "demand-physical" || aName == "demand-currency" || aName == "emissions"
+        || aName == "emissions-sequestered" || aName == "indirect-emissions";
 }
 
 /*!
@@ -2073,6 +2306,45 @@ bool XMLDBOutputter::isTechnologyOperating( const int aPeriod ){
     return ret;
 }
 
+/*!
+ * \brief Check if a visit should be skipped because the output filter excludes
+ *        it or it is contained in an element which was excluded.
+ * \details Every call which returns true must be matched by a call to
+ *          skipEndVisit from the corresponding end visit method.
+ * \param aVariableName The name of the element which is being started.
+ * \param aIsIncluded Whether the element passed any other rules which apply to
+ *        it.
+ * \return Whether nothing should be written for the element or its children.
+ */
+bool XMLDBOutputter::skipStartVisit( const string& aVariableName, const bool aIsIncluded ) {
+    if( mExcludedDepth > 0 || !aIsIncluded || !mOutputFilter->isVariableIncluded( aVariableName ) ) {
+        ++mExcludedDepth;
+        return true;
+    }
+    return false;
+}
+
+/*!
+ * \brief Check if the end of a visit should be skipped because the start of
+ *        the visit was skipped.
+ * \return Whether nothing should be written to end the element.
+ */
+bool XMLDBOutputter::skipEndVisit() {
+    if( mExcludedDepth > 0 ) {
+        --mExcludedDepth;
+        return true;
+    }
+    return false;
+}
+
+bool XMLDBOutputter::shouldVisitRegion( const string& aRegionName ) const {
+    return mOutputFilter->isRegionIncluded( aRegionName );
+}
+
+bool XMLDBOutputter::shouldVisitSector( const string& aSectorName ) const {
+    return mOutputFilter->isSectorIncluded( aSectorName );
+}
+
 #if( __HAVE_JAVA__ )
 /*!
  * \brief Constructs a boost IO sink that sends data to Java.
@@ -2082,17 +2354,8 @@ bool XMLDBOutputter::isTechnologyOperating( const int aPeriod ){
  * \param aJNIContainer A weak pointer to the container which holds the Java VM
  *                      references.  May be null if it did not initialize properly.
  */
-XMLDBOutputter::SendToJavaIOSink::SendToJavaIOSink( const JNIContainer* aJNIContainer )
-:mJNIContainer( aJNIContainer ),
-// Get the receiveDataFromGCAM method from the write DB class with arguments of a byte
-// array "[B", an integer "I", and a return type of bool "Z" 
-mReceiveDataMID( aJNIContainer ? aJNIContainer->mJavaEnv->GetMethodID( aJNIContainer->mWriteDBClass, "receiveDataFromGCAM", "([BI)Z") : 0 ),
-// The same buffer size as the one used in Java, if we try to tune this we should
-// adjust it both here and in Java.
-BUFFER_SIZE( 1024 * 1024 ),
-mJNIBuffer( aJNIContainer ? aJNIContainer->mJavaEnv->NewByteArray( BUFFER_SIZE  ) : 0 ),
-// If any of the required JNI data structures were not properly set then set the error flag.
-mErrorFlag( !mJNIContainer || !mReceiveDataMID || !mJNIBuffer )
+XMLDBOutputter::SendToJavaIOSink::SendToJavaIOSink( const boost::shared_ptr<JNIContainer>& aJNIContainer )
+:mJNIContainer( aJNIContainer )
 {
 }
 
@@ -2100,27 +2363,94 @@ mErrorFlag( !mJNIContainer || !mReceiveDataMID || !mJNIBuffer )
  * \brief Destructor
  */
 XMLDBOutputter::SendToJavaIOSink::~SendToJavaIOSink() {
-    // Nothing to do since this class does not manage the memory for
-    // the JNI Container data.
 }
 
 /*!
  * \brief Read bytes as they are generated and pass them through to Java.
+ * \details The bytes are copied into a JavaOutputBlock and given to the
+ *          AsyncOutputWriter which may send them on a separate thread.
  * \param aData The current buffer of data that needs to be sent.
  * \param aLength How many chars from the buffer should be read.
+ */
+streamsize XMLDBOutputter::SendToJavaIOSink::write( const char *aData, std::streamsize aLength ) {
+    if( mJNIContainer.get() ) {
+        AsyncOutputWriter::getInstance().submit( new JavaOutputBlock( mJNIContainer,
+            JavaOutputBlock::RECEIVE_DATA, string( aData, aLength ) ) );
+    }
+    return aLength;
+}
+
+/*!
+ * \brief Constructor
+ * \param aJNIContainer The JNIContainer to communicate with Java.
+ * \param aMethod The Java method to call.
+ * \param aData The data to send to Java if aMethod is RECEIVE_DATA.
+ */
+XMLDBOutputter::JavaOutputBlock::JavaOutputBlock( const boost::shared_ptr<JNIContainer>& aJNIContainer,
+                                                  const JavaMethod aMethod,
+                                                  const string& aData )
+:mJNIContainer( aJNIContainer ),
+mMethod( aMethod ),
+mData( aData )
+{
+}
+
+size_t XMLDBOutputter::JavaOutputBlock::getSize() const {
+    return mData.size();
+}
+
+/*!
+ * \brief Make the Java call on the current thread.
+ * \details Data is sent in pieces of at most BUFFER_SIZE.  The finish call
+ *          will wait until the database is done processing all data and the
+ *          finalizeAndClose call will (potentially) run queries then close the
+ *          database before returning.
  * \warning If there was an error for any reason while dealing with Java the error flag
  *          will be set and no more data will be sent.
  */
-streamsize XMLDBOutputter::SendToJavaIOSink::write( const char *aData, std::streamsize aLength ) {
-    streamsize offset = 0;
-    const jbyte* jniData = reinterpret_cast<const jbyte*>( aData );
-    while( !mErrorFlag && offset < aLength ) {
-        streamsize numRead = min( aLength - offset, BUFFER_SIZE );
-        mJNIContainer->mJavaEnv->SetByteArrayRegion( mJNIBuffer, 0, numRead, jniData+offset );
-        mErrorFlag = mJNIContainer->mJavaEnv->CallBooleanMethod( mJNIContainer->mWriteDBInstance,
-            mReceiveDataMID, mJNIBuffer, numRead );
-        offset += numRead;
-    }
-    return offset;
+void XMLDBOutputter::JavaOutputBlock::write() {
+    JNIEnv* currEnv = mJNIContainer->getThreadEnv();
+    if( mMethod == RECEIVE_DATA ) {
+        // Blocks are written one at a time in order so the method and buffer
+        // only need to be set up by the first block and can then be reused.
+        if( !mJNIContainer->mJNIBuffer && !mJNIContainer->mErrorFlag ) {
+            // Get the receiveDataFromGCAM method from the write DB class with arguments of a byte
+            // array "[B", an integer "I", and a return type of bool "Z"
+            mJNIContainer->mReceiveDataMID = currEnv->GetMethodID( mJNIContainer->mWriteDBClass,
+                "receiveDataFromGCAM", "([BI)Z" );
+            jbyteArray localBuffer = currEnv->NewByteArray( SendToJavaIOSink::BUFFER_SIZE );
+            if( localBuffer ) {
+                mJNIContainer->mJNIBuffer = static_cast<jbyteArray>( currEnv->NewGlobalRef( localBuffer ) );
+                currEnv->DeleteLocalRef( localBuffer );
+            }
+            if( !mJNIContainer->mReceiveDataMID || !mJNIContainer->mJNIBuffer ) {
+                mJNIContainer->mErrorFlag = true;
+            }
+        }
+
+        const streamsize length = mData.size();
+        const jbyte* jniData = reinterpret_cast<const jbyte*>( mData.data() );
+        streamsize offset = 0;
+        while( !mJNIContainer->mErrorFlag && offset < length ) {
+            streamsize numRead = min( length - offset, SendToJavaIOSink::BUFFER_SIZE );
+            currEnv->SetByteArrayRegion( mJNIContainer->mJNIBuffer, 0, numRead, jniData+offset );
+            mJNIContainer->mErrorFlag = currEnv->CallBooleanMethod( mJNIContainer->mWriteDBInstance,
+                mJNIContainer->mReceiveDataMID, mJNIContainer->mJNIBuffer, numRead );
+            offset += numRead;
+        }
+        return;
+    }
+
+    // Look up the appropriate "finish" or "finalizeAndClose" Java method with no
+    // arguments and void return: "()V" then call it.
+    const char* methodName = mMethod == FINISH ? "finish" : "finalizeAndClose";
+    jmethodID methodMID = currEnv->GetMethodID( mJNIContainer->mWriteDBClass, methodName, "()V" );
+    if( !methodMID ) {
+        ILogger& mainLog = ILogger::getLogger( "main_log" );
+        mainLog.setLevel( ILogger::SEVERE );
+        mainLog << "Failed to find JNI method: " << methodName << endl;
+        return;
+    }
+    currEnv->CallVoidMethod( mJNIContainer->mWriteDBInstance, methodMID );
 }
 #endif
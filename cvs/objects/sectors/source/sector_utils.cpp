@@ -260,17 +260,20 @@ double SectorUtils::normalizeLogShares( vector<double>& alogShares ){
     // in theory we could check for lfac == +Inf here, but in light of how the log
     // shares are calculated, it would seem like that can't happen.
 
-    // rescale and get normalization sum
-    for( size_t i = 0; i < alogShares.size(); ++i ) {
-        alogShares[ i ] -= lfac;
-        sum += exp( alogShares[ i ] );
+    // rescale, unlog and get normalization sum.  The largest share is
+    // rescaled to one so the sum can not underflow.
+    const size_t numShares = alogShares.size();
+    double* shares = &alogShares[ 0 ];
+    for( size_t i = 0; i < numShares; ++i ) {
+        shares[ i ] = exp( shares[ i ] - lfac );
+        sum += shares[ i ];
     }
-    double norm = log( sum );
+    const double norm = 1.0 / sum;
     sum = 0.0;                               // double check the normalization
-    for( size_t i = 0; i < alogShares.size(); ++i ) {
-        alogShares[ i ] = exp( alogShares[ i ] - norm );   // divide by norm constant and unlog
-        sum += alogShares[ i ];                      // accumulate sum of normalized shares 
-                                                     //   (should be 1.0 when we're done.)
+    for( size_t i = 0; i < numShares; ++i ) {
+        shares[ i ] *= norm;                 // divide by norm constant
+        sum += shares[ i ];                  // accumulate sum of normalized shares
+                                             //   (should be 1.0 when we're done.)
     }
     
     // In actuality, this rescaling scheme should eliminate the problem of
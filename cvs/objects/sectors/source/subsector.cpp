@@ -692,12 +692,13 @@ double Subsector::calcShare( const IDiscreteChoice* aChoiceFn, const GDP* aGDP,
         return -numeric_limits<double>::infinity();
     }
 
-    
-    double scaledGdpPerCapita = aGDP->getBestScaledGDPperCap( aPeriod );
-    assert( scaledGdpPerCapita > 0.0 );
+    double logshare = aChoiceFn->calcUnnormalizedShare( mShareWeights[ aPeriod ], subsectorPrice, aPeriod );
 
-    double logshare = aChoiceFn->calcUnnormalizedShare( mShareWeights[ aPeriod ], subsectorPrice, aPeriod )
-        + fuelPrefElasticity[ aPeriod ] * log( scaledGdpPerCapita );
+    if( fuelPrefElasticity[ aPeriod ] != 0 ) {
+        double scaledGdpPerCapita = aGDP->getBestScaledGDPperCap( aPeriod );
+        assert( scaledGdpPerCapita > 0.0 );
+        logshare += fuelPrefElasticity[ aPeriod ] * log( scaledGdpPerCapita );
+    }
 
     /*! \post logshare is finite or minus-infinity. */
     // Check for invalid shares.
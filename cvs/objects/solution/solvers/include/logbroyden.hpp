@@ -100,7 +100,7 @@ public:
   static const std::string & getXMLNameStatic( void ) {return SOLVER_NAME;}
 
 protected:
-  //! Perform the Broyden's method iterations.
+  //! Perform the Broyden's method iterations.  On success B holds the final jacobian.
   int bsolve(VecFVec<double,double> &F, UBLAS::vector<double> &x, UBLAS::vector<double> &fx,
              UBMATRIX &B, int &neval);
   //! Additional logging for visualizing solver progress.
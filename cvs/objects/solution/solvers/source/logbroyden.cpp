@@ -60,6 +60,7 @@
 #include "util/base/include/xml_helper.h"
 #include "solution/util/include/solution_info_filter_factory.h"
 #include "solution/util/include/solvable_nr_solution_info_filter.h"
+#include "solution/util/include/solution_sensitivity.h"
 
 #include "solution/util/include/functor-subs.hpp"
 #include "solution/util/include/linesearch.hpp"
@@ -320,6 +321,18 @@ SolverComponent::ReturnCode LogBroyden::solve(SolutionInfoSet &solnset, int peri
     if(bstatus == 0) {
         solverLog << "Broyden solution success.\n";
         code = SUCCESS;
+
+        // Keep the jacobian at the solution to estimate responses to
+        // changes in fixed prices, if any have been requested.  The one
+        // left by bsolve was found before the last step, so it is
+        // recalculated here.
+        SolutionSensitivity& sensitivity = SolutionSensitivity::getInstance();
+        if( sensitivity.hasDirections() ) {
+            UBMATRIX Jsoln(F.narg(), F.nrtn());
+            fdjac(F, x, fx, Jsoln, true);
+            sensitivity.calculate(F, x, fx, boost::numeric::ublas::matrix<double>(Jsoln), solnset,
+                                  marketplace, period, mLogPricep);
+        }
     }
     else if(bstatus == -1) {
         code = FAILURE_ITER_MAX_REACHED;
@@ -596,6 +609,7 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       if(msf < mFTOL) {
         // basically, we're letting ourselves converge to the sqrt of
         // our intended tolerance.
+        B = Btmp;               // return the jacobian rather than its decomposition
         return 0;
       }
 
@@ -653,6 +667,7 @@ int LogBroyden::bsolve(VecFVec<double,double> &F, UBVECTOR &x, UBVECTOR &fx,
       solverLog << "Solution successful.\n";
       x = xnew;
       fx = fxnew;
+      B = Btmp;                 // return the jacobian rather than its decomposition
       return 0;                 // SUCCESS 
     }
 
@@ -55,6 +55,8 @@
 #include "tbb/blocked_range.h"
 #endif 
 
+class ILogger;
+
 #define UBVECTOR boost::numeric::ublas::vector
 
 /*!
@@ -102,6 +104,7 @@ class LogEDFun : public VecFVec<double,double>
   int partj; //!< flag indicating which variable in the input vector
              //!has changed in a partial derivative calculation
   bool mLogPricep;               //!< Flag indicating whether inputs are prices or log-prices
+  ILogger &mSolverLog;           //!< The solver log, looked up once since the functor is called very often
 
   // diagnostic variables
   std::vector<double> mstate;
@@ -0,0 +1,171 @@
+#ifndef _SOLUTION_SENSITIVITY_H_
+#define _SOLUTION_SENSITIVITY_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*! 
+* \file solution_sensitivity.h
+* \ingroup Solution
+* \brief The header file for the SolutionSensitivity class.
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+
+#include "solution/util/include/functor.hpp"
+
+class Marketplace;
+class SolutionInfoSet;
+
+/*!
+* \ingroup Solution
+* \brief Linearized responses of a solved period to changes in fixed market
+*        prices.
+* \details Once the Broyden solver has solved a period it finds the Jacobian
+*          at the solution by finite differences and hands it to this class,
+*          which keeps the L-U factorization for the period. For each registered direction, a market whose price is held
+*          fixed such as a carbon tax, the change in excess demands caused by a
+*          small step in that price is found with one model evaluation. The
+*          implicit function theorem then gives the first order change in the
+*          solved prices as dx = -J^-1 dF, which costs only a back substitution.
+*          A second evaluation at the predicted prices gives the corresponding
+*          change in the supply of each solved market and the residual left by
+*          the linearization, after which the model is returned to the
+*          solution.
+*
+*          The responses can be used to predict the solved prices of a nearby
+*          scenario, for instance a cost curve point with a fraction of the
+*          tax, and those predictions make a much better starting point than
+*          the base solution when set as price guesses in the marketplace.
+*
+*          Directions are registered by code which intends to use them, or
+*          listed in the sensitivity-markets configuration string as
+*          region:good pairs separated by commas. Nothing is calculated while
+*          no directions are registered. A direction whose market is solved,
+*          such as an emissions constraint, has no response since the solver
+*          sets its price.
+*
+*          Stored periods are dropped by invalidatePeriod when the scenario
+*          invalidates them and by clear when a scenario is initialized, so
+*          that responses never outlive the solution they were found at.
+* \note The Jacobian is in the scaled space of the solver and finding it costs
+*       one model evaluation per solved market. It is square in the number of
+*       solved markets, so keeping it for every period takes a fair amount of
+*       memory for large models.
+*/
+class SolutionSensitivity {
+public:
+    static SolutionSensitivity& getInstance();
+
+    void addDirection( const std::string& aRegionName, const std::string& aGoodName );
+    void removeDirection( const std::string& aRegionName, const std::string& aGoodName );
+    bool hasDirections() const;
+
+    void calculate( VecFVec<double, double>& aF, const boost::numeric::ublas::vector<double>& aX,
+                    const boost::numeric::ublas::vector<double>& aFX,
+                    const boost::numeric::ublas::matrix<double>& aJacobian,
+                    const SolutionInfoSet& aSolutionSet, Marketplace* aMarketplace,
+                    const int aPeriod, const bool aLogPrice );
+
+    bool solveLinearResponse( const int aPeriod, boost::numeric::ublas::vector<double>& aChange ) const;
+
+    bool predictPrices( const int aPeriod, const std::string& aRegionName, const std::string& aGoodName,
+                        const double aNewPrice, std::vector<double>& aPrices ) const;
+
+    bool getSupplyResponse( const int aPeriod, const std::string& aRegionName, const std::string& aGoodName,
+                            std::map<std::string, double>& aSupplyChanges ) const;
+
+    void invalidatePeriod( const int aPeriod );
+
+    void clear();
+private:
+    //! Private constructor to prevent multiple instances.
+    SolutionSensitivity();
+    //! Private undefined copy constructor to prevent copying.
+    SolutionSensitivity( const SolutionSensitivity& aOther );
+    //! Private undefined assignment operator to prevent copying.
+    SolutionSensitivity& operator=( const SolutionSensitivity& aOther );
+
+    static std::string getDirectionKey( const std::string& aRegionName, const std::string& aGoodName );
+
+    //! The response of a solved period to a step in one direction.
+    struct DirectionResponse {
+        //! The price of the direction market at the solution.
+        double mBasePrice;
+
+        //! The step taken in the price of the direction market.
+        double mStep;
+
+        //! The price of each market, ordered as in Marketplace::getPrices,
+        //! predicted for the step.
+        std::vector<double> mStepPrices;
+
+        //! The change in supply of each solved market per unit of price in the
+        //! direction market, by market name.
+        std::map<std::string, double> mSupplyChanges;
+    };
+
+    //! The factorized Jacobian and the responses for a solved period.
+    struct PeriodSensitivity {
+        //! L-U factorization of the Jacobian at the solution.
+        boost::numeric::ublas::matrix<double> mLU;
+
+        //! Row permutation from the factorization.
+        std::vector<std::size_t> mPivots;
+
+        //! The price of each market at the solution.
+        std::vector<double> mBasePrices;
+
+        //! Whether the solver was working in log prices.
+        bool mLogPrice;
+
+        //! Responses by direction key.
+        std::map<std::string, DirectionResponse> mResponses;
+    };
+
+    //! Registered directions as region and good names, by direction key.
+    std::map<std::string, std::pair<std::string, std::string> > mDirections;
+
+    //! Sensitivities by period.
+    std::map<int, PeriodSensitivity> mPeriods;
+};
+
+#endif // _SOLUTION_SENSITIVITY_H_
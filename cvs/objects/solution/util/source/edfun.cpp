@@ -54,7 +54,8 @@ LogEDFun::LogEDFun(SolutionInfoSet &sisin,
     mkts(sisin.getSolvableSet()),
     solnset(sisin),
     world(w), mktplc(m), period(per), partj(-1),
-    mLogPricep(aLogPricep)
+    mLogPricep(aLogPricep),
+    mSolverLog(ILogger::getLogger("solver_log"))
 {
     na=nr=mkts.size();
     mdiagnostic=false;
@@ -198,7 +199,7 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx)
     }
 
     if(mdiagnostic) {
-      ILogger &solverlog = ILogger::getLogger("solver_log");
+      ILogger &solverlog = mSolverLog;
       solverlog.setLevel(ILogger::DEBUG);
 
       solverlog << "j= " << partj <<"\tprice  \tsupply \tdemand\tmarket"
@@ -248,7 +249,7 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx)
     evalPartTimer.stop();
 
     if(mdiagnostic) {
-      ILogger &solverlog = ILogger::getLogger("solver_log");
+      ILogger &solverlog = mSolverLog;
       solverlog.setLevel(ILogger::DEBUG);
       
       solverlog << "new   \t" << mkts[partj].getPrice() << "\t" << mkts[partj].getSupply()
@@ -280,8 +281,8 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx)
       double p  = x[i]>=ARGMAX ? PMAX : exp(x[i]);
       double c  = std::max(0.0, p0-p);
       double fxi = log(d/s);
-      if(c>0.0) {
-        ILogger &solverlog = ILogger::getLogger("solver_log");
+      if(c>0.0 && mSolverLog.wouldPrint(ILogger::DEBUG)) {
+        ILogger &solverlog = mSolverLog;
         solverlog.setLevel(ILogger::DEBUG);
         solverlog << "\t\tAdding supply correction: i= " << i << "  p= " << p
                   << "  p0= " << p0 << "  c= " << c
@@ -305,8 +306,8 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx)
         double c = s == 0 ? std::max(0.0, (p0-x[i])/mfxscl[i]/mxscl[i]) : 0;
         // give difference as a fraction of demand
         fx[i] = d - s + c;          // == d-(s-c); i.e., the correction subtracts from supply
-        if(c>0.0) {
-          ILogger &solverlog = ILogger::getLogger("solver_log");
+        if(c>0.0 && mSolverLog.wouldPrint(ILogger::DEBUG)) {
+          ILogger &solverlog = mSolverLog;
           solverlog.setLevel(ILogger::DEBUG);
           solverlog << "\t\tAdding supply correction: i= " << i << "  p= " << x[i]
                     << "  p0= " << p0 << "  c= " << c << "  modified supply= " << s-c
@@ -330,8 +331,8 @@ void LogEDFun::operator()(const UBVECTOR<double> &ax, UBVECTOR<double> &fx)
         double c = std::max(0.0, (p0-x[i])/mfxscl[i]/mxscl[i]);
         // give difference as a fraction of demand
         fx[i] = d - s + c;          // == d-(s-c); i.e., the correction subtracts from supply
-        if(c>0.0) {
-          ILogger &solverlog = ILogger::getLogger("solver_log");
+        if(c>0.0 && mSolverLog.wouldPrint(ILogger::DEBUG)) {
+          ILogger &solverlog = mSolverLog;
           solverlog.setLevel(ILogger::DEBUG);
           solverlog << "\t\tAdding supply correction: i= " << i << "  p= " << x[i]
                     << "  p0= " << p0 << "  c= " << c << "  modified supply= " << s-c
@@ -0,0 +1,361 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file solution_sensitivity.cpp
+* \ingroup Solution
+* \brief SolutionSensitivity class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+#include <boost/numeric/ublas/lu.hpp>
+
+#include "solution/util/include/solution_sensitivity.h"
+#include "solution/util/include/solution_info_set.h"
+#include "solution/util/include/solution_info.h"
+#include "marketplace/include/marketplace.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+namespace ublas = boost::numeric::ublas;
+
+namespace {
+    /*!
+     * \brief Step in the price of a direction market relative to its price.
+     * \details The step is large enough that the change in excess demands is
+     *          well above the solution tolerance, but small enough that the
+     *          response stays close to linear.
+     */
+    const double RELATIVE_STEP = 0.01;
+
+    //! Largest absolute value in a vector.
+    double maxAbs( const ublas::vector<double>& aVector ) {
+        double maxValue = 0;
+        for( unsigned int i = 0; i < aVector.size(); ++i ) {
+            maxValue = max( maxValue, fabs( aVector[ i ] ) );
+        }
+        return maxValue;
+    }
+}
+
+//! Private constructor which registers the configured directions.
+SolutionSensitivity::SolutionSensitivity() {
+    string marketList = Configuration::getInstance()->getString( "sensitivity-markets", "", false );
+    replace( marketList.begin(), marketList.end(), ',', ' ' );
+    istringstream marketStream( marketList );
+    string market;
+    while( marketStream >> market ) {
+        const string::size_type separator = market.find( ':' );
+        if( separator == string::npos || separator == 0 || separator + 1 == market.size() ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Skipping sensitivity market " << market
+                    << " which is not of the form region:good." << endl;
+            continue;
+        }
+        addDirection( market.substr( 0, separator ), market.substr( separator + 1 ) );
+    }
+}
+
+/*!
+ * \brief Get the singleton instance of the SolutionSensitivity.
+ * \return The SolutionSensitivity.
+ */
+SolutionSensitivity& SolutionSensitivity::getInstance() {
+    static SolutionSensitivity SOLUTION_SENSITIVITY;
+    return SOLUTION_SENSITIVITY;
+}
+
+/*!
+ * \brief Register a market whose price is a direction for which responses
+ *        should be calculated.
+ * \param aRegionName A region in the market.
+ * \param aGoodName The good of the market.
+ */
+void SolutionSensitivity::addDirection( const string& aRegionName, const string& aGoodName ) {
+    mDirections[ getDirectionKey( aRegionName, aGoodName ) ] = make_pair( aRegionName, aGoodName );
+}
+
+/*!
+ * \brief Stop calculating responses for a direction.
+ * \details Responses which have already been calculated are kept.
+ * \param aRegionName A region in the market.
+ * \param aGoodName The good of the market.
+ */
+void SolutionSensitivity::removeDirection( const string& aRegionName, const string& aGoodName ) {
+    mDirections.erase( getDirectionKey( aRegionName, aGoodName ) );
+}
+
+/*!
+ * \brief Whether any directions are registered.
+ * \return Whether a solver should call calculate once a period is solved.
+ */
+bool SolutionSensitivity::hasDirections() const {
+    return !mDirections.empty();
+}
+
+/*!
+ * \brief Calculate the responses of a solved period to each direction.
+ * \details Factorizes the Jacobian and keeps it for the period, replacing
+ *          anything stored for the period by an earlier solution. For each
+ *          direction the excess demands are evaluated with the direction price
+ *          stepped, the linear price response is found from the factorization,
+ *          and the model is evaluated at the predicted prices to find the
+ *          supply response. The model is evaluated at the solution once more
+ *          at the end so that it is left as the solver found it. Directions
+ *          whose market is solved in the period, such as a constraint, are
+ *          skipped with a warning.
+ * \param aF The excess demand function the solver used.
+ * \param aX The solution in the input space of aF.
+ * \param aFX The value of aF at the solution.
+ * \param aJacobian The Jacobian of aF at the solution.
+ * \param aSolutionSet The solution set which was solved.
+ * \param aMarketplace The marketplace.
+ * \param aPeriod The period which was solved.
+ * \param aLogPrice Whether the inputs of aF are log prices.
+ */
+void SolutionSensitivity::calculate( VecFVec<double, double>& aF, const ublas::vector<double>& aX,
+                                     const ublas::vector<double>& aFX,
+                                     const ublas::matrix<double>& aJacobian,
+                                     const SolutionInfoSet& aSolutionSet, Marketplace* aMarketplace,
+                                     const int aPeriod, const bool aLogPrice )
+{
+    ILogger& solverLog = ILogger::getLogger( "solver_log" );
+    solverLog.setLevel( ILogger::NOTICE );
+
+    const size_t size = aX.size();
+    PeriodSensitivity& sensitivity = mPeriods[ aPeriod ];
+    sensitivity = PeriodSensitivity();
+    sensitivity.mLU = aJacobian;
+    sensitivity.mLogPrice = aLogPrice;
+    ublas::permutation_matrix<size_t> pivots( size );
+    if( ublas::lu_factorize( sensitivity.mLU, pivots ) != 0 ) {
+        solverLog << "Skipping sensitivities for period " << aPeriod
+                  << " as the Jacobian at the solution is singular." << endl;
+        mPeriods.erase( aPeriod );
+        return;
+    }
+    sensitivity.mPivots.assign( pivots.begin(), pivots.end() );
+    sensitivity.mBasePrices = aMarketplace->getPrices( aPeriod );
+
+    const vector<SolutionInfo> solvable = aSolutionSet.getSolvableSet();
+    vector<double> baseSupplies( solvable.size() );
+    for( unsigned int i = 0; i < solvable.size(); ++i ) {
+        baseSupplies[ i ] = solvable[ i ].getSupply();
+    }
+
+    aF.partial( -1 );
+    ublas::vector<double> fxStep( size );
+    ublas::vector<double> fxPredicted( size );
+    typedef map<string, pair<string, string> >::const_iterator DirectionIterator;
+    for( DirectionIterator iter = mDirections.begin(); iter != mDirections.end(); ++iter ) {
+        const string& regionName = iter->second.first;
+        const string& goodName = iter->second.second;
+        const double basePrice = aMarketplace->getPrice( goodName, regionName, aPeriod, false );
+        if( basePrice == Marketplace::NO_MARKET_PRICE ) {
+            continue;
+        }
+
+        // The price of a solved market is set by the solver from aX, so a
+        // step set in the marketplace would be overwritten and the response
+        // would be zero.
+        const IInfo* directionInfo = aMarketplace->getMarketInfo( goodName, regionName, aPeriod, false );
+        bool isSolved = false;
+        for( unsigned int i = 0; i < solvable.size() && !isSolved; ++i ) {
+            isSolved = solvable[ i ].getMarketInfo() == directionInfo;
+        }
+        if( isSolved ) {
+            solverLog.setLevel( ILogger::WARNING );
+            solverLog << "Skipping sensitivity to " << iter->first << " in period " << aPeriod
+                      << " as the market is solved, only fixed prices can be directions." << endl;
+            solverLog.setLevel( ILogger::NOTICE );
+            continue;
+        }
+
+        DirectionResponse& response = sensitivity.mResponses[ iter->first ];
+        response.mBasePrice = basePrice;
+        response.mStep = RELATIVE_STEP * max( fabs( basePrice ), 1.0 );
+        aMarketplace->setPrice( goodName, regionName, basePrice + response.mStep, aPeriod );
+
+        // The excess demands move by dF for the step with the solved prices
+        // held, and the solved prices must move by -J^-1 dF to cancel it.
+        aF( aX, fxStep );
+        ublas::vector<double> dx( aFX - fxStep );
+        try {
+            ublas::lu_substitute( sensitivity.mLU, pivots, dx );
+        }
+        catch( const ublas::internal_logic& ) {
+            // An ill-conditioned Jacobian, the prediction is checked below.
+        }
+        aF( ublas::vector<double>( aX + dx ), fxPredicted );
+
+        response.mStepPrices = aMarketplace->getPrices( aPeriod );
+        for( unsigned int i = 0; i < solvable.size(); ++i ) {
+            response.mSupplyChanges[ solvable[ i ].getName() ] =
+                ( solvable[ i ].getSupply() - baseSupplies[ i ] ) / response.mStep;
+        }
+        aMarketplace->setPrice( goodName, regionName, basePrice, aPeriod );
+
+        solverLog << "Sensitivity to " << iter->first << " in period " << aPeriod
+                  << ": step " << response.mStep << ", largest excess demand "
+                  << maxAbs( fxStep ) << " before and " << maxAbs( fxPredicted )
+                  << " after the predicted price change." << endl;
+    }
+
+    // Leave the model at the solution.
+    aF( aX, fxStep );
+}
+
+/*!
+ * \brief Solve the factorized Jacobian of a period for a change in excess
+ *        demands.
+ * \details Callers which find the change in excess demands for a perturbation
+ *          themselves can use this to get the linear change in the solver
+ *          inputs which cancels it.
+ * \param aPeriod The period.
+ * \param aChange The negated change in excess demands, in the scaled space of
+ *        the solver, which is replaced by the change in solver inputs.
+ * \return Whether a factorization is stored for the period.
+ */
+bool SolutionSensitivity::solveLinearResponse( const int aPeriod, ublas::vector<double>& aChange ) const {
+    map<int, PeriodSensitivity>::const_iterator period = mPeriods.find( aPeriod );
+    if( period == mPeriods.end() || period->second.mPivots.size() != aChange.size() ) {
+        return false;
+    }
+    ublas::permutation_matrix<size_t> pivots( aChange.size() );
+    copy( period->second.mPivots.begin(), period->second.mPivots.end(), pivots.begin() );
+    try {
+        ublas::lu_substitute( period->second.mLU, pivots, aChange );
+    }
+    catch( const ublas::internal_logic& ) {
+        // Same treatment as in the solver, the result is used as it is.
+    }
+    return true;
+}
+
+/*!
+ * \brief Predict the solved prices of a period for a new price in a direction
+ *        market.
+ * \details The response to the step is scaled to the change from the base
+ *          price, in log prices if the solver worked in log prices.
+ * \param aPeriod The period.
+ * \param aRegionName A region in the direction market.
+ * \param aGoodName The good of the direction market.
+ * \param aNewPrice The new price of the direction market.
+ * \param aPrices The predicted price of each market, ordered as in
+ *        Marketplace::getPrices and suitable for
+ *        Marketplace::setPriceGuesses.
+ * \return Whether a response was calculated for the direction and period.
+ */
+bool SolutionSensitivity::predictPrices( const int aPeriod, const string& aRegionName, const string& aGoodName,
+                                         const double aNewPrice, vector<double>& aPrices ) const
+{
+    map<int, PeriodSensitivity>::const_iterator period = mPeriods.find( aPeriod );
+    if( period == mPeriods.end() ) {
+        return false;
+    }
+    map<string, DirectionResponse>::const_iterator response =
+        period->second.mResponses.find( getDirectionKey( aRegionName, aGoodName ) );
+    if( response == period->second.mResponses.end() ) {
+        return false;
+    }
+
+    const vector<double>& basePrices = period->second.mBasePrices;
+    const vector<double>& stepPrices = response->second.mStepPrices;
+    const double stepFraction = ( aNewPrice - response->second.mBasePrice ) / response->second.mStep;
+    aPrices.resize( basePrices.size() );
+    for( unsigned int i = 0; i < basePrices.size(); ++i ) {
+        if( period->second.mLogPrice && basePrices[ i ] > 0 && stepPrices[ i ] > 0 ) {
+            aPrices[ i ] = basePrices[ i ] * pow( stepPrices[ i ] / basePrices[ i ], stepFraction );
+        }
+        else {
+            aPrices[ i ] = basePrices[ i ] + ( stepPrices[ i ] - basePrices[ i ] ) * stepFraction;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief Get the change in supply of each solved market per unit of price in a
+ *        direction market.
+ * \param aPeriod The period.
+ * \param aRegionName A region in the direction market.
+ * \param aGoodName The good of the direction market.
+ * \param aSupplyChanges The supply changes by market name.
+ * \return Whether a response was calculated for the direction and period.
+ */
+bool SolutionSensitivity::getSupplyResponse( const int aPeriod, const string& aRegionName,
+                                             const string& aGoodName,
+                                             map<string, double>& aSupplyChanges ) const
+{
+    map<int, PeriodSensitivity>::const_iterator period = mPeriods.find( aPeriod );
+    if( period == mPeriods.end() ) {
+        return false;
+    }
+    map<string, DirectionResponse>::const_iterator response =
+        period->second.mResponses.find( getDirectionKey( aRegionName, aGoodName ) );
+    if( response == period->second.mResponses.end() ) {
+        return false;
+    }
+    aSupplyChanges = response->second.mSupplyChanges;
+    return true;
+}
+
+/*!
+ * \brief Remove all stored factorizations and responses.
+ */
+/*!
+ * \brief Drop the sensitivities of a period whose solution is no longer valid.
+ * \param aPeriod The period.
+ */
+void SolutionSensitivity::invalidatePeriod( const int aPeriod ) {
+    mPeriods.erase( aPeriod );
+}
+
+void SolutionSensitivity::clear() {
+    mPeriods.clear();
+}
+
+/*!
+ * \brief Get the key under which a direction is stored.
+ * \param aRegionName A region in the market.
+ * \param aGoodName The good of the market.
+ * \return The key.
+ */
+string SolutionSensitivity::getDirectionKey( const string& aRegionName, const string& aGoodName ) {
+    return aRegionName + ":" + aGoodName;
+}
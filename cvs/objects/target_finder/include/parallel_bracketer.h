@@ -0,0 +1,134 @@
+#ifndef _PARALLEL_BRACKETER_H_
+#define _PARALLEL_BRACKETER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+* \file parallel_bracketer.h
+* \ingroup Objects
+* \brief The ParallelBracketer class header file.
+*/
+
+#include <vector>
+
+/*!
+ * \brief Object which searches for a target using several trial values at a
+ *        time.
+ * \details Each iteration returns a set of trial values which may be
+ *          evaluated simultaneously. The statuses of all of the trials are then
+ *          used to narrow the bracket which contains the solution. The status
+ *          of a trial follows the ITarget convention: positive if the trial
+ *          value is too low, negative if it is too high.
+ *
+ *          Until the solution is bracketed the trials step geometrically away
+ *          from the known bound by the given multiple. Once it is bracketed one
+ *          trial is placed at the false position estimate and the remaining
+ *          trials divide the bracket evenly, so the bracket shrinks by at least
+ *          a factor of the number of trials each iteration. With a single
+ *          trial this reduces to bisection.
+ */
+class ParallelBracketer {
+public:
+    ParallelBracketer( const double aTolerance,
+                       const unsigned int aNumTrials,
+                       const double aMaximum,
+                       const double aMultiple,
+                       const double aInitialValue,
+                       const double aInitialStatus );
+
+    const std::vector<double>& getTrialValues() const;
+
+    void setTrialStatuses( const std::vector<double>& aStatuses );
+
+    bool isDone() const;
+
+    bool isSolved() const;
+
+    double getSolution() const;
+
+    unsigned int getIterations() const;
+private:
+    //! The tolerance of the target.
+    const double mTolerance;
+
+    //! The number of trial values to return each iteration.
+    const unsigned int mNumTrials;
+
+    //! The maximum trial value.
+    const double mMaximum;
+
+    //! The adjustment to make between trials until the solution is bracketed.
+    const double mMultiple;
+
+    //! The largest value with a positive status, or -1 if there is none.
+    double mLowerBound;
+
+    //! The status at the lower bound.
+    double mLowerStatus;
+
+    //! The smallest value with a negative status, or -1 if there is none.
+    double mUpperBound;
+
+    //! The status at the upper bound.
+    double mUpperStatus;
+
+    //! The value with the status closest to zero which has been evaluated.
+    double mBestValue;
+
+    //! The status of the best value.
+    double mBestStatus;
+
+    //! The trial values to evaluate in the current iteration.
+    std::vector<double> mTrialValues;
+
+    //! The number of iterations performed.
+    unsigned int mIterations;
+
+    //! Whether the search has finished.
+    bool mIsDone;
+
+    //! Whether the search found a solution.
+    bool mIsSolved;
+
+    void updateState( const double aValue, const double aStatus );
+
+    void calcTrialValues();
+
+    void printState() const;
+};
+
+#endif // _PARALLEL_BRACKETER_H_
@@ -46,6 +46,7 @@
 
 #include <memory>
 #include <vector>
+#include <list>
 #include "containers/include/iscenario_runner.h"
 #include "util/base/include/value.h"
 
@@ -54,6 +55,7 @@ class TotalPolicyCostCalculator;
 class SingleScenarioRunner;
 class ITarget;
 class Modeltime;
+class ClimateEmulator;
 
 /*! 
  * \ingroup Objects
@@ -103,6 +105,14 @@ class Modeltime;
  *                   (optional) The default is 2020.
  *              - \c max-iterations PolicyTargetRunner::mMaxIterations
  *                   (optional) The default is 100.
+ *              - \c parallel-trials PolicyTargetRunner::mNumParallelTrials
+ *                   (optional) The default is 1.
+ *              - \c warm-start-trials PolicyTargetRunner::mWarmStartTrials
+ *                   (optional) The default is false.
+ *              - \c interpolate-warm-start PolicyTargetRunner::mInterpolateWarmStart
+ *                   (optional) The default is false.
+ *              - \c emulate-climate PolicyTargetRunner::mEmulateClimate
+ *                   (optional) The default is false.
  *              - \c stabilization PolicyTargetRunner::mInitialTargetYear
  *                   (optional) Set the initial target year to the flag
  *                   ITarget::getUseMaxTargetYearFlag(), this is the default.
@@ -203,6 +213,59 @@ private:
     //! solve.
     double mMaxTax;
 
+    //! The number of trial taxes to evaluate at once in forked copies of the
+    //! model. If this is one the trials are run one at a time.
+    unsigned int mNumParallelTrials;
+
+    //! Whether each trial run should start the solver from the prices solved
+    //! by the nearest earlier trial of the same search.
+    bool mWarmStartTrials;
+
+    //! Whether warm started trials which lie between two earlier trials should
+    //! start from prices linearly interpolated between them.
+    bool mInterpolateWarmStart;
+
+    //! The solved prices of a trial run kept to warm start later trials.
+    struct TrialPrices {
+        //! The trial value which was run.
+        double mTrialValue;
+
+        //! The prices of all markets by period starting at the first period
+        //! kept in the trial history.
+        std::vector<std::vector<double> > mPrices;
+    };
+
+    //! The prices of the trials run in the current search, oldest first.
+    std::list<TrialPrices> mTrialHistory;
+
+    //! The first period whose prices are kept in the trial history.
+    int mHistoryFirstPeriod;
+
+    //! The last period whose prices are kept in the trial history.
+    int mHistoryLastPeriod;
+
+    //! The number of world calculations used by the first run of the current
+    //! search, which is started without any trial history.
+    int mColdStartCalcs;
+
+    //! The number of trial runs which were warm started.
+    unsigned int mNumWarmStarts;
+
+    //! The estimated number of world calculations saved by warm starting.
+    int mCalcsSaved;
+
+    //! Whether trials of forcing, concentration and temperature targets may
+    //! evaluate the target against a climate emulator, with the full climate
+    //! model confirming each solution.
+    bool mEmulateClimate;
+
+    //! The climate emulator used by the trials, null if the full climate
+    //! model is used.
+    ClimateEmulator* mClimateEmulator;
+
+    class TrialEvaluator;
+    friend class TrialEvaluator;
+
     void
         calculateHotellingPath( const double aIntialTax,
                                 const double aHotellingRate,
@@ -212,6 +275,37 @@ private:
                                 std::vector<double>& aTaxes );
 
     void setTrialTaxes( const std::vector<double> aTaxes );
+
+    void calculateTrialTaxes( const double aTrial,
+                              const int aFirstSkippedPeriod,
+                              const int aPeriod,
+                              std::vector<double>& aTaxes );
+
+    bool useParallelTrials() const;
+
+    void startTrialHistory( const int aFirstPeriod, const int aLastPeriod );
+
+    bool runTrial( const double aTrialValue, const int aPeriod, Timer& aTimer );
+
+    bool confirmClimateModel();
+
+    bool seedTrialPrices( const double aTrialValue );
+
+    void recordTrialPrices( const double aTrialValue );
+
+    bool solveTargetInParallel( std::vector<double>& aTaxes,
+                                const ITarget* aPolicyTarget,
+                                const double aInitialTrial,
+                                const double aInitialStatus,
+                                const double aMultiple,
+                                const unsigned int aLimitIterations,
+                                const double aTolerance,
+                                const int aFirstSkippedPeriod,
+                                const int aPeriod,
+                                const int aTargetYear,
+                                unsigned int& aIterations,
+                                bool& aRunSuccess,
+                                Timer& aTimer );
     
     bool solveInitialTarget( std::vector<double>& aTaxes,
                              const ITarget* aPolicyTarget,
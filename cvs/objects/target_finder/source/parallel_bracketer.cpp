@@ -0,0 +1,268 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*!
+* \file parallel_bracketer.cpp
+* \ingroup Objects
+* \brief ParallelBracketer class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "util/logger/include/ilogger.h"
+#include "target_finder/include/parallel_bracketer.h"
+#include "target_finder/include/itarget_solver.h"
+#include "util/base/include/util.h"
+
+using namespace std;
+
+/*!
+ * \brief Construct the ParallelBracketer.
+ * \param aTolerance Solution tolerance.
+ * \param aNumTrials The number of trial values to evaluate each iteration.
+ * \param aMaximum The maximum trial value.
+ * \param aMultiple Amount to adjust trial values by until the solution is
+ *        bracketed.
+ * \param aInitialValue A value which has already been evaluated.
+ * \param aInitialStatus The status of the initial value.
+ */
+ParallelBracketer::ParallelBracketer( const double aTolerance,
+                                      const unsigned int aNumTrials,
+                                      const double aMaximum,
+                                      const double aMultiple,
+                                      const double aInitialValue,
+                                      const double aInitialStatus ):
+mTolerance( aTolerance ),
+mNumTrials( max( aNumTrials, 1u ) ),
+mMaximum( aMaximum ),
+mMultiple( aMultiple ),
+mLowerBound( ITargetSolver::undefined() ),
+mLowerStatus( 0 ),
+mUpperBound( ITargetSolver::undefined() ),
+mUpperStatus( 0 ),
+mBestValue( aInitialValue ),
+mBestStatus( aInitialStatus ),
+mIterations( 0 ),
+mIsDone( false ),
+mIsSolved( false )
+{
+    updateState( aInitialValue, aInitialStatus );
+    if( fabs( aInitialStatus ) < mTolerance ) {
+        mIsDone = true;
+        mIsSolved = true;
+    }
+    else {
+        calcTrialValues();
+    }
+
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::DEBUG );
+    targetLog << "Constructing a ParallelBracketer with " << mNumTrials
+              << " trials per iteration. Initial point: (" << aInitialValue
+              << ", " << aInitialStatus << ")" << endl;
+}
+
+/*!
+ * \brief Get the trial values to evaluate in the current iteration.
+ * \return The trial values in increasing order.
+ */
+const vector<double>& ParallelBracketer::getTrialValues() const {
+    return mTrialValues;
+}
+
+/*!
+ * \brief Set the statuses of the current trial values and calculate the next
+ *        set of trial values.
+ * \param aStatuses The status of each trial value in the same order as they
+ *        were returned by getTrialValues.
+ */
+void ParallelBracketer::setTrialStatuses( const vector<double>& aStatuses ) {
+    /*! \pre A status was calculated for each trial. */
+    assert( aStatuses.size() == mTrialValues.size() );
+    assert( !mIsDone );
+
+    ++mIterations;
+    for( unsigned int i = 0; i < mTrialValues.size(); ++i ) {
+        updateState( mTrialValues[ i ], aStatuses[ i ] );
+    }
+
+    if( fabs( mBestStatus ) < mTolerance ) {
+        mIsDone = true;
+        mIsSolved = true;
+    }
+    else if( mLowerBound != ITargetSolver::undefined() && mUpperBound != ITargetSolver::undefined()
+             && mUpperBound - mLowerBound < mTolerance )
+    {
+        // The solution lies within a bracket narrower than the tolerance.
+        mIsDone = true;
+        mIsSolved = true;
+    }
+    else {
+        calcTrialValues();
+    }
+    printState();
+}
+
+/*!
+ * \brief Whether the search has finished, either successfully or not.
+ * \return Whether the search has finished.
+ */
+bool ParallelBracketer::isDone() const {
+    return mIsDone;
+}
+
+/*!
+ * \brief Whether the search found a solution.
+ * \return Whether the search found a solution.
+ */
+bool ParallelBracketer::isSolved() const {
+    return mIsSolved;
+}
+
+/*!
+ * \brief Get the evaluated value with the status closest to zero.
+ * \return The best value found.
+ */
+double ParallelBracketer::getSolution() const {
+    return mBestValue;
+}
+
+/*!
+ * \brief Get the number of iterations, each of which evaluates a full set of
+ *        trial values, performed.
+ * \return The number of iterations performed.
+ */
+unsigned int ParallelBracketer::getIterations() const {
+    return mIterations;
+}
+
+/*!
+ * \brief Update the bracket and best value with an evaluated trial.
+ * \param aValue The trial value.
+ * \param aStatus The status of the trial value.
+ */
+void ParallelBracketer::updateState( const double aValue, const double aStatus ) {
+    if( fabs( aStatus ) < fabs( mBestStatus ) ) {
+        mBestValue = aValue;
+        mBestStatus = aStatus;
+    }
+    if( aStatus > 0 && aValue > mLowerBound ) {
+        mLowerBound = aValue;
+        mLowerStatus = aStatus;
+    }
+    else if( aStatus < 0 && ( mUpperBound == ITargetSolver::undefined() || aValue < mUpperBound ) ) {
+        mUpperBound = aValue;
+        mUpperStatus = aStatus;
+    }
+}
+
+/*!
+ * \brief Calculate the trial values for the next iteration from the current
+ *        bracket.
+ * \details Sets the search to done without a solution if the bracket can not
+ *          be extended any further.
+ */
+void ParallelBracketer::calcTrialValues() {
+    mTrialValues.clear();
+    const bool hasLower = mLowerBound != ITargetSolver::undefined();
+    const bool hasUpper = mUpperBound != ITargetSolver::undefined();
+    if( hasLower && hasUpper ) {
+        const double width = mUpperBound - mLowerBound;
+        unsigned int numEven = mNumTrials;
+        if( mNumTrials > 1 ) {
+            // Use one trial for the false position estimate if it is inside
+            // the bracket.
+            const double falsePosition = mLowerBound + mLowerStatus * width
+                / ( mLowerStatus - mUpperStatus );
+            if( falsePosition > mLowerBound && falsePosition < mUpperBound ) {
+                mTrialValues.push_back( falsePosition );
+                --numEven;
+            }
+        }
+        for( unsigned int i = 1; i <= numEven; ++i ) {
+            mTrialValues.push_back( mLowerBound + i * width / ( numEven + 1 ) );
+        }
+    }
+    else if( hasLower ) {
+        // Step upwards until the solution is bracketed.
+        if( mLowerBound >= mMaximum ) {
+            mIsDone = true;
+            return;
+        }
+        double trial = mLowerBound == 0 ? 1 + mMultiple : mLowerBound * ( 1 + mMultiple );
+        for( unsigned int i = 0; i < mNumTrials; ++i ) {
+            mTrialValues.push_back( min( trial, mMaximum ) );
+            if( trial >= mMaximum ) {
+                break;
+            }
+            trial *= 1 + mMultiple;
+        }
+    }
+    else {
+        // Step downwards until the solution is bracketed. If the upper bound
+        // is already near zero the constraint can not be met.
+        assert( hasUpper );
+        if( mUpperBound < mTolerance ) {
+            mIsDone = true;
+            return;
+        }
+        double trial = mUpperBound / ( 1 + mMultiple );
+        for( unsigned int i = 0; i < mNumTrials; ++i ) {
+            mTrialValues.push_back( trial );
+            trial /= 1 + mMultiple;
+        }
+    }
+    sort( mTrialValues.begin(), mTrialValues.end() );
+}
+
+/*!
+ * \brief Print the current state of the search.
+ */
+void ParallelBracketer::printState() const {
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::DEBUG );
+    if( mIsSolved ) {
+        targetLog << "Found solution. ";
+    }
+    else if( mIsDone ) {
+        targetLog << "Failed to solve because the bracket could not be extended. ";
+    }
+    else {
+        targetLog << "Attempting to solve target. Iteration: " << mIterations << " ";
+    }
+    targetLog << "The best trial is (" << mBestValue << ", " << mBestStatus
+              << "). Lower bound is " << mLowerBound << " and upper bound is "
+              << mUpperBound << "." << endl;
+}
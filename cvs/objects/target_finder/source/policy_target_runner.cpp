@@ -42,6 +42,7 @@
 #include <cassert>
 #include <string>
 #include <cmath>
+#include <cstring>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "util/base/include/xml_helper.h"
@@ -50,6 +51,7 @@
 #include "target_finder/include/itarget_solver.h"
 #include "target_finder/include/bisecter.h"
 #include "target_finder/include/secanter.h"
+#include "target_finder/include/parallel_bracketer.h"
 #include "target_finder/include/itarget.h"
 #include "containers/include/scenario_runner_factory.h"
 #include "util/base/include/configuration.h"
@@ -61,6 +63,10 @@
 #include "policy/include/policy_ghg.h"
 #include "util/base/include/util.h"
 #include "marketplace/include/marketplace.h"
+#include "util/base/include/forked_task_runner.h"
+#include "containers/include/world.h"
+#include "solution/util/include/calc_counter.h"
+#include "climate/include/climate_emulator.h"
 
 using namespace std;
 using namespace xercesc;
@@ -69,6 +75,144 @@ extern void closeDB();
 extern ofstream outFile;
 extern void createMCvarid();
 
+/*!
+ * \brief Evaluates a set of trial taxes in forked copies of the model.
+ * \details Each trial is run in a child process which writes back the status
+ *          of the target. Trials which could not be run in a child are run in
+ *          the current process instead.
+ */
+class PolicyTargetRunner::TrialEvaluator: public IForkedTask {
+public:
+    TrialEvaluator( PolicyTargetRunner* aRunner,
+                    const vector<double>& aTaxes,
+                    const ITarget* aPolicyTarget,
+                    const vector<double>& aTrialValues,
+                    const int aFirstSkippedPeriod,
+                    const int aPeriod,
+                    const int aTargetYear,
+                    Timer& aTimer );
+
+    // IForkedTask methods
+    virtual bool runInChild( const int aTaskIndex, string& aResult );
+    virtual void collectResult( const int aTaskIndex, const string& aResult,
+                                const bool aReceived, const bool aSucceeded );
+
+    const vector<double>& getStatuses() const;
+private:
+    //! The target runner which owns the scenario.
+    PolicyTargetRunner* mRunner;
+
+    //! The taxes to which the trial values are applied.
+    const vector<double>& mTaxes;
+
+    //! The policy target.
+    const ITarget* mPolicyTarget;
+
+    //! The trial values to evaluate.
+    const vector<double>& mTrialValues;
+
+    //! The first period whose tax is interpolated to the trial period.
+    const int mFirstSkippedPeriod;
+
+    //! The period to set the trial tax in and run up to.
+    const int mPeriod;
+
+    //! The year in which to check the target.
+    const int mTargetYear;
+
+    //! The timer passed to the scenario runs.
+    Timer& mTimer;
+
+    //! The run id of the first trial.
+    const unsigned int mFirstRunID;
+
+    //! The status of the target for each trial.
+    vector<double> mStatuses;
+
+    bool runTrial( const int aTaskIndex );
+};
+
+/*!
+ * \brief Constructor.
+ * \param aRunner The target runner which owns the scenario.
+ * \param aTaxes The taxes to which the trial values are applied.
+ * \param aPolicyTarget The policy target.
+ * \param aTrialValues The trial values to evaluate.
+ * \param aFirstSkippedPeriod The first period whose tax is interpolated.
+ * \param aPeriod The period to set the trial tax in and run up to.
+ * \param aTargetYear The year in which to check the target.
+ * \param aTimer The timer passed to the scenario runs.
+ */
+PolicyTargetRunner::TrialEvaluator::TrialEvaluator( PolicyTargetRunner* aRunner,
+                                                    const vector<double>& aTaxes,
+                                                    const ITarget* aPolicyTarget,
+                                                    const vector<double>& aTrialValues,
+                                                    const int aFirstSkippedPeriod,
+                                                    const int aPeriod,
+                                                    const int aTargetYear,
+                                                    Timer& aTimer ):
+mRunner( aRunner ),
+mTaxes( aTaxes ),
+mPolicyTarget( aPolicyTarget ),
+mTrialValues( aTrialValues ),
+mFirstSkippedPeriod( aFirstSkippedPeriod ),
+mPeriod( aPeriod ),
+mTargetYear( aTargetYear ),
+mTimer( aTimer ),
+mFirstRunID( aRunner->mRunID ),
+mStatuses( aTrialValues.size(), 0.0 )
+{
+}
+
+bool PolicyTargetRunner::TrialEvaluator::runInChild( const int aTaskIndex, string& aResult ) {
+    const bool success = runTrial( aTaskIndex );
+    const double status = mPolicyTarget->getStatus( mTargetYear );
+    aResult.assign( reinterpret_cast<const char*>( &status ), sizeof( status ) );
+    return success;
+}
+
+void PolicyTargetRunner::TrialEvaluator::collectResult( const int aTaskIndex, const string& aResult,
+                                                        const bool aReceived, const bool aSucceeded )
+{
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    if( aReceived && aResult.size() == sizeof( double ) ) {
+        memcpy( &mStatuses[ aTaskIndex ], aResult.data(), sizeof( double ) );
+        targetLog.setLevel( ILogger::NOTICE );
+        targetLog << "Trial value " << mTrialValues[ aTaskIndex ] << " has status "
+                  << mStatuses[ aTaskIndex ] << ". Return status = " << aSucceeded << endl;
+    }
+    else {
+        targetLog.setLevel( ILogger::WARNING );
+        targetLog << "Trial value " << mTrialValues[ aTaskIndex ]
+                  << " could not be run in a separate process, running it serially." << endl;
+        runTrial( aTaskIndex );
+        mStatuses[ aTaskIndex ] = mPolicyTarget->getStatus( mTargetYear );
+    }
+    // Keep the run ids unique across trials run in different processes.
+    mRunner->mRunID = max( mRunner->mRunID, static_cast<unsigned int>( mFirstRunID + aTaskIndex + 1 ) );
+}
+
+/*!
+ * \brief Get the status of the target for each trial.
+ * \return The status for each trial in the same order as the trial values.
+ */
+const vector<double>& PolicyTargetRunner::TrialEvaluator::getStatuses() const {
+    return mStatuses;
+}
+
+/*!
+ * \brief Set the taxes for a trial into the scenario and run it.
+ * \param aTaskIndex The index of the trial value.
+ * \return Whether the scenario solved.
+ */
+bool PolicyTargetRunner::TrialEvaluator::runTrial( const int aTaskIndex ) {
+    vector<double> taxes = mTaxes;
+    mRunner->calculateTrialTaxes( mTrialValues[ aTaskIndex ], mFirstSkippedPeriod, mPeriod, taxes );
+    mRunner->setTrialTaxes( taxes );
+    mRunner->mRunID = mFirstRunID + aTaskIndex;
+    return mRunner->runTrial( mTrialValues[ aTaskIndex ], mPeriod, mTimer );
+}
+
 /*!
  * \brief Constructor.
  */
@@ -81,7 +225,17 @@ mHasParsedConfig( false ),
 mRunID( 0 ),
 mNumForwardLooking( 0 ),
 mNumBackwardsLook( 0 ),
-mMaxTax( 4999 )
+mMaxTax( 4999 ),
+mNumParallelTrials( 1 ),
+mWarmStartTrials( false ),
+mInterpolateWarmStart( false ),
+mHistoryFirstPeriod( 0 ),
+mHistoryLastPeriod( 0 ),
+mColdStartCalcs( 0 ),
+mNumWarmStarts( 0 ),
+mCalcsSaved( 0 ),
+mEmulateClimate( false ),
+mClimateEmulator( 0 )
 {
 }
 
@@ -168,6 +322,18 @@ bool PolicyTargetRunner::XMLParse( const xercesc::DOMNode* aRoot ){
         else if( nodeName == "initial-tax-guess" ) {
             mInitialTaxGuess = XMLHelper<double>::getValue( curr );
         }
+        else if( nodeName == "parallel-trials" ) {
+            mNumParallelTrials = XMLHelper<unsigned int>::getValue( curr );
+        }
+        else if( nodeName == "warm-start-trials" ) {
+            mWarmStartTrials = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "interpolate-warm-start" ) {
+            mInterpolateWarmStart = XMLHelper<bool>::getValue( curr );
+        }
+        else if( nodeName == "emulate-climate" ) {
+            mEmulateClimate = XMLHelper<bool>::getValue( curr );
+        }
         // Handle unknown nodes.
         else {
             ILogger& mainLog = ILogger::getLogger( "main_log" );
@@ -261,8 +427,23 @@ bool PolicyTargetRunner::runScenarios( const int aSinglePeriod,
 {
     // Perform the initial run.
     ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    if( mNumParallelTrials > 1 && !ForkedTaskRunner::isSupported() ) {
+        targetLog.setLevel( ILogger::WARNING );
+        targetLog << "Parallel trials are not supported in this build, running trials serially." << endl;
+    }
     targetLog.setLevel( ILogger::NOTICE );
     targetLog << "Performing the baseline run." << endl;
+
+    // The emulator must stand in for the climate model before the baseline
+    // run so that it sees every full run, and before the target is created
+    // so that the target reads from it. Parallel trials always use the full
+    // model since their statuses are not confirmed.
+    if( mEmulateClimate && !useParallelTrials() &&
+        ( mTargetType == "forcing" || mTargetType == "concentration" || mTargetType == "temperature" ) )
+    {
+        mClimateEmulator = getInternalScenario()->getWorld()->useClimateEmulator();
+        mClimateEmulator->setEmulationEnabled( true );
+    }
     
     // Run the model without a tax target once to get a baseline for the
     // solver and to calculate the initial non-tax periods.
@@ -351,9 +532,24 @@ bool PolicyTargetRunner::runScenarios( const int aSinglePeriod,
         }
     }
     
+    // The output must come from the full climate model.
+    if( mClimateEmulator ) {
+        mClimateEmulator->setEmulationEnabled( false );
+        if( mClimateEmulator->isLastRunEmulated() ) {
+            mClimateEmulator->runFullModel();
+        }
+    }
+
     targetLog.setLevel( ILogger::NOTICE );
     targetLog << "Target finding for all years completed with status "
               << success << "." << endl;
+    if( mWarmStartTrials ) {
+        targetLog << "Warm started " << mNumWarmStarts << " trial runs, saving an estimated "
+                  << mCalcsSaved << " world calculations." << endl;
+    }
+    if( mClimateEmulator ) {
+        mClimateEmulator->printStatistics( targetLog );
+    }
 
     // Print the output before the total cost calculator modifies the scenario.
     mSingleScenario->printOutput( aTimer, false );
@@ -412,9 +608,8 @@ bool PolicyTargetRunner::solveInitialTarget( vector<double>& aTaxes,
 
     // Run the model without a tax target once to get a baseline for the
     // solver and to calculate the initial non-tax periods.
-    logRunID();
-    bool success = mSingleScenario->runScenarios( Scenario::RUN_ALL_PERIODS,
-                                                  false, aTimer );
+    startTrialHistory( firstTaxPeriod, getInternalScenario()->getModeltime()->getmaxper() - 1 );
+    bool success = runTrial( initialTax, Scenario::RUN_ALL_PERIODS, aTimer );
     
     // If we are already below the target at a zero tax then we won't be able to
     // get to the target.
@@ -431,68 +626,85 @@ bool PolicyTargetRunner::solveInitialTarget( vector<double>& aTaxes,
     
     // Increment is 1+ this number, which is used to increase the initial trial price
     const double INCREASE_INCREMENT = mInitialTaxGuess - 1;
-    auto_ptr<ITargetSolver> solver;
-    /* Note that the following code is left commented out incase a user wanted
-       to use the bisection routine rather then the secant.
-    solver.reset( new Bisecter( aPolicyTarget,
-                       aTolerance,
-                       0,
-                       Bisecter::undefined(),
-                       Bisecter::undefined(),
-                       INCREASE_INCREMENT,
-                       mInitialTargetYear ) );*/
+    unsigned int iterations = 0;
+    if( useParallelTrials() ) {
+        if( !solveTargetInParallel( aTaxes, aPolicyTarget, initialTax,
+                                    aPolicyTarget->getStatus( mInitialTargetYear ),
+                                    INCREASE_INCREMENT, aLimitIterations, aTolerance,
+                                    Scenario::RUN_ALL_PERIODS, Scenario::RUN_ALL_PERIODS,
+                                    mInitialTargetYear, iterations, success, aTimer ) )
+        {
+            return false;
+        }
+    }
+    else {
+        auto_ptr<ITargetSolver> solver;
+        /* Note that the following code is left commented out incase a user wanted
+           to use the bisection routine rather then the secant.
+        solver.reset( new Bisecter( aPolicyTarget,
+                           aTolerance,
+                           0,
+                           Bisecter::undefined(),
+                           Bisecter::undefined(),
+                           INCREASE_INCREMENT,
+                           mInitialTargetYear ) );*/
     
-    solver.reset( new Secanter( aPolicyTarget,
-                       aTolerance,
-                       initialTax,
-                       aPolicyTarget->getStatus( mInitialTargetYear ),
-                       INCREASE_INCREMENT,
-                       mInitialTargetYear ) );
+        solver.reset( new Secanter( aPolicyTarget,
+                           aTolerance,
+                           initialTax,
+                           aPolicyTarget->getStatus( mInitialTargetYear ),
+                           INCREASE_INCREMENT,
+                           mInitialTargetYear ) );
     
 
-    while( solver->getIterations() < aLimitIterations ) {
-        pair<double, bool> trial = solver->getNextValue();
+        while( solver->getIterations() < aLimitIterations ) {
+            pair<double, bool> trial = solver->getNextValue();
 
-        // Check for solution.
-        if( trial.second ){
-            break;
-        }
+            // Check for solution.
+            if( trial.second ){
+                if( !confirmClimateModel() ) {
+                    continue;
+                }
+                break;
+            }
         
-        if( !util::isValidNumber( trial.first ) ) {
-            targetLog.setLevel( ILogger::ERROR );
-            targetLog << "Failed due to invalid trial price generated by solver." << endl;
-            return false;
-        }
+            if( !util::isValidNumber( trial.first ) ) {
+                targetLog.setLevel( ILogger::ERROR );
+                targetLog << "Failed due to invalid trial price generated by solver." << endl;
+                return false;
+            }
 
         
-        targetLog << "Iteration " << solver->getIterations() << " trial value = "
-                  << trial.first << endl;
+            targetLog << "Iteration " << solver->getIterations() << " trial value = "
+                      << trial.first << endl;
 
-        // Set the trial tax.
-        calculateHotellingPath( trial.first,
-                                         mPathDiscountRate,
-                                         getInternalScenario()->getModeltime(),
-                                         mFirstTaxYear,
-                                         finalModelYear,
-                                         aTaxes );
+            // Set the trial tax.
+            calculateHotellingPath( trial.first,
+                                             mPathDiscountRate,
+                                             getInternalScenario()->getModeltime(),
+                                             mFirstTaxYear,
+                                             finalModelYear,
+                                             aTaxes );
 
-        setTrialTaxes( aTaxes );
+            setTrialTaxes( aTaxes );
 
-        // Run the scenario at the trial tax.
-        // TODO: If the run failed to solve then the target status may be unreliable.
-        logRunID();
-        success = mSingleScenario->runScenarios( Scenario::RUN_ALL_PERIODS, false, aTimer );
+            // Run the scenario at the trial tax.
+            // TODO: If the run failed to solve then the target status may be unreliable.
+            success = runTrial( trial.first, Scenario::RUN_ALL_PERIODS, aTimer );
 
-        targetLog << "Scenario run complete.  Return status = " << success << endl;
-    }
+            targetLog << "Scenario run complete.  Return status = " << success << endl;
+        }
 
-    if( solver->getIterations() >= aLimitIterations ){
-        targetLog.setLevel( ILogger::ERROR );
-        targetLog << "Exiting target finding search as the iterations limit was"
-                  << " reached." << endl;
-        success = false;
+        if( solver->getIterations() >= aLimitIterations ){
+            targetLog.setLevel( ILogger::ERROR );
+            targetLog << "Exiting target finding search as the iterations limit was"
+                      << " reached." << endl;
+            return false;
+        }
+        iterations = solver->getIterations();
     }
-    else if( !success ) {
+
+    if( !success ) {
         // This is the case that we found the target however the run in which we
         // found the target had periods that did not solve.  If only periods after
         // target year did not solve then we will allow it.
@@ -515,7 +727,7 @@ bool PolicyTargetRunner::solveInitialTarget( vector<double>& aTaxes,
     if( success ) {
         targetLog.setLevel( ILogger::NOTICE );
         targetLog << "Target value was found by search algorithm in "
-                  << solver->getIterations() << " iterations." << endl;
+                  << iterations << " iterations." << endl;
     }
     return success;
 }
@@ -551,65 +763,81 @@ bool PolicyTargetRunner::solveFutureTarget( vector<double>& aTaxes,
     // path.
     aTaxes[ aPeriod ] = aTaxes[ aPeriod - 1 ];
     setTrialTaxes( aTaxes );
-    logRunID();
-    bool success = mSingleScenario->runScenarios( aPeriod, false, aTimer );
+    startTrialHistory( aPeriod, aPeriod );
+    bool success = runTrial( aTaxes[ aPeriod ], aPeriod, aTimer );
 
     // Construct a solver which has an initial trial equal to the current tax.
     const Modeltime* modeltime = getInternalScenario()->getModeltime();
     int currYear = modeltime->getper_to_yr( aPeriod );
-    auto_ptr<ITargetSolver> solver;
-    /* Note that the following code is left commented out incase a user wanted
-     to use the bisection routine rather then the secant.
-     solver.reset( new Bisecter( aPolicyTarget,
-                       aTolerance,
-                       0,
-                       MAX_SOLVABLE_TAX, // Maximum tax
-                       aTaxes[ aPeriod ],
-                       4.0, // Note the hard coded value is the initial bracket interval
-                       currYear ) );*/
-    solver.reset( new Secanter( aPolicyTarget,
-                       aTolerance,
-                       aTaxes[ aPeriod ],
-                       aPolicyTarget->getStatus( currYear ),
-                       0.2, // Note the hard coded value is the initial percent change
-                            // for the second initial guess.
-                       currYear ) );
-
-    while( solver->getIterations() < aLimitIterations ){
-        pair<double, bool> trial = solver->getNextValue();
-        
-        // Check for solution.
-        if( trial.second ){
-            break;
+    unsigned int iterations = 0;
+    if( useParallelTrials() ) {
+        if( !solveTargetInParallel( aTaxes, aPolicyTarget, aTaxes[ aPeriod ],
+                                    aPolicyTarget->getStatus( currYear ),
+                                    0.2, aLimitIterations, aTolerance, aPeriod, aPeriod,
+                                    currYear, iterations, success, aTimer ) )
+        {
+            return false;
         }
+    }
+    else {
+        auto_ptr<ITargetSolver> solver;
+        /* Note that the following code is left commented out incase a user wanted
+         to use the bisection routine rather then the secant.
+         solver.reset( new Bisecter( aPolicyTarget,
+                           aTolerance,
+                           0,
+                           MAX_SOLVABLE_TAX, // Maximum tax
+                           aTaxes[ aPeriod ],
+                           4.0, // Note the hard coded value is the initial bracket interval
+                           currYear ) );*/
+        solver.reset( new Secanter( aPolicyTarget,
+                           aTolerance,
+                           aTaxes[ aPeriod ],
+                           aPolicyTarget->getStatus( currYear ),
+                           0.2, // Note the hard coded value is the initial percent change
+                                // for the second initial guess.
+                           currYear ) );
+
+        while( solver->getIterations() < aLimitIterations ){
+            pair<double, bool> trial = solver->getNextValue();
+        
+            // Check for solution.
+            if( trial.second ){
+                if( !confirmClimateModel() ) {
+                    continue;
+                }
+                break;
+            }
 
-        // Replace the current periods tax with the calculated tax.
-        assert( static_cast<unsigned int>( aPeriod ) < aTaxes.size() );
-        aTaxes[ aPeriod ] = trial.first;
+            // Replace the current periods tax with the calculated tax.
+            assert( static_cast<unsigned int>( aPeriod ) < aTaxes.size() );
+            aTaxes[ aPeriod ] = trial.first;
 
-        // Set the trial taxes.
-        setTrialTaxes( aTaxes );
+            // Set the trial taxes.
+            setTrialTaxes( aTaxes );
 
-        // Run the base scenario.
-        // TODO: If the run failed to solve then the target status may be unreliable.
-        logRunID();
-        success = mSingleScenario->runScenarios( aPeriod, false, aTimer );
-    }
+            // Run the base scenario.
+            // TODO: If the run failed to solve then the target status may be unreliable.
+            success = runTrial( trial.first, aPeriod, aTimer );
+        }
 
-    if( solver->getIterations() >= aLimitIterations ){
-        targetLog.setLevel( ILogger::ERROR );
-        targetLog << "Exiting target finding search as the iterations limit " 
-                  << "was reached." << endl;
-        success = false;
+        if( solver->getIterations() >= aLimitIterations ){
+            targetLog.setLevel( ILogger::ERROR );
+            targetLog << "Exiting target finding search as the iterations limit " 
+                      << "was reached." << endl;
+            return false;
+        }
+        iterations = solver->getIterations();
     }
-    else if( !success ) {
+
+    if( !success ) {
         targetLog.setLevel( ILogger::ERROR );
         targetLog << "Failed due to unsolved model period: " << aPeriod << endl;
     }
     else {
         targetLog.setLevel( ILogger::NOTICE );
         targetLog << "Target value was found by search algorithm in "
-                  << solver->getIterations() << " iterations." << endl;
+                  << iterations << " iterations." << endl;
     }
     return success;
 }
@@ -669,69 +897,85 @@ bool PolicyTargetRunner::skipFuturePeriod( vector<double>& aTaxes,
         getInternalScenario()->invalidatePeriod( period );
     }
     setTrialTaxes( aTaxes );
-    logRunID();
-    bool success = mSingleScenario->runScenarios( lastPeriodToCalc, false, aTimer );
+    startTrialHistory( aFirstSkippedPeriod, lastPeriodToCalc );
+    bool success = runTrial( aTaxes[ aPeriod ], lastPeriodToCalc, aTimer );
     
     // Construct a solver which has an initial trial equal to the current tax.
-    auto_ptr<ITargetSolver> solver;
-    /* Note that the following code is left commented out incase a user wanted
-     to use the bisection routine rather then the secant.
-     solver.reset( new Bisecter( aPolicyTarget,
-                                 aTolerance,
-                                 0,
-                                 MAX_SOLVABLE_TAX, // Maximum tax
-                                 aTaxes[ aPeriod ],
-                                 4.0, // Note the hard coded value is the initial bracket interval
-                                 currYear ) );*/
-    solver.reset( new Secanter( aPolicyTarget,
-                                aTolerance,
-                                aTaxes[ aPeriod ],
-                                aPolicyTarget->getStatus( currYear ),
-                                0.2, // Note the hard coded value is the initial percent change
-                                     // for the second initial guess.
-                                currYear ) );
+    unsigned int iterations = 0;
+    if( useParallelTrials() ) {
+        if( !solveTargetInParallel( aTaxes, aPolicyTarget, aTaxes[ aPeriod ],
+                                    aPolicyTarget->getStatus( currYear ),
+                                    0.2, aLimitIterations, aTolerance, aFirstSkippedPeriod,
+                                    aPeriod, currYear, iterations, success, aTimer ) )
+        {
+            return false;
+        }
+    }
+    else {
+        auto_ptr<ITargetSolver> solver;
+        /* Note that the following code is left commented out incase a user wanted
+         to use the bisection routine rather then the secant.
+         solver.reset( new Bisecter( aPolicyTarget,
+                                     aTolerance,
+                                     0,
+                                     MAX_SOLVABLE_TAX, // Maximum tax
+                                     aTaxes[ aPeriod ],
+                                     4.0, // Note the hard coded value is the initial bracket interval
+                                     currYear ) );*/
+        solver.reset( new Secanter( aPolicyTarget,
+                                    aTolerance,
+                                    aTaxes[ aPeriod ],
+                                    aPolicyTarget->getStatus( currYear ),
+                                    0.2, // Note the hard coded value is the initial percent change
+                                         // for the second initial guess.
+                                    currYear ) );
     
-    while( solver->getIterations() < aLimitIterations ){
-        pair<double, bool> trial = solver->getNextValue();
+        while( solver->getIterations() < aLimitIterations ){
+            pair<double, bool> trial = solver->getNextValue();
         
-        // Check for solution.
-        if( trial.second ){
-            break;
-        }
+            // Check for solution.
+            if( trial.second ){
+                if( !confirmClimateModel() ) {
+                    continue;
+                }
+                break;
+            }
         
-        if( !util::isValidNumber( trial.first ) ) {
-            targetLog.setLevel( ILogger::ERROR );
-            targetLog << "Failed due to invalid trial price generated by solver." << endl;
-            return false;
-        }
+            if( !util::isValidNumber( trial.first ) ) {
+                targetLog.setLevel( ILogger::ERROR );
+                targetLog << "Failed due to invalid trial price generated by solver." << endl;
+                return false;
+            }
         
-        // Replace the current periods tax with the calculated tax.
-        assert( static_cast<unsigned int>( aPeriod ) < aTaxes.size() );
-        aTaxes[ aPeriod ] = trial.first;
-        for( int period = aFirstSkippedPeriod; period < aPeriod; ++period ) {
-            const int year = modeltime->getper_to_yr( period );
-            aTaxes[ period ] = util::linearInterpolateY( year, lastTaxYear, currYear,
-                                                         aTaxes[ aFirstSkippedPeriod - 1 ],
-                                                         aTaxes[ aPeriod ] );
-            getInternalScenario()->invalidatePeriod( period );
-        }
+            // Replace the current periods tax with the calculated tax.
+            assert( static_cast<unsigned int>( aPeriod ) < aTaxes.size() );
+            aTaxes[ aPeriod ] = trial.first;
+            for( int period = aFirstSkippedPeriod; period < aPeriod; ++period ) {
+                const int year = modeltime->getper_to_yr( period );
+                aTaxes[ period ] = util::linearInterpolateY( year, lastTaxYear, currYear,
+                                                             aTaxes[ aFirstSkippedPeriod - 1 ],
+                                                             aTaxes[ aPeriod ] );
+                getInternalScenario()->invalidatePeriod( period );
+            }
         
-        // Set the trial taxes.
-        setTrialTaxes( aTaxes );
+            // Set the trial taxes.
+            setTrialTaxes( aTaxes );
         
-        // Run the base scenario.
-        // TODO: If the run failed to solve then the target status may be unreliable.
-        logRunID();
-        success = mSingleScenario->runScenarios( lastPeriodToCalc, false, aTimer );
-    }
+            // Run the base scenario.
+            // TODO: If the run failed to solve then the target status may be unreliable.
+            success = runTrial( trial.first, lastPeriodToCalc, aTimer );
+        }
     
-    if( solver->getIterations() >= aLimitIterations ){
-        targetLog.setLevel( ILogger::ERROR );
-        targetLog << "Exiting target finding search as the iterations limit " 
-                  << "was reached." << endl;
-        success = false;
+        if( solver->getIterations() >= aLimitIterations ){
+            targetLog.setLevel( ILogger::ERROR );
+            targetLog << "Exiting target finding search as the iterations limit " 
+                      << "was reached." << endl;
+            return false;
+        }
+        iterations = solver->getIterations();
     }
-    else if( !success ) {
+
+    if( !success ) {
         // This is the case that we found the target however the run in which we
         // found the target had periods that did not solve.  If only periods after
         // aPeriod did not solve then we will allow it.
@@ -751,7 +995,7 @@ bool PolicyTargetRunner::skipFuturePeriod( vector<double>& aTaxes,
     if( !success ) {
         targetLog.setLevel( ILogger::NOTICE );
         targetLog << "Target value was found by search algorithm in "
-                  << solver->getIterations() << " iterations." << endl;
+                  << iterations << " iterations." << endl;
     }
     return success;
 }
@@ -841,6 +1085,282 @@ void PolicyTargetRunner::setTrialTaxes( const vector<double> aTaxes ) {
     mSingleScenario->getInternalScenario()->setTax( &tax );
 }
 
+/*!
+ * \brief Calculate the taxes for a trial value.
+ * \details If aPeriod is Scenario::RUN_ALL_PERIODS the trial value is the
+ *          initial tax of a Hotelling price path. Otherwise it is the tax in
+ *          aPeriod and the taxes in the periods from aFirstSkippedPeriod up to
+ *          aPeriod are linearly interpolated from the last tax before them.
+ * \param aTrial The trial value.
+ * \param aFirstSkippedPeriod The first period whose tax is interpolated.
+ * \param aPeriod The period the trial value is the tax for.
+ * \param aTaxes The taxes to update.
+ */
+void PolicyTargetRunner::calculateTrialTaxes( const double aTrial,
+                                              const int aFirstSkippedPeriod,
+                                              const int aPeriod,
+                                              vector<double>& aTaxes )
+{
+    const Modeltime* modeltime = getInternalScenario()->getModeltime();
+    if( aPeriod == Scenario::RUN_ALL_PERIODS ) {
+        calculateHotellingPath( aTrial, mPathDiscountRate, modeltime, mFirstTaxYear,
+                                modeltime->getEndYear(), aTaxes );
+        return;
+    }
+
+    assert( static_cast<unsigned int>( aPeriod ) < aTaxes.size() );
+    aTaxes[ aPeriod ] = aTrial;
+    const int currYear = modeltime->getper_to_yr( aPeriod );
+    const int lastTaxYear = modeltime->getper_to_yr( aFirstSkippedPeriod - 1 );
+    for( int period = aFirstSkippedPeriod; period < aPeriod; ++period ) {
+        const int year = modeltime->getper_to_yr( period );
+        aTaxes[ period ] = util::linearInterpolateY( year, lastTaxYear, currYear,
+                                                     aTaxes[ aFirstSkippedPeriod - 1 ],
+                                                     aTaxes[ aPeriod ] );
+        getInternalScenario()->invalidatePeriod( period );
+    }
+}
+
+/*!
+ * \brief Whether trial taxes should be evaluated several at a time in forked
+ *        copies of the model.
+ * \return Whether to use parallel trials.
+ */
+bool PolicyTargetRunner::useParallelTrials() const {
+    return mNumParallelTrials > 1 && ForkedTaskRunner::isSupported();
+}
+
+/*!
+ * \brief Clear the trial history at the start of a new search.
+ * \details Prices are only reused between trials of the same search since
+ *          trials of different searches differ in more than the trial value.
+ * \param aFirstPeriod The first period whose prices are changed by the trials.
+ * \param aLastPeriod The last period the trials are run to.
+ */
+void PolicyTargetRunner::startTrialHistory( const int aFirstPeriod, const int aLastPeriod ) {
+    mTrialHistory.clear();
+    mHistoryFirstPeriod = aFirstPeriod;
+    mHistoryLastPeriod = aLastPeriod;
+    mColdStartCalcs = 0;
+}
+
+/*!
+ * \brief Run the scenario for a trial whose taxes have already been set.
+ * \details If warm starting is enabled the solver starts from the prices of
+ *          earlier trials in the search and the prices solved by this trial
+ *          are kept for later ones. The number of world calculations used is
+ *          compared to the first run of the search, which had nothing to start
+ *          from, to estimate the calculations saved.
+ * \param aTrialValue The trial value which was used to set the taxes.
+ * \param aPeriod The period to run up to or Scenario::RUN_ALL_PERIODS.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether the scenario solved.
+ */
+bool PolicyTargetRunner::runTrial( const double aTrialValue, const int aPeriod, Timer& aTimer ) {
+    if( !mWarmStartTrials ) {
+        logRunID();
+        return mSingleScenario->runScenarios( aPeriod, false, aTimer );
+    }
+
+    const bool isWarmStart = seedTrialPrices( aTrialValue );
+    const CalcCounter* calcCounter = getInternalScenario()->getWorld()->getCalcCounter();
+    const int startCalcs = calcCounter->getTotalCount();
+    logRunID();
+    const bool success = mSingleScenario->runScenarios( aPeriod, false, aTimer );
+    const int numCalcs = calcCounter->getTotalCount() - startCalcs;
+    getInternalScenario()->getMarketplace()->clearPriceGuesses();
+    recordTrialPrices( aTrialValue );
+
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::DEBUG );
+    if( isWarmStart ) {
+        ++mNumWarmStarts;
+        mCalcsSaved += mColdStartCalcs - numCalcs;
+        targetLog << "Warm started trial used " << numCalcs << " world calculations compared to "
+                  << mColdStartCalcs << " for the cold start." << endl;
+    }
+    else {
+        mColdStartCalcs = numCalcs;
+        targetLog << "Cold started trial used " << numCalcs << " world calculations." << endl;
+    }
+    return success;
+}
+
+/*!
+ * \brief Confirm a solution found against the climate emulator with the full
+ *        climate model.
+ * \details If the climate of the last trial was emulated the full climate
+ *          model is run with the same emissions, and the solver should check
+ *          the target again before accepting the solution.
+ * \return Whether the climate of the last trial came from the full model.
+ */
+bool PolicyTargetRunner::confirmClimateModel() {
+    if( !mClimateEmulator || !mClimateEmulator->isLastRunEmulated() ) {
+        return true;
+    }
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    targetLog.setLevel( ILogger::NOTICE );
+    targetLog << "Confirming the emulated solution with the full climate model." << endl;
+    mClimateEmulator->runFullModel();
+    return false;
+}
+
+/*!
+ * \brief Give the marketplace starting prices for a trial from the trial
+ *        history.
+ * \details The prices of the earlier trial nearest to the trial value are
+ *          used. If interpolation is enabled and there are earlier trials on
+ *          both sides of the trial value the prices are instead linearly
+ *          interpolated between the nearest trial on each side.
+ * \param aTrialValue The trial value about to be run.
+ * \return Whether any starting prices were set.
+ */
+bool PolicyTargetRunner::seedTrialPrices( const double aTrialValue ) {
+    if( mTrialHistory.empty() ) {
+        return false;
+    }
+
+    typedef list<TrialPrices>::const_iterator HistoryIterator;
+    HistoryIterator nearest = mTrialHistory.end();
+    HistoryIterator below = mTrialHistory.end();
+    HistoryIterator above = mTrialHistory.end();
+    for( HistoryIterator it = mTrialHistory.begin(); it != mTrialHistory.end(); ++it ) {
+        if( nearest == mTrialHistory.end() ||
+            fabs( it->mTrialValue - aTrialValue ) < fabs( nearest->mTrialValue - aTrialValue ) )
+        {
+            nearest = it;
+        }
+        if( it->mTrialValue < aTrialValue &&
+            ( below == mTrialHistory.end() || it->mTrialValue > below->mTrialValue ) )
+        {
+            below = it;
+        }
+        if( it->mTrialValue > aTrialValue &&
+            ( above == mTrialHistory.end() || it->mTrialValue < above->mTrialValue ) )
+        {
+            above = it;
+        }
+    }
+
+    Marketplace* marketplace = getInternalScenario()->getMarketplace();
+    const bool interpolate = mInterpolateWarmStart && below != mTrialHistory.end()
+        && above != mTrialHistory.end();
+    for( unsigned int i = 0; i < nearest->mPrices.size(); ++i ) {
+        if( !interpolate ) {
+            marketplace->setPriceGuesses( mHistoryFirstPeriod + i, nearest->mPrices[ i ] );
+            continue;
+        }
+        const vector<double>& belowPrices = below->mPrices[ i ];
+        const vector<double>& abovePrices = above->mPrices[ i ];
+        vector<double> prices( belowPrices.size() );
+        for( unsigned int j = 0; j < prices.size(); ++j ) {
+            prices[ j ] = util::linearInterpolateY( aTrialValue, below->mTrialValue,
+                                                    above->mTrialValue, belowPrices[ j ],
+                                                    abovePrices[ j ] );
+        }
+        marketplace->setPriceGuesses( mHistoryFirstPeriod + i, prices );
+    }
+    return true;
+}
+
+/*!
+ * \brief Keep the prices solved by a trial in the trial history.
+ * \details Only the most recent trials are kept since the search converges
+ *          and older trials are unlikely to be the nearest.
+ * \param aTrialValue The trial value which was run.
+ */
+void PolicyTargetRunner::recordTrialPrices( const double aTrialValue ) {
+    const unsigned int MAX_HISTORY_SIZE = 10;
+    if( mTrialHistory.size() >= MAX_HISTORY_SIZE ) {
+        mTrialHistory.pop_front();
+    }
+
+    const Marketplace* marketplace = getInternalScenario()->getMarketplace();
+    mTrialHistory.push_back( TrialPrices() );
+    mTrialHistory.back().mTrialValue = aTrialValue;
+    for( int period = mHistoryFirstPeriod; period <= mHistoryLastPeriod; ++period ) {
+        mTrialHistory.back().mPrices.push_back( marketplace->getPrices( period ) );
+    }
+}
+
+/*!
+ * \brief Search for the tax which meets the target by evaluating several trial
+ *        taxes at a time.
+ * \details Each iteration the trial values from a ParallelBracketer are run in
+ *          forked copies of the model, which all start from the current state
+ *          of the scenario. The statuses of all of the trials are used to
+ *          narrow the bracket. Once the target is found the scenario is run
+ *          at the solution in this process so that its state matches the
+ *          returned taxes.
+ * \param aTaxes The current tax vector which will be updated to the solution.
+ * \param aPolicyTarget Object which detects if the policy target has been
+ *        reached.
+ * \param aInitialTrial A trial value which has already been run.
+ * \param aInitialStatus The target status of the initial trial.
+ * \param aMultiple Amount to adjust trial values by until the solution is
+ *        bracketed.
+ * \param aLimitIterations The maximum number of iterations to perform.
+ * \param aTolerance The tolerance of the solution.
+ * \param aFirstSkippedPeriod The first period whose tax is interpolated.
+ * \param aPeriod The period to set the trial tax in and run up to, or
+ *        Scenario::RUN_ALL_PERIODS to set a Hotelling price path.
+ * \param aTargetYear The year in which to check the target.
+ * \param aIterations Set to the number of iterations performed.
+ * \param aRunSuccess Set to whether the run at the solution solved.
+ * \param aTimer The timer used to print out the amount of time spent performing
+ *        operations.
+ * \return Whether the target was found.
+ */
+bool PolicyTargetRunner::solveTargetInParallel( vector<double>& aTaxes,
+                                                const ITarget* aPolicyTarget,
+                                                const double aInitialTrial,
+                                                const double aInitialStatus,
+                                                const double aMultiple,
+                                                const unsigned int aLimitIterations,
+                                                const double aTolerance,
+                                                const int aFirstSkippedPeriod,
+                                                const int aPeriod,
+                                                const int aTargetYear,
+                                                unsigned int& aIterations,
+                                                bool& aRunSuccess,
+                                                Timer& aTimer )
+{
+    ILogger& targetLog = ILogger::getLogger( "target_finder_log" );
+    ParallelBracketer solver( aTolerance, mNumParallelTrials, mMaxTax, aMultiple,
+                              aInitialTrial, aInitialStatus );
+    while( !solver.isDone() && solver.getIterations() < aLimitIterations ) {
+        const vector<double>& trials = solver.getTrialValues();
+        targetLog.setLevel( ILogger::NOTICE );
+        targetLog << "Iteration " << solver.getIterations() << " evaluating "
+                  << trials.size() << " trial values." << endl;
+
+        TrialEvaluator evaluator( this, aTaxes, aPolicyTarget, trials, aFirstSkippedPeriod,
+                                  aPeriod, aTargetYear, aTimer );
+        ForkedTaskRunner::run( evaluator, trials.size(), trials.size() );
+        solver.setTrialStatuses( evaluator.getStatuses() );
+    }
+    aIterations = solver.getIterations();
+
+    if( !solver.isDone() ) {
+        targetLog.setLevel( ILogger::ERROR );
+        targetLog << "Exiting target finding search as the iterations limit "
+                  << "was reached." << endl;
+        return false;
+    }
+    else if( !solver.isSolved() ) {
+        targetLog.setLevel( ILogger::ERROR );
+        targetLog << "Failed because the target could not be bracketed." << endl;
+        return false;
+    }
+
+    // Run the solution in this process so the scenario is left in its state.
+    calculateTrialTaxes( solver.getSolution(), aFirstSkippedPeriod, aPeriod, aTaxes );
+    setTrialTaxes( aTaxes );
+    aRunSuccess = runTrial( solver.getSolution(), aPeriod, aTimer );
+    return true;
+}
+
 /*!
  * \brief Write a unique identifier into each of several log files
  */
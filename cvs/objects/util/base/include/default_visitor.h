@@ -238,6 +238,9 @@ public:
 
     virtual void startVisitNoEmissCarbonCalc( const NoEmissCarbonCalc* aNoEmissCarbonCalc, const int aPeriod ){}
     virtual void endVisitNoEmissCarbonCalc( const NoEmissCarbonCalc* aNoEmissCarbonCalc, const int aPeriod ){}
+
+    virtual bool shouldVisitRegion( const std::string& aRegionName ) const { return true; }
+    virtual bool shouldVisitSector( const std::string& aSectorName ) const { return true; }
 };
 
 #endif // _DEFAULT_VISITOR_H_
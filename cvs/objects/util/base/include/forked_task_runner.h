@@ -0,0 +1,131 @@
+#ifndef _FORKED_TASK_RUNNER_H_
+#define _FORKED_TASK_RUNNER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file forked_task_runner.h
+* \ingroup Objects
+* \brief The IForkedTask interface and ForkedTaskRunner class header file.
+*/
+
+#include <string>
+
+/*!
+ * \ingroup Objects
+ * \brief Interface for a set of independent tasks which may be run in forked
+ *        child processes.
+ * \details Each task is run in a child process which has a copy-on-write copy
+ *          of the state of the parent at the time it was forked. The child
+ *          serializes its result to a string which is passed back to the
+ *          parent, where it is deserialized by collectResult.
+ */
+class IForkedTask {
+public:
+    //! Virtual destructor so that derived classes may be deleted through this interface.
+    virtual ~IForkedTask() {}
+
+    /*!
+     * \brief Run a task in the child process.
+     * \param aTaskIndex The index of the task to run.
+     * \param aResult String to which the serialized result should be written.
+     * \return Whether the task completed successfully.
+     */
+    virtual bool runInChild( const int aTaskIndex, std::string& aResult ) = 0;
+
+    /*!
+     * \brief Receive the result of a task in the parent process.
+     * \param aTaskIndex The index of the task.
+     * \param aResult The serialized result written by the child.
+     * \param aReceived Whether the child process returned a result. If this is
+     *        false the child could not be started or failed before writing
+     *        its result and aResult is empty.
+     * \param aSucceeded Whether runInChild returned true.
+     */
+    virtual void collectResult( const int aTaskIndex, const std::string& aResult,
+                                const bool aReceived, const bool aSucceeded ) = 0;
+};
+
+/*!
+ * \ingroup Objects
+ * \brief Runs a set of IForkedTasks in forked child processes.
+ * \details Tasks are started in index order with at most a given number of
+ *          child processes at a time. Results are collected in the parent in
+ *          the same order, and each child is read until it closes its pipe
+ *          before it is reaped so that a child can never block on a full pipe.
+ *          Children exit without running any destructors or flushing any
+ *          buffers inherited from the parent.
+ *
+ *          Forking is only supported on POSIX systems in builds without
+ *          GCAM_PARALLEL_ENABLED, as the threads started by TBB and the
+ *          asynchronous writers do not exist in a forked child. Callers should
+ *          check isSupported and run their tasks serially otherwise.
+ *          Forking is also stopped once the process has started a resource
+ *          which can not be used in a forked child, such as the Java VM, and
+ *          has called disableForking. Tasks which have not been started by
+ *          then are reported as not received.
+ *
+ *          Children which write to shared files or databases may bracket the
+ *          writes with beginSerialSection and endSerialSection so that only
+ *          one child of a run writes at a time. The lock is released by the
+ *          operating system if a child exits while holding it.
+ */
+class ForkedTaskRunner {
+public:
+    static bool isSupported();
+
+    static void run( IForkedTask& aTask, const int aNumTasks, const int aMaxWorkers );
+
+    static void disableForking();
+
+    static void beginSerialSection();
+
+    static void endSerialSection();
+private:
+    //! Private undefined constructor to prevent creating a ForkedTaskRunner.
+    ForkedTaskRunner();
+
+    //! File descriptor of the file locked by serial sections of the current
+    //! run, or -1 if no run is in progress.
+    static int sLockFD;
+
+    //! Whether the process has started a resource which would be broken in
+    //! a forked child.
+    static bool sIsForkingDisabled;
+};
+
+#endif // _FORKED_TASK_RUNNER_H_
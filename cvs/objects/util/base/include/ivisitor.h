@@ -312,6 +312,11 @@ public:
 
     virtual void startVisitNoEmissCarbonCalc( const NoEmissCarbonCalc* aNoEmissCarbonCalc, const int aPeriod ) = 0;
     virtual void endVisitNoEmissCarbonCalc( const NoEmissCarbonCalc* aNoEmissCarbonCalc, const int aPeriod ) = 0;
+
+    // Following allow a visitor to skip entire subtrees it has no interest in.
+    // Containers check these before calling accept on the children.
+    virtual bool shouldVisitRegion( const std::string& aRegionName ) const = 0;
+    virtual bool shouldVisitSector( const std::string& aSectorName ) const = 0;
 };
 
 IVisitor::~IVisitor(){
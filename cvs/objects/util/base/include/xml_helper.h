@@ -81,6 +81,7 @@
 #include <xercesc/dom/DOMNodeList.hpp>
 #include <xercesc/sax/HandlerBase.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
+#include <xercesc/framework/MemBufInputSource.hpp>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/trim.hpp>
@@ -91,6 +92,7 @@
 #include "util/base/include/iparsable.h"
 #include "util/base/include/time_vector.h"
 #include "util/base/include/value.h"
+#include "util/base/include/xml_parse_cache.h"
 
 /*!
  * \ingroup Objects
@@ -176,6 +178,7 @@ public:
 
    static int getNodePeriod ( const xercesc::DOMNode* node, const Modeltime* modeltime );
    static bool parseXML( const std::string& aXMLFile, IParsable* aModelElement );
+   static bool parseXMLString( const std::string& aXML, IParsable* aModelElement );
    static const std::string& text();
    static const std::string& name();
    static void cleanupParser();
@@ -185,8 +188,12 @@ public:
 private:
     static xercesc::XercesDOMParser** getParserPointerInternal();
     static xercesc::ErrorHandler** getErrorHandlerPointerInternal();
+    static unsigned int& getNumParsesInternal();
     static void initParser();
     static xercesc::XercesDOMParser* getParser();
+    template<class Source>
+    static bool parseSource( const Source& aSource, const std::string& aCacheFile,
+                             IParsable* aModelElement );
 };
 
 
@@ -844,7 +851,9 @@ void XMLWriteVector( const objects::PeriodVector<T>& aOutputVector,
 * \brief Function to parse an XML file, returning a pointer to the root.
 *
 * This is a very simple function which calls the parse function and handles the exceptions which it may throw.
-* It also takes care of fetching the document and its root element.
+* It also takes care of fetching the document and its root element. If the
+* XMLParseCache is enabled and has a copy of the file the document is read from
+* the cache instead, otherwise the parsed document is added to the cache.
 * \param aXMLFile The name of the file to parse.
 * \param aModelElement Element to call XMLParse on.
 * \return Whether parsing was successful.
@@ -852,13 +861,60 @@ void XMLWriteVector( const objects::PeriodVector<T>& aOutputVector,
 
 template <class T>
 bool XMLHelper<T>::parseXML( const std::string& aXMLFile, IParsable* aModelElement ) {
+    XMLParseCache& parseCache = XMLParseCache::getInstance();
+    std::string cacheFile;
+    if( parseCache.isEnabled() ) {
+        cacheFile = parseCache.getCacheFileName( aXMLFile );
+        xercesc::DOMDocument* cachedDocument = cacheFile.empty() ? 0
+            : parseCache.readCachedDocument( aXMLFile, cacheFile );
+        if( cachedDocument ) {
+            bool success = aModelElement->XMLParse( cachedDocument->getDocumentElement() );
+            cachedDocument->release();
+            return success;
+        }
+    }
+    return parseSource( aXMLFile.c_str(), cacheFile, aModelElement );
+}
+
+/*!
+* \brief Function to parse XML contained in a string.
+* \details This allows XML which was generated in memory, such as add-on
+*          values for a single run, to be parsed without writing it to a file.
+*          The document is never cached.
+* \param aXML The XML document to parse.
+* \param aModelElement Element to call XMLParse on.
+* \return Whether parsing was successful.
+*/
+template <class T>
+bool XMLHelper<T>::parseXMLString( const std::string& aXML, IParsable* aModelElement ) {
+    // Make sure the platform is initialized before creating the input source.
+    getParser();
+    const xercesc::MemBufInputSource source( reinterpret_cast<const XMLByte*>( aXML.data() ),
+                                             aXML.size(), "in-memory-xml" );
+    return parseSource( source, "", aModelElement );
+}
+
+/*!
+* \brief Parse a document from a file name or input source and call XMLParse
+*         on its root.
+* \param aSource The file name or input source to parse.
+* \param aCacheFile The name of the parse cache file to write the document to,
+*        or an empty string if it should not be cached.
+* \param aModelElement Element to call XMLParse on.
+* \return Whether parsing was successful.
+*/
+template <class T>
+template <class Source>
+bool XMLHelper<T>::parseSource( const Source& aSource, const std::string& aCacheFile,
+                                IParsable* aModelElement )
+{
     // Track the number of active parses to avoid destroying a document that causes other
     // documents to be parsed before its own parsing was complete.
-    static unsigned int numParses = 0;
+    unsigned int& numParses = getNumParsesInternal();
     ++numParses;
     xercesc::XercesDOMParser* parser = XMLHelper<T>::getParser();
     try {
-        parser->parse( aXMLFile.c_str() );
+        parser->parse( aSource );
     } catch ( const xercesc::XMLException& toCatch ) {
         std::string message = XMLHelper<std::string>::safeTranscode( toCatch.getMessage() );
         std::cout << "ERROR: XML Read Exception message is:" << std::endl << message << std::endl;
@@ -876,6 +932,12 @@ bool XMLHelper<T>::parseXML( const std::string& aXMLFile, IParsable* aModelEleme
         return false;
     }
 
+    // Store the document before parsing it since parsing may cause other
+    // documents to be parsed.
+    if( !aCacheFile.empty() ) {
+        XMLParseCache::getInstance().writeCachedDocument( aCacheFile, parser->getDocument() );
+    }
+
     bool success = aModelElement->XMLParse( parser->getDocument()->getDocumentElement() );
     // Cleanup parser memory if there are no active parses.
     if( --numParses == 0 ){
@@ -1313,6 +1375,12 @@ xercesc::XercesDOMParser** XMLHelper<T>::getParserPointerInternal(){
     return &parser;
 }
 
+template<class T>
+unsigned int& XMLHelper<T>::getNumParsesInternal(){
+    static unsigned int numParses = 0;
+    return numParses;
+}
+
 template<class T>
 xercesc::ErrorHandler** XMLHelper<T>::getErrorHandlerPointerInternal(){
     static xercesc::ErrorHandler* errorHandler;
@@ -0,0 +1,99 @@
+#ifndef _XML_PARSE_CACHE_H_
+#define _XML_PARSE_CACHE_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file xml_parse_cache.h
+* \ingroup Objects
+* \brief The XMLParseCache class header file.
+*/
+
+#include <string>
+#include <iosfwd>
+#include <xercesc/dom/DOMDocument.hpp>
+
+/*!
+ * \ingroup Objects
+ * \brief A cache of validated input files stored in a pre-tokenized binary
+ *        form.
+ * \details Validating and parsing the large input XML files takes a
+ *          significant part of the time to set up a scenario, even though
+ *          most of them do not change between runs.  When the Configuration
+ *          sets the file xml-parse-cache-dir this class stores the DOM tree of
+ *          each file which was successfully parsed in that directory, keyed
+ *          by a hash of the file contents.  Element and attribute names are
+ *          interned in a table at the start of each cache file, and the rest
+ *          of the tree is stored in document order as raw XML strings so it
+ *          can be rebuilt without scanning or validating.  The next time a
+ *          file with the same contents is read the DOM is rebuilt directly
+ *          from the cache file and passed to the ordinary XMLParse methods,
+ *          so Xerces is not used to parse it.  A cache file which is missing,
+ *          corrupt, or written by a different version is treated as a miss.
+ * \note Cache files are only valid on the machine which wrote them since
+ *       they are stored in native byte order.
+ */
+class XMLParseCache {
+public:
+    static XMLParseCache& getInstance();
+
+    bool isEnabled() const;
+
+    std::string getCacheFileName( const std::string& aXMLFile ) const;
+
+    xercesc::DOMDocument* readCachedDocument( const std::string& aXMLFile,
+                                              const std::string& aCacheFile );
+
+    void writeCachedDocument( const std::string& aCacheFile,
+                              const xercesc::DOMDocument* aDocument ) const;
+
+    void printStatistics( std::ostream& aOut ) const;
+private:
+    //! The number of files which were read from the cache.
+    unsigned int mNumHits;
+
+    //! The number of files which had to be parsed by Xerces.
+    unsigned int mNumMisses;
+
+    XMLParseCache();
+    //! Private undefined copy constructor to prevent copying.
+    XMLParseCache( const XMLParseCache& );
+    //! Private undefined assignment operator to prevent copying.
+    XMLParseCache& operator=( const XMLParseCache& );
+};
+
+#endif // _XML_PARSE_CACHE_H_
@@ -0,0 +1,276 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file forked_task_runner.cpp
+* \ingroup Objects
+* \brief ForkedTaskRunner class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <iostream>
+#include <list>
+#include <algorithm>
+#include "util/base/include/forked_task_runner.h"
+
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+using namespace std;
+
+int ForkedTaskRunner::sLockFD = -1;
+
+bool ForkedTaskRunner::sIsForkingDisabled = false;
+
+/*!
+ * \brief Whether tasks may be run in forked child processes.
+ * \return True if forking is supported in this build and has not been
+ *         disabled.
+ */
+bool ForkedTaskRunner::isSupported() {
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+    return !sIsForkingDisabled;
+#else
+    return false;
+#endif
+}
+
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+namespace {
+    /*!
+     * \brief Write an entire buffer to a file descriptor.
+     * \param aFD The file descriptor to write to.
+     * \param aData The data to write.
+     * \return Whether all of the data was written.
+     */
+    bool writeAll( const int aFD, const string& aData ) {
+        size_t written = 0;
+        while( written < aData.size() ) {
+            const ssize_t numWritten = write( aFD, aData.data() + written, aData.size() - written );
+            if( numWritten < 0 ) {
+                if( errno == EINTR ) {
+                    continue;
+                }
+                return false;
+            }
+            written += numWritten;
+        }
+        return true;
+    }
+
+    /*!
+     * \brief Read from a file descriptor until the other end is closed.
+     * \param aFD The file descriptor to read from.
+     * \param aData String to append the data to.
+     * \return Whether the end of the file was reached without an error.
+     */
+    bool readAll( const int aFD, string& aData ) {
+        char buffer[ 4096 ];
+        while( true ) {
+            const ssize_t numRead = read( aFD, buffer, sizeof( buffer ) );
+            if( numRead == 0 ) {
+                return true;
+            }
+            else if( numRead > 0 ) {
+                aData.append( buffer, numRead );
+            }
+            else if( errno != EINTR ) {
+                return false;
+            }
+        }
+    }
+
+    //! A child process which has been started but not yet collected.
+    struct RunningChild {
+        //! The process id of the child.
+        pid_t mPID;
+
+        //! The read end of the pipe from the child.
+        int mReadFD;
+
+        //! The index of the task the child is running.
+        int mTaskIndex;
+    };
+}
+#endif
+
+/*!
+ * \brief Run each task in a forked child process and collect the results.
+ * \details If forking is not supported or a child can not be started the
+ *          task is reported to collectResult as not received so that the
+ *          caller may run it in the current process instead.
+ * \param aTask The tasks to run.
+ * \param aNumTasks The number of tasks, which are run in index order.
+ * \param aMaxWorkers The maximum number of child processes to run at once.
+ */
+void ForkedTaskRunner::run( IForkedTask& aTask, const int aNumTasks, const int aMaxWorkers ) {
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+    // Make sure buffered output is not written by both the parent and the children.
+    cout.flush();
+    cerr.flush();
+
+    // Create the file locked by serial sections in the children. The previous
+    // one is restored afterwards in case this is a run within a child.
+    const int previousLockFD = sLockFD;
+    FILE* lockFile = tmpfile();
+    sLockFD = lockFile ? fileno( lockFile ) : -1;
+
+    list<RunningChild> runningChildren;
+    int nextTask = 0;
+    while( nextTask < aNumTasks || !runningChildren.empty() ) {
+        // Start children until the limit is reached.
+        if( nextTask < aNumTasks && static_cast<int>( runningChildren.size() ) < max( aMaxWorkers, 1 ) ) {
+            const int taskIndex = nextTask++;
+            // A task may have started a resource in this process which the
+            // children of later tasks would inherit in a broken state.
+            if( sIsForkingDisabled ) {
+                aTask.collectResult( taskIndex, string(), false, false );
+                continue;
+            }
+
+            int pipeFDs[ 2 ];
+            if( pipe( pipeFDs ) != 0 ) {
+                aTask.collectResult( taskIndex, string(), false, false );
+                continue;
+            }
+
+            const pid_t pid = fork();
+            if( pid == 0 ) {
+                // The child process.
+                close( pipeFDs[ 0 ] );
+                string result;
+                const bool success = aTask.runInChild( taskIndex, result );
+                const bool wroteResult = writeAll( pipeFDs[ 1 ], result );
+                close( pipeFDs[ 1 ] );
+                // Exit immediately so that the parent's resources are not cleaned
+                // up or written out by the child.
+                _exit( !wroteResult ? 2 : success ? 0 : 1 );
+            }
+
+            close( pipeFDs[ 1 ] );
+            if( pid == -1 ) {
+                close( pipeFDs[ 0 ] );
+                aTask.collectResult( taskIndex, string(), false, false );
+                continue;
+            }
+            RunningChild child;
+            child.mPID = pid;
+            child.mReadFD = pipeFDs[ 0 ];
+            child.mTaskIndex = taskIndex;
+            runningChildren.push_back( child );
+            continue;
+        }
+
+        // Collect the oldest child.
+        const RunningChild child = runningChildren.front();
+        runningChildren.pop_front();
+
+        string result;
+        const bool readResult = readAll( child.mReadFD, result );
+        close( child.mReadFD );
+
+        int status = 0;
+        while( waitpid( child.mPID, &status, 0 ) == -1 && errno == EINTR ) {
+        }
+        const bool exited = WIFEXITED( status );
+        const bool received = readResult && exited && WEXITSTATUS( status ) != 2;
+        aTask.collectResult( child.mTaskIndex, received ? result : string(), received,
+                             exited && WEXITSTATUS( status ) == 0 );
+    }
+
+    if( lockFile ) {
+        fclose( lockFile );
+    }
+    sLockFD = previousLockFD;
+#else
+    for( int taskIndex = 0; taskIndex < aNumTasks; ++taskIndex ) {
+        aTask.collectResult( taskIndex, string(), false, false );
+    }
+#endif
+}
+
+/*!
+ * \brief Stop running tasks in forked child processes for the rest of the
+ *        life of this process.
+ * \details This must be called when the process starts a resource which
+ *          does not survive a fork, such as a Java VM, as the threads it
+ *          depends on would not exist in the child.
+ */
+void ForkedTaskRunner::disableForking() {
+    sIsForkingDisabled = true;
+}
+
+/*!
+ * \brief Wait until no other child of the current run is in a serial section
+ *        and enter it.
+ * \details This does nothing if it is not called from a child of a run.
+ */
+void ForkedTaskRunner::beginSerialSection() {
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+    if( sLockFD == -1 ) {
+        return;
+    }
+    // Record locks belong to the process, so the children of a run exclude
+    // each other even though they share the inherited descriptor.
+    struct flock lock;
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = 0;
+    lock.l_len = 0;
+    while( fcntl( sLockFD, F_SETLKW, &lock ) == -1 && errno == EINTR ) {
+    }
+#endif
+}
+
+/*!
+ * \brief Leave a serial section entered with beginSerialSection.
+ */
+void ForkedTaskRunner::endSerialSection() {
+#if !defined( WIN32 ) && !GCAM_PARALLEL_ENABLED
+    if( sLockFD == -1 ) {
+        return;
+    }
+    struct flock lock;
+    lock.l_type = F_UNLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = 0;
+    lock.l_len = 0;
+    fcntl( sLockFD, F_SETLK, &lock );
+#endif
+}
@@ -0,0 +1,456 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+
+/*! 
+* \file xml_parse_cache.cpp
+* \ingroup Objects
+* \brief XMLParseCache class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdint.h>
+#if defined( WIN32 )
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <xercesc/dom/DOMImplementation.hpp>
+#include <xercesc/dom/DOMElement.hpp>
+#include <xercesc/dom/DOMNamedNodeMap.hpp>
+#include <xercesc/dom/DOMText.hpp>
+#include <xercesc/util/XMLString.hpp>
+#include "util/base/include/xml_parse_cache.h"
+#include "util/base/include/configuration.h"
+#include "util/logger/include/ilogger.h"
+
+using namespace std;
+using namespace xercesc;
+
+namespace {
+    //! Identifies a cache file and the version of its format.
+    const char CACHE_FILE_TAG[] = "GCAMXC01";
+
+    //! The length of the tag, without the null terminator.
+    const size_t CACHE_FILE_TAG_LENGTH = sizeof( CACHE_FILE_TAG ) - 1;
+
+    //! Record types which make up the body of a cache file.
+    enum RecordType {
+        END_ELEMENT,
+        ELEMENT,
+        TEXT
+    };
+
+    //! A null terminated XML string which may be used as a map key.
+    typedef vector<XMLCh> XMLChString;
+
+    /*!
+     * \brief Builds the body of a cache file and the table of names it uses.
+     * \details Nodes are written in document order.  An element is written as
+     *          its interned name, its attributes, its children, and finally an
+     *          end record.  Text and CDATA nodes are written as text records.
+     *          No other node types are kept by the parser.
+     */
+    class CacheFileWriter {
+    public:
+        void writeNode( const DOMNode* aNode );
+        void writeFile( ostream& aOut ) const;
+    private:
+        //! Map of interned name to its index in the name table.
+        map<XMLChString, uint32_t> mNameIndices;
+
+        //! Names in the order they were interned.
+        vector<const XMLChString*> mNames;
+
+        //! The records written so far.
+        ostringstream mBody;
+
+        uint32_t internName( const XMLCh* aName );
+    };
+
+    //! Write an integer in native byte order.
+    void writeInt( ostream& aOut, const uint32_t aValue ) {
+        aOut.write( reinterpret_cast<const char*>( &aValue ), sizeof( aValue ) );
+    }
+
+    //! Write an XML string as its length followed by its characters.
+    void writeXMLString( ostream& aOut, const XMLCh* aString ) {
+        const uint32_t length = static_cast<uint32_t>( XMLString::stringLen( aString ) );
+        writeInt( aOut, length );
+        aOut.write( reinterpret_cast<const char*>( aString ), length * sizeof( XMLCh ) );
+    }
+
+    //! Get the index of the name in the name table, adding it if necessary.
+    uint32_t CacheFileWriter::internName( const XMLCh* aName ) {
+        const XMLChString key( aName, aName + XMLString::stringLen( aName ) + 1 );
+        map<XMLChString, uint32_t>::iterator found = mNameIndices.find( key );
+        if( found != mNameIndices.end() ) {
+            return found->second;
+        }
+        const uint32_t index = static_cast<uint32_t>( mNames.size() );
+        found = mNameIndices.insert( make_pair( key, index ) ).first;
+        mNames.push_back( &found->first );
+        return index;
+    }
+
+    //! Write the node and all of its children as records.
+    void CacheFileWriter::writeNode( const DOMNode* aNode ) {
+        const short nodeType = aNode->getNodeType();
+        if( nodeType == DOMNode::TEXT_NODE || nodeType == DOMNode::CDATA_SECTION_NODE ) {
+            mBody.put( static_cast<char>( TEXT ) );
+            writeXMLString( mBody, aNode->getNodeValue() );
+        }
+        else if( nodeType == DOMNode::ELEMENT_NODE ) {
+            mBody.put( static_cast<char>( ELEMENT ) );
+            writeInt( mBody, internName( aNode->getNodeName() ) );
+
+            const DOMNamedNodeMap* attrs = aNode->getAttributes();
+            const uint32_t numAttrs = attrs ? static_cast<uint32_t>( attrs->getLength() ) : 0;
+            writeInt( mBody, numAttrs );
+            for( uint32_t i = 0; i < numAttrs; ++i ) {
+                const DOMNode* currAttr = attrs->item( i );
+                writeInt( mBody, internName( currAttr->getNodeName() ) );
+                writeXMLString( mBody, currAttr->getNodeValue() );
+            }
+
+            for( const DOMNode* child = aNode->getFirstChild(); child; child = child->getNextSibling() ) {
+                writeNode( child );
+            }
+            mBody.put( static_cast<char>( END_ELEMENT ) );
+        }
+    }
+
+    //! Write the complete cache file: the tag, the name table, and the body.
+    void CacheFileWriter::writeFile( ostream& aOut ) const {
+        aOut.write( CACHE_FILE_TAG, CACHE_FILE_TAG_LENGTH );
+        writeInt( aOut, static_cast<uint32_t>( mNames.size() ) );
+        for( vector<const XMLChString*>::const_iterator it = mNames.begin(); it != mNames.end(); ++it ) {
+            writeXMLString( aOut, &( **it )[ 0 ] );
+        }
+        const string body = mBody.str();
+        aOut.write( body.data(), body.size() );
+    }
+
+    /*!
+     * \brief Reads values from the contents of a cache file.
+     * \details Reading past the end of the data puts the reader in a failed
+     *          state rather than throwing so that a truncated file can be
+     *          treated as a cache miss.
+     */
+    class CacheFileReader {
+    public:
+        CacheFileReader( const vector<char>& aData ):mData( aData ), mPosition( 0 ), mFailed( false ) {}
+
+        //! Whether a read has failed.
+        bool failed() const { return mFailed; }
+
+        //! Whether all the data has been read.
+        bool atEnd() const { return mPosition == mData.size(); }
+
+        //! Read the given number of bytes into the destination.
+        void read( void* aDest, const size_t aLength ) {
+            if( mFailed || mData.size() - mPosition < aLength ) {
+                mFailed = true;
+                return;
+            }
+            if( aLength > 0 ) {
+                memcpy( aDest, &mData[ mPosition ], aLength );
+            }
+            mPosition += aLength;
+        }
+
+        //! Read an integer in native byte order.
+        uint32_t readInt() {
+            uint32_t value = 0;
+            read( &value, sizeof( value ) );
+            return value;
+        }
+
+        //! Read a record type.
+        char readRecordType() {
+            char type = END_ELEMENT;
+            read( &type, sizeof( type ) );
+            return type;
+        }
+
+        //! Read an XML string into a null terminated buffer.
+        void readXMLString( XMLChString& aString ) {
+            const uint32_t length = readInt();
+            if( mFailed || ( mData.size() - mPosition ) / sizeof( XMLCh ) < length ) {
+                mFailed = true;
+                return;
+            }
+            aString.resize( length + 1 );
+            read( &aString[ 0 ], length * sizeof( XMLCh ) );
+            aString[ length ] = 0;
+        }
+    private:
+        //! The contents of the cache file.
+        const vector<char>& mData;
+
+        //! The position of the next byte to read.
+        size_t mPosition;
+
+        //! Whether a read has failed.
+        bool mFailed;
+    };
+
+    /*!
+     * \brief Rebuild the document stored in a cache file.
+     * \param aReader Reader positioned at the start of the cache file.
+     * \return The document, or null if the file was not a valid cache file.
+     *         The caller is responsible for releasing it.
+     */
+    DOMDocument* buildDocument( CacheFileReader& aReader ) {
+        char tag[ CACHE_FILE_TAG_LENGTH ];
+        aReader.read( tag, CACHE_FILE_TAG_LENGTH );
+        if( aReader.failed() || !equal( tag, tag + CACHE_FILE_TAG_LENGTH, CACHE_FILE_TAG ) ) {
+            return 0;
+        }
+
+        const uint32_t numNames = aReader.readInt();
+        vector<XMLChString> names;
+        for( uint32_t i = 0; i < numNames && !aReader.failed(); ++i ) {
+            names.push_back( XMLChString() );
+            aReader.readXMLString( names.back() );
+        }
+        if( aReader.failed() ) {
+            return 0;
+        }
+
+        DOMDocument* doc = DOMImplementation::getImplementation()->createDocument();
+        DOMNode* parent = doc;
+        XMLChString value;
+        bool isComplete = false;
+        while( !isComplete && !aReader.failed() ) {
+            const char type = aReader.readRecordType();
+            if( aReader.failed() ) {
+                break;
+            }
+            if( type == ELEMENT ) {
+                const uint32_t nameIndex = aReader.readInt();
+                if( nameIndex >= names.size() ) {
+                    break;
+                }
+                DOMElement* element = doc->createElement( &names[ nameIndex ][ 0 ] );
+                const uint32_t numAttrs = aReader.readInt();
+                for( uint32_t i = 0; i < numAttrs && !aReader.failed(); ++i ) {
+                    const uint32_t attrIndex = aReader.readInt();
+                    aReader.readXMLString( value );
+                    if( aReader.failed() || attrIndex >= names.size() ) {
+                        break;
+                    }
+                    element->setAttribute( &names[ attrIndex ][ 0 ], &value[ 0 ] );
+                }
+                parent->appendChild( element );
+                parent = element;
+            }
+            else if( type == TEXT && parent != doc ) {
+                aReader.readXMLString( value );
+                if( !aReader.failed() ) {
+                    parent->appendChild( doc->createTextNode( &value[ 0 ] ) );
+                }
+            }
+            else if( type == END_ELEMENT && parent != doc ) {
+                parent = parent->getParentNode();
+                // The document is complete once the root element is closed.
+                isComplete = parent == doc;
+            }
+            else {
+                break;
+            }
+        }
+
+        if( !isComplete || aReader.failed() || !aReader.atEnd() ) {
+            doc->release();
+            return 0;
+        }
+        return doc;
+    }
+}
+
+//! Private constructor to prevent multiple instances.
+XMLParseCache::XMLParseCache():mNumHits( 0 ), mNumMisses( 0 )
+{
+}
+
+/*!
+ * \brief Get the single instance of the XMLParseCache.
+ * \return The XMLParseCache.
+ */
+XMLParseCache& XMLParseCache::getInstance() {
+    static XMLParseCache sInstance;
+    return sInstance;
+}
+
+/*!
+ * \brief Whether the cache has been configured.
+ * \details The cache is used only if the Configuration sets the file
+ *          xml-parse-cache-dir.  Files parsed before the Configuration, such
+ *          as the Configuration itself, are never cached.
+ * \return Whether the cache should be used.
+ */
+bool XMLParseCache::isEnabled() const {
+    return !Configuration::getInstance()->getFile( "xml-parse-cache-dir", "", false ).empty();
+}
+
+/*!
+ * \brief Get the name of the cache file for an input file.
+ * \details The name is a 64 bit FNV-1a hash of the contents of the input file
+ *          so that an input file which is modified, or a different input file
+ *          with the same name, will not match an old cache file.
+ * \param aXMLFile The input file.
+ * \return The cache file name, or the empty string if the input file could
+ *         not be read.
+ */
+string XMLParseCache::getCacheFileName( const string& aXMLFile ) const {
+    ifstream inputFile( aXMLFile.c_str(), ios::in | ios::binary );
+    if( !inputFile ) {
+        return "";
+    }
+
+    const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = FNV_OFFSET_BASIS;
+    char buffer[ 64 * 1024 ];
+    while( inputFile.read( buffer, sizeof( buffer ) ) || inputFile.gcount() > 0 ) {
+        const streamsize numRead = inputFile.gcount();
+        for( streamsize i = 0; i < numRead; ++i ) {
+            hash ^= static_cast<unsigned char>( buffer[ i ] );
+            hash *= FNV_PRIME;
+        }
+    }
+
+    string cacheDir = Configuration::getInstance()->getFile( "xml-parse-cache-dir", "", false );
+    if( cacheDir[ cacheDir.size() - 1 ] != '/' && cacheDir[ cacheDir.size() - 1 ] != '\\' ) {
+        cacheDir += '/';
+    }
+    ostringstream cacheFileName;
+    cacheFileName << cacheDir << hex << setfill( '0' ) << setw( 16 ) << hash << ".xmlc";
+    return cacheFileName.str();
+}
+
+/*!
+ * \brief Rebuild a document from its cache file.
+ * \details Records a hit if the document could be read, otherwise a miss.
+ *          The document URI is set to the input file so that errors found
+ *          while parsing the document report the correct file.
+ * \param aXMLFile The input file the cache file was created from.
+ * \param aCacheFile The cache file name from getCacheFileName.
+ * \return The document or null if the cache file does not exist or is not
+ *         valid.  The caller is responsible for releasing the document.
+ */
+DOMDocument* XMLParseCache::readCachedDocument( const string& aXMLFile,
+                                                const string& aCacheFile )
+{
+    DOMDocument* doc = 0;
+    ifstream cacheFile( aCacheFile.c_str(), ios::in | ios::binary );
+    if( cacheFile ) {
+        vector<char> data;
+        cacheFile.seekg( 0, ios::end );
+        data.resize( static_cast<size_t>( cacheFile.tellg() ) );
+        cacheFile.seekg( 0, ios::beg );
+        if( !data.empty() && cacheFile.read( &data[ 0 ], data.size() ) ) {
+            CacheFileReader reader( data );
+            doc = buildDocument( reader );
+        }
+    }
+
+    if( doc ) {
+        XMLCh* documentURI = XMLString::transcode( aXMLFile.c_str() );
+        doc->setDocumentURI( documentURI );
+        XMLString::release( &documentURI );
+        ++mNumHits;
+    }
+    else {
+        ++mNumMisses;
+    }
+    return doc;
+}
+
+/*!
+ * \brief Store a document which was successfully parsed in the cache.
+ * \details The file is written under a temporary name which is unique to
+ *          this process and then renamed so that concurrent runs sharing a
+ *          cache directory never read a partially written file or write
+ *          over each other's temporary file.  Failure to write the cache is not an
+ *          error, the input file will just be parsed again next time.
+ * \param aCacheFile The cache file name from getCacheFileName.
+ * \param aDocument The parsed document.
+ */
+void XMLParseCache::writeCachedDocument( const string& aCacheFile,
+                                         const DOMDocument* aDocument ) const
+{
+    CacheFileWriter writer;
+    writer.writeNode( aDocument->getDocumentElement() );
+
+    stringstream tempFileName;
+#if defined( WIN32 )
+    tempFileName << aCacheFile << "." << _getpid() << ".tmp";
+#else
+    tempFileName << aCacheFile << "." << getpid() << ".tmp";
+#endif
+    {
+        ofstream tempFile( tempFileName.str().c_str(), ios::out | ios::binary | ios::trunc );
+        if( tempFile ) {
+            writer.writeFile( tempFile );
+        }
+        if( !tempFile ) {
+            ILogger& mainLog = ILogger::getLogger( "main_log" );
+            mainLog.setLevel( ILogger::WARNING );
+            mainLog << "Could not write XML parse cache file " << aCacheFile << endl;
+            remove( tempFileName.str().c_str() );
+            return;
+        }
+    }
+    if( rename( tempFileName.str().c_str(), aCacheFile.c_str() ) != 0 ) {
+        // Another run may have written the same file already.
+        remove( tempFileName.str().c_str() );
+    }
+}
+
+/*!
+ * \brief Print the number of cache hits and misses.
+ * \param aOut Stream to print to.
+ */
+void XMLParseCache::printStatistics( ostream& aOut ) const {
+    aOut << "XML parse cache hits: " << mNumHits << " misses: " << mNumMisses << endl;
+}
@@ -0,0 +1,111 @@
+#ifndef _ASYNC_LOG_WRITER_H_
+#define _ASYNC_LOG_WRITER_H_
+#if defined(_MSC_VER)
+#pragma once
+#endif
+
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file async_log_writer.h
+* \ingroup Objects
+* \brief The AsyncLogWriter class header file.
+*/
+
+#include <string>
+#include <memory>
+#include "util/logger/include/ilogger.h"
+
+#if GCAM_PARALLEL_ENABLED
+#include <tbb/tbb_thread.h>
+#include <tbb/concurrent_queue.h>
+#endif
+
+class Logger;
+
+/*! 
+* \ingroup Objects
+* \brief Writes completed log messages to their Loggers on a separate thread.
+* \details Loggers which are configured to write asynchronously hand each
+*          complete message to this class which queues it and returns
+*          immediately.  A single writer thread, shared by all Loggers, blocks
+*          on the queue and passes the messages to Logger::logCompleteMessage
+*          in the order they were received.  Only parallel builds have a
+*          writer thread, otherwise messages are written immediately.
+* \warning The writer must be destroyed before the Loggers are closed.
+*/
+class AsyncLogWriter {
+public:
+    AsyncLogWriter();
+    ~AsyncLogWriter();
+    void write( Logger* aLogger, const ILogger::WarningLevel aLevel, const std::string& aMessage );
+    void flush();
+private:
+    //! A single complete message and where it should be written.
+    struct LogMessage {
+        //! The Logger to write the message to, or null for a message which
+        //! only asks the writer thread to flush or stop.
+        Logger* mLogger;
+
+        //! The warning level the message was written at.
+        ILogger::WarningLevel mLevel;
+
+        //! The message without the trailing newline.
+        std::string mMessage;
+
+#if GCAM_PARALLEL_ENABLED
+        //! For a flush request, the queue on which the writer thread signals
+        //! that all earlier messages have been written.  Null for a request
+        //! to stop.
+        tbb::concurrent_bounded_queue<bool>* mFlushed;
+#endif
+    };
+
+#if GCAM_PARALLEL_ENABLED
+    static void runWriterThread( AsyncLogWriter* aWriter );
+
+    //! Messages waiting to be written.
+    tbb::concurrent_bounded_queue<LogMessage> mQueue;
+
+    //! The writer thread.
+    std::auto_ptr<tbb::tbb_thread> mWriterThread;
+#endif
+
+    //! Private undefined copy constructor to prevent copying.
+    AsyncLogWriter( const AsyncLogWriter& );
+    //! Private undefined assignment operator to prevent copying.
+    AsyncLogWriter& operator=( const AsyncLogWriter& );
+};
+
+#endif // _ASYNC_LOG_WRITER_H_
@@ -54,11 +54,13 @@
 
 #if GCAM_PARALLEL_ENABLED
 #include <tbb/spin_mutex.h>
+#include <tbb/enumerable_thread_specific.h>
 #endif
 
 // Forward definition of the Logger class.
 class Logger; 
 class Tabs;
+class AsyncLogWriter;
 
 /*!
 * \ingroup Objects
@@ -66,6 +68,7 @@ class Tabs;
 * 
 * This is a very simple class which contains a pointer to its parent Logger.
 * When the streambuf receives a character it passes it to its parent stream for processing.
+* Strings are passed to the parent all at once rather than character by character.
 *
 * \author Josh Lurz
 * \warning Overriding the iostream class is somewhat difficult so this class may be somewhat esoteric.
@@ -78,6 +81,7 @@ class PassToParentStreamBuf: std::streambuf {
 public:
     PassToParentStreamBuf();
     int overflow( int ch );
+    std::streamsize xsputn( const char* aData, std::streamsize aLength );
     int underflow( int ch );
     void setParent( Logger* parentIn );
     void toDebugXML( std::ostream& out ) const;
@@ -108,10 +112,14 @@ class Logger: public ILogger {
 
     //! Friend declaration to allow LoggerFactory to create Loggers.
     friend class LoggerFactory;
+
+    //! Friend declaration to allow the AsyncLogWriter to write complete messages.
+    friend class AsyncLogWriter;
 public:
     virtual ~Logger(); //!< Virtual destructor.
     virtual void open( const char[] = 0 ) = 0; //!< Pure virtual function called to begin logging.
     int receiveCharFromUnderStream( int ch ); //!< Pure virtual function called to complete the log and clean up.
+    void receiveCharsFromUnderStream( const char* aData, const std::streamsize aLength );
     virtual void close() = 0;
     ILogger::WarningLevel setLevel( const ILogger::WarningLevel newLevel );
     bool wouldPrint(ILogger::WarningLevel aLevel) const;
@@ -140,24 +148,36 @@ protected:
 
 	//! Defines whether to print the warning level.
     bool mPrintLogWarningLevel;
+
+    //! Whether complete messages should be written by the AsyncLogWriter.
+    bool mAsyncWrite;
+
+    //! A weak pointer to the AsyncLogWriter if mAsyncWrite is set.
+    AsyncLogWriter* mAsyncWriter;
     Logger( const std::string& aFileName = "" );
     
 	//! Log a message with the given warning level.
-    virtual void logCompleteMessage( const std::string& aMessage ) = 0;
-    void printToScreenIfConfigured( const std::string& aMessage );
+    virtual void logCompleteMessage( const ILogger::WarningLevel aLevel, const std::string& aMessage ) = 0;
+    void printToScreenIfConfigured( const ILogger::WarningLevel aLevel, const std::string& aMessage );
     static void parseHeader( std::string& aHeader );
     static const std::string& convertLevelToString( ILogger::WarningLevel aLevel );
 private:
-	 //! Buffer which contains characters waiting to be printed.
-    std::stringstream mBuf;
 #if GCAM_PARALLEL_ENABLED
-    tbb::spin_mutex mMutex;  //<! mutex protecting mBuf
+    //! Buffers which contain characters waiting to be printed, one for each
+    //! thread so that partial messages from different threads are not mixed.
+    tbb::enumerable_thread_specific<std::string> mLineBuffers;
+
+    tbb::spin_mutex mMutex;  //<! mutex protecting the log file and screen
+#else
+	 //! Buffer which contains characters waiting to be printed.
+    std::string mLineBuffer;
 #endif
 
 	 //! Underlying ofstream
     PassToParentStreamBuf mUnderStream;
 
     void XMLParse( const xercesc::DOMNode* node );
+    void completeMessage( const std::string& aMessage );
     static const std::string getTimeString();
     static const std::string getDateString();
 };
@@ -48,11 +48,13 @@
 */
 
 #include <map>
+#include <memory>
 #include <xercesc/dom/DOMNode.hpp>
 #include "util/base/include/iparsable.h"
 
 // Forward Declaration
 class Logger;
+class AsyncLogWriter;
 class Tabs;
 
 /*! 
@@ -71,6 +73,7 @@ public:
     static void logNewScenarioStarting( const std::string& aScenarioName );
 private:
     static std::map<std::string,Logger*> mLoggers; //!< Map of logger names to loggers.
+    static std::auto_ptr<AsyncLogWriter> mAsyncWriter; //!< Writer shared by all asynchronous loggers.
     static void XMLParse( const xercesc::DOMNode* aRoot );
     static void cleanUp();
     //! Private undefined constructor to prevent creating a LoggerFactory.
@@ -66,7 +66,7 @@ class PlainTextLogger: public Logger {
     public:
     void open( const char[] = 0 );
     void close();
-    void logCompleteMessage( const std::string& aMessage );
+    void logCompleteMessage( const ILogger::WarningLevel aLevel, const std::string& aMessage );
 private:
     std::ofstream mLogFile; //!< The filestream to which data is written.
     PlainTextLogger( const std::string& aLoggerName ="" );
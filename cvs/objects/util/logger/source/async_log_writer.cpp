@@ -0,0 +1,127 @@
+/*
+* LEGAL NOTICE
+* This computer software was prepared by Battelle Memorial Institute,
+* hereinafter the Contractor, under Contract No. DE-AC05-76RL0 1830
+* with the Department of Energy (DOE). NEITHER THE GOVERNMENT NOR THE
+* CONTRACTOR MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY
+* LIABILITY FOR THE USE OF THIS SOFTWARE. This notice including this
+* sentence must appear on any copies of this computer software.
+* 
+* EXPORT CONTROL
+* User agrees that the Software will not be shipped, transferred or
+* exported into any country or used in any manner prohibited by the
+* United States Export Administration Act or any other applicable
+* export laws, restrictions or regulations (collectively the "Export Laws").
+* Export of the Software may require some form of license or other
+* authority from the U.S. Government, and failure to obtain such
+* export control license may result in criminal liability under
+* U.S. laws. In addition, if the Software is identified as export controlled
+* items under the Export Laws, User represents and warrants that User
+* is not a citizen, or otherwise located within, an embargoed nation
+* (including without limitation Iran, Syria, Sudan, Cuba, and North Korea)
+*     and that User is not otherwise prohibited
+* under the Export Laws from receiving the Software.
+* 
+* Copyright 2011 Battelle Memorial Institute.  All Rights Reserved.
+* Distributed as open-source under the terms of the Educational Community 
+* License version 2.0 (ECL 2.0). http://www.opensource.org/licenses/ecl2.php
+* 
+* For further details, see: http://www.globalchange.umd.edu/models/gcam/
+*
+*/
+
+
+/*! 
+* \file async_log_writer.cpp
+* \ingroup Objects
+* \brief AsyncLogWriter class source file.
+*/
+
+#include "util/base/include/definitions.h"
+#include "util/logger/include/async_log_writer.h"
+#include "util/logger/include/logger.h"
+
+using namespace std;
+
+//! Constructor which starts the writer thread.
+AsyncLogWriter::AsyncLogWriter()
+{
+#if GCAM_PARALLEL_ENABLED
+    mWriterThread.reset( new tbb::tbb_thread( &AsyncLogWriter::runWriterThread, this ) );
+#endif
+}
+
+//! Destructor which writes any remaining messages and stops the writer thread.
+AsyncLogWriter::~AsyncLogWriter() {
+#if GCAM_PARALLEL_ENABLED
+    LogMessage stop;
+    stop.mLogger = 0;
+    stop.mFlushed = 0;
+    mQueue.push( stop );
+    mWriterThread->join();
+#endif
+}
+
+/*!
+ * \brief Queue a complete message to be written to the given Logger.
+ * \param aLogger The Logger which will write the message.
+ * \param aLevel The warning level the message was written at.
+ * \param aMessage The message without the trailing newline.
+ */
+void AsyncLogWriter::write( Logger* aLogger, const ILogger::WarningLevel aLevel, const string& aMessage ) {
+#if GCAM_PARALLEL_ENABLED
+    LogMessage message;
+    message.mLogger = aLogger;
+    message.mLevel = aLevel;
+    message.mMessage = aMessage;
+    message.mFlushed = 0;
+    mQueue.push( message );
+#else
+    aLogger->logCompleteMessage( aLevel, aMessage );
+#endif
+}
+
+/*!
+ * \brief Wait until all messages queued before this call have been written.
+ * \details This is used to make sure serious errors reach the log before the
+ *          model has a chance to abort.  A flush request is queued behind the
+ *          messages and the caller blocks until the writer thread reaches it.
+ */
+void AsyncLogWriter::flush() {
+#if GCAM_PARALLEL_ENABLED
+    tbb::concurrent_bounded_queue<bool> flushed;
+    LogMessage request;
+    request.mLogger = 0;
+    request.mFlushed = &flushed;
+    mQueue.push( request );
+    bool done;
+    flushed.pop( done );
+#endif
+}
+
+#if GCAM_PARALLEL_ENABLED
+/*!
+ * \brief The body of the writer thread.
+ * \details Blocks until a message is available and writes messages in the
+ *          order they were queued.  Flush requests are answered once every
+ *          message queued before them has been written.  The thread exits
+ *          when it receives a request to stop, which is queued after all
+ *          other messages.
+ * \param aWriter The log writer to process.
+ */
+void AsyncLogWriter::runWriterThread( AsyncLogWriter* aWriter ) {
+    LogMessage message;
+    while( true ) {
+        aWriter->mQueue.pop( message );
+        if( message.mLogger ) {
+            message.mLogger->logCompleteMessage( message.mLevel, message.mMessage );
+        }
+        else if( message.mFlushed ) {
+            message.mFlushed->push( true );
+        }
+        else {
+            break;
+        }
+    }
+}
+#endif
@@ -46,9 +46,11 @@
 #include <sstream>
 #include <cassert>
 #include <ctime>
+#include <algorithm>
 #include <xercesc/dom/DOMNode.hpp>
 #include <xercesc/dom/DOMNodeList.hpp>
 #include "util/logger/include/logger.h"
+#include "util/logger/include/async_log_writer.h"
 #include "util/base/include/xml_helper.h"
 
 using namespace std;
@@ -66,6 +68,17 @@ int PassToParentStreamBuf::overflow( int aChar ){
 	return mParent->receiveCharFromUnderStream( aChar );
 }
 
+/*!
+ * \brief Overriding xsputn function which passes an entire string to its parent.
+ * \details This avoids passing strings to the parent one character at a time.
+ */
+streamsize PassToParentStreamBuf::xsputn( const char* aData, streamsize aLength ){
+	/*! \pre Make sure the parent is not null. */
+	assert( mParent );
+	mParent->receiveCharsFromUnderStream( aData, aLength );
+	return aLength;
+}
+
 //! Overriding underflow function which should not be reached because this is a write-only stream.
 int PassToParentStreamBuf::underflow( int aChar ){
 	/*! \pre This function should never be called. */
@@ -88,7 +101,9 @@ mCurrentWarningLevel( ILogger::DEBUG ),
 mFileName( aFileName ),
 mMinLogWarningLevel( ILogger::DEBUG ),
 mMinToScreenWarningLevel( ILogger::SEVERE ),
-mPrintLogWarningLevel( false ){
+mPrintLogWarningLevel( false ),
+mAsyncWrite( false ),
+mAsyncWriter( 0 ){
     // Set the understream's parent to this Logger.
 	mUnderStream.setParent( this );
 }
@@ -97,12 +112,24 @@ mPrintLogWarningLevel( false ){
 Logger::~Logger() {
 }
 
-//! Set the current warning level.
+/*!
+ * \brief Set the current warning level.
+ * \details If messages at the new level would not be printed the stream is put
+ *          into a failed state so that any values written to it are discarded
+ *          before they are formatted.  This makes writing to a log which is
+ *          turned off nearly free.
+ */
 ILogger::WarningLevel Logger::setLevel( const ILogger::WarningLevel aLevel ){
     // Haven't bothered to protect this with a mutex, since doing so
     // doesn't actually solve the race condition.
     ILogger::WarningLevel oldLevel = mCurrentWarningLevel;
     mCurrentWarningLevel = aLevel;
+    if( wouldPrint( aLevel ) ) {
+        clear();
+    }
+    else {
+        setstate( ios_base::badbit );
+    }
     return oldLevel;
 }
 
@@ -117,38 +144,77 @@ bool Logger::wouldPrint(ILogger::WarningLevel aLevel) const
 
 //! Receive a single character from the underlying stream and buffer it, printing the buffer it is a newline.
 int Logger::receiveCharFromUnderStream( int ch ) {
-    // Only receive the character or print to the screen if it needed.
-    if( mCurrentWarningLevel >= mMinLogWarningLevel || mCurrentWarningLevel >= mMinToScreenWarningLevel ){
-        // only really need to lock the mutex if we're going to do something.
+    const char currChar = static_cast<char>( ch );
+    receiveCharsFromUnderStream( &currChar, 1 );
+    return ch;
+}
+
+/*!
+ * \brief Receive a string from the underlying stream and buffer it, printing
+ *        each complete line.
+ * \details Lines are buffered per thread so no locking is required until a
+ *          line is complete.
+ * \param aData The characters to receive.
+ * \param aLength The number of characters to receive.
+ */
+void Logger::receiveCharsFromUnderStream( const char* aData, const streamsize aLength ) {
+    // Only receive the characters if they would be printed.
+    if( !wouldPrint( mCurrentWarningLevel ) ){
+        return;
+    }
 #if GCAM_PARALLEL_ENABLED
-        tbb::spin_mutex::scoped_lock lck( mMutex );
+    string& lineBuffer = mLineBuffers.local();
+#else
+    string& lineBuffer = mLineBuffer;
 #endif
-        if( ch == '\n' ){
-            string tempString( mBuf.str() );
-            logCompleteMessage( tempString );
-            printToScreenIfConfigured( tempString );
-
-            // reset the stringstream buffer
-            mBuf.clear();       // Clear error flags, if any.
-            mBuf.str(std::string()); // clear out the data in the buffer.
-       }
-        else {
-            // The functions that perform the output will add the
-            // newline, so we only want to insert non-newline
-            // characters.
-            mBuf << ( char )ch;
+    const char* end = aData + aLength;
+    while( aData != end ) {
+        const char* newLine = find( aData, end, '\n' );
+        // The functions that perform the output will add the
+        // newline, so we only want to insert non-newline
+        // characters.
+        lineBuffer.append( aData, newLine );
+        if( newLine == end ) {
+            break;
         }
+        completeMessage( lineBuffer );
+        lineBuffer.clear();
+        aData = newLine + 1;
     }
-    return ch;
+}
+
+/*!
+ * \brief Write a complete message to the log and screen.
+ * \details The message is written at the current warning level.  If the
+ *          Logger writes asynchronously the message is handed to the
+ *          AsyncLogWriter, however errors are flushed immediately so that they
+ *          are not lost if the model aborts.
+ * \param aMessage The complete message.
+ */
+void Logger::completeMessage( const string& aMessage ) {
+    const ILogger::WarningLevel currLevel = mCurrentWarningLevel;
+    if( mAsyncWriter ) {
+        mAsyncWriter->write( this, currLevel, aMessage );
+        if( currLevel >= ILogger::ERROR ) {
+            mAsyncWriter->flush();
+        }
+    }
+#if GCAM_PARALLEL_ENABLED
+    tbb::spin_mutex::scoped_lock lck( mMutex );
+#endif
+    if( !mAsyncWriter ) {
+        logCompleteMessage( currLevel, aMessage );
+    }
+    printToScreenIfConfigured( currLevel, aMessage );
 }
 
 //! Print the message to the screen if the Logger is configured to.
-void Logger::printToScreenIfConfigured( const string& aMessage ){
+void Logger::printToScreenIfConfigured( const ILogger::WarningLevel aLevel, const string& aMessage ){
 	// Decide whether to print the message
-	if ( mCurrentWarningLevel >= mMinToScreenWarningLevel ) {
+	if ( aLevel >= mMinToScreenWarningLevel ) {
 		// Print the warning level
-		if ( mPrintLogWarningLevel || mCurrentWarningLevel >= ILogger::ERROR ) {
-            cout << convertLevelToString( mCurrentWarningLevel ) << ":";
+		if ( mPrintLogWarningLevel || aLevel >= ILogger::ERROR ) {
+            cout << convertLevelToString( aLevel ) << ":";
 		}
 		cout << aMessage << endl;
 	}
@@ -184,6 +250,9 @@ void Logger::XMLParse( const DOMNode* aNode ){
 		else if ( nodeName == "headerMessage" ) {
 			mHeaderMessage = XMLHelper<string>::getValue( curr );
 		}
+		else if ( nodeName == "asyncWrite" ) {
+			mAsyncWrite = XMLHelper<bool>::getValue( curr );
+		}
 	}
 }
 
@@ -194,6 +263,7 @@ void Logger::toDebugXML( ostream& out, Tabs* tabs ) const {
 	XMLWriteElement( mMinLogWarningLevel, "minLogWarningLevel", out, tabs );
 	XMLWriteElement( mMinToScreenWarningLevel, "minToScreenWarningLevel", out, tabs );
 	XMLWriteElement( mPrintLogWarningLevel, "printLogWarningLevel", out, tabs );
+	XMLWriteElement( mAsyncWrite, "asyncWrite", out, tabs );
 	XMLWriteClosingTag( "Logger", out, tabs );
 }
 
@@ -50,6 +50,7 @@
 #include "util/logger/include/logger_factory.h"
 #include "util/logger/include/logger.h"
 #include "util/logger/include/ilogger.h"
+#include "util/logger/include/async_log_writer.h"
 // Logger subclass headers.
 #include "util/logger/include/plain_text_logger.h"
 #include "util/logger/include/xml_logger.h"
@@ -58,6 +59,7 @@ using namespace std;
 using namespace xercesc;
 
 map<string,Logger*> LoggerFactory::mLoggers;
+auto_ptr<AsyncLogWriter> LoggerFactory::mAsyncWriter;
 
 //! Parse the XML data.
 void LoggerFactory::XMLParse( const DOMNode* aRoot ){
@@ -91,6 +93,13 @@ void LoggerFactory::XMLParse( const DOMNode* aRoot ){
 			
 			newLogger->XMLParse( curr );
 			newLogger->open();
+			// Create the shared writer the first time a Logger requests it.
+			if( newLogger->mAsyncWrite ) {
+				if( !mAsyncWriter.get() ) {
+					mAsyncWriter.reset( new AsyncLogWriter() );
+				}
+				newLogger->mAsyncWriter = mAsyncWriter.get();
+			}
 			mLoggers[ newLogger->mName ] = newLogger;
 		}
 	}
@@ -119,6 +128,8 @@ Logger& LoggerFactory::getLogger( const string& aLoggerName ) {
 
 //! Cleans up the logger.
 void LoggerFactory::cleanUp() {
+	// Write any queued messages before the loggers are closed.
+	mAsyncWriter.reset();
 	for( map<string,Logger*>::iterator logIter = mLoggers.begin(); logIter != mLoggers.end(); logIter++ ){
 		logIter->second->close();
 		delete logIter->second;
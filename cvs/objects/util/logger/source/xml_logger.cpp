@@ -79,14 +79,14 @@ void XMLLogger::close(){
 }
 
 //! Logs a single message.
-void XMLLogger::logCompleteMessage( const string& aMessage ){
+void XMLLogger::logCompleteMessage( const ILogger::WarningLevel aLevel, const string& aMessage ){
 	// Decide whether to print the message
-	if ( mCurrentWarningLevel >= mMinLogWarningLevel ){
+	if ( aLevel >= mMinLogWarningLevel ){
 		// Print the opening log tag.
 		mLogFile << "\t<LogEntry>" << endl;
 		
 		// Print the warning level
-		mLogFile << "\t\t<WarningLevel>" << convertLevelToString( mCurrentWarningLevel ) << "</WarningLevel>" << endl;
+		mLogFile << "\t\t<WarningLevel>" << convertLevelToString( aLevel ) << "</WarningLevel>" << endl;
 
 		// Print the message
 		mLogFile << "\t\t<Message>" << aMessage << "</Message>" << endl;